@@ -81,6 +81,10 @@ struct daos_event_private {
 	struct daos_event_callback evx_callback;
 
 	tse_sched_t		*evx_sched;
+
+	/** link chains on the lock-free stacks of EQ, see daos_eq_private */
+	struct daos_event_private *evx_launch_next;
+	struct daos_event_private *evx_comp_next;
 };
 
 static inline struct daos_event_private *
@@ -99,8 +103,18 @@ struct daos_eq_private {
 	/* link chain in the global hash list */
 	struct d_hlink		eqx_hlink;
 	pthread_mutex_t		eqx_lock;
-	unsigned int		eqx_lock_init:1,
-				eqx_finalizing:1;
+	unsigned int		eqx_lock_init:1;
+	/* set by destroy, it's read without lock by launch */
+	int			eqx_finalizing;
+	/* number of launches in progress without lock */
+	int			eqx_launching;
+	/*
+	 * Launched and completed events are pushed to these lock-free stacks
+	 * by any thread, they are moved to eq_running and eq_comp in batch
+	 * by whoever holds eqx_lock, e.g. the poller.
+	 */
+	struct daos_event_private *eqx_launched;
+	struct daos_event_private *eqx_completed;
 
 	/* CRT context associated with this eq */
 	crt_context_t		eqx_ctx;
@@ -30,7 +30,9 @@
  */
 #define D_LOGFAC	DD_FAC(client)
 
+#include <sched.h>
 #include "client_internal.h"
+#include <daos/object.h>
 #include <daos/rpc.h>
 
 /** thread-private event */
@@ -202,6 +204,7 @@ daos_eq_alloc(void)
 	eq->eq_n_comp = 0;
 
 	eqx = daos_eq2eqx(eq);
+	D_CASSERT(sizeof(eq->eq_private) >= sizeof(*eqx));
 
 	rc = D_MUTEX_INIT(&eqx->eqx_lock, NULL);
 	if (rc != 0)
@@ -252,24 +255,121 @@ daos_eq_handle(struct daos_eq_private *eqx, daos_handle_t *h)
 }
 
 static void
-daos_event_launch_locked(struct daos_eq_private *eqx,
-			 struct daos_event_private *evx)
+daos_eq_launch_push(struct daos_eq_private *eqx, struct daos_event_private *evx)
 {
-	struct daos_eq *eq = NULL;
+	struct daos_event_private *head;
+
+	head = __atomic_load_n(&eqx->eqx_launched, __ATOMIC_RELAXED);
+	do {
+		evx->evx_launch_next = head;
+	} while (!__atomic_compare_exchange_n(&eqx->eqx_launched, &head, evx,
+					      true, __ATOMIC_RELEASE,
+					      __ATOMIC_RELAXED));
+}
 
-	if (eqx != NULL)
-		eq = daos_eqx2eq(eqx);
+static void
+daos_eq_comp_push(struct daos_eq_private *eqx, struct daos_event_private *evx)
+{
+	struct daos_event_private *head;
+
+	head = __atomic_load_n(&eqx->eqx_completed, __ATOMIC_RELAXED);
+	do {
+		evx->evx_comp_next = head;
+	} while (!__atomic_compare_exchange_n(&eqx->eqx_completed, &head, evx,
+					      true, __ATOMIC_RELEASE,
+					      __ATOMIC_RELAXED));
+}
+
+/**
+ * Move all events pushed to the lock-free stacks to the lists of EQ, each
+ * stack is taken by one atomic exchange. Completions are taken before
+ * launches, so the launch of any taken completion has been taken as well.
+ */
+static void
+daos_eq_reap_locked(struct daos_eq_private *eqx)
+{
+	struct daos_eq			*eq = daos_eqx2eq(eqx);
+	struct daos_event_private	*comp;
+	struct daos_event_private	*launched;
+	struct daos_event_private	*evx;
+	struct daos_event_private	*prev;
+
+	comp = __atomic_exchange_n(&eqx->eqx_completed, NULL,
+				   __ATOMIC_ACQUIRE);
+	launched = __atomic_exchange_n(&eqx->eqx_launched, NULL,
+				       __ATOMIC_ACQUIRE);
+
+	/* stacks are LIFO, reverse them to keep the order of events */
+	for (prev = NULL; launched != NULL; launched = evx) {
+		evx = launched->evx_launch_next;
+		launched->evx_launch_next = prev;
+		prev = launched;
+	}
+
+	for (evx = prev; evx != NULL; evx = evx->evx_launch_next) {
+		d_list_add_tail(&evx->evx_link, &eq->eq_running);
+		eq->eq_n_running++;
+	}
 
+	for (prev = NULL; comp != NULL; comp = evx) {
+		evx = comp->evx_comp_next;
+		comp->evx_comp_next = prev;
+		prev = comp;
+	}
+
+	for (evx = prev; evx != NULL; evx = evx->evx_comp_next) {
+		D_ASSERT(!d_list_empty(&evx->evx_link));
+		evx->evx_status = DAOS_EVS_COMPLETED;
+		d_list_move_tail(&evx->evx_link, &eq->eq_comp);
+		eq->eq_n_comp++;
+		D_ASSERT(eq->eq_n_running > 0);
+		eq->eq_n_running--;
+	}
+}
+
+/**
+ * Launch a child or a barrier parent with the EQ lock held. A barrier parent
+ * still goes through the launch stack rather than eq_running, otherwise it
+ * could be linked ahead of events launched before it but not reaped yet.
+ * Its completion, which can be pushed right after this, is always taken
+ * with its launch by daos_eq_reap_locked().
+ */
+static void
+daos_event_launch_locked(struct daos_eq_private *eqx,
+			 struct daos_event_private *evx)
+{
 	evx->evx_status = DAOS_EVS_RUNNING;
 	if (evx->evx_parent != NULL) {
 		evx->evx_parent->evx_nchild_running++;
 		return;
 	}
 
-	if (eq != NULL) {
-		d_list_add_tail(&evx->evx_link, &eq->eq_running);
-		eq->eq_n_running++;
+	if (eqx != NULL)
+		daos_eq_launch_push(eqx, evx);
+}
+
+/**
+ * Launch an event without taking the EQ lock, it's pushed to the launch
+ * stack and linked to eq_running by the next reap. Destroy of EQ waits for
+ * launches in progress after setting eqx_finalizing, so either the launch
+ * sees eqx_finalizing, or destroy sees the launch.
+ */
+static int
+daos_event_launch_nolock(struct daos_eq_private *eqx,
+			 struct daos_event_private *evx)
+{
+	int rc = 0;
+
+	__atomic_add_fetch(&eqx->eqx_launching, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&eqx->eqx_finalizing, __ATOMIC_SEQ_CST)) {
+		D_ERROR("Event queue is in progress of finalizing\n");
+		rc = -DER_NONEXIST;
+	} else {
+		evx->evx_status = DAOS_EVS_RUNNING;
+		daos_eq_launch_push(eqx, evx);
 	}
+	__atomic_sub_fetch(&eqx->eqx_launching, 1, __ATOMIC_RELEASE);
+	return rc;
 }
 
 crt_context_t
@@ -338,7 +438,9 @@ daos_event_complete_locked(struct daos_eq_private *eqx,
 	if (eqx != NULL)
 		eq = daos_eqx2eq(eqx);
 
-	evx->evx_status = DAOS_EVS_COMPLETED;
+	/* event in EQ is marked as completed by daos_eq_reap_locked() */
+	if (eq == NULL || parent_evx != NULL)
+		evx->evx_status = DAOS_EVS_COMPLETED;
 	rc = daos_event_complete_cb(evx, rc);
 	ev->ev_error = rc;
 
@@ -373,20 +475,16 @@ daos_event_complete_locked(struct daos_eq_private *eqx,
 
 		/* Complete the barrier parent */
 		D_ASSERT(parent_evx->evx_status == DAOS_EVS_RUNNING);
-		parent_evx->evx_status = DAOS_EVS_COMPLETED;
+		if (eq == NULL)
+			parent_evx->evx_status = DAOS_EVS_COMPLETED;
 		rc = daos_event_complete_cb(parent_evx, rc);
 
 		parent_ev->ev_error = parent_ev->ev_error ?: rc;
 		evx = parent_evx;
 	}
 
-	if (eq != NULL) {
-		D_ASSERT(!d_list_empty(&evx->evx_link));
-		d_list_move_tail(&evx->evx_link, &eq->eq_comp);
-		eq->eq_n_comp++;
-		D_ASSERT(eq->eq_n_running > 0);
-		eq->eq_n_running--;
-	}
+	if (eq != NULL)
+		daos_eq_comp_push(eqx, evx);
 
 	return 0;
 }
@@ -417,6 +515,13 @@ daos_event_launch(struct daos_event *ev)
 			return -DER_NONEXIST;
 		}
 
+		/* nothing else to update for a standalone event in EQ */
+		if (evx->evx_parent == NULL && !evx->is_barrier) {
+			rc = daos_event_launch_nolock(eqx, evx);
+			daos_eq_putref(eqx);
+			return rc;
+		}
+
 		D_MUTEX_LOCK(&eqx->eqx_lock);
 		if (eqx->eqx_finalizing) {
 			D_ERROR("Event queue is in progress of finalizing\n");
@@ -470,12 +575,19 @@ daos_event_complete(struct daos_event *ev, int rc)
 {
 	struct daos_event_private	*evx = daos_ev2evx(ev);
 	struct daos_eq_private		*eqx = NULL;
+	bool				 locked = false;
 
 	if (!daos_handle_is_inval(evx->evx_eqh)) {
 		eqx = daos_eq_lookup(evx->evx_eqh);
 		D_ASSERT(eqx != NULL);
 
-		D_MUTEX_LOCK(&eqx->eqx_lock);
+		/* only completion of child updates the shared states, others
+		 * are pushed to the completion stack without lock.
+		 */
+		if (evx->evx_parent != NULL) {
+			D_MUTEX_LOCK(&eqx->eqx_lock);
+			locked = true;
+		}
 	}
 
 	D_ASSERT(evx->evx_status == DAOS_EVS_RUNNING ||
@@ -483,7 +595,7 @@ daos_event_complete(struct daos_event *ev, int rc)
 
 	daos_event_complete_locked(eqx, evx, rc);
 
-	if (eqx != NULL)
+	if (locked)
 		D_MUTEX_UNLOCK(&eqx->eqx_lock);
 
 	if (eqx != NULL)
@@ -502,12 +614,21 @@ ev_progress_cb(void *arg)
 	struct daos_event_private       *evx = epa->evx;
 	struct daos_eq_private		*eqx = epa->eqx;
 
+	dc_obj_progress(evx->evx_ctx);
 	tse_sched_progress(evx->evx_sched);
 
 	/** If another thread progressed this, get out now. */
 	if (evx->evx_status == DAOS_EVS_READY)
 		return 1;
 
+	/** completion of event in EQ is visible after it's been reaped */
+	if (eqx != NULL && evx->evx_status == DAOS_EVS_RUNNING &&
+	    __atomic_load_n(&eqx->eqx_completed, __ATOMIC_ACQUIRE) != NULL) {
+		D_MUTEX_LOCK(&eqx->eqx_lock);
+		daos_eq_reap_locked(eqx);
+		D_MUTEX_UNLOCK(&eqx->eqx_lock);
+	}
+
 	/** Event is still in-flight */
 	if (evx->evx_status != DAOS_EVS_COMPLETED &&
 	    evx->evx_status != DAOS_EVS_ABORTED)
@@ -645,12 +766,23 @@ eq_progress_cb(void *arg)
 	struct daos_eq			*eq;
 	struct daos_event_private	*evx;
 	struct daos_event_private	*tmp;
+	struct daos_event_private	*comp;
 
 	eq = daos_eqx2eq(epa->eqx);
 
+	dc_obj_progress(epa->eqx->eqx_ctx);
 	tse_sched_progress(&epa->eqx->eqx_sched);
 
+	/* nothing to reap or poll, don't take the lock */
+	comp = __atomic_load_n(&epa->eqx->eqx_completed, __ATOMIC_ACQUIRE);
+	if (!epa->wait_running && comp == NULL &&
+	    __atomic_load_n(&eq->eq_n_comp, __ATOMIC_RELAXED) == 0 &&
+	    !__atomic_load_n(&epa->eqx->eqx_finalizing, __ATOMIC_RELAXED))
+		return 0;
+
 	D_MUTEX_LOCK(&epa->eqx->eqx_lock);
+	/* all completions since the last poll are reaped at once */
+	daos_eq_reap_locked(epa->eqx);
 	d_list_for_each_entry_safe(evx, tmp, &eq->eq_comp, evx_link) {
 		D_ASSERT(eq->eq_n_comp > 0);
 
@@ -752,6 +884,7 @@ daos_eq_query(daos_handle_t eqh, daos_eq_query_t query,
 
 	count = 0;
 	D_MUTEX_LOCK(&eqx->eqx_lock);
+	daos_eq_reap_locked(eqx);
 
 	if (n_events == 0 || events == NULL) {
 		if ((query & DAOS_EQR_COMPLETED) != 0)
@@ -847,6 +980,7 @@ daos_eq_destroy(daos_handle_t eqh, int flags)
 	}
 
 	eq = daos_eqx2eq(eqx);
+	daos_eq_reap_locked(eqx);
 
 	/* If it is not force destroyed, then we need check if
 	 * there are still events linked here */
@@ -858,7 +992,11 @@ daos_eq_destroy(daos_handle_t eqh, int flags)
 	}
 
 	/* prevent other threads to launch new event */
-	eqx->eqx_finalizing = 1;
+	__atomic_store_n(&eqx->eqx_finalizing, 1, __ATOMIC_SEQ_CST);
+	/* wait for the launches which haven't seen eqx_finalizing */
+	while (__atomic_load_n(&eqx->eqx_launching, __ATOMIC_SEQ_CST) != 0)
+		sched_yield();
+	daos_eq_reap_locked(eqx);
 
 	/* abort all launched events */
 	d_list_for_each_entry_safe(evx, tmp, &eq->eq_running, evx_link) {
@@ -1136,6 +1274,7 @@ daos_event_abort(struct daos_event *ev)
 			return -DER_NONEXIST;
 		}
 		D_MUTEX_LOCK(&eqx->eqx_lock);
+		daos_eq_reap_locked(eqx);
 	}
 
 	daos_event_abort_locked(eqx, evx);
@@ -161,6 +161,15 @@ dc_task_get_args(tse_task_t *task)
 	return &task_ptr2args(task)->ta_u;
 }
 
+bool
+dc_task_is_sync(tse_task_t *task)
+{
+	struct daos_task_args *args = task_ptr2args(task);
+
+	return args->ta_magic == DAOS_TASK_MAGIC && args->ta_ev != NULL &&
+	       daos_event_is_priv(args->ta_ev);
+}
+
 void
 dc_task_set_opc(tse_task_t *task, uint32_t opc)
 {
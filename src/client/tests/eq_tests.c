@@ -48,6 +48,7 @@
 #define EQT_EV_COUNT		1000
 #define EQ_COUNT		5
 #define EQT_SLEEP_INV		2
+#define EQT_THREAD_NR		4
 
 #define DAOS_TEST_FMT	"-------- %s test_%s: %s\n"
 
@@ -976,6 +977,194 @@ out_free:
 	return rc;
 }
 
+static struct daos_event	mt_events[EQT_THREAD_NR][EQT_EV_COUNT];
+static int			mt_polled[EQT_THREAD_NR][EQT_EV_COUNT];
+static daos_handle_t		mt_eqh;
+
+/* completion status of event \a i of thread \a tid */
+#define EQT_MT_STATUS(tid, i)	(-((tid) * EQT_EV_COUNT + (i) + 1))
+
+static void *
+eq_test_mt_producer(void *arg)
+{
+	int	tid = (int)(intptr_t)arg;
+	int	rc = 0;
+	int	i;
+
+	/* complete each event right after launching the next one, so the
+	 * launches and completions of all threads are interleaved.
+	 */
+	for (i = 0; i <= EQT_EV_COUNT; i++) {
+		if (i < EQT_EV_COUNT) {
+			rc = daos_event_launch(&mt_events[tid][i]);
+			if (rc != 0) {
+				print_error("Thread %d failed to launch "
+					    "event %d: %d\n", tid, i, rc);
+				break;
+			}
+		}
+		if (i > 0)
+			daos_event_complete(&mt_events[tid][i - 1],
+					    EQT_MT_STATUS(tid, i - 1));
+	}
+	return (void *)(intptr_t)rc;
+}
+
+static void *
+eq_test_mt_poller(void *arg)
+{
+	struct daos_event	**evpps;
+	int			  total;
+	int			  rc = 0;
+	int			  i;
+
+	evpps = malloc(EQT_EV_COUNT * sizeof(*evpps));
+	if (evpps == NULL)
+		return (void *)(intptr_t)-ENOMEM;
+
+	for (total = 0; total < EQT_THREAD_NR * EQT_EV_COUNT; total += rc) {
+		rc = daos_eq_poll(mt_eqh, 0, DAOS_EQ_WAIT, EQT_EV_COUNT,
+				  evpps);
+		if (rc < 0) {
+			print_error("EQ poll returned error: %d\n", rc);
+			goto out;
+		}
+
+		for (i = 0; i < rc; i++) {
+			int idx = evpps[i] - &mt_events[0][0];
+
+			if (idx < 0 || idx >= EQT_THREAD_NR * EQT_EV_COUNT) {
+				print_error("Polled unknown event %p\n",
+					    evpps[i]);
+				rc = -1;
+				goto out;
+			}
+			mt_polled[idx / EQT_EV_COUNT][idx % EQT_EV_COUNT]++;
+		}
+	}
+
+	/* all events have been polled, nothing should be left */
+	rc = daos_eq_poll(mt_eqh, 0, DAOS_EQ_NOWAIT, EQT_EV_COUNT, evpps);
+	if (rc != 0) {
+		print_error("Polled %d events more than launched\n", rc);
+		rc = -1;
+		goto out;
+	}
+
+	rc = daos_eq_query(mt_eqh, DAOS_EQR_ALL, 0, NULL);
+	if (rc != 0) {
+		print_error("EQ should be empty: %d\n", rc);
+		rc = -1;
+		goto out;
+	}
+
+	for (i = 0; i < EQT_THREAD_NR * EQT_EV_COUNT; i++) {
+		rc = daos_event_fini(&mt_events[0][0] + i);
+		if (rc != 0) {
+			print_error("Failed to finalize event %d: %d\n",
+				    i, rc);
+			goto out;
+		}
+	}
+
+	rc = daos_eq_destroy(mt_eqh, 0);
+	if (rc != 0)
+		print_error("Failed to destroy EQ: %d\n", rc);
+out:
+	free(evpps);
+	return (void *)(intptr_t)rc;
+}
+
+static int
+eq_test_8()
+{
+	struct daos_event	*ep;
+	pthread_t		producers[EQT_THREAD_NR];
+	pthread_t		poller;
+	void			*ret;
+	int			rc;
+	int			i;
+	int			j;
+
+	DAOS_TEST_ENTRY("8", "Multi-thread launch/complete/poll/destroy");
+
+	rc = daos_eq_create(&mt_eqh);
+	if (rc != 0) {
+		print_error("Failed to create EQ: %d\n", rc);
+		goto out;
+	}
+
+	for (i = 0; i < EQT_THREAD_NR; i++) {
+		for (j = 0; j < EQT_EV_COUNT; j++) {
+			rc = daos_event_init(&mt_events[i][j], mt_eqh, NULL);
+			if (rc != 0) {
+				print_error("Failed to init event: %d\n", rc);
+				daos_eq_destroy(mt_eqh, DAOS_EQ_DESTROY_FORCE);
+				goto out;
+			}
+		}
+	}
+	memset(mt_polled, 0, sizeof(mt_polled));
+
+	print_message("%d threads launch and complete %d events, "
+		      "another thread polls and destroys EQ\n",
+		      EQT_THREAD_NR, EQT_EV_COUNT);
+	rc = pthread_create(&poller, NULL, eq_test_mt_poller, NULL);
+	if (rc != 0) {
+		print_error("Failed to create poller: %d\n", rc);
+		daos_eq_destroy(mt_eqh, DAOS_EQ_DESTROY_FORCE);
+		goto out;
+	}
+
+	for (i = 0; i < EQT_THREAD_NR; i++) {
+		rc = pthread_create(&producers[i], NULL, eq_test_mt_producer,
+				    (void *)(intptr_t)i);
+		D_ASSERT(rc == 0);
+	}
+
+	for (i = 0; i < EQT_THREAD_NR; i++) {
+		pthread_join(producers[i], &ret);
+		if (ret != NULL)
+			rc = (int)(intptr_t)ret;
+	}
+	pthread_join(poller, &ret);
+	if (ret != NULL)
+		rc = (int)(intptr_t)ret;
+	if (rc != 0)
+		goto out;
+
+	print_message("Check each event is polled once with its status\n");
+	for (i = 0; i < EQT_THREAD_NR; i++) {
+		for (j = 0; j < EQT_EV_COUNT; j++) {
+			if (mt_polled[i][j] != 1) {
+				print_error("Event %d of thread %d is polled "
+					    "%d times\n", j, i,
+					    mt_polled[i][j]);
+				rc = -1;
+				goto out;
+			}
+			if (mt_events[i][j].ev_error != EQT_MT_STATUS(i, j)) {
+				print_error("Event %d of thread %d has status "
+					    "%d\n", j, i,
+					    mt_events[i][j].ev_error);
+				rc = -1;
+				goto out;
+			}
+		}
+	}
+
+	rc = daos_eq_poll(mt_eqh, 0, DAOS_EQ_NOWAIT, 1, &ep);
+	if (rc != -DER_NONEXIST) {
+		print_error("EQ should have been destroyed: %d\n", rc);
+		rc = -1;
+		goto out;
+	}
+	rc = 0;
+out:
+	DAOS_TEST_EXIT(rc);
+	return rc;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1051,6 +1240,12 @@ main(int argc, char **argv)
 		test_fail++;
 	}
 
+	rc = eq_test_8();
+	if (rc != 0) {
+		print_error("EQ TEST 8 failed: %d\n", rc);
+		test_fail++;
+	}
+
 	if (test_fail)
 		print_error("ERROR, %d test(s) failed\n", test_fail);
 	else
@@ -59,7 +59,8 @@ union btr_rec_buf {
 	struct btr_record		rb_rec;
 	struct {
 		struct btr_record	rec;
-		char			key[DAOS_HKEY_MAX];
+		char			key[DAOS_HKEY_MAX +
+						    BTR_REC_INLINE_MAX];
 	}				rb_buf;
 };
 
@@ -121,6 +122,8 @@ struct btr_context {
 	unsigned short			 tc_class;
 	/** cached feature bits, avoid loading from slow memory */
 	uint64_t			 tc_feats;
+	/** cached size of the inline value buffer of each record */
+	int				 tc_inline_size;
 	/** trace for the tree root */
 	struct btr_trace		*tc_trace;
 	/** trace buffer */
@@ -218,6 +221,21 @@ btr_ops(struct btr_context *tcx)
 	return tcx->tc_tins.ti_ops;
 }
 
+/**
+ * Cache the size of the inline value buffer of each record, it depends on
+ * the tree features so it should be called once the root is available.
+ */
+static void
+btr_context_set_inline(struct btr_context *tcx)
+{
+	int size = 0;
+
+	if (btr_ops(tcx)->to_rec_inline_size)
+		size = btr_ops(tcx)->to_rec_inline_size(&tcx->tc_tins);
+
+	D_ASSERT(size <= BTR_REC_INLINE_MAX);
+	tcx->tc_inline_size = size;
+}
 
 /**
  * Create a btree context (in volatile memory).
@@ -267,6 +285,7 @@ btr_context_create(TMMID(struct btr_root) root_mmid, struct btr_root *root,
 		depth		= root->tr_depth;
 		D_DEBUG(DB_TRACE, "Load tree context from "TMMID_PF"\n",
 			TMMID_P(root_mmid));
+		btr_context_set_inline(tcx);
 	}
 
 	btr_context_set_depth(tcx, depth);
@@ -474,7 +493,8 @@ btr_rec_string(struct btr_context *tcx, struct btr_record *rec,
 static inline int
 btr_rec_size(struct btr_context *tcx)
 {
-	return btr_hkey_size(tcx) + sizeof(struct btr_record);
+	return btr_hkey_size(tcx) + tcx->tc_inline_size +
+	       sizeof(struct btr_record);
 }
 
 static struct btr_record *
@@ -699,6 +719,7 @@ btr_root_init(struct btr_context *tcx, struct btr_root *root)
 	root->tr_feats	= tcx->tc_feats;
 	root->tr_order	= tcx->tc_order;
 	root->tr_node	= BTR_NODE_NULL;
+	btr_context_set_inline(tcx);
 
 	return 0;
 }
@@ -1568,6 +1589,381 @@ dbtree_update(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val)
 	return rc;
 }
 
+/** sorting context of dbtree_bulk_load */
+struct btr_bulk_sort {
+	struct btr_context	*bs_tcx;
+	/** DRAM copy of the new records */
+	struct btr_record	*bs_recs;
+	daos_iov_t		*bs_keys;
+	/** records are sorted by this index array */
+	unsigned int		*bs_idx;
+	/** comparison error */
+	int			 bs_rc;
+};
+
+static int
+btr_bulk_cmp(void *array, int a, int b)
+{
+	struct btr_bulk_sort	*bs = array;
+	struct btr_context	*tcx = bs->bs_tcx;
+	struct btr_record	*rec_a;
+	struct btr_record	*rec_b;
+	int			 cmp;
+
+	rec_a = btr_rec_at(tcx, bs->bs_recs, bs->bs_idx[a]);
+	if (tcx->tc_feats & BTR_FEAT_DIRECT_KEY) {
+		cmp = btr_key_cmp(tcx, rec_a, &bs->bs_keys[bs->bs_idx[b]]);
+	} else {
+		rec_b = btr_rec_at(tcx, bs->bs_recs, bs->bs_idx[b]);
+		cmp = btr_hkey_cmp(tcx, rec_a, &rec_b->rec_hkey[0]);
+	}
+
+	switch (cmp) {
+	case BTR_CMP_LT:
+		return -1;
+	case BTR_CMP_GT:
+		return 1;
+	case BTR_CMP_EQ:
+		return 0;
+	default:
+		/* reported as duplicate key, which terminates the sort */
+		bs->bs_rc = -DER_INVAL;
+		return 0;
+	}
+}
+
+static void
+btr_bulk_swap(void *array, int a, int b)
+{
+	struct btr_bulk_sort	*bs = array;
+	unsigned int		 tmp;
+
+	tmp = bs->bs_idx[a];
+	bs->bs_idx[a] = bs->bs_idx[b];
+	bs->bs_idx[b] = tmp;
+}
+
+static daos_sort_ops_t btr_bulk_sort_ops = {
+	.so_cmp		= btr_bulk_cmp,
+	.so_swap	= btr_bulk_swap,
+};
+
+/**
+ * Number of entries of the \a at-th node if \a nr entries are evenly
+ * distributed to \a node_nr nodes.
+ */
+static inline unsigned int
+btr_bulk_node_keyn(unsigned int nr, unsigned int node_nr, unsigned int at)
+{
+	return nr / node_nr + (at < nr % node_nr);
+}
+
+/**
+ * Build the tree bottom-up from the sorted records of \a bs: records are
+ * packed into leaves, then each level of internal nodes is generated from
+ * the level below it until only the root is left.
+ *
+ * Every node allocated by this function is stored in \a nodes, so caller
+ * can release them on failure.
+ */
+static int
+btr_bulk_build(struct btr_context *tcx, struct btr_bulk_sort *bs,
+	       unsigned int nr, TMMID(struct btr_node) *nodes,
+	       unsigned int *nodes_nr)
+{
+	struct btr_root		*root = tcx->tc_tins.ti_root;
+	TMMID(struct btr_node)	*level;
+	TMMID(struct btr_node)	*leaves;
+	struct btr_record	*rec;
+	struct btr_node		*nd;
+	TMMID(struct btr_node)	 nd_mmid;
+	unsigned int		 order = tcx->tc_order;
+	unsigned int		 node_nr;
+	unsigned int		 child_nr;
+	unsigned int		 depth;
+	unsigned int		 keyn;
+	unsigned int		 i;
+	unsigned int		 j;
+	unsigned int		 k;
+	int			 rc;
+
+	node_nr = (nr + order - 2) / (order - 1);
+	/* nodes of the current level, and the leftmost leaf of each of them */
+	D_ALLOC(level, 2 * node_nr * sizeof(*level));
+	if (level == NULL)
+		return -DER_NOMEM;
+	leaves = &level[node_nr];
+
+	for (i = j = 0; i < node_nr; i++) {
+		rc = btr_node_alloc(tcx, &nd_mmid);
+		if (rc != 0)
+			D_GOTO(out, rc);
+
+		nodes[(*nodes_nr)++] = nd_mmid;
+		btr_node_set(tcx, nd_mmid, BTR_NODE_LEAF);
+
+		keyn = btr_bulk_node_keyn(nr, node_nr, i);
+		for (k = 0; k < keyn; k++, j++) {
+			rec = btr_rec_at(tcx, bs->bs_recs, bs->bs_idx[j]);
+			btr_rec_copy(tcx, btr_node_rec_at(tcx, nd_mmid, k),
+				     rec, 1);
+		}
+		btr_mmid2ptr(tcx, nd_mmid)->tn_keyn = keyn;
+		level[i] = leaves[i] = nd_mmid;
+	}
+	D_ASSERT(j == nr);
+
+	/* an internal node has at most @order children */
+	for (depth = 1; node_nr > 1; depth++) {
+		D_ASSERT(depth < BTR_TRACE_MAX);
+
+		child_nr = node_nr;
+		node_nr = (child_nr + order - 1) / order;
+
+		for (i = j = 0; i < node_nr; i++) {
+			rc = btr_node_alloc(tcx, &nd_mmid);
+			if (rc != 0)
+				D_GOTO(out, rc);
+
+			nodes[(*nodes_nr)++] = nd_mmid;
+			nd = btr_mmid2ptr(tcx, nd_mmid);
+			nd->tn_child = level[j];
+
+			/* the first child has no separator key */
+			keyn = btr_bulk_node_keyn(child_nr, node_nr, i) - 1;
+			D_ASSERT(keyn > 0);
+
+			/* NB: level[i] and leaves[i] are overwritten after
+			 * reading level[j] and leaves[j], and j >= i.
+			 */
+			leaves[i] = leaves[j++];
+			for (k = 0; k < keyn; k++, j++) {
+				rec = btr_node_rec_at(tcx, nd_mmid, k);
+				rec->rec_mmid = umem_id_t2u(level[j]);
+				if (tcx->tc_feats & BTR_FEAT_DIRECT_KEY)
+					rec->rec_node[0] = leaves[j];
+				else
+					btr_rec_copy_hkey(tcx, rec,
+						btr_node_rec_at(tcx, leaves[j],
+								0));
+			}
+			nd->tn_keyn = keyn;
+			level[i] = nd_mmid;
+		}
+		D_ASSERT(j == child_nr);
+	}
+
+	if (btr_has_tx(tcx)) {
+		rc = btr_root_tx_add(tcx);
+		if (rc != 0)
+			D_GOTO(out, rc);
+	}
+
+	btr_node_set(tcx, level[0], BTR_NODE_ROOT);
+	root->tr_node = level[0];
+	root->tr_depth = depth;
+	btr_context_set_depth(tcx, depth);
+
+	D_DEBUG(DB_TRACE, "Bulk loaded %u records, depth %u, nodes %u\n",
+		nr, depth, *nodes_nr);
+	rc = 0;
+out:
+	D_FREE(level);
+	return rc;
+}
+
+/**
+ * Insert all records of \a bs into a non-empty tree in key order, sorted
+ * insertion makes consecutive probes walk the same path of the tree.
+ */
+static int
+btr_bulk_merge(struct btr_context *tcx, struct btr_bulk_sort *bs,
+	       unsigned int nr, daos_iov_t *vals)
+{
+	unsigned int	i;
+	int		rc;
+
+	for (i = 0; i < nr; i++) {
+		rc = btr_update(tcx, &bs->bs_keys[bs->bs_idx[i]],
+				&vals[bs->bs_idx[i]]);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+static int
+btr_bulk_load(struct btr_context *tcx, unsigned int nr, daos_iov_t *keys,
+	      daos_iov_t *vals)
+{
+	struct btr_bulk_sort	 bs;
+	struct btr_record	*rec;
+	TMMID(struct btr_node)	*nodes = NULL;
+	unsigned int		 nodes_nr = 0;
+	unsigned int		 node_max;
+	unsigned int		 rec_nr = 0;
+	unsigned int		 i;
+	int			 rc;
+
+	memset(&bs, 0, sizeof(bs));
+	bs.bs_tcx  = tcx;
+	bs.bs_keys = keys;
+
+	D_ALLOC(bs.bs_idx, nr * sizeof(*bs.bs_idx));
+	if (bs.bs_idx == NULL)
+		return -DER_NOMEM;
+
+	for (i = 0; i < nr; i++)
+		bs.bs_idx[i] = i;
+
+	btr_context_set_depth(tcx, tcx->tc_tins.ti_root->tr_depth);
+	if (!btr_root_empty(tcx)) {
+		/* DIRECT_KEY can only compare a key with an existing record,
+		 * so the batch is merged in the provided order.
+		 */
+		if (tcx->tc_feats & BTR_FEAT_DIRECT_KEY) {
+			rc = btr_bulk_merge(tcx, &bs, nr, vals);
+			goto out;
+		}
+
+		/* only hkeys are needed for sorting, no record is created */
+		D_ALLOC(bs.bs_recs, nr * btr_rec_size(tcx));
+		if (bs.bs_recs == NULL)
+			D_GOTO(out, rc = -DER_NOMEM);
+
+		for (i = 0; i < nr; i++) {
+			rec = btr_rec_at(tcx, bs.bs_recs, i);
+			btr_hkey_gen(tcx, &keys[i], &rec->rec_hkey[0]);
+		}
+
+		rc = daos_array_sort(&bs, nr, true, &btr_bulk_sort_ops);
+		if (rc != 0 || bs.bs_rc != 0)
+			D_GOTO(out, rc = -DER_INVAL);
+
+		rc = btr_bulk_merge(tcx, &bs, nr, vals);
+		goto out;
+	}
+
+	D_ALLOC(bs.bs_recs, nr * btr_rec_size(tcx));
+	if (bs.bs_recs == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	for (rec_nr = 0; rec_nr < nr; rec_nr++) {
+		rec = btr_rec_at(tcx, bs.bs_recs, rec_nr);
+		btr_hkey_gen(tcx, &keys[rec_nr], &rec->rec_hkey[0]);
+
+		rc = btr_rec_alloc(tcx, &keys[rec_nr], &vals[rec_nr], rec);
+		if (rc != 0) {
+			D_DEBUG(DB_TRACE, "Failed to create new record: %d\n",
+				rc);
+			goto out;
+		}
+	}
+
+	rc = daos_array_sort(&bs, nr, true, &btr_bulk_sort_ops);
+	if (rc != 0 || bs.bs_rc != 0) {
+		D_DEBUG(DB_TRACE, "Duplicate or invalid key for bulk load\n");
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+
+	/* leaves, plus at most half of them for all internal levels */
+	node_max = (nr + tcx->tc_order - 2) / (tcx->tc_order - 1);
+	node_max += node_max / 2 + BTR_TRACE_MAX;
+	D_ALLOC(nodes, node_max * sizeof(*nodes));
+	if (nodes == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	rc = btr_bulk_build(tcx, &bs, nr, nodes, &nodes_nr);
+	D_ASSERT(nodes_nr <= node_max);
+	if (rc == 0)
+		rec_nr = 0; /* records are owned by the tree now */
+out:
+	if (rc != 0) {
+		/* NB: under transaction, these are rolled back by the
+		 * transaction abort anyway.
+		 */
+		for (i = 0; i < nodes_nr; i++)
+			btr_node_free(tcx, nodes[i]);
+		for (i = 0; i < rec_nr; i++)
+			btr_rec_free(tcx, btr_rec_at(tcx, bs.bs_recs, i),
+				     NULL);
+	}
+	D_FREE(nodes);
+	D_FREE(bs.bs_recs);
+	D_FREE(bs.bs_idx);
+	return rc;
+}
+
+static int
+btr_tx_bulk_load(struct btr_context *tcx, unsigned int nr, daos_iov_t *keys,
+		 daos_iov_t *vals)
+{
+#if DAOS_HAS_PMDK
+	struct umem_instance *umm = btr_umm(tcx);
+	int		      rc = 0;
+
+	TX_BEGIN(umm->umm_u.pmem_pool) {
+		rc = btr_bulk_load(tcx, nr, keys, vals);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D_DEBUG(DB_TRACE, "dbtree_bulk_load tx aborted: %d\n", rc);
+
+	} TX_FINALLY {
+		D_DEBUG(DB_TRACE, "dbtree_bulk_load tx exited\n");
+	} TX_END
+
+	return rc;
+#else
+	D_ASSERT(0);
+	return -DER_NO_PERM;
+#endif
+}
+
+/**
+ * Load a batch of KV pairs into the tree in one transaction.
+ *
+ * If the tree is empty, all records are created at once and the tree is
+ * built bottom-up with fully packed nodes, there is no node split and only
+ * the tree root is added to the transaction. Otherwise the batch is merged
+ * into the existing tree in key order.
+ *
+ * Keys can be in any order but they must be unique, duplicate keys are
+ * not detected while merging into a non-empty tree with
+ * BTR_FEAT_DIRECT_KEY.
+ *
+ * \param toh		[IN]	Tree open handle.
+ * \param nr		[IN]	Number of KV pairs.
+ * \param keys		[IN]	Array of \a nr keys.
+ * \param vals		[IN]	Array of \a nr values.
+ *
+ * \return		0	success
+ *			-DER_INVAL	duplicate keys
+ *			-ve	other error code
+ */
+int
+dbtree_bulk_load(daos_handle_t toh, unsigned int nr, daos_iov_t *keys,
+		 daos_iov_t *vals)
+{
+	struct btr_context *tcx;
+	int		    rc;
+
+	tcx = btr_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (nr == 0)
+		return 0;
+
+	if (btr_has_tx(tcx))
+		rc = btr_tx_bulk_load(tcx, nr, keys, vals);
+	else
+		rc = btr_bulk_load(tcx, nr, keys, vals);
+
+	return rc;
+}
+
 /**
  * Delete the leaf record pointed by @cur_tr from the current node, then fill
  * the deletion gap by shifting remainded records on the specified direction.
@@ -22,22 +22,293 @@
  */
 #define DDSUBSYS	DDFAC(common)
 
+#include <limits.h>
 #include <daos/checksum.h>
 
+#if defined(__x86_64__)
+/**
+ * Algorithm of a checksum type, \a dc_buf of daos_csum_t is the running
+ * state of the algorithm.
+ */
+struct daos_csum_ops {
+	/** reset the running state */
+	void	(*co_reset)(void *state);
+	/** accumulate \a len bytes of \a buf into the running state */
+	void	(*co_update)(void *state, const void *buf, uint64_t len);
+	/** output the digest, NULL if the state is the digest */
+	void	(*co_final)(const void *state, void *digest);
+};
+#endif
+
 struct daos_csum_entry {
 	char		*cs_name;	/**< name string of the checksum */
+	char		*cs_alias;	/**< alternative name, can be NULL */
 	uint64_t	 cs_size;
+#if defined(__x86_64__)
+	struct daos_csum_ops	*cs_ops;
+#endif
 };
 
+#if defined(__x86_64__)
+/*
+ * CRC kernels are provided by ISA-L, it selects the SSE4.2 (CRC32C) or
+ * PCLMULQDQ folding (CRC64) implementation at runtime by CPU features.
+ */
+static void
+crc32_reset(void *state)
+{
+	*(uint32_t *)state = 0;
+}
+
+static void
+crc32_update(void *state, const void *buf, uint64_t len)
+{
+	uint32_t *crc = state;
+
+	/* crc32_iscsi() takes int length */
+	while (len > 0) {
+		int nob = min(len, (uint64_t)INT_MAX);
+
+		*crc = crc32_iscsi((unsigned char *)buf, nob, *crc);
+		buf += nob;
+		len -= nob;
+	}
+}
+
+static struct daos_csum_ops crc32_ops = {
+	.co_reset	= crc32_reset,
+	.co_update	= crc32_update,
+};
+
+static void
+crc64_reset(void *state)
+{
+	*(uint64_t *)state = 0;
+}
+
+static void
+crc64_update(void *state, const void *buf, uint64_t len)
+{
+	uint64_t *crc = state;
+
+	*crc = crc64_ecma_refl(*crc, buf, len);
+}
+
+static struct daos_csum_ops crc64_ops = {
+	.co_reset	= crc64_reset,
+	.co_update	= crc64_update,
+};
+
+static void
+adler32_reset(void *state)
+{
+	*(uint32_t *)state = 1;
+}
+
+static void
+adler32_update(void *state, const void *buf, uint64_t len)
+{
+	uint32_t *adler = state;
+
+	*adler = isal_adler32(*adler, buf, len);
+}
+
+static struct daos_csum_ops adler32_ops = {
+	.co_reset	= adler32_reset,
+	.co_update	= adler32_update,
+};
+
+/* xxHash64, see https://github.com/Cyan4973/xxHash */
+#define XXH_PRIME64_1	0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2	0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3	0x165667B19E3779F9ULL
+#define XXH_PRIME64_4	0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5	0x27D4EB2F165667C5ULL
+
+#define XXH_STRIPE	32
+
+struct xxh64_state {
+	uint64_t	xs_len;
+	uint64_t	xs_acc[4];
+	uint8_t		xs_mem[XXH_STRIPE];
+	uint32_t	xs_mem_size;
+};
+
+static inline uint64_t
+xxh_rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+xxh_read64(const void *ptr)
+{
+	uint64_t val;
+
+	memcpy(&val, ptr, sizeof(val));
+	return val;
+}
+
+static inline uint32_t
+xxh_read32(const void *ptr)
+{
+	uint32_t val;
+
+	memcpy(&val, ptr, sizeof(val));
+	return val;
+}
+
+static inline uint64_t
+xxh64_round(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_PRIME64_2;
+	acc = xxh_rotl64(acc, 31);
+	return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t
+xxh64_merge_round(uint64_t acc, uint64_t val)
+{
+	acc ^= xxh64_round(0, val);
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static inline void
+xxh64_stripe(struct xxh64_state *xs, const uint8_t *p)
+{
+	int i;
+
+	for (i = 0; i < 4; i++)
+		xs->xs_acc[i] = xxh64_round(xs->xs_acc[i],
+					    xxh_read64(p + i * 8));
+}
+
+static void
+xxh64_reset(void *state)
+{
+	struct xxh64_state *xs = state;
+
+	D_CASSERT(sizeof(*xs) <= DAOS_CSUM_STATE_SIZE);
+	memset(xs, 0, sizeof(*xs));
+	xs->xs_acc[0] = XXH_PRIME64_1 + XXH_PRIME64_2;
+	xs->xs_acc[1] = XXH_PRIME64_2;
+	xs->xs_acc[2] = 0;
+	xs->xs_acc[3] = -XXH_PRIME64_1;
+}
+
+static void
+xxh64_update(void *state, const void *buf, uint64_t len)
+{
+	struct xxh64_state *xs = state;
+	const uint8_t	   *p = buf;
+	const uint8_t	   *end = p + len;
+	uint32_t	    nob;
+
+	xs->xs_len += len;
+
+	if (xs->xs_mem_size != 0) {
+		nob = min(len, (uint64_t)(XXH_STRIPE - xs->xs_mem_size));
+		memcpy(xs->xs_mem + xs->xs_mem_size, p, nob);
+		xs->xs_mem_size += nob;
+		p += nob;
+		if (xs->xs_mem_size < XXH_STRIPE)
+			return;
+
+		xxh64_stripe(xs, xs->xs_mem);
+		xs->xs_mem_size = 0;
+	}
+
+	for (; p + XXH_STRIPE <= end; p += XXH_STRIPE)
+		xxh64_stripe(xs, p);
+
+	if (p < end) {
+		memcpy(xs->xs_mem, p, end - p);
+		xs->xs_mem_size = end - p;
+	}
+}
+
+static void
+xxh64_final(const void *state, void *digest)
+{
+	const struct xxh64_state *xs = state;
+	const uint8_t		 *p = xs->xs_mem;
+	const uint8_t		 *end = p + xs->xs_mem_size;
+	uint64_t		  h;
+	int			  i;
+
+	if (xs->xs_len >= XXH_STRIPE) {
+		h = xxh_rotl64(xs->xs_acc[0], 1) +
+		    xxh_rotl64(xs->xs_acc[1], 7) +
+		    xxh_rotl64(xs->xs_acc[2], 12) +
+		    xxh_rotl64(xs->xs_acc[3], 18);
+		for (i = 0; i < 4; i++)
+			h = xxh64_merge_round(h, xs->xs_acc[i]);
+	} else {
+		h = xs->xs_acc[2] /* seed */ + XXH_PRIME64_5;
+	}
+	h += xs->xs_len;
+
+	for (; p + 8 <= end; p += 8) {
+		h ^= xxh64_round(0, xxh_read64(p));
+		h = xxh_rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+	}
+	if (p + 4 <= end) {
+		h ^= (uint64_t)xxh_read32(p) * XXH_PRIME64_1;
+		h = xxh_rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		p += 4;
+	}
+	for (; p < end; p++) {
+		h ^= *p * XXH_PRIME64_5;
+		h = xxh_rotl64(h, 11) * XXH_PRIME64_1;
+	}
+
+	h ^= h >> 33;
+	h *= XXH_PRIME64_2;
+	h ^= h >> 29;
+	h *= XXH_PRIME64_3;
+	h ^= h >> 32;
+
+	memcpy(digest, &h, sizeof(h));
+}
+
+static struct daos_csum_ops xxh64_ops = {
+	.co_reset	= xxh64_reset,
+	.co_update	= xxh64_update,
+	.co_final	= xxh64_final,
+};
+#endif /* __x86_64__ */
 
 static struct daos_csum_entry	csum_dict[] = {
 	[DAOS_CS_CRC32] = {
 		.cs_name	= "crc32",
+		.cs_alias	= "crc32c",
 		.cs_size	= sizeof(uint32_t),
+#if defined(__x86_64__)
+		.cs_ops		= &crc32_ops,
+#endif
 	},
 	[DAOS_CS_CRC64] = {
 		.cs_name	= "crc64",
 		.cs_size	= sizeof(uint64_t),
+#if defined(__x86_64__)
+		.cs_ops		= &crc64_ops,
+#endif
+	},
+	[DAOS_CS_XXHASH64] = {
+		.cs_name	= "xxhash64",
+		.cs_alias	= "xxhash",
+		.cs_size	= sizeof(uint64_t),
+#if defined(__x86_64__)
+		.cs_ops		= &xxh64_ops,
+#endif
+	},
+	[DAOS_CS_ADLER32] = {
+		.cs_name	= "adler32",
+		.cs_alias	= "adler",
+		.cs_size	= sizeof(uint32_t),
+#if defined(__x86_64__)
+		.cs_ops		= &adler32_ops,
+#endif
 	},
 };
 
@@ -47,19 +318,34 @@ static struct daos_csum_entry	csum_dict[] = {
 static inline unsigned int
 daos_name_to_type(const char *cs_name)
 {
-	int i;
+	struct daos_csum_entry	*dict;
+	int			 i;
 
 	if (!cs_name)
-		return -DER_INVAL;
+		return DAOS_CS_UNKNOWN;
 
 	for (i = 0; i < DAOS_CS_MAX; i++) {
-		if (!strcasecmp(csum_dict[i].cs_name, cs_name))
+		dict = &csum_dict[i];
+		if (!strcasecmp(dict->cs_name, cs_name) ||
+		    (dict->cs_alias && !strcasecmp(dict->cs_alias, cs_name)))
 			return i;
 	}
 	D_ERROR("Unsupported checksum - no type for: %s\n", cs_name);
 	return DAOS_CS_UNKNOWN;
 }
 
+const char *
+daos_csum_type2name(unsigned int type)
+{
+	return type < DAOS_CS_MAX ? csum_dict[type].cs_name : "unknown";
+}
+
+/** Type of checksum \a cs_name (or alias), DAOS_CS_UNKNOWN if unsupported */
+unsigned int
+daos_csum_name2type(const char *cs_name)
+{
+	return daos_name_to_type(cs_name);
+}
 
 /**
  * This function initializes a checksum and
@@ -72,32 +358,44 @@ daos_csum_init(const char *cs_name, daos_csum_t *cs_obj)
 	unsigned int		type;
 
 	type = daos_name_to_type(cs_name);
-	if (type > DAOS_CS_MAX)
+	if (type >= DAOS_CS_MAX)
 		return -DER_NOSYS;
 	dict = &csum_dict[type];
 
 #if defined(__x86_64__)
 	cs_obj->dc_csum = type;
+	memset(cs_obj->dc_buf, 0, DAOS_CSUM_STATE_SIZE);
+	dict->cs_ops->co_reset(cs_obj->dc_buf);
 #else
 	rc = mchecksum_init(cs_name, &cs_obj->dc_csum);
 	if (rc < 0) {
 		D_ERROR("Error in initializing checksum\n");
 		return -DER_NOMEM;
 	}
+	memset(cs_obj->dc_buf, 0, DAOS_CSUM_STATE_SIZE);
 #endif
 	cs_obj->dc_init = 1;
-	memset(cs_obj->dc_buf, 0, DAOS_CSUM_SIZE);
 	D_DEBUG(DB_IO, "Initialize checksum=%s\n", dict->cs_name);
 	return 0;
 }
 
+int
+daos_csum_init_type(unsigned int type, daos_csum_t *cs_obj)
+{
+	if (type >= DAOS_CS_MAX) {
+		D_ERROR("Unknown checksum type %u\n", type);
+		return -DER_NOSYS;
+	}
+	return daos_csum_init(csum_dict[type].cs_name, cs_obj);
+}
+
 inline int
 daos_csum_reset(daos_csum_t *cs_obj)
 {
 	if (!cs_obj->dc_init)
 		return -DER_UNINIT;
 #if defined(__x86_64__)
-	memset(cs_obj->dc_buf, 0, DAOS_CSUM_SIZE);
+	csum_dict[cs_obj->dc_csum].cs_ops->co_reset(cs_obj->dc_buf);
 #else
 	rc = mchecksum_reset(cs_obj->dc_csum);
 	if (rc < 0) {
@@ -127,6 +425,20 @@ daos_csum_get_size(daos_csum_t *csum)
 #endif
 }
 
+#if defined(__x86_64__)
+/** output the digest of the running state of \a csum */
+static inline void
+daos_csum_digest(daos_csum_t *csum, void *digest)
+{
+	struct daos_csum_entry *dict = &csum_dict[csum->dc_csum];
+
+	if (dict->cs_ops->co_final)
+		dict->cs_ops->co_final(csum->dc_buf, digest);
+	else
+		memcpy(digest, csum->dc_buf, dict->cs_size);
+}
+#endif
+
 inline int
 daos_csum_get(daos_csum_t *csum, daos_csum_buf_t *csum_buf)
 {
@@ -135,8 +447,7 @@ daos_csum_get(daos_csum_t *csum, daos_csum_buf_t *csum_buf)
 		return -DER_INVAL;
 	}
 #if defined(__x86_64__)
-	memcpy(csum_buf->cs_csum, csum->dc_buf,
-	       csum_dict[csum->dc_csum].cs_size);
+	daos_csum_digest(csum, csum_buf->cs_csum);
 #else
 	mchecksum_get(csum, csum_buf->cs_csum, csum_buf->cs_buf_len,
 		      MCHECKSUM_FINALIZE);
@@ -148,9 +459,15 @@ daos_csum_compare(daos_csum_t *csum, daos_csum_t *csum_src)
 {
 
 #if defined(__x86_64__)
-	return (csum->dc_csum == csum_src->dc_csum) &&
-		!(memcmp(csum->dc_buf, csum_src->dc_buf,
-			 csum_dict[csum->dc_csum].cs_size));
+	char	digest[DAOS_CSUM_SIZE];
+	char	digest_src[DAOS_CSUM_SIZE];
+
+	if (csum->dc_csum != csum_src->dc_csum)
+		return 0;
+
+	daos_csum_digest(csum, digest);
+	daos_csum_digest(csum_src, digest_src);
+	return !memcmp(digest, digest_src, csum_dict[csum->dc_csum].cs_size);
 #else
 	size_t	hash_size;
 
@@ -168,32 +485,11 @@ daos_csum_update(daos_csum_t *csum, const void *buf,
 		 uint64_t len)
 {
 #if defined(__x86_64__)
-	switch (csum->dc_csum) {
-	case DAOS_CS_CRC64:
-	{
-		uint64_t *cur_crc64;
-
-		cur_crc64 = (uint64_t *)csum->dc_buf;
-		*cur_crc64 = crc64_ecma_refl(*cur_crc64,
-					     (const unsigned char *)buf,
-					     len);
-		break;
-	}
-	case DAOS_CS_CRC32:
-	{
-		uint32_t *cur_crc32;
-
-		cur_crc32 = (uint32_t *)csum->dc_buf;
-		*cur_crc32 = crc32_iscsi((unsigned char *)buf,
-					 (int)len,
-					 *cur_crc32);
-		break;
-	}
-	default:
+	if (csum->dc_csum < 0 || csum->dc_csum >= DAOS_CS_MAX) {
 		D_ERROR("Unknown checksum type\n");
 		return -DER_NOSYS;
 	}
-
+	csum_dict[csum->dc_csum].cs_ops->co_update(csum->dc_buf, buf, len);
 #else
 	/* accumulates a partial checksum of the input data */
 	int	 rc;
@@ -209,7 +505,7 @@ int
 daos_csum_compute(daos_csum_t *csum, daos_sg_list_t *sgl)
 {
 	int	i;
-	int	rc;
+	int	rc = 0;
 
 	if (!sgl->sg_iovs)
 		return 0;
@@ -229,3 +525,224 @@ failed:
 	return rc;
 }
 
+/** output the checksum of a chunk to \a digest and start a new chunk */
+static int
+csum_chunk_get(daos_csum_t *csum, void *digest, daos_size_t size)
+{
+	daos_csum_buf_t	tmp;
+	int		rc;
+
+	daos_csum_set(&tmp, digest, size);
+	rc = daos_csum_get(csum, &tmp);
+	if (rc != 0)
+		return rc;
+
+	return daos_csum_reset(csum);
+}
+
+/** position within a sgl, data of the sgl is consumed in order */
+struct csum_sgl_cursor {
+	daos_iov_t	*sc_iovs;
+	unsigned int	 sc_nr;
+	unsigned int	 sc_at;
+	daos_size_t	 sc_off;
+};
+
+static void
+csum_sgl_cursor_init(struct csum_sgl_cursor *cur, daos_iov_t *iovs,
+		     unsigned int nr)
+{
+	cur->sc_iovs = iovs;
+	cur->sc_nr = nr;
+	cur->sc_at = 0;
+	cur->sc_off = 0;
+}
+
+/** accumulate the next \a len bytes of the sgl into \a csum */
+static int
+csum_sgl_update(daos_csum_t *csum, struct csum_sgl_cursor *cur,
+		daos_size_t len)
+{
+	daos_iov_t	*iov;
+	daos_size_t	 nob;
+	int		 rc;
+
+	while (len > 0) {
+		if (cur->sc_at >= cur->sc_nr) {
+			D_ERROR("sgl is short of "DF_U64" bytes\n", len);
+			return -DER_INVAL;
+		}
+
+		iov = &cur->sc_iovs[cur->sc_at];
+		if (iov->iov_buf == NULL || cur->sc_off >= iov->iov_len) {
+			cur->sc_at++;
+			cur->sc_off = 0;
+			continue;
+		}
+
+		nob = min(len, iov->iov_len - cur->sc_off);
+		rc = daos_csum_update(csum, iov->iov_buf + cur->sc_off, nob);
+		if (rc != 0)
+			return rc;
+
+		cur->sc_off += nob;
+		len -= nob;
+	}
+	return 0;
+}
+
+int
+daos_csum_compute_chunks(daos_csum_t *csum, daos_sg_list_t *sgl,
+			 daos_size_t chunk_size, daos_csum_buf_t *csums,
+			 unsigned int csum_nr)
+{
+	struct csum_sgl_cursor	cur;
+	daos_size_t		size;
+	daos_size_t		len = 0;
+	daos_size_t		nob;
+	int			cnt;
+	int			i;
+	int			rc;
+
+	if (chunk_size == 0 || csums == NULL)
+		return -DER_INVAL;
+
+	if (!sgl->sg_iovs)
+		return 0;
+
+	for (i = 0; i < sgl->sg_nr_out; i++) {
+		if (sgl->sg_iovs[i].iov_buf)
+			len += sgl->sg_iovs[i].iov_len;
+	}
+
+	if (daos_csum_chunk_cnt(len, chunk_size) > csum_nr) {
+		D_ERROR("Too many chunks, csum_nr=%u\n", csum_nr);
+		return -DER_INVAL;
+	}
+
+	rc = daos_csum_reset(csum);
+	if (rc != 0)
+		return rc;
+
+	size = daos_csum_get_size(csum);
+	csum_sgl_cursor_init(&cur, sgl->sg_iovs, sgl->sg_nr_out);
+	for (cnt = 0; len > 0; cnt++, len -= nob) {
+		if (csums[cnt].cs_csum == NULL ||
+		    csums[cnt].cs_buf_len < size) {
+			D_ERROR("Invalid checksum buffer %d\n", cnt);
+			return -DER_INVAL;
+		}
+
+		nob = min(len, chunk_size);
+		rc = csum_sgl_update(csum, &cur, nob);
+		if (rc != 0)
+			return rc;
+
+		rc = csum_chunk_get(csum, csums[cnt].cs_csum, size);
+		if (rc != 0)
+			return rc;
+		csums[cnt].cs_len = size;
+	}
+
+	return cnt;
+}
+
+int
+daos_csum_compute_iod(daos_csum_t *csum, daos_iod_t *iod,
+		      daos_sg_list_t *sgl, unsigned int chunk_size)
+{
+	struct csum_sgl_cursor	 cur;
+	daos_csum_buf_t		*csums;
+	daos_size_t		 size;
+	daos_size_t		 len;
+	daos_size_t		 nob;
+	unsigned int		 cnt = 0;
+	char			*buf;
+	int			 i;
+	int			 rc;
+
+	if (iod->iod_type != DAOS_IOD_ARRAY || chunk_size == 0 ||
+	    iod->iod_csums != NULL)
+		return -DER_INVAL;
+
+	size = daos_csum_get_size(csum);
+	for (i = 0; i < iod->iod_nr; i++) {
+		len = iod->iod_recxs[i].rx_nr * iod->iod_size;
+		if (daos_csum_chunk_cnt(len, chunk_size) * size > UINT16_MAX) {
+			D_ERROR("Too many chunks for recx %d, chunk=%u\n",
+				i, chunk_size);
+			return -DER_INVAL;
+		}
+		cnt += daos_csum_chunk_cnt(len, chunk_size);
+	}
+
+	/* all checksums of the iod share the same buffer */
+	D_ALLOC(csums, iod->iod_nr * sizeof(*csums) + cnt * size);
+	if (csums == NULL)
+		return -DER_NOMEM;
+	buf = (char *)&csums[iod->iod_nr];
+
+	rc = daos_csum_reset(csum);
+	if (rc != 0)
+		D_GOTO(failed, rc);
+
+	csum_sgl_cursor_init(&cur, sgl->sg_iovs, sgl->sg_nr);
+	for (i = 0; i < iod->iod_nr; i++) {
+		len = iod->iod_recxs[i].rx_nr * iod->iod_size;
+		cnt = daos_csum_chunk_cnt(len, chunk_size);
+
+		daos_csum_set(&csums[i], buf, cnt * size);
+#if defined(__x86_64__)
+		csums[i].cs_type = csum->dc_csum;
+#endif
+		csums[i].cs_chunk_size = chunk_size;
+
+		for (; len > 0; len -= nob, buf += size) {
+			nob = min(len, chunk_size);
+			rc = csum_sgl_update(csum, &cur, nob);
+			if (rc != 0)
+				D_GOTO(failed, rc);
+
+			rc = csum_chunk_get(csum, buf, size);
+			if (rc != 0)
+				D_GOTO(failed, rc);
+		}
+	}
+
+	iod->iod_csums = csums;
+	return 0;
+failed:
+	D_FREE(csums);
+	return rc;
+}
+
+void
+daos_csum_iod_free(daos_iod_t *iod)
+{
+	if (iod->iod_csums != NULL) {
+		D_FREE(iod->iod_csums);
+		iod->iod_csums = NULL;
+	}
+}
+
+int
+daos_csum_verify(daos_csum_t *csum, const void *buf, daos_size_t len,
+		 const void *digest)
+{
+	char	out[DAOS_CSUM_SIZE];
+	int	rc;
+
+	rc = daos_csum_reset(csum);
+	if (rc != 0)
+		return rc;
+
+	rc = daos_csum_update(csum, buf, len);
+	if (rc != 0)
+		return rc;
+
+	rc = csum_chunk_get(csum, out, daos_csum_get_size(csum));
+	if (rc != 0)
+		return rc;
+
+	return memcmp(out, digest, daos_csum_get_size(csum)) ? -DER_IO : 0;
+}
@@ -35,58 +35,122 @@
 #include <gurt/hash.h>
 #include <daos/lru.h>
 
-static struct daos_llink*
-hash2lru_link(d_list_t *blink)
+/** seed of the key hash */
+#define LRU_HASH_SEED		2166136261U
+/** log2 of the initial number of hash table slots */
+#define LRU_SLOT_BITS_MIN	6
+
+static inline uint32_t
+lru_slot_mask(struct daos_lru_cache *lcache)
+{
+	return (1U << lcache->dlc_slot_bits) - 1;
+}
+
+static inline uint64_t
+lru_key_hash(void *key, unsigned int key_size)
 {
-	return container_of(blink, struct daos_llink, ll_hlink);
+	return d_hash_murmur64((unsigned char *)key, key_size, LRU_HASH_SEED);
 }
 
+/** Store @llink in the first empty slot of its probing sequence */
 static void
-lru_hop_rec_addref(struct d_hash_table *lr_htab, d_list_t *rlink)
+lru_slot_insert(struct daos_llink **slots, uint32_t mask,
+		struct daos_llink *llink)
 {
-	hash2lru_link(rlink)->ll_ref++;
+	uint32_t	i;
+
+	for (i = llink->ll_hash & mask; slots[i] != NULL; i = (i + 1) & mask)
+		;
+	slots[i] = llink;
 }
 
-static bool
-lru_hop_rec_decref(struct d_hash_table *lr_htab, d_list_t *rlink)
+/** Double the number of hash table slots and rehash all items */
+static int
+lru_slots_grow(struct daos_lru_cache *lcache)
 {
+	struct daos_llink	**slots;
+	uint32_t		  nr = 1U << lcache->dlc_slot_bits;
+	uint32_t		  i;
+
+	D_ALLOC(slots, 2 * nr * sizeof(*slots));
+	if (slots == NULL)
+		return -DER_NOMEM;
 
-       struct daos_llink *llink = hash2lru_link(rlink);
+	for (i = 0; i < nr; i++) {
+		if (lcache->dlc_slots[i] != NULL)
+			lru_slot_insert(slots, 2 * nr - 1,
+					lcache->dlc_slots[i]);
+	}
 
-       D_ASSERT(llink->ll_ref > 0);
-       llink->ll_ref--;
-       /* Delete from hash only if no more references */
-       return llink->ll_ref == 0;
+	D_DEBUG(DB_TRACE, "Grow LRU hash table from %u to %u slots\n",
+		nr, 2 * nr);
+	D_FREE(lcache->dlc_slots);
+	lcache->dlc_slots = slots;
+	lcache->dlc_slot_bits++;
+	return 0;
 }
 
-static bool
-lru_hop_key_cmp(struct d_hash_table *lr_htab, d_list_t *rlink,
-		const void *key, unsigned int ksize)
+static struct daos_llink *
+lru_slot_find(struct daos_lru_cache *lcache, uint64_t hash, void *key,
+	      unsigned int key_size)
 {
-	struct daos_llink *llink = hash2lru_link(rlink);
+	struct daos_llink	*llink;
+	uint32_t		 mask = lru_slot_mask(lcache);
+	uint32_t		 i;
+
+	for (i = hash & mask; (llink = lcache->dlc_slots[i]) != NULL;
+	     i = (i + 1) & mask) {
+		if (llink->ll_hash != hash)
+			continue;
 
-	if (llink->ll_evicted)
-		return false; /* nobody should use it */
-	else
-		return llink->ll_ops->lop_cmp_keys(key, ksize, llink);
+		if (llink->ll_evicted)
+			continue; /* nobody should use it */
+
+		if (llink->ll_ops->lop_cmp_keys(key, key_size, llink))
+			return llink;
+	}
+	return NULL;
 }
 
+/**
+ * Remove @llink from the hash table. Items after it in the same cluster
+ * are shifted backward, so no tombstone is required by lookup.
+ */
 static void
-lru_hop_rec_free(struct d_hash_table *lr_htab, d_list_t *rlink)
+lru_slot_delete(struct daos_lru_cache *lcache, struct daos_llink *llink)
 {
-	struct daos_llink *llink = hash2lru_link(rlink);
+	struct daos_llink	**slots = lcache->dlc_slots;
+	uint32_t		  mask = lru_slot_mask(lcache);
+	uint32_t		  home;
+	uint32_t		  i;
+	uint32_t		  j;
+
+	for (i = llink->ll_hash & mask; slots[i] != llink; i = (i + 1) & mask)
+		D_ASSERT(slots[i] != NULL);
+
+	for (j = (i + 1) & mask; slots[j] != NULL; j = (j + 1) & mask) {
+		home = slots[j]->ll_hash & mask;
+		/* can't move an item before its home slot */
+		if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+			continue;
+
+		slots[i] = slots[j];
+		i = j;
+	}
+	slots[i] = NULL;
+	lcache->dlc_slot_used--;
+}
 
+/** Remove @llink from the cache and free it */
+static void
+lru_item_delete(struct daos_lru_cache *lcache, struct daos_llink *llink)
+{
+	D_ASSERT(llink->ll_ref == 1);
+	d_list_del_init(&llink->ll_qlink);
+	lru_slot_delete(lcache, llink);
 	llink->ll_ops->lop_free_ref(llink);
 }
 
-static d_hash_table_ops_t lru_ops = {
-	.hop_key_cmp		= lru_hop_key_cmp,
-	.hop_rec_addref		= lru_hop_rec_addref,
-	.hop_rec_decref		= lru_hop_rec_decref,
-	.hop_rec_free		= lru_hop_rec_free,
-};
-
-
 int
 daos_lru_cache_create(int bits, uint32_t feats,
 		      struct daos_llink_ops *ops,
@@ -106,14 +170,21 @@ daos_lru_cache_create(int bits, uint32_t feats,
 		return -DER_INVAL;
 	}
 
+	/* no lock in the open addressing table, see daos_lru_cache_create() */
+	if (!(feats & D_HASH_FT_NOLOCK)) {
+		D_ERROR("LRU cache can't be locked, D_HASH_FT_NOLOCK is "
+			"required\n");
+		return -DER_INVAL;
+	}
+
 	D_ALLOC_PTR(lru_cache);
 	if (lru_cache == NULL)
 		return -DER_NOMEM;
 
-	rc = d_hash_table_create_inplace(feats, max(4, bits - 3),
-					 NULL, &lru_ops,
-					 &lru_cache->dlc_htable);
-	if (rc)
+	lru_cache->dlc_slot_bits = LRU_SLOT_BITS_MIN;
+	D_ALLOC(lru_cache->dlc_slots,
+		(1U << LRU_SLOT_BITS_MIN) * sizeof(*lru_cache->dlc_slots));
+	if (lru_cache->dlc_slots == NULL)
 		D_GOTO(exit, rc = -DER_NOMEM);
 
 	if (bits >= 0)
@@ -137,6 +208,8 @@ exit:
 void
 daos_lru_cache_destroy(struct daos_lru_cache *lcache)
 {
+	struct daos_llink *llink;
+	struct daos_llink *tmp;
 
 	D_DEBUG(DB_TRACE, "Destroying LRU cache\n");
 	/**
@@ -146,8 +219,17 @@ daos_lru_cache_destroy(struct daos_lru_cache *lcache)
 	D_DEBUG(DB_TRACE, "refs_held :%u\n", lcache->dlc_busy_nr);
 	D_ASSERTF(lcache->dlc_busy_nr == 0, "busy=%d", lcache->dlc_busy_nr);
 
-	d_hash_table_debug(&lcache->dlc_htable);
-	d_hash_table_destroy_inplace(&lcache->dlc_htable, true);
+	D_DEBUG(DB_TRACE, "LRU stats: hit "DF_U64", miss "DF_U64", evict "
+		DF_U64", slots %u/%u\n", lcache->dlc_hits, lcache->dlc_misses,
+		lcache->dlc_evicts, lcache->dlc_slot_used,
+		1U << lcache->dlc_slot_bits);
+
+	d_list_for_each_entry_safe(llink, tmp, &lcache->dlc_idle_list,
+				   ll_qlink)
+		lru_item_delete(lcache, llink);
+
+	D_ASSERT(lcache->dlc_slot_used == 0);
+	D_FREE(lcache->dlc_slots);
 	D_FREE_PTR(lcache);
 }
 
@@ -171,53 +253,15 @@ daos_lru_cache_evict(struct daos_lru_cache *lcache,
 	d_list_for_each_entry_safe(llink, tmp, &lcache->dlc_idle_list,
 				   ll_qlink) {
 		if (cond == NULL || cond(llink, args)) {
-			d_list_del_init(&llink->ll_qlink);
-			d_hash_rec_delete_at(&lcache->dlc_htable,
-					     &llink->ll_hlink);
+			lru_item_delete(lcache, llink);
 			lcache->dlc_idle_nr--;
+			lcache->dlc_evicts++;
 			cntr++;
 		}
 	}
 	D_DEBUG(DB_TRACE, "Evicted %d items from idle list\n", cntr);
 }
 
-static struct daos_llink *
-lru_fast_search(struct daos_lru_cache *lcache, d_list_t *head,
-		void *key, unsigned int key_size)
-{
-	struct daos_llink *llink;
-
-	if (d_list_empty(head))
-		return NULL;
-
-	llink = d_list_entry(head->next, struct daos_llink, ll_qlink);
-	if (llink->ll_evicted)
-		return NULL;
-
-	if (llink->ll_ops->lop_cmp_keys(key, key_size, llink)) {
-		D_DEBUG(DB_TRACE, "Found item on the %s list.\n",
-			head == &lcache->dlc_busy_list ? "busy" : "idle");
-
-		llink->ll_ref++; /* +1 for caller */
-		return llink;
-	}
-	return NULL;
-}
-
-struct daos_llink *
-lru_hash_search(struct daos_lru_cache *lcache, void *key,
-		unsigned int key_size)
-{
-	d_list_t	*hlink;
-
-	hlink = d_hash_rec_find(&lcache->dlc_htable, key, key_size);
-	if (hlink == NULL)
-		return NULL;
-
-	D_DEBUG(DB_TRACE, "Found in the cache hash table\n");
-	return hash2lru_link(hlink);
-}
-
 static inline void
 lru_mark_busy(struct daos_lru_cache *lcache, struct daos_llink *llink)
 {
@@ -243,27 +287,33 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 		  struct daos_llink **rlink)
 {
 	struct daos_llink *llink;
+	uint64_t	   hash;
 	int		   rc;
 
 	D_ASSERT(lcache != NULL && key != NULL && key_size > 0);
-	if (lcache->dlc_ops->lop_print_key)
-		lcache->dlc_ops->lop_print_key(key, key_size);
-
-	llink = lru_fast_search(lcache, &lcache->dlc_busy_list, key, key_size);
-	if (llink)
-		D_GOTO(found, rc = 0);
 
-	llink = lru_fast_search(lcache, &lcache->dlc_idle_list, key, key_size);
-	if (llink)
+	hash = lru_key_hash(key, key_size);
+	llink = lru_slot_find(lcache, hash, key, key_size);
+	if (llink) {
+		lcache->dlc_hits++;
+		llink->ll_ref++; /* +1 for caller */
 		D_GOTO(found, rc = 0);
+	}
 
-	llink = lru_hash_search(lcache, key, key_size);
-	if (llink)
-		D_GOTO(found, rc = 0);
+	lcache->dlc_misses++;
+	if (lcache->dlc_ops->lop_print_key)
+		lcache->dlc_ops->lop_print_key(key, key_size);
 
 	if (!create_args)
 		D_GOTO(out, rc = -DER_NONEXIST);
 
+	/* keep the load factor of the hash table under 1/2 */
+	if (2 * (lcache->dlc_slot_used + 1) > (1U << lcache->dlc_slot_bits)) {
+		rc = lru_slots_grow(lcache);
+		if (rc)
+			D_GOTO(out, rc);
+	}
+
 	D_DEBUG(DB_TRACE, "Entry not found adding it to LRU\n");
 	/* llink does not exist create one */
 	rc = lcache->dlc_ops->lop_alloc_ref(key, key_size, create_args, &llink);
@@ -271,14 +321,14 @@ daos_lru_ref_hold(struct daos_lru_cache *lcache, void *key,
 		D_GOTO(out, rc);
 
 	D_DEBUG(DB_TRACE, "Inserting into LRU Hash table\n");
+	llink->ll_hash	  = hash;
 	llink->ll_evicted = 0;
-	llink->ll_ref	  = 1; /* 1 for caller */
+	llink->ll_ref	  = 2; /* 1 for hash, 1 for caller */
 	llink->ll_ops	  = lcache->dlc_ops;
 	D_INIT_LIST_HEAD(&llink->ll_qlink);
 
-	rc = d_hash_rec_insert(&lcache->dlc_htable, key, key_size,
-			       &llink->ll_hlink, true);
-	D_ASSERT(rc == 0);
+	lru_slot_insert(lcache->dlc_slots, lru_slot_mask(lcache), llink);
+	lcache->dlc_slot_used++;
 found:
 	if (llink->ll_ref == 2) /* 1 for hash, 1 for the first holder */
 		lru_mark_busy(lcache, llink);
@@ -304,10 +354,8 @@ daos_lru_ref_release(struct daos_lru_cache *lcache, struct daos_llink *llink)
 
 		if (llink->ll_evicted) {
 			D_DEBUG(DB_TRACE, "Evict %p from LRU cache\n", llink);
-			d_list_del_init(&llink->ll_qlink);
-			/* be freed within hash callback */
-			d_hash_rec_delete_at(&lcache->dlc_htable,
-					     &llink->ll_hlink);
+			lru_item_delete(lcache, llink);
+			lcache->dlc_evicts++;
 		} else {
 			D_DEBUG(DB_TRACE,
 				"Moving %p to the idle list\n", llink);
@@ -327,9 +375,9 @@ daos_lru_ref_release(struct daos_lru_cache *lcache, struct daos_llink *llink)
 		llink = container_of(lcache->dlc_idle_list.prev,
 				     struct daos_llink, ll_qlink);
 
-		d_list_del_init(&llink->ll_qlink);
-		d_hash_rec_delete_at(&lcache->dlc_htable, &llink->ll_hlink);
+		lru_item_delete(lcache, llink);
 		lcache->dlc_idle_nr--;
+		lcache->dlc_evicts++;
 	}
 	D_DEBUG(DB_TRACE, "Done releasing reference\n");
 }
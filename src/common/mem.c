@@ -131,6 +131,12 @@ pmem_tx_publish(struct umem_instance *umm, struct pobj_action *actv,
 	return pmemobj_tx_publish(actv, actv_cnt);
 }
 
+static void
+pmem_persist(struct umem_instance *umm, void *addr, size_t size)
+{
+	pmemobj_persist(umm->umm_u.pmem_pool, addr, size);
+}
+
 static umem_ops_t	pmem_ops = {
 	.mo_addr		= pmem_addr,
 	.mo_equal		= pmem_equal,
@@ -144,6 +150,7 @@ static umem_ops_t	pmem_ops = {
 	.mo_reserve		= pmem_reserve,
 	.mo_cancel		= pmem_cancel,
 	.mo_tx_publish		= pmem_tx_publish,
+	.mo_persist		= pmem_persist,
 };
 
 int
@@ -376,6 +376,133 @@ daos_file_is_dax(const char *pathname)
 	return !strncmp(pathname, "/dev/dax", strlen("/dev/dax"));
 }
 
+static inline uint64_t
+hash_rotl64(uint64_t val, int bits)
+{
+	return (val << bits) | (val >> (64 - bits));
+}
+
+static inline uint64_t
+hash_fmix64(uint64_t key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return key;
+}
+
+/**
+ * 128-bit MurmurHash3 (x64 variant). It computes both 64-bit halves in a
+ * single pass over \a key, which is cheaper than generating two different
+ * 64-bit and 32-bit hashes of the same key.
+ */
+void
+daos_hash_murmur128(const void *key, unsigned int len, uint64_t seed,
+		    uint64_t hash[2])
+{
+	const unsigned char	*data = key;
+	const unsigned char	*tail;
+	const uint64_t		 c1 = 0x87c37b91114253d5ULL;
+	const uint64_t		 c2 = 0x4cf5ad432745937fULL;
+	uint64_t		 h1 = seed;
+	uint64_t		 h2 = seed;
+	uint64_t		 k1;
+	uint64_t		 k2;
+	unsigned int		 i;
+
+	for (i = 0; i < len / 16; i++) {
+		memcpy(&k1, &data[i * 16], sizeof(k1));
+		memcpy(&k2, &data[i * 16 + 8], sizeof(k2));
+
+		k1 *= c1;
+		k1 = hash_rotl64(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+		h1 = hash_rotl64(h1, 27);
+		h1 += h2;
+		h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= c2;
+		k2 = hash_rotl64(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+		h2 = hash_rotl64(h2, 31);
+		h2 += h1;
+		h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	tail = &data[len & ~15U];
+	k1 = k2 = 0;
+	switch (len & 15) {
+	case 15:
+		k2 ^= (uint64_t)tail[14] << 48;
+		/* fall through */
+	case 14:
+		k2 ^= (uint64_t)tail[13] << 40;
+		/* fall through */
+	case 13:
+		k2 ^= (uint64_t)tail[12] << 32;
+		/* fall through */
+	case 12:
+		k2 ^= (uint64_t)tail[11] << 24;
+		/* fall through */
+	case 11:
+		k2 ^= (uint64_t)tail[10] << 16;
+		/* fall through */
+	case 10:
+		k2 ^= (uint64_t)tail[9] << 8;
+		/* fall through */
+	case 9:
+		k2 ^= (uint64_t)tail[8];
+		k2 *= c2;
+		k2 = hash_rotl64(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+		/* fall through */
+	case 8:
+		k1 ^= (uint64_t)tail[7] << 56;
+		/* fall through */
+	case 7:
+		k1 ^= (uint64_t)tail[6] << 48;
+		/* fall through */
+	case 6:
+		k1 ^= (uint64_t)tail[5] << 40;
+		/* fall through */
+	case 5:
+		k1 ^= (uint64_t)tail[4] << 32;
+		/* fall through */
+	case 4:
+		k1 ^= (uint64_t)tail[3] << 24;
+		/* fall through */
+	case 3:
+		k1 ^= (uint64_t)tail[2] << 16;
+		/* fall through */
+	case 2:
+		k1 ^= (uint64_t)tail[1] << 8;
+		/* fall through */
+	case 1:
+		k1 ^= (uint64_t)tail[0];
+		k1 *= c1;
+		k1 = hash_rotl64(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+	}
+
+	h1 ^= len;
+	h2 ^= len;
+	h1 += h2;
+	h2 += h1;
+	h1 = hash_fmix64(h1);
+	h2 = hash_fmix64(h2);
+	h1 += h2;
+	h2 += h1;
+
+	hash[0] = h1;
+	hash[1] = h2;
+}
+
 /**
  * Some helper functions for daos handle hash-table.
  */
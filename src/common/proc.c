@@ -131,6 +131,7 @@ daos_proc_unit_oid(crt_proc_t proc, daos_unit_oid_t *doi)
  *	unsigned int	 cs_type;
  *	unsigned short	 cs_len;
  *	unsigned short	 cs_buf_len;
+ *	unsigned int	 cs_chunk_size;
  *	void		*cs_csum;
  * } daos_csum_buf_t;
 **/
@@ -156,6 +157,10 @@ daos_proc_csum_buf(crt_proc_t proc, daos_csum_buf_t *csum)
 	if (rc != 0)
 		return -DER_HG;
 
+	rc = crt_proc_uint32_t(proc, &csum->cs_chunk_size);
+	if (rc != 0)
+		return -DER_HG;
+
 	if (csum->cs_buf_len < csum->cs_len) {
 		D_ERROR("invalid csum buf len %hu < csum len %hu\n",
 			csum->cs_buf_len, csum->cs_len);
@@ -0,0 +1,200 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/*
+ * This file is part of DAOSM
+ *
+ * common/scratch.c
+ */
+#define D_LOGFAC	DD_FAC(common)
+
+#include <daos/common.h>
+#include <daos/scratch.h>
+
+/** alignment of all scratch allocations */
+#define SCRATCH_ALIGN		16
+
+struct daos_scratch_chunk {
+	/** link chain on daos_scratch::ds_idle */
+	d_list_t		 sc_link;
+	/** offset of the bump pointer within \a sc_buf */
+	size_t			 sc_used;
+	/** number of live allocations */
+	unsigned int		 sc_ref;
+	/** size of \a sc_buf */
+	unsigned int		 sc_size;
+	char			 sc_buf[0];
+};
+
+/** header of each allocation, it's also used by heap allocations */
+struct scratch_hdr {
+	/** the owner chunk, NULL if it's allocated from heap */
+	struct daos_scratch_chunk	*sh_chunk;
+	uint64_t			 sh_padding;
+};
+
+void
+daos_scratch_init(struct daos_scratch *scr, unsigned int chunk_size,
+		  unsigned int idle_max)
+{
+	memset(scr, 0, sizeof(*scr));
+	D_INIT_LIST_HEAD(&scr->ds_idle);
+	scr->ds_chunk_size = chunk_size ? : DAOS_SCRATCH_CHUNK_SIZE;
+	scr->ds_idle_max = idle_max;
+}
+
+void
+daos_scratch_fini(struct daos_scratch *scr)
+{
+	struct daos_scratch_chunk *chk;
+	struct daos_scratch_chunk *tmp;
+
+	if (scr->ds_cur != NULL) {
+		/* NB: leak it if it's still in use, instead of crashing
+		 * those holders.
+		 */
+		if (scr->ds_cur->sc_ref == 0)
+			D_FREE(scr->ds_cur);
+		else
+			D_ERROR("%u scratch buffers are still in use\n",
+				scr->ds_cur->sc_ref);
+		scr->ds_cur = NULL;
+	}
+
+	d_list_for_each_entry_safe(chk, tmp, &scr->ds_idle, sc_link) {
+		d_list_del(&chk->sc_link);
+		D_FREE(chk);
+	}
+	scr->ds_idle_nr = 0;
+}
+
+/** take an idle chunk, or allocate a new one */
+static struct daos_scratch_chunk *
+scratch_chunk_get(struct daos_scratch *scr)
+{
+	struct daos_scratch_chunk *chk;
+
+	if (!d_list_empty(&scr->ds_idle)) {
+		chk = d_list_entry(scr->ds_idle.next,
+				   struct daos_scratch_chunk, sc_link);
+		d_list_del_init(&chk->sc_link);
+		scr->ds_idle_nr--;
+		return chk;
+	}
+
+	D_ALLOC(chk, sizeof(*chk) + scr->ds_chunk_size);
+	if (chk == NULL)
+		return NULL;
+
+	D_INIT_LIST_HEAD(&chk->sc_link);
+	chk->sc_size = scr->ds_chunk_size;
+	return chk;
+}
+
+/** park a retired chunk on the idle list, or free it */
+static void
+scratch_chunk_put(struct daos_scratch *scr, struct daos_scratch_chunk *chk)
+{
+	D_ASSERT(chk->sc_ref == 0);
+	if (scr->ds_idle_nr >= scr->ds_idle_max) {
+		D_FREE(chk);
+		return;
+	}
+
+	chk->sc_used = 0;
+	d_list_add(&chk->sc_link, &scr->ds_idle);
+	scr->ds_idle_nr++;
+}
+
+void *
+daos_scratch_alloc(struct daos_scratch *scr, size_t size)
+{
+	struct daos_scratch_chunk *chk;
+	struct scratch_hdr	  *hdr;
+	size_t			   len;
+
+	len = sizeof(*hdr) + size;
+	len = (len + SCRATCH_ALIGN - 1) & ~((size_t)SCRATCH_ALIGN - 1);
+
+	if (scr == NULL || len > scr->ds_chunk_size / 4) {
+		D_ALLOC(hdr, len);
+		if (hdr == NULL)
+			return NULL;
+
+		hdr->sh_chunk = NULL;
+		return hdr + 1;
+	}
+
+	chk = scr->ds_cur;
+	if (chk != NULL && chk->sc_used + len > chk->sc_size) {
+		if (chk->sc_ref == 0) {
+			/* all buffers have been freed, rewind */
+			chk->sc_used = 0;
+		} else {
+			/* retire it, the last free will recycle it */
+			chk = NULL;
+		}
+	}
+
+	if (chk == NULL) {
+		chk = scratch_chunk_get(scr);
+		if (chk == NULL)
+			return NULL;
+		scr->ds_cur = chk;
+	}
+
+	hdr = (struct scratch_hdr *)&chk->sc_buf[chk->sc_used];
+	chk->sc_used += len;
+	chk->sc_ref++;
+
+	memset(hdr, 0, len);
+	hdr->sh_chunk = chk;
+	return hdr + 1;
+}
+
+void
+daos_scratch_free(struct daos_scratch *scr, void *ptr)
+{
+	struct daos_scratch_chunk *chk;
+	struct scratch_hdr	  *hdr;
+
+	if (ptr == NULL)
+		return;
+
+	hdr = (struct scratch_hdr *)ptr - 1;
+	chk = hdr->sh_chunk;
+	if (chk == NULL) {
+		D_FREE(hdr);
+		return;
+	}
+
+	D_ASSERT(scr != NULL);
+	D_ASSERT(chk->sc_ref > 0);
+	chk->sc_ref--;
+	if (chk->sc_ref > 0)
+		return;
+
+	if (chk == scr->ds_cur)
+		chk->sc_used = 0;
+	else
+		scratch_chunk_put(scr, chk);
+}
@@ -740,6 +740,98 @@ ik_btr_batch_oper(unsigned int key_nr)
 	return 0;
 }
 
+/**
+ * bulk load @key_nr integer keys into an empty tree, lookup all of them,
+ * then bulk merge the same number of new keys into the tree.
+ */
+static int
+ik_btr_bulk_load(unsigned int key_nr)
+{
+	unsigned int	*arr;
+	uint64_t	*keys;
+	char		*vbufs;
+	daos_iov_t	*key_iovs;
+	daos_iov_t	*val_iovs;
+	char		 buf[64];
+	int		 i;
+	int		 j;
+	int		 rc = 0;
+	bool		 verbose = key_nr < 20;
+
+	if (key_nr == 0 || key_nr > (1U << 27)) {
+		D_PRINT("Invalid key number: %d\n", key_nr);
+		return -1;
+	}
+
+	arr = malloc(2 * key_nr * sizeof(*arr));
+	keys = malloc(key_nr * sizeof(*keys));
+	vbufs = malloc(key_nr * 16);
+	key_iovs = malloc(key_nr * sizeof(*key_iovs));
+	val_iovs = malloc(key_nr * sizeof(*val_iovs));
+	D_ASSERT(arr != NULL && keys != NULL && vbufs != NULL &&
+		 key_iovs != NULL && val_iovs != NULL);
+
+	/* odd keys are loaded into the empty tree, even keys are merged */
+	ik_btr_gen_keys(arr, 2 * key_nr);
+	for (j = 0; j < 2; j++) {
+		int	nr;
+
+		for (i = nr = 0; i < 2 * key_nr; i++) {
+			if (arr[i] % 2 != (j == 0))
+				continue;
+
+			keys[nr] = arr[i];
+			snprintf(&vbufs[nr * 16], 16, "%d", arr[i]);
+			daos_iov_set(&key_iovs[nr], &keys[nr],
+				     sizeof(keys[nr]));
+			daos_iov_set(&val_iovs[nr], &vbufs[nr * 16],
+				     strlen(&vbufs[nr * 16]) + 1);
+			nr++;
+		}
+		D_ASSERT(nr == key_nr);
+
+		D_PRINT("Bulk %s %d records.\n", j == 0 ? "load" : "merge",
+			key_nr);
+		rc = dbtree_bulk_load(ik_toh, key_nr, key_iovs, val_iovs);
+		if (rc != 0) {
+			D_PRINT("Bulk load failed: %d\n", rc);
+			D_GOTO(out, rc = -1);
+		}
+		ik_btr_query();
+
+		D_PRINT("Batch lookup %d records.\n", (j + 1) * key_nr);
+		for (i = 0; i < 2 * key_nr; i++) {
+			if (j == 0 && arr[i] % 2 == 0)
+				continue;
+
+			sprintf(buf, "%d", arr[i]);
+			rc = ik_btr_kv_operate(BTR_OPC_LOOKUP, buf, verbose);
+			if (rc != 0) {
+				D_PRINT("Batch lookup failed: %d\n", rc);
+				D_GOTO(out, rc = -1);
+			}
+		}
+	}
+
+	/* duplicate keys in the same batch should be rejected */
+	if (key_nr > 1) {
+		key_iovs[1] = key_iovs[0];
+		rc = dbtree_bulk_load(ik_toh, 2, key_iovs, val_iovs);
+		if (rc != -DER_INVAL) {
+			D_PRINT("Duplicate keys are not rejected: %d\n", rc);
+			D_GOTO(out, rc = -1);
+		}
+		rc = 0;
+	}
+out:
+	free(val_iovs);
+	free(key_iovs);
+	free(vbufs);
+	free(keys);
+	free(arr);
+	return rc;
+}
+
 static int
 ik_btr_perf(unsigned int key_nr)
 {
@@ -827,6 +919,7 @@ static struct option btr_ops[] = {
 	{ "iterate",	required_argument,	NULL,	'i'	},
 	{ "batch",	required_argument,	NULL,	'b'	},
 	{ "perf",	required_argument,	NULL,	'p'	},
+	{ "bulk",	required_argument,	NULL,	'l'	},
 	{ NULL,		0,			NULL,	0	},
 };
 
@@ -848,7 +941,7 @@ main(int argc, char **argv)
 
 	optind = 0;
 	ik_uma.uma_id = UMEM_CLASS_VMEM;
-	while ((rc = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:",
+	while ((rc = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:l:",
 				 btr_ops, NULL)) != -1) {
 		switch (rc) {
 		case 'C':
@@ -888,6 +981,9 @@ main(int argc, char **argv)
 		case 'p':
 			rc = ik_btr_perf(atoi(optarg));
 			break;
+		case 'l':
+			rc = ik_btr_bulk_load(atoi(optarg));
+			break;
 		case 'm':
 			ik_uma.uma_id = UMEM_CLASS_PMEM;
 			ik_uma.uma_u.pmem_pool = pmemobj_create(POOL_NAME,
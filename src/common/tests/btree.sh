@@ -99,6 +99,11 @@ if [ -z ${PERF} ]; then
 	-o				\
 	-b $BAT_NUM			\
 	-D
+
+    echo "B+tree bulk load test..."
+    $BTR	-C ${UINT}${IPL}o:$ORDER		\
+	-l $BAT_NUM			\
+	-D
 else
     echo "B+tree performance test..."
     $BTR	-C ${UINT}${IPL}o:$ORDER		\
@@ -64,6 +64,248 @@ exit:
 	return rc;
 }
 
+/* xxHash64 of well-known strings, seed is 0 */
+static int
+test_checksum_xxhash(void)
+{
+	daos_csum_t	csum;
+	daos_csum_buf_t	csum_buf;
+	daos_iov_t	iov;
+	daos_sg_list_t	sgl;
+	uint64_t	digest;
+	char		str[] = "abc";
+	int		rc;
+
+	rc = daos_csum_init("xxhash64", &csum);
+	if (rc != 0)
+		return rc;
+
+	daos_csum_set(&csum_buf, &digest, sizeof(digest));
+	daos_csum_get(&csum, &csum_buf);
+	if (digest != 0xEF46DB3751D8E999ULL) {
+		D_PRINT("xxhash64 of empty string: "DF_X64"\n", digest);
+		return -DER_IO;
+	}
+
+	daos_iov_set(&iov, str, strlen(str));
+	sgl.sg_nr = sgl.sg_nr_out = 1;
+	sgl.sg_iovs = &iov;
+	daos_csum_compute(&csum, &sgl);
+	daos_csum_get(&csum, &csum_buf);
+	if (digest != 0x44BC2CF5AD770999ULL) {
+		D_PRINT("xxhash64 of \"abc\": "DF_X64"\n", digest);
+		return -DER_IO;
+	}
+
+	daos_csum_free(&csum);
+	return 0;
+}
+
+#define TEST_KAT_BUF_SIZE	1000
+
+/*
+ * Known answers of the ISA-L based checksums, the state is reset to 0 for
+ * CRCs (no final inversion for crc32) and to 1 for adler32. NULL string is
+ * a 1000 bytes pattern (i * 7) split into two iovs of 333 and 667 bytes.
+ */
+static struct {
+	char		*kv_name;
+	char		*kv_str;
+	uint64_t	 kv_digest;
+} csum_kats[] = {
+	{ "crc32",	"",			0x00000000 },
+	{ "crc32",	"a",			0x93ad1061 },
+	{ "crc32",	"123456789",		0x58e3fa20 },
+	{ "crc32",	"message digest",	0x74d64e21 },
+	{ "crc32",	NULL,			0xa1ecb0b1 },
+	{ "crc64",	"",			0x0000000000000000ULL },
+	{ "crc64",	"abc",			0x2cd8094a1a277627ULL },
+	{ "crc64",	"123456789",		0x995dc9bbdf1939faULL },
+	{ "crc64",	"message digest",	0x5dbcc956318a9b6fULL },
+	{ "crc64",	NULL,			0x4bb90d757d4efe3dULL },
+	{ "adler32",	"",			0x00000001 },
+	{ "adler32",	"abc",			0x024d0127 },
+	{ "adler32",	"Wikipedia",		0x11e60398 },
+	{ "adler32",	"message digest",	0x29750586 },
+	{ "adler32",	NULL,			0x5762ee44 },
+};
+
+static int
+test_checksum_kat(void)
+{
+	daos_csum_t	csum;
+	daos_csum_buf_t	csum_buf;
+	daos_iov_t	iovs[2];
+	daos_sg_list_t	sgl;
+	uint64_t	digest;
+	char		buf[TEST_KAT_BUF_SIZE];
+	int		i, rc;
+
+	for (i = 0; i < sizeof(buf); i++)
+		buf[i] = i * 7;
+
+	for (i = 0; i < ARRAY_SIZE(csum_kats); i++) {
+		rc = daos_csum_init(csum_kats[i].kv_name, &csum);
+		if (rc != 0)
+			return rc;
+
+		if (csum_kats[i].kv_str == NULL) {
+			daos_iov_set(&iovs[0], buf, 333);
+			daos_iov_set(&iovs[1], buf + 333, sizeof(buf) - 333);
+			sgl.sg_nr = sgl.sg_nr_out = 2;
+		} else {
+			daos_iov_set(&iovs[0], csum_kats[i].kv_str,
+				     strlen(csum_kats[i].kv_str));
+			sgl.sg_nr = sgl.sg_nr_out = 1;
+		}
+		sgl.sg_iovs = iovs;
+		if (iovs[0].iov_len != 0)
+			daos_csum_compute(&csum, &sgl);
+
+		digest = 0;
+		daos_csum_set(&csum_buf, &digest, daos_csum_get_size(&csum));
+		daos_csum_get(&csum, &csum_buf);
+		daos_csum_free(&csum);
+
+		if (digest != csum_kats[i].kv_digest) {
+			D_PRINT("%s of \"%s\": "DF_X64", expected "DF_X64"\n",
+				csum_kats[i].kv_name,
+				csum_kats[i].kv_str ?: "<pattern>",
+				digest, csum_kats[i].kv_digest);
+			return -DER_IO;
+		}
+	}
+	return 0;
+}
+
+#define TEST_CHUNK_SIZE		64
+#define TEST_CHUNK_NR		5
+
+/* Chunk checksums of a fragmented sgl should match the contiguous ones */
+static int
+test_checksum_chunks(char *cs_name)
+{
+	daos_csum_t	csum;
+	daos_csum_buf_t	csums[TEST_CHUNK_NR];
+	daos_csum_buf_t	cbuf;
+	daos_iov_t	iovs[3];
+	daos_sg_list_t	sgl;
+	uint64_t	digests[TEST_CHUNK_NR];
+	uint64_t	digest;
+	char		buf[TEST_CHUNK_SIZE * (TEST_CHUNK_NR - 1) + 10];
+	int		i, rc;
+
+	for (i = 0; i < sizeof(buf); i++)
+		buf[i] = i * 7;
+
+	rc = daos_csum_init(cs_name, &csum);
+	if (rc != 0)
+		return rc;
+
+	/* split at unaligned offsets */
+	daos_iov_set(&iovs[0], buf, 10);
+	daos_iov_set(&iovs[1], buf + 10, 100);
+	daos_iov_set(&iovs[2], buf + 110, sizeof(buf) - 110);
+	sgl.sg_nr = sgl.sg_nr_out = 3;
+	sgl.sg_iovs = iovs;
+
+	for (i = 0; i < TEST_CHUNK_NR; i++)
+		daos_csum_set(&csums[i], &digests[i], sizeof(digests[i]));
+
+	rc = daos_csum_compute_chunks(&csum, &sgl, TEST_CHUNK_SIZE, csums,
+				      TEST_CHUNK_NR);
+	if (rc != TEST_CHUNK_NR) {
+		D_PRINT("%s: %d chunks computed\n", cs_name, rc);
+		return -DER_IO;
+	}
+
+	sgl.sg_nr = sgl.sg_nr_out = 1;
+	for (i = 0; i < TEST_CHUNK_NR; i++) {
+		daos_iov_set(&iovs[0], buf + i * TEST_CHUNK_SIZE,
+			     min(TEST_CHUNK_SIZE,
+				 sizeof(buf) - i * TEST_CHUNK_SIZE));
+		daos_csum_reset(&csum);
+		daos_csum_compute(&csum, &sgl);
+
+		daos_csum_set(&cbuf, &digest, daos_csum_get_size(&csum));
+		daos_csum_get(&csum, &cbuf);
+		if (memcmp(&digest, &digests[i], cbuf.cs_len)) {
+			D_PRINT("%s: mismatched chunk %d\n", cs_name, i);
+			return -DER_IO;
+		}
+	}
+
+	daos_csum_free(&csum);
+	return 0;
+}
+
+/* Chunk checksums of extents in an iod, data is shared by one sgl */
+static int
+test_checksum_iod(void)
+{
+	daos_csum_t	csum;
+	daos_iod_t	iod;
+	daos_recx_t	recxs[2];
+	daos_iov_t	iovs[2];
+	daos_sg_list_t	sgl;
+	char		buf[300];
+	char		*digest;
+	daos_size_t	off, len;
+	int		i, rc;
+
+	for (i = 0; i < sizeof(buf); i++)
+		buf[i] = i * 3;
+
+	rc = daos_csum_init("crc64", &csum);
+	if (rc != 0)
+		return rc;
+
+	/* two extents of 100 and 200 bytes, chunk size is 64 */
+	memset(&iod, 0, sizeof(iod));
+	iod.iod_type = DAOS_IOD_ARRAY;
+	iod.iod_size = 4;
+	iod.iod_nr = 2;
+	iod.iod_recxs = recxs;
+	recxs[0].rx_idx = 0;
+	recxs[0].rx_nr = 25;
+	recxs[1].rx_idx = 100;
+	recxs[1].rx_nr = 50;
+
+	daos_iov_set(&iovs[0], buf, 150);
+	daos_iov_set(&iovs[1], buf + 150, 150);
+	sgl.sg_nr = sgl.sg_nr_out = 2;
+	sgl.sg_iovs = iovs;
+
+	rc = daos_csum_compute_iod(&csum, &iod, &sgl, TEST_CHUNK_SIZE);
+	if (rc != 0)
+		return rc;
+
+	for (off = 0, i = 0; i < iod.iod_nr; i++) {
+		daos_size_t end = off + recxs[i].rx_nr * iod.iod_size;
+
+		if (iod.iod_csums[i].cs_len !=
+		    daos_csum_chunk_cnt(end - off, TEST_CHUNK_SIZE) * 8) {
+			D_PRINT("recx %d: checksum len %u\n", i,
+				iod.iod_csums[i].cs_len);
+			D_GOTO(out, rc = -DER_IO);
+		}
+
+		digest = iod.iod_csums[i].cs_csum;
+		for (; off < end; off += len, digest += 8) {
+			len = min(end - off, TEST_CHUNK_SIZE);
+			rc = daos_csum_verify(&csum, buf + off, len, digest);
+			if (rc != 0) {
+				D_PRINT("recx %d: mismatch at "DF_U64"\n",
+					i, off);
+				D_GOTO(out, rc);
+			}
+		}
+	}
+out:
+	daos_csum_iod_free(&iod);
+	daos_csum_free(&csum);
+	return rc;
+}
 
 int main(int argc, char *argv[])
 {
@@ -73,7 +315,10 @@ int main(int argc, char *argv[])
 	daos_csum_t	*csum = &csum_local;
 	daos_csum_t	*csum_cmp = &csum_cmp_local;
 	daos_csum_buf_t	csum_buf;
+	char		*chunk_csums[] = {"crc32", "crc64", "xxhash64",
+					  "adler32"};
 	int		test_fail = 0;
+	int		i;
 
 	rc = test_checksum_simple("crc64", csum, &csum_buf);
 	if (rc != 0) {
@@ -107,6 +352,34 @@ int main(int argc, char *argv[])
 		D_ERROR("Error in generating crc32 checksum\n");
 		test_fail++;
 	}
+
+	rc = test_checksum_xxhash();
+	if (rc != 0) {
+		D_ERROR("FAIL in test for xxhash64 checksum: %d\n", rc);
+		test_fail++;
+	}
+
+	rc = test_checksum_kat();
+	if (rc != 0) {
+		D_ERROR("FAIL in known answer test: %d\n", rc);
+		test_fail++;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(chunk_csums); i++) {
+		rc = test_checksum_chunks(chunk_csums[i]);
+		if (rc != 0) {
+			D_ERROR("FAIL in chunk test for %s: %d\n",
+				chunk_csums[i], rc);
+			test_fail++;
+		}
+	}
+
+	rc = test_checksum_iod();
+	if (rc != 0) {
+		D_ERROR("FAIL in iod checksum test: %d\n", rc);
+		test_fail++;
+	}
+
 	if (test_fail)
 		D_PRINT("%d tests failed\n", test_fail);
 	else
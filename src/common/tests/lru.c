@@ -105,6 +105,137 @@ test_ref_hold(struct daos_lru_cache *cache,
 	return rc;
 }
 
+/** hold a key which is already in the cache, without creating it */
+static struct uint_ref *
+test_ref_lookup(struct daos_lru_cache *cache, uint64_t key)
+{
+	struct daos_llink	*link;
+	int			 rc;
+
+	rc = daos_lru_ref_hold(cache, &key, sizeof(key), NULL, &link);
+	D_ASSERTF(rc == 0, "key "DF_U64" isn't found: %d\n", key, rc);
+	return container_of(link, struct uint_ref, ur_llink);
+}
+
+#define LRU_TEST_GROW_NR	1000
+
+/** Hash table should grow with the number of items, and keep all of them */
+static void
+test_slots_grow(void)
+{
+	struct daos_lru_cache	*cache;
+	struct daos_llink	**links;
+	struct uint_ref		*ref;
+	uint64_t		 key;
+	int			 rc;
+
+	rc = daos_lru_cache_create(10, D_HASH_FT_NOLOCK, &uint_ref_llink_ops,
+				   &cache);
+	D_ASSERT(rc == 0);
+
+	D_ALLOC(links, LRU_TEST_GROW_NR * sizeof(*links));
+	D_ASSERT(links != NULL);
+
+	for (key = 0; key < LRU_TEST_GROW_NR; key++) {
+		rc = test_ref_hold(cache, &links[key], &key, sizeof(key));
+		D_ASSERT(rc == 0);
+		D_ASSERT(2 * cache->dlc_slot_used <=
+			 (1U << cache->dlc_slot_bits));
+	}
+	D_ASSERT(cache->dlc_slot_used == LRU_TEST_GROW_NR);
+
+	for (key = 0; key < LRU_TEST_GROW_NR; key++) {
+		ref = test_ref_lookup(cache, key);
+		D_ASSERT(&ref->ur_llink == links[key]);
+		daos_lru_ref_release(cache, &ref->ur_llink);
+		daos_lru_ref_release(cache, links[key]);
+	}
+	D_ASSERT(cache->dlc_busy_nr == 0);
+
+	D_FREE(links);
+	daos_lru_cache_destroy(cache);
+	D_PRINT("LRU hash table grow test passed\n");
+}
+
+#define LRU_TEST_COLL_NR	4
+
+/**
+ * Remove the first of a cluster of colliding keys, the keys after it should
+ * be shifted backward and still be found.
+ */
+static void
+test_slots_collision(void)
+{
+	struct daos_lru_cache	*cache;
+	struct daos_llink	*link;
+	struct daos_llink	*links[LRU_TEST_COLL_NR];
+	struct uint_ref		*ref;
+	uint64_t		 keys[LRU_TEST_COLL_NR];
+	uint64_t		 key;
+	uint32_t		 mask;
+	uint32_t		 home = 0;
+	int			 nr = 0;
+	int			 i;
+	int			 rc;
+
+	rc = daos_lru_cache_create(10, D_HASH_FT_NOLOCK, &uint_ref_llink_ops,
+				   &cache);
+	D_ASSERT(rc == 0);
+	mask = (1U << cache->dlc_slot_bits) - 1;
+
+	/*
+	 * Find three keys with the same home slot, and a fourth key whose home
+	 * is the slot after it. Probed keys are evicted on release, so they
+	 * don't stay in the table.
+	 */
+	for (key = 0; nr < LRU_TEST_COLL_NR; key++) {
+		uint32_t slot;
+
+		rc = daos_lru_ref_hold(cache, &key, sizeof(key), (void *)1,
+				       &link);
+		D_ASSERT(rc == 0);
+		slot = link->ll_hash & mask;
+		daos_lru_ref_evict(link);
+		daos_lru_ref_release(cache, link);
+
+		if (nr == 0)
+			home = slot;
+		else if (slot != ((nr < LRU_TEST_COLL_NR - 1) ?
+				  home : ((home + 1) & mask)))
+			continue;
+		keys[nr++] = key;
+	}
+	D_ASSERT(cache->dlc_slot_used == 0);
+
+	for (i = 0; i < LRU_TEST_COLL_NR; i++) {
+		rc = test_ref_hold(cache, &links[i], &keys[i], sizeof(keys[i]));
+		D_ASSERT(rc == 0);
+		D_ASSERT(cache->dlc_slots[(home + i) & mask] == links[i]);
+	}
+	/* no growth, so the slots are still addressed by @mask */
+	D_ASSERT(mask == (1U << cache->dlc_slot_bits) - 1);
+
+	/* remove the first key of the cluster */
+	daos_lru_ref_evict(links[0]);
+	daos_lru_ref_release(cache, links[0]);
+	D_ASSERT(cache->dlc_slot_used == LRU_TEST_COLL_NR - 1);
+
+	for (i = 1; i < LRU_TEST_COLL_NR; i++) {
+		D_ASSERT(cache->dlc_slots[(home + i - 1) & mask] == links[i]);
+		ref = test_ref_lookup(cache, keys[i]);
+		D_ASSERT(&ref->ur_llink == links[i]);
+		daos_lru_ref_release(cache, &ref->ur_llink);
+		daos_lru_ref_release(cache, links[i]);
+	}
+	D_ASSERT(cache->dlc_slots[(home + LRU_TEST_COLL_NR - 1) & mask] ==
+		 NULL);
+
+	rc = daos_lru_ref_hold(cache, &keys[0], sizeof(keys[0]), NULL, &link);
+	D_ASSERT(rc == -DER_NONEXIST);
+
+	daos_lru_cache_destroy(cache);
+	D_PRINT("LRU hash table collision test passed\n");
+}
 
 int
 main(int argc, char **argv)
@@ -123,7 +254,7 @@ main(int argc, char **argv)
 		exit(-1);
 	}
 
-	rc = daos_lru_cache_create(atoi(argv[1]), D_HASH_FT_RWLOCK,
+	rc = daos_lru_cache_create(atoi(argv[1]), D_HASH_FT_NOLOCK,
 				   &uint_ref_llink_ops,
 				   &tcache);
 	if (rc)
@@ -169,6 +300,15 @@ main(int argc, char **argv)
 	daos_lru_ref_release(tcache, link_ret[1]);
 	D_PRINT("Completed ref release for key: %"PRIu64"\n",
 		keys[1]);
+
+	D_PRINT("LRU stats: hit "DF_U64", miss "DF_U64", evict "DF_U64"\n",
+		tcache->dlc_hits, tcache->dlc_misses, tcache->dlc_evicts);
+	D_ASSERT(tcache->dlc_hits + tcache->dlc_misses == num_keys + 2);
+	D_ASSERT(tcache->dlc_slot_used ==
+		 tcache->dlc_idle_nr + tcache->dlc_busy_nr);
+
+	test_slots_grow();
+	test_slots_collision();
 exit:
 	daos_lru_cache_destroy(tcache);
 	if (keys)
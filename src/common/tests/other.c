@@ -29,6 +29,7 @@
 
 #include <getopt.h>
 #include <daos/common.h>
+#include <daos/scratch.h>
 
 static int
 sort_cmp(void *array, int a, int b)
@@ -60,6 +61,8 @@ static daos_sort_ops_t sort_ops = {
 
 static struct option opts[] = {
 	{ "sort",		required_argument,	NULL,   's'},
+	{ "scratch",		required_argument,	NULL,   'a'},
+	{ "hash",		no_argument,		NULL,   'm'},
 	{  NULL,		0,			NULL,	 0 }
 };
 
@@ -94,6 +97,134 @@ comb_sort_test(int num)
 	return 0;
 }
 
+/**
+ * Allocate \a num buffers from a small scratch arena and free them in
+ * interleaved order, so chunks are retired, recycled and rewound.
+ */
+static int
+scratch_test(int num)
+{
+	struct daos_scratch	  scr;
+	char			**bufs;
+	int			  i;
+	int			  j;
+	int			  rc = 0;
+
+	bufs = calloc(num, sizeof(*bufs));
+	if (bufs == NULL)
+		return -ENOMEM;
+
+	daos_scratch_init(&scr, 4096, 2);
+	for (j = 0; j < 2; j++) {
+		for (i = 0; i < num; i++) {
+			int	size = 1 + (i * 37) % 2048;
+
+			bufs[i] = daos_scratch_alloc(&scr, size);
+			if (bufs[i] == NULL)
+				D_GOTO(out, rc = -ENOMEM);
+
+			if (bufs[i][0] != 0 || bufs[i][size - 1] != 0) {
+				D_PRINT("Buffer %d is not zeroed\n", i);
+				D_GOTO(out, rc = -EINVAL);
+			}
+			memset(bufs[i], i & 0xff, size);
+			/* free every other buffer early */
+			if (i & 1) {
+				daos_scratch_free(&scr, bufs[i]);
+				bufs[i] = NULL;
+			}
+		}
+
+		for (i = 0; i < num; i++) {
+			if (bufs[i] == NULL)
+				continue;
+
+			if (bufs[i][0] != (char)(i & 0xff)) {
+				D_PRINT("Buffer %d was overwritten\n", i);
+				D_GOTO(out, rc = -EINVAL);
+			}
+			daos_scratch_free(&scr, bufs[i]);
+			bufs[i] = NULL;
+		}
+		D_PRINT("Scratch round %d: %d buffers, %u idle chunks\n",
+			j, num, scr.ds_idle_nr);
+	}
+out:
+	for (i = 0; i < num; i++)
+		daos_scratch_free(&scr, bufs[i]);
+	daos_scratch_fini(&scr);
+	free(bufs);
+	return rc;
+}
+
+/** Known answers of 128-bit MurmurHash3 (x64), same as the reference code */
+static struct {
+	const char	*hv_key;
+	uint64_t	 hv_seed;
+	uint64_t	 hv_hash[2];
+} hash_vectors[] = {
+	{ "", 0, { 0x0000000000000000ULL, 0x0000000000000000ULL } },
+	{ "a", 0, { 0x85555565f6597889ULL, 0xe6b53a48510e895aULL } },
+	{ "hello", 0, { 0xcbd8a7b341bd9b02ULL, 0x5b1e906a48ae1d19ULL } },
+	{ "The quick brown fox jumps over the lazy dog", 0,
+	  { 0xe34bbc7bbc071b6cULL, 0x7a433ca9c49a9347ULL } },
+	{ "0123456789abcdef", 0,
+	  { 0x4be06d94cf4ad1a7ULL, 0x87c35b5c63a708daULL } },
+	{ "0123456789abcdef0", 0,
+	  { 0xeb24ae8785a5c075ULL, 0x73fb68b3313128caULL } },
+	{ "", 0x12345678,
+	  { 0xe5769bec5bf78badULL, 0x53bd95278ebdb3a7ULL } },
+	{ "a", 0x12345678,
+	  { 0x6b5bbddb7d04684cULL, 0xd23be386e40e8658ULL } },
+	{ "hello", 0x12345678,
+	  { 0x90004e88df7df7fbULL, 0x40c378227096884eULL } },
+	{ "The quick brown fox jumps over the lazy dog", 0x12345678,
+	  { 0x95f6dd9e04994ff7ULL, 0x2e0a602ff06d0ef5ULL } },
+	{ "0123456789abcdef", 0x12345678,
+	  { 0x16ec292dd9fca3d8ULL, 0xbfb865559668f4ceULL } },
+	{ "0123456789abcdef0", 0x12345678,
+	  { 0xb7702816508c1ae7ULL, 0x1aaa6f3f17618333ULL } },
+};
+
+/**
+ * Check daos_hash_murmur128() against the known answers, the key is also
+ * hashed at an unaligned address.
+ */
+static int
+hash_test(void)
+{
+	char		buf[64];
+	uint64_t	hash[2];
+	unsigned int	len;
+	int		i;
+
+	for (i = 0; i < ARRAY_SIZE(hash_vectors); i++) {
+		len = strlen(hash_vectors[i].hv_key);
+		D_ASSERT(len < sizeof(buf));
+		memcpy(&buf[1], hash_vectors[i].hv_key, len);
+
+		daos_hash_murmur128(hash_vectors[i].hv_key, len,
+				    hash_vectors[i].hv_seed, hash);
+		if (hash[0] != hash_vectors[i].hv_hash[0] ||
+		    hash[1] != hash_vectors[i].hv_hash[1])
+			goto failed;
+
+		daos_hash_murmur128(&buf[1], len, hash_vectors[i].hv_seed,
+				    hash);
+		if (hash[0] != hash_vectors[i].hv_hash[0] ||
+		    hash[1] != hash_vectors[i].hv_hash[1])
+			goto failed;
+	}
+	D_PRINT("Hash test passed, %d vectors\n", i);
+	return 0;
+failed:
+	D_PRINT("Hash of \"%s\" seed "DF_X64" is "DF_X64":"DF_X64
+		", expected "DF_X64":"DF_X64"\n", hash_vectors[i].hv_key,
+		hash_vectors[i].hv_seed, hash[0], hash[1],
+		hash_vectors[i].hv_hash[0], hash_vectors[i].hv_hash[1]);
+	return -EINVAL;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -104,7 +235,7 @@ main(int argc, char **argv)
 	if (rc != 0)
 		return rc;
 
-	while ((opc = getopt_long(argc, argv, "s:", opts, NULL)) != -1) {
+	while ((opc = getopt_long(argc, argv, "s:a:m", opts, NULL)) != -1) {
 		int	num;
 
 		switch (opc) {
@@ -117,6 +248,16 @@ main(int argc, char **argv)
 
 			rc = comb_sort_test(num);
 			break;
+		case 'a':
+			num = strtoul(optarg, NULL, 0);
+			if (num <= 0)
+				return -EINVAL;
+
+			rc = scratch_test(num);
+			break;
+		case 'm':
+			rc = hash_test();
+			break;
 		}
 	}
 
@@ -0,0 +1,87 @@
+/**
+ * (C) Copyright 2019 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * ds_cont: Aggregation Pace
+ *
+ * Aggregation and compaction run as background ULTs in small slices, every
+ * slice is charged with the credits it consumed so the ULT can yield to the
+ * I/O ULTs, or sleep if a purge rate is set and it runs ahead of it.
+ */
+#define D_LOGFAC	DD_FAC(container)
+
+#include <abt.h>
+#include <daos/common.h>
+#include "srv_internal.h"
+
+void
+cont_agg_pace_init(struct cont_agg_pace *pace)
+{
+	memset(pace, 0, sizeof(*pace));
+	pace->ap_rate	= daos_env2uint(getenv("DAOS_PURGE_RATE"));
+	pace->ap_start	= ABT_get_wtime();
+	pace->ap_report	= pace->ap_start;
+}
+
+void
+cont_agg_pace_yield(struct cont_agg_pace *pace, unsigned int used)
+{
+	double	now;
+	double	due;
+
+	pace->ap_used += used;
+	if (pace->ap_rate == 0) {
+		ABT_thread_yield();
+		return;
+	}
+
+	now = ABT_get_wtime();
+	due = pace->ap_start + (double)pace->ap_used / pace->ap_rate;
+	if (due > now)
+		dss_sleep((int)((due - now) * 1000) + 1);
+	else
+		ABT_thread_yield();
+}
+
+int
+cont_agg_pace_run(struct cont_agg_pace *pace, unsigned int credits,
+		  cont_agg_slice_cb_t slice_cb, void *arg)
+{
+	unsigned int	left;
+	bool		finish;
+	int		rc;
+
+	do {
+		left = credits;
+		finish = false;
+		rc = slice_cb(arg, &left, &finish);
+		if (rc != 0)
+			return rc;
+		/*
+		 * Charge the last slice as well, otherwise an object which
+		 * is done in one slice is never paced.
+		 */
+		cont_agg_pace_yield(pace, credits - left);
+	} while (!finish);
+
+	return 0;
+}
@@ -166,6 +166,44 @@ int ds_cont_hdl_hash_create(struct d_hash_table *hash);
 void ds_cont_hdl_hash_destroy(struct d_hash_table *hash);
 void ds_cont_oid_alloc_handler(crt_rpc_t *rpc);
 
+/**
+ * srv_agg_pace.c
+ */
+
+/**
+ * Pace of the aggregation ULT of this xstream. Every slice of aggregation
+ * or compaction is charged with the credits it consumed, the ULT sleeps if
+ * it runs ahead of the budget, otherwise it only yields.
+ */
+struct cont_agg_pace {
+	/** start time of this aggregation */
+	double		ap_start;
+	/** credits (records) per second, zero means unlimited */
+	unsigned int	ap_rate;
+	/** credits consumed so far */
+	uint64_t	ap_used;
+	/** time of the last progress report */
+	double		ap_report;
+	/** progress: objects aggregated, records checked and deleted */
+	uint64_t	ap_nr_objs;
+	uint64_t	ap_nr_scanned;
+	uint64_t	ap_nr_purged;
+};
+
+/**
+ * Process one slice of an object, \a credits is the budget on input and the
+ * unused part of it on return, \a finish is set once the object is done.
+ */
+typedef int (*cont_agg_slice_cb_t)(void *arg, unsigned int *credits,
+				   bool *finish);
+
+void cont_agg_pace_init(struct cont_agg_pace *pace);
+/** Charge \a used credits to the pace and yield (or sleep) */
+void cont_agg_pace_yield(struct cont_agg_pace *pace, unsigned int used);
+/** Run \a slice_cb until the object is done, every slice is charged */
+int cont_agg_pace_run(struct cont_agg_pace *pace, unsigned int credits,
+		      cont_agg_slice_cb_t slice_cb, void *arg);
+
 /**
  * oid_iv.c
  */
@@ -910,10 +910,113 @@ set_container_purged_epoch(daos_handle_t vos_chdl,
 			    NULL, &finish);
 }
 
+/** seconds between two progress reports */
+#define CONT_AGG_REPORT_INTV	10
+
+/** Report the aggregation progress, at most once per report interval */
+static void
+cont_agg_pace_report(struct cont_agg_pace *pace,
+		     struct cont_tgt_epoch_aggregate_in *in, bool force)
+{
+	double	now = ABT_get_wtime();
+
+	if (!force && now - pace->ap_report < CONT_AGG_REPORT_INTV)
+		return;
+
+	pace->ap_report = now;
+	D_DEBUG(DF_DSMS, DF_CONT": aggregated "DF_U64" objects, purged "
+		DF_U64"/"DF_U64" records, %.1f records/s\n",
+		DP_CONT(in->tai_pool_uuid, in->tai_cont_uuid),
+		pace->ap_nr_objs, pace->ap_nr_purged, pace->ap_nr_scanned,
+		now > pace->ap_start ?
+		pace->ap_nr_scanned / (now - pace->ap_start) : 0.0);
+}
+
+/** Arguments of one aggregation or compaction slice */
+struct cont_agg_slice_arg {
+	daos_handle_t		 sa_chdl;
+	daos_unit_oid_t		 sa_oid;
+	daos_epoch_range_t	*sa_epr;
+	vos_purge_anchor_t	*sa_anchor;
+};
+
+static int
+cont_aggregate_slice(void *varg, unsigned int *credits, bool *finish)
+{
+	struct cont_agg_slice_arg *arg = varg;
+
+	return vos_epoch_aggregate(arg->sa_chdl, arg->sa_oid, arg->sa_epr,
+				   credits, arg->sa_anchor, finish);
+}
+
+static int
+cont_compact_slice(void *varg, unsigned int *credits, bool *finish)
+{
+	struct cont_agg_slice_arg *arg = varg;
+
+	return vos_epoch_compact(arg->sa_chdl, arg->sa_oid, credits,
+				 arg->sa_anchor, finish);
+}
+
+/**
+ * Free the record extents which have been fully overwritten at the purged
+ * epoch, it runs in small steps and yields between them.
+ */
+static int
+cont_epoch_compact(daos_handle_t vos_chdl,
+		   struct cont_tgt_epoch_aggregate_in *in, unsigned int credits,
+		   struct cont_agg_pace *pace)
+{
+	vos_iter_param_t	param;
+	vos_iter_entry_t	ent;
+	vos_purge_anchor_t	anchor;
+	struct cont_agg_slice_arg arg;
+	daos_handle_t		iter_hdl;
+	int			rc;
+
+	memset(&param, 0, sizeof(param));
+	param.ip_hdl		= vos_chdl;
+	param.ip_epr.epr_lo	= 0;
+	param.ip_epr.epr_hi	= DAOS_EPOCH_MAX;
+
+	rc = vos_iter_prepare(VOS_ITER_OBJ, &param, &iter_hdl);
+	if (rc != 0)
+		return rc;
+
+	memset(&anchor, 0, sizeof(anchor));
+	arg.sa_chdl	= vos_chdl;
+	arg.sa_epr	= NULL;
+	arg.sa_anchor	= &anchor;
+	rc = vos_iter_probe(iter_hdl, NULL);
+	while (rc == 0) {
+		rc = vos_iter_fetch(iter_hdl, &ent, NULL);
+		if (rc != 0)
+			break;
+
+		arg.sa_oid = ent.ie_oid;
+		rc = cont_agg_pace_run(pace, credits, cont_compact_slice, &arg);
+		if (rc != 0)
+			D_GOTO(out, rc);
+
+		rc = vos_iter_next(iter_hdl);
+	}
+
+	if (rc == -DER_NONEXIST)
+		rc = 0;
+out:
+	if (rc != 0)
+		D_ERROR(DF_CONT": failed to compact extents: %d\n",
+			DP_CONT(in->tai_pool_uuid, in->tai_cont_uuid), rc);
+	vos_iter_finish(iter_hdl);
+	return rc;
+}
+
 static int
 cont_epoch_aggregate_one(void *vin)
 {
 	struct cont_tgt_epoch_aggregate_in	*in  = vin;
+	struct cont_agg_pace			pace;
+	struct cont_agg_slice_arg		arg;
 	unsigned int				credits;
 	vos_iter_param_t			param;
 	struct ds_pool_child			*pool_child;
@@ -924,13 +1027,13 @@ cont_epoch_aggregate_one(void *vin)
 	int					aggregated;
 	int					found;
 	int					rc;
-	bool					finish;
 	size_t					i;
 
 	purge_credits = getenv("DAOS_PURGE_CREDITS");
 	credits = daos_env2uint(purge_credits);
 	if (credits == 0)
 		credits = DAOS_PURGE_CREDITS_MAX;
+	cont_agg_pace_init(&pace);
 
 	pool_child = ds_pool_child_lookup(in->tai_pool_uuid);
 	if (pool_child == NULL) {
@@ -956,6 +1059,8 @@ cont_epoch_aggregate_one(void *vin)
 
 	memset(&param, 0, sizeof(param));
 	param.ip_hdl = vos_chdl;
+	arg.sa_chdl = vos_chdl;
+	arg.sa_epr = &param.ip_epr;
 	found = 0;
 	aggregated = 0;
 	for (i = 0; i < in->tai_epr_list.ca_count; i++) {
@@ -1020,27 +1125,20 @@ cont_epoch_aggregate_one(void *vin)
 			found++;
 
 			memset(&anchor, 0, sizeof(vos_purge_anchor_t));
-			while (true) {
-				unsigned int	l_credits = credits;
-
-				finish = false;
-				rc = vos_epoch_aggregate(vos_chdl, ent.ie_oid,
-							 &param.ip_epr,
-							 &l_credits,
-							 &anchor, &finish);
-				if (rc != 0)
-					goto end_loop;
-
-				if (finish) {
-					D_DEBUG(DB_EPC, "Finished "
-						DF_U64"->"DF_U64")\n",
-						param.ip_epr.epr_lo,
-						param.ip_epr.epr_hi);
-					break;
-				}
-				ABT_thread_yield();
-			}
+			arg.sa_oid = ent.ie_oid;
+			arg.sa_anchor = &anchor;
+			rc = cont_agg_pace_run(&pace, credits,
+					       cont_aggregate_slice, &arg);
+			if (rc != 0)
+				goto end_loop;
+
+			D_DEBUG(DB_EPC, "Finished "DF_U64"->"DF_U64")\n",
+				param.ip_epr.epr_lo, param.ip_epr.epr_hi);
 			aggregated++;
+			pace.ap_nr_objs++;
+			pace.ap_nr_scanned += anchor.pa_nr_scanned;
+			pace.ap_nr_purged += anchor.pa_nr_purged;
+			cont_agg_pace_report(&pace, in, false);
 			opstr = "iter next with vos obj iterator";
 			rc = vos_iter_next(iter_hdl);
 		}
@@ -1052,6 +1150,10 @@ end_loop:
 	D_DEBUG(DF_DSMS, DF_CONT": aggregated %d/%d objects\n",
 		DP_CONT(in->tai_pool_uuid, in->tai_cont_uuid),
 			aggregated, found);
+	cont_agg_pace_report(&pace, in, true);
+
+	/* Compaction is an optimization, failing it can be ignored */
+	cont_epoch_compact(vos_chdl, in, credits, &pace);
 cont_close:
 	vos_cont_close(vos_chdl);
 pool_child:
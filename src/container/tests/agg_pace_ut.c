@@ -0,0 +1,206 @@
+/**
+ * (C) Copyright 2019 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+#define D_LOGFAC	DD_FAC(tests)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <daos/common.h>
+#include "../srv_internal.h"
+
+/*
+ * Unit tests of the aggregation pace. The clock, yield and sleep of the
+ * ULT are emulated, so the test can count how often the ULT gives up the
+ * xstream and how long it sleeps.
+ */
+
+static double	ut_now;
+static int	ut_yields;
+static int	ut_sleeps;
+
+int
+ABT_thread_yield(void)
+{
+	ut_yields++;
+	return 0;
+}
+
+double
+ABT_get_wtime(void)
+{
+	return ut_now;
+}
+
+void
+dss_sleep(int ms)
+{
+	ut_sleeps++;
+	ut_now += (double)ms / 1000;
+}
+
+/* An object which takes uo_slices slices of uo_used credits each */
+struct ut_obj {
+	int		uo_slices;
+	unsigned int	uo_used;
+	int		uo_calls;
+	int		uo_rc;
+};
+
+static int
+ut_slice(void *arg, unsigned int *credits, bool *finish)
+{
+	struct ut_obj *obj = arg;
+
+	obj->uo_calls++;
+	if (obj->uo_rc != 0)
+		return obj->uo_rc;
+
+	assert_true(*credits >= obj->uo_used);
+	*credits -= obj->uo_used;
+	*finish = obj->uo_calls == obj->uo_slices;
+	return 0;
+}
+
+static int
+ut_setup(void **state)
+{
+	ut_now = 0;
+	ut_yields = 0;
+	ut_sleeps = 0;
+	unsetenv("DAOS_PURGE_RATE");
+	return 0;
+}
+
+/* Objects done in a single slice still yield and are charged */
+static void
+ut_pace_single_slice(void **state)
+{
+	struct cont_agg_pace	pace;
+	struct ut_obj		obj;
+	int			i;
+	int			rc;
+
+	cont_agg_pace_init(&pace);
+	for (i = 0; i < 8; i++) {
+		memset(&obj, 0, sizeof(obj));
+		obj.uo_slices = 1;
+		obj.uo_used = 10;
+		rc = cont_agg_pace_run(&pace, 32, ut_slice, &obj);
+		assert_int_equal(rc, 0);
+		assert_int_equal(obj.uo_calls, 1);
+	}
+	assert_int_equal(ut_yields, 8);
+	assert_int_equal(ut_sleeps, 0);
+	assert_int_equal(pace.ap_used, 80);
+}
+
+/* Every slice of a large object is charged, including the last one */
+static void
+ut_pace_multi_slice(void **state)
+{
+	struct cont_agg_pace	pace;
+	struct ut_obj		obj;
+	int			rc;
+
+	cont_agg_pace_init(&pace);
+	memset(&obj, 0, sizeof(obj));
+	obj.uo_slices = 5;
+	obj.uo_used = 32;
+	rc = cont_agg_pace_run(&pace, 32, ut_slice, &obj);
+	assert_int_equal(rc, 0);
+	assert_int_equal(obj.uo_calls, 5);
+	assert_int_equal(ut_yields, 5);
+	assert_int_equal(pace.ap_used, 160);
+}
+
+/* With a purge rate, single slice objects are throttled to that rate */
+static void
+ut_pace_rate(void **state)
+{
+	struct cont_agg_pace	pace;
+	struct ut_obj		obj;
+	int			i;
+	int			rc;
+
+	setenv("DAOS_PURGE_RATE", "100", 1);
+	cont_agg_pace_init(&pace);
+	assert_int_equal(pace.ap_rate, 100);
+
+	for (i = 0; i < 4; i++) {
+		memset(&obj, 0, sizeof(obj));
+		obj.uo_slices = 1;
+		obj.uo_used = 50;
+		rc = cont_agg_pace_run(&pace, 64, ut_slice, &obj);
+		assert_int_equal(rc, 0);
+	}
+	/* 200 credits at 100 credits/s take two seconds */
+	assert_int_equal(ut_sleeps, 4);
+	assert_int_equal(ut_yields, 0);
+	assert_true(ut_now >= 2.0);
+	assert_int_equal(pace.ap_used, 200);
+}
+
+/* A failed slice is returned without being charged */
+static void
+ut_pace_error(void **state)
+{
+	struct cont_agg_pace	pace;
+	struct ut_obj		obj;
+	int			rc;
+
+	cont_agg_pace_init(&pace);
+	memset(&obj, 0, sizeof(obj));
+	obj.uo_slices = 3;
+	obj.uo_used = 8;
+	obj.uo_rc = -DER_NOMEM;
+	rc = cont_agg_pace_run(&pace, 32, ut_slice, &obj);
+	assert_int_equal(rc, -DER_NOMEM);
+	assert_int_equal(obj.uo_calls, 1);
+	assert_int_equal(ut_yields, 0);
+	assert_int_equal(pace.ap_used, 0);
+}
+
+static const struct CMUnitTest pace_uts[] = {
+	cmocka_unit_test_setup(ut_pace_single_slice, ut_setup),
+	cmocka_unit_test_setup(ut_pace_multi_slice, ut_setup),
+	cmocka_unit_test_setup(ut_pace_rate, ut_setup),
+	cmocka_unit_test_setup(ut_pace_error, ut_setup),
+};
+
+int
+main(int argc, char **argv)
+{
+	int rc;
+
+	rc = daos_debug_init(NULL);
+	if (rc != 0)
+		return rc;
+
+	rc = cmocka_run_group_tests_name("Aggregation pace unit tests",
+					 pace_uts, NULL, NULL);
+	daos_debug_fini();
+	return rc;
+}
@@ -26,6 +26,159 @@
 #include <spdk/blob.h>
 #include "eio_internal.h"
 
+static inline unsigned int
+chunk_units(unsigned int type)
+{
+	return type == EIO_CHK_TYPE_LARGE ? EIO_LARGE_CHK_MULT : 1;
+}
+
+static void
+dma_chunk_free(struct eio_dma_chunk *chunk)
+{
+	D_ASSERT(chunk->edc_ptr != NULL);
+	D_ASSERT(chunk->edc_ref == 0);
+
+	spdk_dma_free(chunk->edc_ptr);
+	D_FREE_PTR(chunk);
+}
+
+static struct eio_dma_chunk *
+dma_chunk_alloc(unsigned int type, int socket)
+{
+	struct eio_dma_chunk *chunk;
+	unsigned int pg_cnt = eio_chk_sz * chunk_units(type);
+
+	D_ALLOC_PTR(chunk);
+	if (chunk == NULL) {
+		D_ERROR("Failed to allocate chunk\n");
+		return NULL;
+	}
+
+	chunk->edc_ptr = spdk_dma_malloc_socket(pg_cnt * EIO_DMA_PAGE_SZ,
+						EIO_DMA_PAGE_SZ, NULL, socket);
+	if (chunk->edc_ptr == NULL) {
+		D_ERROR("Failed to allocate DMA buffer\n");
+		D_FREE_PTR(chunk);
+		return NULL;
+	}
+
+	D_INIT_LIST_HEAD(&chunk->edc_link);
+	chunk->edc_pg_cnt = pg_cnt;
+	chunk->edc_type = type;
+	return chunk;
+}
+
+/* Take an idle chunk from reserve, allocate one if there isn't any */
+static struct eio_dma_chunk *
+dma_reserve_get(struct eio_dma_reserve *rsrv, unsigned int type)
+{
+	struct eio_dma_chunk *chunk = NULL;
+	unsigned int units = chunk_units(type);
+
+	ABT_mutex_lock(rsrv->edr_mutex);
+	if (!d_list_empty(&rsrv->edr_idle_list[type])) {
+		chunk = d_list_entry(rsrv->edr_idle_list[type].next,
+				     struct eio_dma_chunk, edc_link);
+		d_list_del_init(&chunk->edc_link);
+		rsrv->edr_idle_cnt[type]--;
+		ABT_mutex_unlock(rsrv->edr_mutex);
+		return chunk;
+	}
+
+	if (rsrv->edr_tot_cnt + units > rsrv->edr_cnt_max) {
+		ABT_mutex_unlock(rsrv->edr_mutex);
+		D_ERROR("Reaching maximum DMA buffer size %u on socket %d\n",
+			rsrv->edr_cnt_max, rsrv->edr_socket);
+		return NULL;
+	}
+	rsrv->edr_tot_cnt += units;
+	ABT_mutex_unlock(rsrv->edr_mutex);
+
+	chunk = dma_chunk_alloc(type, rsrv->edr_socket);
+	if (chunk == NULL) {
+		ABT_mutex_lock(rsrv->edr_mutex);
+		rsrv->edr_tot_cnt -= units;
+		ABT_mutex_unlock(rsrv->edr_mutex);
+	}
+
+	return chunk;
+}
+
+/* Return an idle chunk to reserve, free it if reserve has enough idle ones */
+static void
+dma_reserve_put(struct eio_dma_reserve *rsrv, struct eio_dma_chunk *chunk)
+{
+	unsigned int type = chunk->edc_type;
+	unsigned int units = chunk_units(type);
+
+	D_ASSERT(chunk->edc_ref == 0);
+	D_ASSERT(d_list_empty(&chunk->edc_link));
+	chunk->edc_pg_idx = 0;
+
+	ABT_mutex_lock(rsrv->edr_mutex);
+	if ((rsrv->edr_idle_cnt[type] + 1) * units <= rsrv->edr_idle_max) {
+		d_list_add(&chunk->edc_link, &rsrv->edr_idle_list[type]);
+		rsrv->edr_idle_cnt[type]++;
+		chunk = NULL;
+	} else {
+		D_ASSERT(rsrv->edr_tot_cnt >= units);
+		rsrv->edr_tot_cnt -= units;
+	}
+	ABT_mutex_unlock(rsrv->edr_mutex);
+
+	if (chunk != NULL)
+		dma_chunk_free(chunk);
+}
+
+void
+dma_reserve_destroy(struct eio_dma_reserve *rsrv)
+{
+	struct eio_dma_chunk *chunk, *tmp;
+	int i;
+
+	for (i = 0; i < EIO_CHK_TYPE_MAX; i++) {
+		d_list_for_each_entry_safe(chunk, tmp, &rsrv->edr_idle_list[i],
+					   edc_link) {
+			d_list_del_init(&chunk->edc_link);
+			D_ASSERT(rsrv->edr_tot_cnt >= chunk_units(i));
+			rsrv->edr_tot_cnt -= chunk_units(i);
+			dma_chunk_free(chunk);
+		}
+		rsrv->edr_idle_cnt[i] = 0;
+	}
+	D_ASSERTF(rsrv->edr_tot_cnt == 0, "%u\n", rsrv->edr_tot_cnt);
+
+	ABT_mutex_free(&rsrv->edr_mutex);
+	D_FREE_PTR(rsrv);
+}
+
+struct eio_dma_reserve *
+dma_reserve_create(int socket)
+{
+	struct eio_dma_reserve *rsrv;
+	int i, rc;
+
+	D_ALLOC_PTR(rsrv);
+	if (rsrv == NULL)
+		return NULL;
+
+	rc = ABT_mutex_create(&rsrv->edr_mutex);
+	if (rc != ABT_SUCCESS) {
+		D_FREE_PTR(rsrv);
+		return NULL;
+	}
+
+	for (i = 0; i < EIO_CHK_TYPE_MAX; i++)
+		D_INIT_LIST_HEAD(&rsrv->edr_idle_list[i]);
+	rsrv->edr_socket = socket;
+	/* Each attached xstream enlarges edr_cnt_max */
+	rsrv->edr_cnt_max = 0;
+	rsrv->edr_idle_max = eio_chk_cnt_max;
+
+	return rsrv;
+}
+
+/* Return @cnt idle chunks back to the per-socket reserve */
 static void
 dma_buffer_shrink(struct eio_dma_buffer *buf, unsigned int cnt)
 {
@@ -35,14 +188,10 @@ dma_buffer_shrink(struct eio_dma_buffer *buf, unsigned int cnt)
 		if (cnt == 0)
 			break;
 
-		d_list_del_init(&chunk->edc_link);
-
-		D_ASSERT(chunk->edc_ptr != NULL);
+		D_ASSERT(chunk != buf->edb_cur_chk);
 		D_ASSERT(chunk->edc_pg_idx == 0);
-		D_ASSERT(chunk->edc_ref == 0);
-
-		spdk_dma_free(chunk->edc_ptr);
-		D_FREE_PTR(chunk);
+		d_list_del_init(&chunk->edc_link);
+		dma_reserve_put(buf->edb_rsrv, chunk);
 
 		D_ASSERT(buf->edb_tot_cnt > 0);
 		buf->edb_tot_cnt--;
@@ -50,56 +199,99 @@ dma_buffer_shrink(struct eio_dma_buffer *buf, unsigned int cnt)
 	}
 }
 
+/* Can the xstream borrow a chunk of @type without exceeding its cap? */
+static bool
+dma_buffer_can_borrow(struct eio_dma_buffer *buf, unsigned int type)
+{
+	unsigned int held = buf->edb_tot_cnt + buf->edb_large_cnt;
+
+	if (held + chunk_units(type) <= eio_chk_cnt_max * EIO_DMA_BURST_MULT)
+		return true;
+
+	D_ERROR("Reaching per-xstream DMA buffer cap %u, held:%u\n",
+		eio_chk_cnt_max * EIO_DMA_BURST_MULT, held);
+	return false;
+}
+
+/* Borrow @cnt chunks from the per-socket reserve */
 static int
 dma_buffer_grow(struct eio_dma_buffer *buf, unsigned int cnt)
 {
 	struct eio_dma_chunk *chunk;
-	ssize_t chk_bytes = eio_chk_sz * EIO_DMA_PAGE_SZ;
-	int i, rc = 0;
-
-	if ((buf->edb_tot_cnt + cnt) > eio_chk_cnt_max) {
-		D_ERROR("Exceeding per-xstream DMA buffer size\n");
-		return -DER_OVERFLOW;
-	}
+	int i;
 
 	for (i = 0; i < cnt; i++) {
-		D_ALLOC_PTR(chunk);
-		if (chunk == NULL) {
-			D_ERROR("Failed to allocate chunk\n");
-			rc = -DER_NOMEM;
-			break;
-		}
+		if (!dma_buffer_can_borrow(buf, EIO_CHK_TYPE_IO))
+			return -DER_NOMEM;
 
-		chunk->edc_ptr = spdk_dma_malloc(chk_bytes, EIO_DMA_PAGE_SZ,
-						 NULL);
-		if (chunk->edc_ptr == NULL) {
-			D_ERROR("Failed to allocate DMA buffer\n");
-			D_FREE_PTR(chunk);
-			rc = -DER_NOMEM;
-			break;
-		}
+		chunk = dma_reserve_get(buf->edb_rsrv, EIO_CHK_TYPE_IO);
+		if (chunk == NULL)
+			return -DER_NOMEM;
 
 		d_list_add_tail(&chunk->edc_link, &buf->edb_idle_list);
 		buf->edb_tot_cnt++;
 	}
 
-	return rc;
+	return 0;
+}
+
+/*
+ * Return the idle chunks exceeding the recent high-water mark back to the
+ * per-socket reserve, so that the memory pinned by an idle xstream can be
+ * used by the others.
+ */
+void
+dma_buffer_reclaim(struct eio_dma_buffer *buf, uint64_t now)
+{
+	unsigned int target, idle_cnt;
+
+	if (now < buf->edb_reclaim_ts + EIO_DMA_RECLAIM_US)
+		return;
+
+	buf->edb_reclaim_ts = now;
+	target = max(buf->edb_used_hwm, eio_chk_cnt_init);
+	idle_cnt = buf->edb_tot_cnt - buf->edb_used_cnt;
+	buf->edb_used_hwm = buf->edb_used_cnt;
+
+	if (buf->edb_tot_cnt <= target || idle_cnt == 0)
+		return;
+
+	D_DEBUG(DB_IO, "Reclaim %u/%u DMA chunks, hwm:%u\n",
+		min(buf->edb_tot_cnt - target, idle_cnt), buf->edb_tot_cnt,
+		target);
+	dma_buffer_shrink(buf, min(buf->edb_tot_cnt - target, idle_cnt));
 }
 
 void
 dma_buffer_destroy(struct eio_dma_buffer *buf)
 {
+	struct eio_dma_chunk *chunk = buf->edb_cur_chk;
+
+	/* Current chunk is always on used list */
+	if (chunk != NULL) {
+		D_ASSERT(chunk->edc_ref == 0);
+		d_list_move(&chunk->edc_link, &buf->edb_idle_list);
+		chunk->edc_pg_idx = 0;
+		buf->edb_used_cnt--;
+		buf->edb_cur_chk = NULL;
+	}
+
 	D_ASSERT(d_list_empty(&buf->edb_used_list));
+	D_ASSERT(buf->edb_used_cnt == 0);
+	D_ASSERT(buf->edb_large_cnt == 0);
 	dma_buffer_shrink(buf, buf->edb_tot_cnt);
-
 	D_ASSERT(buf->edb_tot_cnt == 0);
-	buf->edb_cur_chk = NULL;
+
+	ABT_mutex_lock(buf->edb_rsrv->edr_mutex);
+	D_ASSERT(buf->edb_rsrv->edr_cnt_max >= eio_chk_cnt_max);
+	buf->edb_rsrv->edr_cnt_max -= eio_chk_cnt_max;
+	ABT_mutex_unlock(buf->edb_rsrv->edr_mutex);
 
 	D_FREE_PTR(buf);
 }
 
 struct eio_dma_buffer *
-dma_buffer_create(unsigned int init_cnt)
+dma_buffer_create(unsigned int init_cnt, struct eio_dma_reserve *rsrv)
 {
 	struct eio_dma_buffer *buf;
 	int rc;
@@ -112,10 +304,17 @@ dma_buffer_create(unsigned int init_cnt)
 	D_INIT_LIST_HEAD(&buf->edb_used_list);
 	buf->edb_cur_chk = NULL;
 	buf->edb_tot_cnt = 0;
+	buf->edb_rsrv = rsrv;
+	buf->edb_reclaim_ts = d_timeus_secdiff(0);
+
+	/* The reserve can be shared by bursts on any attached xstream */
+	ABT_mutex_lock(rsrv->edr_mutex);
+	rsrv->edr_cnt_max += eio_chk_cnt_max;
+	ABT_mutex_unlock(rsrv->edr_mutex);
 
 	rc = dma_buffer_grow(buf, init_cnt);
 	if (rc != 0) {
-		D_FREE_PTR(buf);
+		dma_buffer_destroy(buf);
 		return NULL;
 	}
 
@@ -189,6 +388,83 @@ eio_iod_free(struct eio_desc *eiod)
 	D_FREE_PTR(eiod);
 }
 
+/*
+ * Get an idle chunk from the per-xstream cache, borrow one from per-socket
+ * reserve when the cache is exhausted and the xstream is under its cap.
+ * Large chunks are always taken from the reserve.
+ */
+static struct eio_dma_chunk *
+chunk_get_idle(struct eio_dma_buffer *edb, unsigned int type)
+{
+	struct eio_dma_chunk *chk;
+	int rc;
+
+	if (type == EIO_CHK_TYPE_LARGE) {
+		if (!dma_buffer_can_borrow(edb, type))
+			return NULL;
+
+		chk = dma_reserve_get(edb->edb_rsrv, type);
+		if (chk != NULL) {
+			d_list_add_tail(&chk->edc_link, &edb->edb_used_list);
+			edb->edb_large_cnt += chunk_units(type);
+		}
+		return chk;
+	}
+
+	if (d_list_empty(&edb->edb_idle_list)) {
+		rc = dma_buffer_grow(edb, 1);
+		if (rc != 0)
+			return NULL;
+	}
+
+	D_ASSERT(!d_list_empty(&edb->edb_idle_list));
+	chk = d_list_entry(edb->edb_idle_list.next, struct eio_dma_chunk,
+			   edc_link);
+	d_list_move_tail(&chk->edc_link, &edb->edb_used_list);
+
+	edb->edb_used_cnt++;
+	if (edb->edb_used_cnt > edb->edb_used_hwm)
+		edb->edb_used_hwm = edb->edb_used_cnt;
+
+	return chk;
+}
+
+/*
+ * Put a chunk no longer referenced by any I/O descriptor back to the cache,
+ * the large chunks and the borrowed chunks exceeding per-xstream cache size
+ * are returned to per-socket reserve.
+ */
+static void
+chunk_put_idle(struct eio_dma_buffer *edb, struct eio_dma_chunk *chk)
+{
+	D_ASSERT(chk->edc_ref == 0);
+	chk->edc_pg_idx = 0;
+
+	/* Current chunk stays on used list, it's reused from the start */
+	if (chk == edb->edb_cur_chk)
+		return;
+
+	d_list_del_init(&chk->edc_link);
+	if (chk->edc_type == EIO_CHK_TYPE_LARGE) {
+		D_ASSERT(edb->edb_large_cnt >= chunk_units(chk->edc_type));
+		edb->edb_large_cnt -= chunk_units(chk->edc_type);
+		dma_reserve_put(edb->edb_rsrv, chk);
+		return;
+	}
+
+	D_ASSERT(edb->edb_used_cnt > 0);
+	edb->edb_used_cnt--;
+
+	if (edb->edb_tot_cnt > eio_chk_cnt_max) {
+		dma_reserve_put(edb->edb_rsrv, chk);
+		edb->edb_tot_cnt--;
+		return;
+	}
+
+	/* Most recently used chunk is reused first */
+	d_list_add(&chk->edc_link, &edb->edb_idle_list);
+}
+
 static inline struct eio_dma_buffer *
 iod_dma_buf(struct eio_desc *eiod)
 {
@@ -230,10 +506,8 @@ iod_release_buffer(struct eio_desc *eiod)
 		D_ASSERT(chunk->edc_ref > 0);
 		chunk->edc_ref--;
 
-		if (chunk->edc_ref == 0) {
-			chunk->edc_pg_idx = 0;
-			d_list_move_tail(&chunk->edc_link, &edb->edb_idle_list);
-		}
+		if (chunk->edc_ref == 0)
+			chunk_put_idle(edb, chunk);
 		rsrvd_dma->erd_dma_chks[i] = NULL;
 	}
 
@@ -241,6 +515,11 @@ iod_release_buffer(struct eio_desc *eiod)
 	rsrvd_dma->erd_dma_chks = NULL;
 	rsrvd_dma->erd_chk_max = rsrvd_dma->erd_chk_cnt = 0;
 
+	if (rsrvd_dma->erd_iovs != NULL) {
+		D_FREE(rsrvd_dma->erd_iovs);
+		rsrvd_dma->erd_iovs = NULL;
+	}
+
 	eiod->ed_buffer_prep = 0;
 }
 
@@ -299,15 +578,15 @@ chunk_reserve(struct eio_dma_chunk *chk, unsigned int chk_pg_idx,
 	      unsigned int pg_cnt, unsigned int pg_off)
 {
 	D_ASSERT(chk != NULL);
-	D_ASSERTF(chk->edc_pg_idx <= eio_chk_sz, "%u > %u\n",
-		  chk->edc_pg_idx, eio_chk_sz);
+	D_ASSERTF(chk->edc_pg_idx <= chk->edc_pg_cnt, "%u > %u\n",
+		  chk->edc_pg_idx, chk->edc_pg_cnt);
 
 	D_ASSERTF(chk_pg_idx == chk->edc_pg_idx ||
 		  (chk_pg_idx + 1) == chk->edc_pg_idx, "%u, %u\n",
 		  chk_pg_idx, chk->edc_pg_idx);
 
 	/* The chunk doesn't have enough unused pages */
-	if (chk_pg_idx + pg_cnt > eio_chk_sz)
+	if (chk_pg_idx + pg_cnt > chk->edc_pg_cnt)
 		return NULL;
 
 	chk->edc_pg_idx = chk_pg_idx + pg_cnt;
@@ -323,32 +602,6 @@ iod_last_region(struct eio_desc *eiod)
 	return (cnt != 0) ? &eiod->ed_rsrvd.erd_regions[cnt - 1] : NULL;
 }
 
-static struct eio_dma_chunk *
-chunk_get_idle(struct eio_dma_buffer *edb)
-{
-	struct eio_dma_chunk *chk;
-	int rc;
-
-	if (d_list_empty(&edb->edb_idle_list)) {
-		/* TODO: Wait for the in-flight I/O being drained off? */
-		if (edb->edb_tot_cnt == eio_chk_cnt_max) {
-			D_ERROR("Reaching maximum DMA buffer size\n");
-			return NULL;
-		}
-
-		rc = dma_buffer_grow(edb, 1);
-		if (rc != 0)
-			return NULL;
-	}
-
-	D_ASSERT(!d_list_empty(&edb->edb_idle_list));
-	chk = d_list_entry(edb->edb_idle_list.next, struct eio_dma_chunk,
-			   edc_link);
-	d_list_move_tail(&chk->edc_link, &edb->edb_used_list);
-
-	return chk;
-}
-
 static int
 iod_add_chunk(struct eio_desc *eiod, struct eio_dma_chunk *chk)
 {
@@ -457,7 +710,7 @@ dma_map_one(struct eio_desc *eiod, struct eio_iov *eiov,
 			off / EIO_DMA_PAGE_SZ;
 	pg_off = off & ~(EIO_DMA_PAGE_SZ - 1);
 
-	if (pg_cnt > eio_chk_sz) {
+	if (pg_cnt > eio_chk_sz * EIO_LARGE_CHK_MULT) {
 		D_ERROR("IOV is too large "DF_U64"\n", eiov->ei_data_len);
 		return -DER_OVERFLOW;
 	}
@@ -465,7 +718,7 @@ dma_map_one(struct eio_desc *eiod, struct eio_iov *eiov,
 	last_rg = iod_last_region(eiod);
 	if (last_rg != NULL) {
 		chk = last_rg->err_chk;
-		D_ASSERT(chk == cur_chk);
+		D_ASSERT(chk == cur_chk || chk->edc_type == EIO_CHK_TYPE_LARGE);
 	}
 
 	/* First, try consecutive reserve from the last reserved region */
@@ -473,7 +726,7 @@ dma_map_one(struct eio_desc *eiod, struct eio_iov *eiov,
 		uint64_t cur_pg, prev_pg_start, prev_pg_end;
 		unsigned int chk_pg_idx = last_rg->err_pg_idx;
 
-		D_ASSERT(chk_pg_idx < eio_chk_sz);
+		D_ASSERT(chk_pg_idx < chk->edc_pg_cnt);
 		prev_pg_start = last_rg->err_off / EIO_DMA_PAGE_SZ;
 		prev_pg_end = last_rg->err_end / EIO_DMA_PAGE_SZ;
 		D_ASSERT(prev_pg_start <= prev_pg_end);
@@ -503,19 +756,33 @@ dma_map_one(struct eio_desc *eiod, struct eio_iov *eiov,
 	 * Try to reserve the DMA buffer from the 'current chunk' of the
 	 * per-xstream DMA buffer.
 	 */
-	chk = cur_chk;
-	eiov->ei_buf = chunk_reserve(chk, chk->edc_pg_idx, pg_cnt, pg_off);
-	if (eiov->ei_buf != NULL)
-		goto add_chunk;
+	if (cur_chk != NULL && cur_chk != chk) {
+		chk = cur_chk;
+		eiov->ei_buf = chunk_reserve(chk, chk->edc_pg_idx, pg_cnt,
+					     pg_off);
+		if (eiov->ei_buf != NULL)
+			goto add_chunk;
+	}
 
-	/*
-	 * Switch to another idle chunk, if there isn't any idle chunk
-	 * available, grow buffer.
-	 */
-	chk = chunk_get_idle(edb);
-	if (chk == NULL)
-		return -DER_OVERFLOW;
-	edb->edb_cur_chk = chk;
+	if (pg_cnt > eio_chk_sz) {
+		/* Dedicated large chunk for the IOV exceeding regular chunk */
+		chk = chunk_get_idle(edb, EIO_CHK_TYPE_LARGE);
+		if (chk == NULL)
+			return -DER_OVERFLOW;
+	} else {
+		/*
+		 * Switch to another idle chunk, if there isn't any idle chunk
+		 * available, borrow one from the per-socket reserve.
+		 */
+		chk = chunk_get_idle(edb, EIO_CHK_TYPE_IO);
+		if (chk == NULL)
+			return -DER_OVERFLOW;
+		edb->edb_cur_chk = chk;
+
+		/* Retired current chunk isn't referenced by anyone */
+		if (cur_chk != NULL && cur_chk->edc_ref == 0)
+			chunk_put_idle(edb, cur_chk);
+	}
 
 	D_ASSERT(chk->edc_pg_idx == 0);
 	eiov->ei_buf = chunk_reserve(chk, chk->edc_pg_idx, pg_cnt, pg_off);
@@ -536,6 +803,10 @@ static void
 rw_completion(void *cb_arg, int err)
 {
 	struct eio_desc *eiod = cb_arg;
+	struct eio_xs_context *xs_ctxt = eiod->ed_ctxt->eic_xs_ctxt;
+
+	D_ASSERT(xs_ctxt->exc_inflights > 0);
+	xs_ctxt->exc_inflights--;
 
 	ABT_mutex_lock(eiod->ed_mutex);
 
@@ -550,23 +821,165 @@ rw_completion(void *cb_arg, int err)
 	ABT_mutex_unlock(eiod->ed_mutex);
 }
 
+/*
+ * Submit a blob I/O, the submitter yields when the xstream has reached the
+ * queue depth limit, and resumes once the NVMe poller reaped completions.
+ */
+static void
+dma_submit(struct eio_desc *eiod, bool write, struct iovec *iovs,
+	   int iov_cnt, uint64_t pg_idx, uint64_t pg_cnt)
+{
+	struct eio_xs_context *xs_ctxt = eiod->ed_ctxt->eic_xs_ctxt;
+	struct spdk_blob *blob = eiod->ed_ctxt->eic_blob;
+	struct spdk_io_channel *channel = xs_ctxt->exc_io_channel;
+
+	D_ASSERT(blob != NULL && channel != NULL);
+	D_ASSERT(iov_cnt > 0);
+
+	while (xs_ctxt->exc_inflights >= EIO_XS_QD_MAX)
+		ABT_thread_yield();
+	xs_ctxt->exc_inflights++;
+
+	ABT_mutex_lock(eiod->ed_mutex);
+	eiod->ed_inflights++;
+	ABT_mutex_unlock(eiod->ed_mutex);
+
+	if (iov_cnt == 1) {
+		if (write)
+			spdk_blob_io_write(blob, channel, iovs[0].iov_base,
+					   pg_idx, pg_cnt, rw_completion,
+					   eiod);
+		else
+			spdk_blob_io_read(blob, channel, iovs[0].iov_base,
+					  pg_idx, pg_cnt, rw_completion, eiod);
+	} else {
+		if (write)
+			spdk_blob_io_writev(blob, channel, iovs, iov_cnt,
+					    pg_idx, pg_cnt, rw_completion,
+					    eiod);
+		else
+			spdk_blob_io_readv(blob, channel, iovs, iov_cnt,
+					   pg_idx, pg_cnt, rw_completion, eiod);
+	}
+}
+
+/*
+ * Invalidate the read-ahead pages overlapping with the regions of an update.
+ * It's called both on submission and on completion of the update, because a
+ * read-ahead issued in between could load the old data.
+ */
+static void
+dma_ra_inval(struct eio_desc *eiod)
+{
+	struct eio_rsrvd_dma *rsrvd_dma = &eiod->ed_rsrvd;
+	struct eio_rsrvd_region *rg;
+	uint64_t pg_idx, pg_end;
+	int i;
+
+	for (i = 0; i < rsrvd_dma->erd_rg_cnt; i++) {
+		rg = &rsrvd_dma->erd_regions[i];
+
+		pg_idx = rg->err_off / EIO_DMA_PAGE_SZ;
+		pg_end = (rg->err_end + EIO_DMA_PAGE_SZ - 1) /
+			 EIO_DMA_PAGE_SZ;
+		ra_cache_inval(eiod->ed_ctxt, pg_idx, pg_end - pg_idx);
+	}
+}
+
+/*
+ * Transfer all the reserved regions, the regions adjacent on blob are merged
+ * into a single vectored blob I/O.
+ */
+static void
+dma_rw_regions(struct eio_desc *eiod)
+{
+	struct eio_rsrvd_dma *rsrvd_dma = &eiod->ed_rsrvd;
+	struct eio_rsrvd_region *rg;
+	struct iovec *iovs;
+	uint64_t pg_idx, pg_end, io_idx = 0, io_cnt = 0;
+	uint64_t st_start = 0, st_end = 0;
+	void *payload;
+	int i, iov_start = 0;
+
+	if (rsrvd_dma->erd_iovs == NULL) {
+		D_ALLOC(rsrvd_dma->erd_iovs,
+			sizeof(*rsrvd_dma->erd_iovs) * rsrvd_dma->erd_rg_cnt);
+		if (rsrvd_dma->erd_iovs == NULL) {
+			eiod->ed_result = -DER_NOMEM;
+			return;
+		}
+	}
+	iovs = rsrvd_dma->erd_iovs;
+
+	if (eiod->ed_update)
+		dma_ra_inval(eiod);
+
+	for (i = 0; i < rsrvd_dma->erd_rg_cnt; i++) {
+		rg = &rsrvd_dma->erd_regions[i];
+
+		pg_idx = rg->err_off / EIO_DMA_PAGE_SZ;
+		pg_end = (rg->err_end + EIO_DMA_PAGE_SZ - 1) /
+			 EIO_DMA_PAGE_SZ;
+		payload = rg->err_chk->edc_ptr +
+			  rg->err_pg_idx * EIO_DMA_PAGE_SZ;
+
+		if (i == 0)
+			st_start = pg_idx;
+		st_end = pg_end;
+
+		if (!eiod->ed_update &&
+		    ra_cache_read(eiod->ed_ctxt, payload, pg_idx,
+				  pg_end - pg_idx)) {
+			/* Served by read-ahead, break the merged I/O */
+			if (io_cnt != 0)
+				dma_submit(eiod, false, &iovs[iov_start],
+					   i - iov_start, io_idx, io_cnt);
+			io_cnt = 0;
+			continue;
+		}
+
+		/* Submit the pending I/O if the region isn't adjacent */
+		if (io_cnt != 0 && (io_idx + io_cnt != pg_idx ||
+				    i - iov_start == EIO_DMA_IOV_MAX)) {
+			dma_submit(eiod, eiod->ed_update, &iovs[iov_start],
+				   i - iov_start, io_idx, io_cnt);
+			io_cnt = 0;
+		}
+
+		if (io_cnt == 0) {
+			io_idx = pg_idx;
+			iov_start = i;
+		}
+		iovs[i].iov_base = payload;
+		iovs[i].iov_len = (pg_end - pg_idx) * EIO_DMA_PAGE_SZ;
+		io_cnt += pg_end - pg_idx;
+	}
+
+	if (io_cnt != 0)
+		dma_submit(eiod, eiod->ed_update, &iovs[iov_start],
+			   i - iov_start, io_idx, io_cnt);
+
+	if (!eiod->ed_update && rsrvd_dma->erd_rg_cnt != 0)
+		ra_stream_update(eiod->ed_ctxt, st_start, st_end);
+}
+
 static void
 dma_rw(struct eio_desc *eiod, bool prep)
 {
-	struct spdk_blob *blob;
-	struct spdk_io_channel *channel;
 	struct eio_rsrvd_dma *rsrvd_dma = &eiod->ed_rsrvd;
 	struct eio_rsrvd_region *rg;
-	uint64_t pg_idx, pg_cnt, pg_end;
+	struct iovec iov;
+	uint64_t pg_idx, pg_end;
 	void *payload, *pg_rmw = NULL;
-	bool rmw_read = (prep && eiod->ed_update);
 	unsigned int pg_off;
 	int i;
 
 	D_ASSERT(eiod->ed_ctxt->eic_xs_ctxt);
-	blob = eiod->ed_ctxt->eic_blob;
-	channel = eiod->ed_ctxt->eic_xs_ctxt->exc_io_channel;
-	D_ASSERT(blob != NULL && channel != NULL);
+
+	if (!prep || !eiod->ed_update) {
+		dma_rw_regions(eiod);
+		return;
+	}
 
 	for (i = 0; i < rsrvd_dma->erd_rg_cnt; i++) {
 		rg = &rsrvd_dma->erd_regions[i];
@@ -575,25 +988,6 @@ dma_rw(struct eio_desc *eiod, bool prep)
 		payload = rg->err_chk->edc_ptr +
 			rg->err_pg_idx * EIO_DMA_PAGE_SZ;
 
-		if (!rmw_read) {
-			pg_cnt = rg->err_end + EIO_DMA_PAGE_SZ - 1;
-			pg_cnt = pg_cnt / EIO_DMA_PAGE_SZ - pg_idx;
-
-			ABT_mutex_lock(eiod->ed_mutex);
-			eiod->ed_inflights++;
-			ABT_mutex_unlock(eiod->ed_mutex);
-
-			if (eiod->ed_update)
-				spdk_blob_io_write(blob, channel, payload,
-						   pg_idx, pg_cnt,
-						   rw_completion, eiod);
-			else
-				spdk_blob_io_read(blob, channel, payload,
-						  pg_idx, pg_cnt,
-						  rw_completion, eiod);
-			continue;
-		}
-
 		/*
 		 * RMW read for partial page update, don't need to worry
 		 * about race of RMW to same page for now, since we don't
@@ -602,12 +996,9 @@ dma_rw(struct eio_desc *eiod, bool prep)
 		pg_off = rg->err_off & ~(EIO_DMA_PAGE_SZ - 1);
 
 		if (pg_off != 0 && payload != pg_rmw) {
-			ABT_mutex_lock(eiod->ed_mutex);
-			eiod->ed_inflights++;
-			ABT_mutex_unlock(eiod->ed_mutex);
-
-			spdk_blob_io_read(blob, channel, payload, pg_idx, 1,
-					  rw_completion, eiod);
+			iov.iov_base = payload;
+			iov.iov_len = EIO_DMA_PAGE_SZ;
+			dma_submit(eiod, false, &iov, 1, pg_idx, 1);
 			pg_rmw = payload;
 		}
 
@@ -617,12 +1008,9 @@ dma_rw(struct eio_desc *eiod, bool prep)
 		pg_off = rg->err_end & ~(EIO_DMA_PAGE_SZ - 1);
 
 		if (pg_off != 0 && payload != pg_rmw) {
-			ABT_mutex_lock(eiod->ed_mutex);
-			eiod->ed_inflights++;
-			ABT_mutex_unlock(eiod->ed_mutex);
-
-			spdk_blob_io_read(blob, channel, payload, pg_end, 1,
-					  rw_completion, eiod);
+			iov.iov_base = payload;
+			iov.iov_len = EIO_DMA_PAGE_SZ;
+			dma_submit(eiod, false, &iov, 1, pg_end, 1);
 			pg_rmw = payload;
 		}
 	}
@@ -774,6 +1162,8 @@ eio_iod_post(struct eio_desc *eiod)
 		ABT_cond_wait(eiod->ed_dma_done, eiod->ed_mutex);
 	ABT_mutex_unlock(eiod->ed_mutex);
 
+	/* Drop the pages read ahead while the update was inflight */
+	dma_ra_inval(eiod);
 	iod_release_buffer(eiod);
 
 	return eiod->ed_result;
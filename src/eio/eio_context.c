@@ -57,6 +57,7 @@ eio_ioctxt_open(struct eio_io_context **pctxt, struct eio_xs_context *xs_ctxt,
 void
 eio_ioctxt_close(struct eio_io_context *ctxt)
 {
+	ra_cache_purge(ctxt);
 	/* TODO close SPDK blob */
 	D_FREE_PTR(ctxt);
 }
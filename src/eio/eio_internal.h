@@ -28,28 +28,112 @@
 #include <daos_srv/eio.h>
 
 #define	EIO_DMA_PAGE_SZ		(4UL << 10)	/* 4K */
+#define EIO_SOCKET_MAX		8	/* Max NUMA sockets */
+#define EIO_LARGE_CHK_MULT	4	/* Large chunk size in regular chunks */
+#define EIO_DMA_RECLAIM_US	(10 * 1000 * 1000)	/* 10 seconds */
+#define EIO_DMA_BURST_MULT	2	/* Per-xstream cap in eio_chk_cnt_max */
+#define EIO_XS_QD_MAX		256	/* Per-xstream max inflight blob I/Os */
+#define EIO_DMA_IOV_MAX		64	/* Max IO vectors in a blob I/O */
+#define EIO_RA_ENTRIES		4	/* Read-ahead entries per xstream */
+#define EIO_RA_PAGES		256	/* Pages in a read-ahead cache entry */
+#define EIO_RA_TRIGGER		2	/* Sequential fetches to trigger RA */
+
+enum {
+	/* Regular chunk shared by small I/Os */
+	EIO_CHK_TYPE_IO = 0,
+	/* Large chunk dedicated to the IOV exceeding a regular chunk */
+	EIO_CHK_TYPE_LARGE,
+	EIO_CHK_TYPE_MAX,
+};
 
 /* DMA buffer is managed in chunks */
 struct eio_dma_chunk {
-	/* Link to edb_idle_list or edb_used_list */
+	/* Link to edb_idle_list, edb_used_list or edr_idle_list */
 	d_list_t	 edc_link;
 	/* Base pointer of the chunk address */
 	void		*edc_ptr;
 	/* Page offset (4K page)  to unused fraction */
 	unsigned int	 edc_pg_idx;
+	/* Chunk size in pages */
+	unsigned int	 edc_pg_cnt;
 	/* Being used by how many I/O descriptors */
 	unsigned int	 edc_ref;
+	/* Chunk type, EIO_CHK_TYPE_IO or EIO_CHK_TYPE_LARGE */
+	unsigned int	 edc_type;
+};
+
+/*
+ * Per-socket DMA chunk reserve shared by all xstreams on the socket, the
+ * chunks are allocated from NUMA local memory. An xstream borrows chunks
+ * from the reserve when its own cache is exhausted, and returns them back
+ * once they are idle.
+ */
+struct eio_dma_reserve {
+	ABT_mutex		 edr_mutex;
+	d_list_t		 edr_idle_list[EIO_CHK_TYPE_MAX];
+	unsigned int		 edr_idle_cnt[EIO_CHK_TYPE_MAX];
+	/* Allocated chunks in regular chunk unit, idle or in use */
+	unsigned int		 edr_tot_cnt;
+	/* Max allocated chunks in regular chunk unit */
+	unsigned int		 edr_cnt_max;
+	/* Max idle chunks in regular chunk unit */
+	unsigned int		 edr_idle_max;
+	int			 edr_socket;
 };
 
 /*
  * Per-xstream DMA buffer, used as SPDK dma I/O buffer or as temporary
- * RDMA buffer for ZC fetch/update over NVMe devices.
+ * RDMA buffer for ZC fetch/update over NVMe devices. It's a cache of
+ * regular chunks backed by the per-socket reserve, an xstream can't hold
+ * more than EIO_DMA_BURST_MULT * eio_chk_cnt_max chunks (in regular chunk
+ * unit) so that a bursting xstream can't drain the reserve of others.
  */
 struct eio_dma_buffer {
 	d_list_t		 edb_idle_list;
 	d_list_t		 edb_used_list;
 	struct eio_dma_chunk	*edb_cur_chk;
+	/* Regular chunks held by the xstream, idle or in use */
 	unsigned int		 edb_tot_cnt;
+	/* Regular chunks in use */
+	unsigned int		 edb_used_cnt;
+	/* Large chunks in use, in regular chunk unit */
+	unsigned int		 edb_large_cnt;
+	/* High-water mark of edb_used_cnt since last reclaim */
+	unsigned int		 edb_used_hwm;
+	/* Last reclaim time in us */
+	uint64_t		 edb_reclaim_ts;
+	struct eio_dma_reserve	*edb_rsrv;
+};
+
+enum {
+	EIO_RA_EMPTY = 0,
+	EIO_RA_LOADING,
+	EIO_RA_VALID,
+};
+
+/* Read-ahead cache entry, it caches EIO_RA_PAGES pages of a blob */
+struct eio_ra_entry {
+	struct spdk_blob	*ere_blob;
+	/* DMA buffer, allocated on first use */
+	void			*ere_buf;
+	uint64_t		 ere_pg_idx;
+	/* Last access stamp for LRU replacement */
+	uint64_t		 ere_stamp;
+	unsigned int		 ere_state;
+	/* Overwritten while loading, drop the data on completion */
+	unsigned int		 ere_stale:1;
+};
+
+/* Per-xstream read-ahead cache for the sequential fetch streams */
+struct eio_ra_cache {
+	struct eio_ra_entry	 erc_entries[EIO_RA_ENTRIES];
+	uint64_t		 erc_clock;
+	/* Fetched regions served from cache */
+	uint64_t		 erc_hits;
+	/* Fetched regions read from device */
+	uint64_t		 erc_misses;
+	/* Issued read-aheads */
+	uint64_t		 erc_prefetches;
 };
 
 /* Per-xstream NVMe context */
@@ -60,6 +144,9 @@ struct eio_xs_context {
 	struct spdk_io_channel	*exc_io_channel;
 	d_list_t		 exc_pollers;
 	struct eio_dma_buffer	*exc_dma_buf;
+	/* Inflight blob I/Os submitted from the xstream */
+	unsigned int		 exc_inflights;
+	struct eio_ra_cache	 exc_ra_cache;
 };
 
 /* Per VOS instance I/O context */
@@ -68,6 +155,10 @@ struct eio_io_context {
 	uint64_t		 eic_pmempool_uuid;
 	struct spdk_blob	*eic_blob;
 	struct eio_xs_context	*eic_xs_ctxt;
+	/* Expected start page of next sequential fetch */
+	uint64_t		 eic_ra_next_pg;
+	/* How many sequential fetches are detected */
+	unsigned int		 eic_ra_seq;
 };
 
 /* A contiguous DMA buffer region reserved by certain io descriptor */
@@ -96,6 +187,11 @@ struct eio_rsrvd_dma {
 	unsigned int		  erd_chk_max;
 	/* Total number of chunks being referenced */
 	unsigned int		  erd_chk_cnt;
+	/*
+	 * IO vectors for the vectored blob I/Os, one for each region, they
+	 * must stay valid until the I/Os completed.
+	 */
+	struct iovec		 *erd_iovs;
 };
 
 /* I/O descriptor */
@@ -125,9 +221,24 @@ struct eio_desc {
 /* eio_xstream.c */
 extern unsigned int	eio_chk_sz;
 extern unsigned int	eio_chk_cnt_max;
+extern unsigned int	eio_chk_cnt_init;
 
 /* eio_buffer.c */
 void dma_buffer_destroy(struct eio_dma_buffer *buf);
-struct eio_dma_buffer *dma_buffer_create(unsigned int init_cnt);
+struct eio_dma_buffer *dma_buffer_create(unsigned int init_cnt,
+					 struct eio_dma_reserve *rsrv);
+void dma_buffer_reclaim(struct eio_dma_buffer *buf, uint64_t now);
+struct eio_dma_reserve *dma_reserve_create(int socket);
+void dma_reserve_destroy(struct eio_dma_reserve *rsrv);
+
+/* eio_readahead.c */
+bool ra_cache_read(struct eio_io_context *ctxt, void *buf, uint64_t pg_idx,
+		   uint64_t pg_cnt);
+void ra_cache_inval(struct eio_io_context *ctxt, uint64_t pg_idx,
+		    uint64_t pg_cnt);
+void ra_stream_update(struct eio_io_context *ctxt, uint64_t pg_start,
+		      uint64_t pg_end);
+void ra_cache_purge(struct eio_io_context *ctxt);
+void ra_cache_fini(struct eio_xs_context *xs_ctxt);
 
 #endif /* __EIO_INTERNAL_H__ */
@@ -0,0 +1,266 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+#define D_LOGFAC	DD_FAC(eio)
+
+#include <spdk/env.h>
+#include <spdk/blob.h>
+#include "eio_internal.h"
+
+/*
+ * Read-ahead for sequential fetch streams. A stream is detected when the
+ * fetches of an I/O context are sequential on the blob, the pages following
+ * the stream are then prefetched into the per-xstream read-ahead cache, and
+ * the following fetches are served from the cache.
+ */
+
+static struct eio_ra_entry *
+ra_lookup(struct eio_ra_cache *cache, struct spdk_blob *blob,
+	  uint64_t pg_idx, uint64_t pg_cnt, bool loading)
+{
+	struct eio_ra_entry *ent;
+	int i;
+
+	for (i = 0; i < EIO_RA_ENTRIES; i++) {
+		ent = &cache->erc_entries[i];
+
+		if (ent->ere_state == EIO_RA_EMPTY || ent->ere_blob != blob)
+			continue;
+		if (!loading && ent->ere_state != EIO_RA_VALID)
+			continue;
+		if (pg_idx >= ent->ere_pg_idx &&
+		    pg_idx + pg_cnt <= ent->ere_pg_idx + EIO_RA_PAGES)
+			return ent;
+	}
+
+	return NULL;
+}
+
+/* Copy the cached pages to @buf, returns false on cache miss */
+bool
+ra_cache_read(struct eio_io_context *ctxt, void *buf, uint64_t pg_idx,
+	      uint64_t pg_cnt)
+{
+	struct eio_ra_cache *cache = &ctxt->eic_xs_ctxt->exc_ra_cache;
+	struct eio_ra_entry *ent;
+
+	if (ctxt->eic_blob == NULL)
+		return false;
+
+	ent = ra_lookup(cache, ctxt->eic_blob, pg_idx, pg_cnt, false);
+	if (ent == NULL) {
+		cache->erc_misses++;
+		return false;
+	}
+
+	memcpy(buf, ent->ere_buf + (pg_idx - ent->ere_pg_idx) *
+	       EIO_DMA_PAGE_SZ, pg_cnt * EIO_DMA_PAGE_SZ);
+	ent->ere_stamp = ++cache->erc_clock;
+	cache->erc_hits++;
+	return true;
+}
+
+/* Invalidate the cached pages being overwritten */
+void
+ra_cache_inval(struct eio_io_context *ctxt, uint64_t pg_idx, uint64_t pg_cnt)
+{
+	struct eio_ra_cache *cache = &ctxt->eic_xs_ctxt->exc_ra_cache;
+	struct eio_ra_entry *ent;
+	int i;
+
+	for (i = 0; i < EIO_RA_ENTRIES; i++) {
+		ent = &cache->erc_entries[i];
+
+		if (ent->ere_state == EIO_RA_EMPTY ||
+		    ent->ere_blob != ctxt->eic_blob)
+			continue;
+		if (pg_idx >= ent->ere_pg_idx + EIO_RA_PAGES ||
+		    pg_idx + pg_cnt <= ent->ere_pg_idx)
+			continue;
+
+		if (ent->ere_state == EIO_RA_LOADING)
+			ent->ere_stale = 1;
+		else
+			ent->ere_state = EIO_RA_EMPTY;
+	}
+}
+
+static void
+ra_completion(void *cb_arg, int err)
+{
+	struct eio_ra_entry *ent = cb_arg;
+
+	D_ASSERT(ent->ere_state == EIO_RA_LOADING);
+	if (err != 0)
+		D_DEBUG(DB_IO, "Read-ahead "DF_U64" failed: %d\n",
+			ent->ere_pg_idx, err);
+
+	ent->ere_state = (err != 0 || ent->ere_stale) ? EIO_RA_EMPTY :
+							 EIO_RA_VALID;
+	ent->ere_stale = 0;
+}
+
+/* Pick the empty or least recently used entry, skip the loading ones */
+static struct eio_ra_entry *
+ra_victim(struct eio_ra_cache *cache)
+{
+	struct eio_ra_entry *ent, *victim = NULL;
+	int i;
+
+	for (i = 0; i < EIO_RA_ENTRIES; i++) {
+		ent = &cache->erc_entries[i];
+
+		if (ent->ere_state == EIO_RA_EMPTY)
+			return ent;
+		if (ent->ere_state == EIO_RA_LOADING)
+			continue;
+		if (victim == NULL || ent->ere_stamp < victim->ere_stamp)
+			victim = ent;
+	}
+
+	return victim;
+}
+
+/*
+ * Track the fetch stream of @ctxt, keep a read-ahead window in front of the
+ * stream once it's detected as sequential.
+ */
+void
+ra_stream_update(struct eio_io_context *ctxt, uint64_t pg_start,
+		 uint64_t pg_end)
+{
+	struct eio_xs_context *xs_ctxt = ctxt->eic_xs_ctxt;
+	struct eio_ra_cache *cache = &xs_ctxt->exc_ra_cache;
+	struct eio_ra_entry *ent;
+	uint64_t pg_idx;
+
+	if (ctxt->eic_blob == NULL)
+		return;
+
+	/* Unaligned records could share the last page with previous fetch */
+	if (pg_start == ctxt->eic_ra_next_pg ||
+	    pg_start + 1 == ctxt->eic_ra_next_pg)
+		ctxt->eic_ra_seq++;
+	else
+		ctxt->eic_ra_seq = 0;
+	ctxt->eic_ra_next_pg = pg_end;
+
+	if (ctxt->eic_ra_seq < EIO_RA_TRIGGER)
+		return;
+
+	/* Find the end of the cached (or being loaded) window */
+	pg_idx = pg_end;
+	while ((ent = ra_lookup(cache, ctxt->eic_blob, pg_idx, 1, true))) {
+		pg_idx = ent->ere_pg_idx + EIO_RA_PAGES;
+		ent->ere_stamp = ++cache->erc_clock;
+	}
+
+	/* One window ahead is enough */
+	if (pg_idx - pg_end >= EIO_RA_PAGES)
+		return;
+
+	/* Don't let read-ahead compete with the foreground I/Os */
+	if (xs_ctxt->exc_inflights >= EIO_XS_QD_MAX / 2)
+		return;
+
+	ent = ra_victim(cache);
+	if (ent == NULL)
+		return;
+
+	if (ent->ere_buf == NULL) {
+		ent->ere_buf = spdk_dma_malloc(EIO_RA_PAGES * EIO_DMA_PAGE_SZ,
+					       EIO_DMA_PAGE_SZ, NULL);
+		if (ent->ere_buf == NULL)
+			return;
+	}
+
+	ent->ere_blob = ctxt->eic_blob;
+	ent->ere_pg_idx = pg_idx;
+	ent->ere_stamp = ++cache->erc_clock;
+	ent->ere_state = EIO_RA_LOADING;
+	ent->ere_stale = 0;
+	cache->erc_prefetches++;
+
+	spdk_blob_io_read(ctxt->eic_blob, xs_ctxt->exc_io_channel,
+			  ent->ere_buf, pg_idx, EIO_RA_PAGES, ra_completion,
+			  ent);
+}
+
+/*
+ * Drop all the cached pages of the blob of @ctxt, entries are keyed by blob
+ * so they must not outlive the I/O context. The inflight read-aheads of the
+ * blob are waited since the blob is going to be closed.
+ */
+void
+ra_cache_purge(struct eio_io_context *ctxt)
+{
+	struct eio_xs_context *xs_ctxt = ctxt->eic_xs_ctxt;
+	struct eio_ra_cache *cache;
+	struct eio_ra_entry *ent;
+	int i;
+
+	if (ctxt->eic_blob == NULL || xs_ctxt == NULL)
+		return;
+
+	cache = &xs_ctxt->exc_ra_cache;
+	for (i = 0; i < EIO_RA_ENTRIES; i++) {
+		ent = &cache->erc_entries[i];
+
+		if (ent->ere_state == EIO_RA_EMPTY ||
+		    ent->ere_blob != ctxt->eic_blob)
+			continue;
+
+		ent->ere_stale = 1;
+		while (ent->ere_state == EIO_RA_LOADING)
+			eio_nvme_poll(xs_ctxt);
+
+		ent->ere_state = EIO_RA_EMPTY;
+		ent->ere_blob = NULL;
+	}
+}
+
+/* Wait for the inflight read-aheads and free the cache */
+void
+ra_cache_fini(struct eio_xs_context *xs_ctxt)
+{
+	struct eio_ra_cache *cache = &xs_ctxt->exc_ra_cache;
+	struct eio_ra_entry *ent;
+	int i;
+
+	for (i = 0; i < EIO_RA_ENTRIES; i++) {
+		ent = &cache->erc_entries[i];
+
+		while (ent->ere_state == EIO_RA_LOADING)
+			eio_nvme_poll(xs_ctxt);
+
+		if (ent->ere_buf != NULL) {
+			spdk_dma_free(ent->ere_buf);
+			ent->ere_buf = NULL;
+		}
+		ent->ere_state = EIO_RA_EMPTY;
+	}
+
+	if (cache->erc_prefetches != 0)
+		D_INFO("Read-ahead hits:"DF_U64" misses:"DF_U64
+		       " prefetches:"DF_U64"\n", cache->erc_hits,
+		       cache->erc_misses, cache->erc_prefetches);
+}
@@ -55,7 +55,7 @@ unsigned int eio_chk_sz;
 /* Per-xstream maximum DMA buffer size (in chunk count) */
 unsigned int eio_chk_cnt_max;
 /* Per-xstream initial DMA buffer size (in chunk count) */
-static unsigned int eio_chk_cnt_init;
+unsigned int eio_chk_cnt_init;
 
 struct eio_bdev {
 	d_list_t	 eb_link;
@@ -76,6 +76,8 @@ struct eio_nvme_data {
 	struct spdk_bs_opts	 ed_bs_opts;
 	/* All bdevs can be used by DAOS server */
 	d_list_t		 ed_bdevs;
+	/* Per-socket DMA chunk reserves */
+	struct eio_dma_reserve	*ed_dma_rsrv[EIO_SOCKET_MAX];
 	unsigned int		 ed_skip_setup:1;
 };
 
@@ -139,6 +141,15 @@ eio_nvme_init(void)
 void
 eio_nvme_fini(void)
 {
+	int i;
+
+	for (i = 0; i < EIO_SOCKET_MAX; i++) {
+		if (nvme_glb.ed_dma_rsrv[i] == NULL)
+			continue;
+		dma_reserve_destroy(nvme_glb.ed_dma_rsrv[i]);
+		nvme_glb.ed_dma_rsrv[i] = NULL;
+	}
+
 	ABT_cond_free(&nvme_glb.ed_barrier);
 	ABT_mutex_free(&nvme_glb.ed_mutex);
 	nvme_glb.ed_skip_setup = 0;
@@ -266,6 +277,10 @@ eio_nvme_poll(struct eio_xs_context *ctxt)
 			poller->enp_expire_us = now + poller->enp_period_us;
 	}
 
+	/* Return the DMA buffer pinned by idle xstream to the reserve */
+	if (ctxt->exc_dma_buf != NULL)
+		dma_buffer_reclaim(ctxt->exc_dma_buf, now);
+
 	return count;
 }
 
@@ -539,6 +554,29 @@ init_blobstore_ctxt(struct eio_xs_context *ctxt, int xs_id)
 	return 0;
 }
 
+/* Socket ID of the CPU where current xstream is bound */
+static int
+xs_socket_id(void)
+{
+	hwloc_cpuset_t cpus;
+	hwloc_obj_t obj;
+	int socket = 0;
+
+	cpus = hwloc_bitmap_alloc();
+	if (cpus == NULL)
+		return 0;
+
+	if (hwloc_get_cpubind(dss_topo, cpus, HWLOC_CPUBIND_THREAD) == 0) {
+		obj = hwloc_get_next_obj_covering_cpuset_by_type(dss_topo,
+					cpus, HWLOC_OBJ_SOCKET, NULL);
+		if (obj != NULL && (int)obj->os_index >= 0)
+			socket = obj->os_index;
+	}
+
+	hwloc_bitmap_free(cpus);
+	return socket;
+}
+
 /*
  * Finalize per-xstream NVMe context and SPDK env.
  *
@@ -552,6 +590,7 @@ eio_xsctxt_free(struct eio_xs_context *ctxt)
 	struct common_cp_arg cp_arg;
 
 	if (ctxt->exc_io_channel != NULL) {
+		ra_cache_fini(ctxt);
 		spdk_bs_free_io_channel(ctxt->exc_io_channel);
 		ctxt->exc_io_channel = NULL;
 	}
@@ -617,8 +656,9 @@ eio_xsctxt_alloc(struct eio_xs_context **pctxt, int xs_id)
 {
 	struct spdk_conf *config = NULL;
 	struct eio_xs_context *ctxt;
+	struct eio_dma_reserve *rsrv;
 	char name[32];
-	int rc;
+	int rc, socket;
 
 	D_ALLOC_PTR(ctxt);
 	if (ctxt == NULL)
@@ -743,7 +783,21 @@ eio_xsctxt_alloc(struct eio_xs_context **pctxt, int xs_id)
 	if (rc)
 		goto out;
 
-	ctxt->exc_dma_buf = dma_buffer_create(eio_chk_cnt_init);
+	/* Get the DMA chunk reserve on the socket where xstream is bound */
+	socket = xs_socket_id();
+	rsrv = nvme_glb.ed_dma_rsrv[socket % EIO_SOCKET_MAX];
+	if (rsrv == NULL) {
+		rsrv = dma_reserve_create(socket);
+		if (rsrv == NULL) {
+			rc = -DER_NOMEM;
+			goto out;
+		}
+		nvme_glb.ed_dma_rsrv[socket % EIO_SOCKET_MAX] = rsrv;
+	}
+
+	ctxt->exc_dma_buf = dma_buffer_create(eio_chk_cnt_init, rsrv);
+	if (ctxt->exc_dma_buf == NULL)
+		rc = -DER_NOMEM;
 out:
 	ABT_mutex_unlock(nvme_glb.ed_mutex);
 	spdk_conf_free(config);
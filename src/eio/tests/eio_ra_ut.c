@@ -0,0 +1,272 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+#define D_LOGFAC	DD_FAC(tests)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <spdk/env.h>
+#include <spdk/blob.h>
+#include <daos/common.h>
+#include "../eio_internal.h"
+
+/*
+ * Unit tests of the read-ahead cache. The blob I/O is emulated by a page
+ * array, each page is filled with its version number. A read snapshots the
+ * pages on submission and completes on eio_nvme_poll().
+ */
+
+#define UT_BLOB_PAGES	(EIO_RA_PAGES * 4)
+#define UT_READS_MAX	EIO_RA_ENTRIES
+/* First page read ahead for the stream issued by ut_stream() */
+#define UT_RA_PG	EIO_RA_TRIGGER
+
+struct ut_read {
+	void			*ur_buf;
+	spdk_blob_op_complete	 ur_cb;
+	void			*ur_arg;
+};
+
+static uint8_t			 ut_blob_vers[UT_BLOB_PAGES];
+static struct ut_read		 ut_reads[UT_READS_MAX];
+static int			 ut_read_cnt;
+static struct eio_xs_context	 ut_xs_ctxt;
+static uint64_t			 ut_blob_dummy[2];
+
+void *
+spdk_dma_malloc(size_t size, size_t align, uint64_t *phys_addr)
+{
+	void *buf = NULL;
+
+	if (posix_memalign(&buf, align, size) != 0)
+		return NULL;
+	return buf;
+}
+
+void
+spdk_dma_free(void *buf)
+{
+	free(buf);
+}
+
+void
+spdk_blob_io_read(struct spdk_blob *blob, struct spdk_io_channel *channel,
+		  void *payload, uint64_t offset, uint64_t length,
+		  spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	uint64_t i;
+
+	assert_true(ut_read_cnt < UT_READS_MAX);
+	assert_true(offset + length <= UT_BLOB_PAGES);
+
+	for (i = 0; i < length; i++)
+		memset((char *)payload + i * EIO_DMA_PAGE_SZ,
+		       ut_blob_vers[offset + i], EIO_DMA_PAGE_SZ);
+
+	ut_reads[ut_read_cnt].ur_buf = payload;
+	ut_reads[ut_read_cnt].ur_cb = cb_fn;
+	ut_reads[ut_read_cnt].ur_arg = cb_arg;
+	ut_read_cnt++;
+}
+
+size_t
+eio_nvme_poll(struct eio_xs_context *ctxt)
+{
+	size_t cnt = ut_read_cnt;
+	int i;
+
+	for (i = 0; i < ut_read_cnt; i++)
+		ut_reads[i].ur_cb(ut_reads[i].ur_arg, 0);
+	ut_read_cnt = 0;
+
+	return cnt;
+}
+
+static void
+ut_ctxt_init(struct eio_io_context *ctxt, int blob)
+{
+	memset(ctxt, 0, sizeof(*ctxt));
+	ctxt->eic_blob = (struct spdk_blob *)&ut_blob_dummy[blob];
+	ctxt->eic_xs_ctxt = &ut_xs_ctxt;
+}
+
+/*
+ * Sequential fetches of single page from page 0, it triggers one read-ahead
+ * starting from UT_RA_PG.
+ */
+static void
+ut_stream(struct eio_io_context *ctxt)
+{
+	uint64_t pg;
+
+	for (pg = 0; pg < EIO_RA_TRIGGER; pg++)
+		ra_stream_update(ctxt, pg, pg + 1);
+}
+
+/* Emulate an update of a page, the version is bumped on completion */
+static void
+ut_write(struct eio_io_context *ctxt, uint64_t pg, bool complete)
+{
+	ra_cache_inval(ctxt, pg, 1);
+	if (complete) {
+		ut_blob_vers[pg]++;
+		ra_cache_inval(ctxt, pg, 1);
+	}
+}
+
+/* Check the page is either a miss or the cached copy is up to date */
+static bool
+ut_read_check(struct eio_io_context *ctxt, uint64_t pg)
+{
+	uint8_t buf[EIO_DMA_PAGE_SZ];
+
+	if (!ra_cache_read(ctxt, buf, pg, 1))
+		return false;
+
+	assert_int_equal(buf[0], ut_blob_vers[pg]);
+	assert_int_equal(buf[EIO_DMA_PAGE_SZ - 1], ut_blob_vers[pg]);
+	return true;
+}
+
+static int
+ut_setup(void **state)
+{
+	memset(&ut_xs_ctxt, 0, sizeof(ut_xs_ctxt));
+	memset(ut_blob_vers, 0, sizeof(ut_blob_vers));
+	ut_read_cnt = 0;
+	return 0;
+}
+
+static int
+ut_teardown(void **state)
+{
+	ra_cache_fini(&ut_xs_ctxt);
+	return 0;
+}
+
+static void
+ut_ra_hit(void **state)
+{
+	struct eio_io_context ctxt;
+
+	ut_ctxt_init(&ctxt, 0);
+	ut_stream(&ctxt);
+	assert_int_equal(ut_read_cnt, 1);
+
+	/* Not served until the read-ahead is done */
+	assert_false(ut_read_check(&ctxt, UT_RA_PG + 1));
+	eio_nvme_poll(&ut_xs_ctxt);
+	assert_true(ut_read_check(&ctxt, UT_RA_PG + 1));
+
+	/* Other blobs don't share the cached pages */
+	ut_ctxt_init(&ctxt, 1);
+	assert_false(ut_read_check(&ctxt, UT_RA_PG + 1));
+}
+
+static void
+ut_ra_write_loading(void **state)
+{
+	struct eio_io_context ctxt;
+	uint64_t pg = UT_RA_PG + 2;
+
+	ut_ctxt_init(&ctxt, 0);
+	ut_stream(&ctxt);
+	assert_int_equal(ut_read_cnt, 1);
+
+	/* Overwritten while the read-ahead is inflight */
+	ut_write(&ctxt, pg, true);
+	eio_nvme_poll(&ut_xs_ctxt);
+	assert_false(ut_read_check(&ctxt, pg));
+}
+
+static void
+ut_ra_write_inflight(void **state)
+{
+	struct eio_io_context ctxt;
+	uint64_t pg = UT_RA_PG + 2;
+
+	ut_ctxt_init(&ctxt, 0);
+
+	/* Read-ahead is issued and done while the update is inflight */
+	ut_write(&ctxt, pg, false);
+	ut_stream(&ctxt);
+	eio_nvme_poll(&ut_xs_ctxt);
+	assert_true(ut_read_check(&ctxt, pg));
+
+	/* The old data must be dropped on update completion */
+	ut_blob_vers[pg]++;
+	ra_cache_inval(&ctxt, pg, 1);
+	assert_false(ut_read_check(&ctxt, pg));
+	assert_true(ut_read_check(&ctxt, pg + 1));
+}
+
+static void
+ut_ra_purge(void **state)
+{
+	struct eio_io_context ctxt, other;
+
+	ut_ctxt_init(&other, 1);
+	ut_stream(&other);
+	eio_nvme_poll(&ut_xs_ctxt);
+
+	/* Purge waits for the inflight read-ahead */
+	ut_ctxt_init(&ctxt, 0);
+	ut_stream(&ctxt);
+	assert_int_equal(ut_read_cnt, 1);
+	ra_cache_purge(&ctxt);
+	assert_int_equal(ut_read_cnt, 0);
+
+	/* A new context on a blob reusing the address sees nothing */
+	ut_ctxt_init(&ctxt, 0);
+	assert_false(ut_read_check(&ctxt, UT_RA_PG + 1));
+
+	/* Pages of the other blob are kept */
+	assert_true(ut_read_check(&other, UT_RA_PG + 1));
+}
+
+static const struct CMUnitTest ra_uts[] = {
+	cmocka_unit_test_setup_teardown(ut_ra_hit, ut_setup, ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_ra_write_loading, ut_setup,
+					ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_ra_write_inflight, ut_setup,
+					ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_ra_purge, ut_setup, ut_teardown),
+};
+
+int
+main(int argc, char **argv)
+{
+	int rc;
+
+	rc = daos_debug_init(NULL);
+	if (rc != 0)
+		return rc;
+
+	rc = cmocka_run_group_tests_name("EIO read-ahead unit tests", ra_uts,
+					 NULL, NULL);
+	daos_debug_fini();
+	return rc;
+}
@@ -103,6 +103,9 @@ enum {
 	BTR_ORDER_MAX			= 4096
 };
 
+/** max size of the inline value buffer of a record, see to_rec_inline_size */
+#define BTR_REC_INLINE_MAX		128
+
 /**
  * Tree root descriptor, it consits of tree attributes and reference to the
  * actual root node.
@@ -193,6 +196,20 @@ typedef struct {
 	 *			and memory class etc.
 	 */
 	int		(*to_hkey_size)(struct btr_instance *tins);
+	/**
+	 * Optional:
+	 * Size of the value buffer stored right after the hashed key of each
+	 * record, so the tree class can store small values in the record
+	 * instead of allocating record body for them. It should not be larger
+	 * than BTR_REC_INLINE_MAX.
+	 *
+	 * Absent:
+	 * Records have no inline value buffer.
+	 *
+	 * \param tins	[IN]	Tree instance which contains the root mmid
+	 *			and memory class etc.
+	 */
+	int		(*to_rec_inline_size)(struct btr_instance *tins);
 	/**
 	 * Optional:
 	 * Comparison of hashed key.
@@ -484,6 +501,8 @@ int  dbtree_open_inplace(struct btr_root *root, struct umem_attr *uma,
 int  dbtree_close(daos_handle_t toh);
 int  dbtree_destroy(daos_handle_t toh);
 int  dbtree_update(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val);
+int  dbtree_bulk_load(daos_handle_t toh, unsigned int nr, daos_iov_t *keys,
+		      daos_iov_t *vals);
 int  dbtree_fetch(daos_handle_t toh, dbtree_probe_opc_t opc,
 		  daos_iov_t *key, daos_iov_t *key_out, daos_iov_t *val_out);
 int  dbtree_lookup(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val_out);
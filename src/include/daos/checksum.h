@@ -31,11 +31,18 @@
 #include <mchecksum.h>
 #endif
 
+/** max size of checksum digest */
 #define DAOS_CSUM_SIZE 64
+/** max size of running state of checksum algorithm */
+#define DAOS_CSUM_STATE_SIZE 128
 
 enum {
+	/** CRC32C (Castagnoli) */
 	DAOS_CS_CRC32 = 0,
+	/** CRC64 (ECMA-182, reflected) */
 	DAOS_CS_CRC64 = 1,
+	DAOS_CS_XXHASH64,
+	DAOS_CS_ADLER32,
 	DAOS_CS_MAX,
 	DAOS_CS_UNKNOWN,
 };
@@ -47,16 +54,69 @@ struct daos_csum {
 #else
 	mchecksum_object_t	dc_csum;
 #endif
-	char			dc_buf[DAOS_CSUM_SIZE];
+	char			dc_buf[DAOS_CSUM_STATE_SIZE];
 
 };
 
 typedef struct daos_csum daos_csum_t;
 int		daos_csum_init(const char *cs_name, daos_csum_t *checksum);
+int		daos_csum_init_type(unsigned int type, daos_csum_t *checksum);
 int		daos_csum_free(daos_csum_t *csum);
 int		daos_csum_reset(daos_csum_t *csum);
 int		daos_csum_compute(daos_csum_t *csum, daos_sg_list_t *sgl);
 daos_size_t	daos_csum_get_size(daos_csum_t *csum);
 int		daos_csum_get(daos_csum_t *csum, daos_csum_buf_t *csum_buf);
 int		daos_csum_compare(daos_csum_t *csum, daos_csum_t *csum_src);
+const char	*daos_csum_type2name(unsigned int type);
+unsigned int	daos_csum_name2type(const char *cs_name);
+
+/**
+ * Compute a checksum for every \a chunk_size bytes of \a sgl, the data is
+ * walked iov by iov so there is no need to linearize the sgl. The trailing
+ * partial chunk gets its own checksum.
+ *
+ * \param csum		[IN]	initialized checksum, it's reset on return
+ * \param sgl		[IN]	data to checksum, sg_nr_out iovs are used
+ * \param chunk_size	[IN]	size of chunk in bytes
+ * \param csums	[OUT]	buffers for the chunk checksums
+ * \param csum_nr	[IN]	number of buffers in \a csums
+ *
+ * \return		number of chunks on success, negative value if error
+ */
+int		daos_csum_compute_chunks(daos_csum_t *csum,
+					 daos_sg_list_t *sgl,
+					 daos_size_t chunk_size,
+					 daos_csum_buf_t *csums,
+					 unsigned int csum_nr);
+
+/**
+ * Compute chunk checksums for every extent of the array \a iod, data of the
+ * extents is taken from \a sgl in order. \a iod::iod_csums is allocated
+ * and should be released by \a daos_csum_iod_free.
+ *
+ * \param csum		[IN]	initialized checksum
+ * \param iod		[IN/OUT] array I/O descriptor without checksums
+ * \param sgl		[IN]	data of the extents
+ * \param chunk_size	[IN]	size of chunk in bytes
+ */
+int		daos_csum_compute_iod(daos_csum_t *csum, daos_iod_t *iod,
+				      daos_sg_list_t *sgl,
+				      unsigned int chunk_size);
+void		daos_csum_iod_free(daos_iod_t *iod);
+
+/**
+ * Verify \a len bytes of \a buf against the checksum \a digest.
+ *
+ * \return		0 if matched, -DER_IO if mismatched, or other
+ *			negative error code
+ */
+int		daos_csum_verify(daos_csum_t *csum, const void *buf,
+				 daos_size_t len, const void *digest);
+
+/** number of chunks for \a len bytes of data */
+static inline unsigned int
+daos_csum_chunk_cnt(daos_size_t len, daos_size_t chunk_size)
+{
+	return (len + chunk_size - 1) / chunk_size;
+}
 #endif
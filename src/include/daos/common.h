@@ -297,6 +297,7 @@ daos_fail_value_get(void);
 #define DAOS_SHARD_OBJ_UPDATE_TIMEOUT_SINGLE	(DAOS_OBJ_FAIL_MOD | 0x07)
 #define DAOS_OBJ_SPECIAL_SHARD		(DAOS_OBJ_FAIL_MOD | 0x08)
 #define DAOS_OBJ_TGT_IDX_CHANGE		(DAOS_OBJ_FAIL_MOD | 0x09)
+#define DAOS_OBJ_COALESCE		(DAOS_OBJ_FAIL_MOD | 0x0a)
 
 /* failure for DAOS_REBUILD_MODULE */
 #define DAOS_REBUILD_DROP_SCAN	(DAOS_REBUILD_FAIL_MOD | 0x001)
@@ -325,6 +326,8 @@ static inline int __is_po2(unsigned long long val)
 #define IS_PO2(val)	__is_po2((unsigned long long)(val))
 
 bool daos_file_is_dax(const char *pathname);
+void daos_hash_murmur128(const void *key, unsigned int len, uint64_t seed,
+			 uint64_t hash[2]);
 
 /* daos handle hash table helpers */
 int daos_hhash_init(void);
@@ -173,6 +173,13 @@ dc_task_schedule(tse_task_t *task, bool instant);
 void *
 dc_task_get_args(tse_task_t *task);
 
+/**
+ * Return true if \a task is created by dc_task_create for the private event,
+ * which means the caller is blocked until completion of the task.
+ */
+bool
+dc_task_is_sync(tse_task_t *task);
+
 /** set opc of the task */
 void
 dc_task_set_opc(tse_task_t *task, uint32_t opc);
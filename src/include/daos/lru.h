@@ -39,15 +39,15 @@ struct daos_llink_ops {
 	/** Mandatory: Compare keys callback for LRU */
 	bool	(*lop_cmp_keys)(const void *key, unsigned int ksize,
 				struct daos_llink *link);
-	/** Optional print_key function for debugging */
+	/** Optional print_key function for debugging, called on cache miss */
 	void	(*lop_print_key)(void *key, unsigned int ksize);
 };
 
 struct daos_llink {
-	/* LRU hash link */
-	d_list_t		ll_hlink;
 	/* LRU queue link */
 	d_list_t		ll_qlink;
+	/* Hash of the key, cached for probing and resizing the table */
+	uint64_t		ll_hash;
 	/* Ref count for this reference */
 	unsigned int		ll_ref:30;
 	/** has been evicted */
@@ -60,8 +60,9 @@ struct daos_llink {
 };
 
 /**
- * LRU cache implementation using d_hash_table
- * and d_list_t
+ * LRU cache implementation using an open addressing (linear probing) hash
+ * table and d_list_t. There is no lock in the cache, so it should be owned
+ * by a single xstream.
  */
 struct daos_lru_cache {
 	/* Provided cache size */
@@ -70,14 +71,24 @@ struct daos_lru_cache {
 	uint32_t		dlc_idle_nr;
 	/* # busy items in the LRU (referenced by caller) */
 	uint32_t		dlc_busy_nr;
+	/* # occupied slots of the hash table */
+	uint32_t		dlc_slot_used;
+	/* log2 of the number of hash table slots, it grows on demand */
+	uint32_t		dlc_slot_bits;
+	/* Hash table slots, holds all refs */
+	struct daos_llink	**dlc_slots;
 	/* Queue head, holds idle refs (no refcnt) */
 	d_list_t		dlc_idle_list;
 	/** list head of busy items in the LRU */
 	d_list_t		dlc_busy_list;
-	/* Holds all refs but needs lookup */
-	struct d_hash_table	dlc_htable;
 	/* ops to allocate and free reference */
 	struct daos_llink_ops	*dlc_ops;
+	/** number of lookups found in the cache */
+	uint64_t		dlc_hits;
+	/** number of lookups not found in the cache */
+	uint64_t		dlc_misses;
+	/** number of items dropped from the cache before destroy */
+	uint64_t		dlc_evicts;
 };
 
 /**
@@ -86,7 +97,9 @@ struct daos_lru_cache {
  *
  * \param bits		[IN]	power2(bits) is the size
  *				of the LRU cache
- * \feats feats		[IN]	Feature bits for DHASH, see DHASH_FT_*
+ * \param feats	[IN]	Must have D_HASH_FT_NOLOCK, the cache has no
+ *				lock and should be accessed by a single
+ *				xstream or under the caller's lock.
  * \param ops		[IN]	DAOS LRU callbacks
  * \param lcache	[OUT]	Newly created LRU cache
  *
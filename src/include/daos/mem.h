@@ -202,6 +202,16 @@ typedef struct {
 	int		 (*mo_tx_publish)(struct umem_instance *umm,
 					  struct pobj_action *actv,
 					  int actv_cnt);
+	/**
+	 * Flush the specified range of memory to persistence domain, it
+	 * can be called outside of transaction.
+	 *
+	 * \param umm	[IN]	umem class instance.
+	 * \param addr	[IN]	Directly accessible memory pointer.
+	 * \param size	[IN]	size of the range.
+	 */
+	void		 (*mo_persist)(struct umem_instance *umm,
+				       void *addr, size_t size);
 } umem_ops_t;
 
 /** attributes to initialise an unified memroy class */
@@ -403,4 +413,11 @@ umem_tx_publish(struct umem_instance *umm, struct pobj_action *actv,
 	return 0;
 }
 
+static inline void
+umem_persist(struct umem_instance *umm, void *addr, size_t size)
+{
+	if (umm->umm_ops->mo_persist)
+		umm->umm_ops->mo_persist(umm, addr, size);
+}
+
 #endif /* __DAOS_MEM_H__ */
@@ -88,6 +88,11 @@ daos_oclass_sr_set_rank(daos_obj_id_t oid, d_rank_t rank)
 
 int dc_obj_init(void);
 void dc_obj_fini(void);
+/**
+ * Send the coalesced updates for \a ctx which have been delayed long enough,
+ * it should be called by the progress of \a ctx.
+ */
+void dc_obj_progress(crt_context_t ctx);
 
 int dc_obj_class_register(tse_task_t *task);
 int dc_obj_class_query(tse_task_t *task);
@@ -77,6 +77,12 @@ extern struct crt_msg_field DMF_KEY_ARRAY;
 
 #define DMF_DAOS_SIZE CMF_UINT64
 
+/** proc functions of DAOS types, for composing module-specific formats */
+int daos_proc_iovec(crt_proc_t proc, daos_iov_t *div);
+int daos_proc_unit_oid(crt_proc_t proc, daos_unit_oid_t *doi);
+int daos_proc_iod(crt_proc_t proc, daos_iod_t *dvi);
+int daos_proc_sg_list(crt_proc_t proc, daos_sg_list_t *sgl);
+
 enum daos_module_id {
 	DAOS_VOS_MODULE		= 0, /** version object store */
 	DAOS_MGMT_MODULE	= 1, /** storage management */
@@ -0,0 +1,78 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Scratch arena for request-lifetime memory.
+ * daos/scratch.h
+ *
+ * A scratch arena hands out memory by bumping a pointer in a large chunk.
+ * Every chunk counts its live allocations, a chunk is rewound or recycled
+ * once all of them have been freed, so the steady state of a request path
+ * does not call malloc/free at all. Requests running in different ULTs can
+ * interleave their allocations freely.
+ *
+ * There is no lock in the arena, so it should be owned by a single xstream,
+ * and memory must be freed on the xstream which allocated it.
+ */
+#ifndef __DAOS_SCRATCH_H__
+#define __DAOS_SCRATCH_H__
+
+#include <gurt/list.h>
+#include <daos/common.h>
+
+/** default size of a scratch chunk */
+#define DAOS_SCRATCH_CHUNK_SIZE		(64 << 10)
+/** default number of idle chunks kept by an arena */
+#define DAOS_SCRATCH_IDLE_MAX		4
+
+struct daos_scratch_chunk;
+
+struct daos_scratch {
+	/** the chunk serving new allocations */
+	struct daos_scratch_chunk	*ds_cur;
+	/** idle chunks for reuse */
+	d_list_t			 ds_idle;
+	/** number of chunks on \a ds_idle */
+	unsigned int			 ds_idle_nr;
+	/** max number of idle chunks */
+	unsigned int			 ds_idle_max;
+	/** size of each chunk */
+	unsigned int			 ds_chunk_size;
+};
+
+void daos_scratch_init(struct daos_scratch *scr, unsigned int chunk_size,
+		       unsigned int idle_max);
+void daos_scratch_fini(struct daos_scratch *scr);
+
+/**
+ * Allocate \a size bytes of zeroed memory from the arena \a scr, requests
+ * larger than a quarter of chunk are served by the heap. It is also served
+ * by the heap if \a scr is NULL.
+ *
+ * Returned memory must be released by \a daos_scratch_free.
+ */
+void *daos_scratch_alloc(struct daos_scratch *scr, size_t size);
+
+/** Free memory allocated by \a daos_scratch_alloc, \a ptr can be NULL */
+void daos_scratch_free(struct daos_scratch *scr, void *ptr);
+
+#endif /* __DAOS_SCRATCH_H__ */
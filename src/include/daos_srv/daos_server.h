@@ -29,6 +29,7 @@
 #define __DSS_API_H__
 
 #include <daos/common.h>
+#include <daos/checksum.h>
 #include <daos/rpc.h>
 #include <daos_srv/iv.h>
 #include <daos_event.h>
@@ -350,6 +351,20 @@ struct dss_acc_task {
 	int		(*at_cb)(void *cb_args);
 };
 
+/** Checksum offload arguments, it's \a at_params of dss_acc_task */
+struct dss_acc_csum_args {
+	/** initialized checksum */
+	daos_csum_t		*dca_csum;
+	/** data to checksum */
+	daos_sg_list_t		*dca_sgl;
+	/** chunk size, 0 for a single checksum of the whole sgl */
+	daos_size_t		 dca_chunk_size;
+	/** output checksum buffers */
+	daos_csum_buf_t		*dca_csums;
+	/** number of buffers in \a dca_csums */
+	unsigned int		 dca_csum_nr;
+};
+
 /**
  * Generic offload call abstraction for accelaration with both
  * ULT and FPGA
@@ -370,6 +385,13 @@ enum {
 	DSS_POOL_CNT,
 };
 
+/**
+ * Each ES pool is a scheduling class, the rebuild class is weighted by
+ * dss_rebuild_res_percentage, and the share class takes this percentage
+ * of the rest.
+ */
+#define DSS_SCHED_SHARE_PERCENTAGE	20
+
 /* DAOS object API on the server side */
 int ds_obj_open(daos_handle_t coh, daos_obj_id_t oid,
 		daos_epoch_t epoch, unsigned int mode,
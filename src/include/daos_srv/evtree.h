@@ -62,7 +62,14 @@ struct evt_ptr {
 	umem_id_t			pt_mmid;
 	/** cookie to insert this extent */
 	uuid_t				pt_cookie;
-	uint64_t			pt_csum;
+	/** chunk checksums of the extent data, it can be NULL */
+	umem_id_t			pt_csum_mmid;
+	/** chunk size of checksums */
+	uint32_t			pt_csum_chunk;
+	/** checksum type */
+	uint16_t			pt_csum_type;
+	/** total bytes of checksums in \a pt_csum_mmid */
+	uint16_t			pt_csum_len;
 	/** number of indices */
 	uint64_t			pt_inum;
 	/** number of bytes per index */
@@ -181,6 +188,13 @@ struct evt_entry {
 	uint32_t			 en_inob;
 	/** offset within \a en_mmid */
 	daos_off_t			 en_offset;
+	/** number of indices of the whole data extent of \a en_mmid */
+	uint64_t			 en_ptr_inum;
+	/**
+	 * chunk checksums of the whole data extent, the checksum buffer is
+	 * NULL if the extent has no checksum.
+	 */
+	daos_csum_buf_t			 en_csum;
 	/**
 	 * the input mmid for \a evt_insert, or the output mmid for
 	 * \a evt_find
@@ -322,9 +336,12 @@ int evt_destroy(daos_handle_t toh);
  * \param rect		[IN]	The versioned extent to insert
  * \param inob		[IN]	Number of bytes per index in \a rect
  * \param mmid		[IN]	Memory ID of the input data.
+ * \param csum		[IN]	Chunk checksums of the input data, it can
+ *				be NULL.
  */
 int evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
-	       struct evt_rect *rect, uint32_t inob, umem_id_t mmid);
+	       struct evt_rect *rect, uint32_t inob, umem_id_t mmid,
+	       daos_csum_buf_t *csum);
 
 /**
  * Insert a new extented version \a rect into a opened tree, and copy data in
@@ -334,9 +351,12 @@ int evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
  * \param rect		[IN]	The versioned extent to insert
  * \param inob		[IN]	Number of bytes per index in \a rect
  * \param sgl		[IN]	Scatter/gather list to copy in
+ * \param csum		[IN]	Chunk checksums of the extent data, it can
+ *				be NULL.
  */
 int evt_insert_sgl(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
-		   struct evt_rect *rect, uint32_t inob, daos_sg_list_t *sgl);
+		   struct evt_rect *rect, uint32_t inob, daos_sg_list_t *sgl,
+		   daos_csum_buf_t *csum);
 
 /**
  * Search the tree and return all versioned extents which overlap with \a rect
@@ -358,6 +378,60 @@ int evt_insert_sgl(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
 int evt_find(daos_handle_t toh, struct evt_rect *rect,
 	     struct evt_entry_list *ent_list, d_list_t *covered);
 
+/**
+ * Prototype of evt_find_visible() callbacks. When a callback returns an rc,
+ *
+ *   - if rc == 0, evt_find_visible() continues;
+ *   - if rc == 1, evt_find_visible() stops and returns 0;
+ *   - otherwise, evt_find_visible() stops and returns rc.
+ *
+ * \a ent is only valid within the callback.
+ */
+typedef int (*evt_visible_cb_t)(struct evt_entry *ent, void *arg);
+
+/**
+ * Search the tree and stream the visible parts of extents which overlap with
+ * \a rect at epoch \a rect::rc_epc_lo to \a cb, in offset order. The output
+ * is the same as the sorted \a ent_list of evt_find(), holes are not
+ * reported.
+ *
+ * Unlike evt_find(), no evt_entry is allocated: the overlapping extents are
+ * collected by a single tree walk, sorted by offset and epoch, then visible
+ * fragments are computed by one sweep over them, which costs O(N * log(N))
+ * for N overlapping extents.
+ *
+ * \param toh		[IN]	The tree open handle
+ * \param rect		[IN]	The versioned extent to search
+ * \param cb		[IN]	Callback for each visible fragment
+ * \param arg		[IN]	Argument of \a cb
+ */
+int evt_find_visible(daos_handle_t toh, struct evt_rect *rect,
+		     evt_visible_cb_t cb, void *arg);
+
+/**
+ * Free extents which are fully covered by newer extents visible at \a epoch,
+ * together with their data. These extents are invisible at any epoch which
+ * is equal to or higher than \a epoch, so \a epoch should not be higher than
+ * the lowest epoch which can be read.
+ *
+ * Extents are checked in the order of start offset. Each extent scanned to
+ * find the candidates, and each candidate checked, consumes one credit. This
+ * function returns once \a credits are consumed (at least one extent is
+ * checked by each call), and it can be called again with the returned
+ * \a anchor to continue.
+ *
+ * \param toh		[IN]	The tree open handle
+ * \param epoch		[IN]	Epoch of the compaction
+ * \param credits	[IN/OUT]
+ *				Number of extents to scan and check, it
+ *				returns the credits left.
+ * \param anchor	[IN/OUT]
+ *				Zeroed anchor to start from the first extent,
+ *				it is set to EOF after checking all extents.
+ */
+int evt_compact(daos_handle_t toh, daos_epoch_t epoch, unsigned int *credits,
+		daos_hash_out_t *anchor);
+
 /**
  * Debug function, it outputs status of tree nodes at level \a debug_level,
  * or all levels if \a debug_level is negative.
@@ -92,8 +92,18 @@ struct ds_pool_child {
 };
 
 struct ds_pool_child *ds_pool_child_lookup(const uuid_t uuid);
+void ds_pool_child_get(struct ds_pool_child *child);
 void ds_pool_child_put(struct ds_pool_child *child);
 
+/**
+ * Callback invoked on the xstream of \a child before it's closed, so that
+ * modules can drop the references they cached on the pool child.
+ */
+typedef void (*ds_pool_child_close_cb_t)(struct ds_pool_child *child);
+
+void ds_pool_child_close_cb_register(unsigned int mod_id,
+				     ds_pool_child_close_cb_t cb);
+
 int
 ds_pool_bcast_create(crt_context_t ctx, struct ds_pool *pool,
 		     enum daos_module_id module, crt_opcode_t opcode,
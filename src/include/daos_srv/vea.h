@@ -92,7 +92,9 @@ struct vea_hint_context;
 /* Unmap context provided by caller */
 struct vea_unmap_context {
 	/**
-	 * Unmap (TRIM) the extent being freed.
+	 * Unmap (TRIM) the freed extent. Freed extents are queued and
+	 * coalesced, then unmapped in batches by vea_unmap_poll() and
+	 * vea_unmap_flush().
 	 *
 	 * \param off [IN]         Offset in bytes
 	 * \param len [IN]         Length in bytes
@@ -125,6 +127,45 @@ struct vea_space_df {
 	struct btr_root	vsd_vec_tree;
 };
 
+/*
+ * Number of buckets in free extent size histogram, bucket i counts the free
+ * extents with [2^i, 2^(i+1)) blocks, the last bucket counts all the larger
+ * extents.
+ */
+#define VEA_STAT_HIST_NR	16
+
+/* Free space & fragmentation statistics */
+struct vea_stat {
+	/* Free blocks visible for allocation */
+	uint64_t	vs_free_blks;
+	/* Recently freed blocks, not visible for allocation yet */
+	uint64_t	vs_agg_blks;
+	/* Blocks cached in magazines for small reservations */
+	uint64_t	vs_mag_blks;
+	/* Free blocks queued for unmap */
+	uint64_t	vs_unmap_blks;
+	/* Number of free extents visible for allocation */
+	uint64_t	vs_frags;
+	/* Block count of the largest free extent */
+	uint64_t	vs_largest_blks;
+	/* Free extent size histogram */
+	uint64_t	vs_hist[VEA_STAT_HIST_NR];
+	/* Reserves with a valid hint offset */
+	uint64_t	vs_hint_tries;
+	/* Reserves satisfied from the hint offset */
+	uint64_t	vs_hint_hits;
+	/* Reserves satisfied from magazines, large & small extents */
+	uint64_t	vs_resrv_mag;
+	uint64_t	vs_resrv_large;
+	uint64_t	vs_resrv_small;
+	/* Reserves satisfied by non-contiguous extent vectors */
+	uint64_t	vs_resrv_vec;
+	/* Percentage of free blocks outside of the largest free extent */
+	uint32_t	vs_frag_ratio;
+	/* Percentage of hinted reserves satisfied from the hint offset */
+	uint32_t	vs_hint_ratio;
+};
+
 struct vea_space_info;
 
 /* Callback to initialize block device header */
@@ -171,7 +212,8 @@ int vea_load(struct umem_instance *umem, struct vea_space_df *md,
 	     struct vea_space_info **vsip);
 
 /**
- * Free the memory footprint created by vea_load().
+ * Free the memory footprint created by vea_load(), the free extents queued
+ * for unmap are unmapped before that.
  *
  * \param vsi	[IN]	In-memory compound free extent index
  *
@@ -245,7 +287,8 @@ int vea_tx_publish(struct vea_space_info *vsi, struct vea_hint_context *hint,
 		   d_list_t *resrvd_list);
 
 /**
- * Free allocated extent.
+ * Free allocated extent, all the extents of an extent vector are freed if
+ * @blk_off is the start offset of an allocated extent vector.
  *
  * \param vsi     [IN]		In-memory compound index
  * \param blk_off [IN]		Start offset of the extent to be freed
@@ -256,6 +299,70 @@ int vea_tx_publish(struct vea_space_info *vsi, struct vea_hint_context *hint,
  */
 int vea_free(struct vea_space_info *vsi, uint64_t blk_off, uint32_t blk_cnt);
 
+/**
+ * Return the pre-carved extents cached for small reservations back to the
+ * free extent index, so that they are visible to any reservation.
+ *
+ * \param vsi     [IN]		In-memory compound index
+ *
+ * \return			Zero on success; Appropriated negative value
+ *				on error
+ */
+int vea_flush(struct vea_space_info *vsi);
+
+/**
+ * Query free space and fragmentation statistics, it walks all the free
+ * extents so it shouldn't be called in the I/O path.
+ *
+ * \param vsi     [IN]		In-memory compound index
+ * \param stat    [OUT]		Returned statistics
+ *
+ * \return			Zero on success; Appropriated negative value
+ *				on error
+ */
+int vea_query(struct vea_space_info *vsi, struct vea_stat *stat);
+
+/**
+ * Unmap the free extents queued for unmap in offset order, small extents are
+ * held back to be coalesced with later freed extents. Caller can call it
+ * periodically from a background poller, and bound the unmap traffic of each
+ * call by @max_blks.
+ *
+ * \param vsi           [IN]	In-memory compound index
+ * \param max_blks      [IN]	Max blocks to be unmapped in this call
+ * \param unmapped_blks [OUT]	Unmapped blocks, optional
+ *
+ * \return			Zero on success; Appropriated negative value
+ *				on error
+ */
+int vea_unmap_poll(struct vea_space_info *vsi, uint64_t max_blks,
+		   uint64_t *unmapped_blks);
+
+/**
+ * Unmap all the free extents queued for unmap.
+ *
+ * \param vsi     [IN]		In-memory compound index
+ *
+ * \return			Zero on success; Appropriated negative value
+ *				on error
+ */
+int vea_unmap_flush(struct vea_space_info *vsi);
+
+/**
+ * Defragment free space, the free extents cached for small reservations and
+ * the expired recently freed extents are coalesced in the free extent index
+ * to rebuild large contiguous free runs. Extents freed within the migrate
+ * interval stay invisible for allocation. Caller can call it periodically
+ * from a background ULT, which drives the unmap of the queued free extents
+ * as well, see vea_unmap_poll().
+ *
+ * \param vsi     [IN]		In-memory compound index
+ *
+ * \return			Zero on success; Appropriated negative value
+ *				on error
+ */
+int vea_defrag(struct vea_space_info *vsi);
+
 /**
  * Set an arbitrary age to a free extent with specified start offset.
  *
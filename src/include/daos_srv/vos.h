@@ -215,6 +215,26 @@ vos_epoch_aggregate(daos_handle_t coh, daos_unit_oid_t oid,
 		    daos_epoch_range_t *epr, unsigned int *credits,
 		    vos_purge_anchor_t *anchor, bool *finished);
 
+/**
+ * Frees record extents of an object which are fully overwritten at the
+ * purged (aggregated) epoch of the container. This is done in small steps,
+ * so the caller can yield between the calls.
+ *
+ * \param coh	  [IN]		Container open handle
+ * \param oid	  [IN]		Object to compact
+ * \param credits [IN/OUT]	credits for checking extents
+ * \param anchor  [IN/OUT]	anchor returned for preemption.
+ * \param finished
+ *		  [OUT]		flag returned to notify completion
+ *				of compaction to caller.
+ *
+ * \return			Zero on success, negative value if error
+ */
+int
+vos_epoch_compact(daos_handle_t coh, daos_unit_oid_t oid,
+		  unsigned int *credits, vos_purge_anchor_t *anchor,
+		  bool *finished);
+
 /**
  * Discards changes in all epochs with the epoch range \a epr
  * and \a cookie id.
@@ -276,6 +296,24 @@ vos_obj_fetch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	      daos_key_t *dkey, unsigned int iod_nr, daos_iod_t *iods,
 	      daos_sg_list_t *sgls);
 
+/**
+ * Fetch records of multiple dkeys from the specified object. The object is
+ * only looked up and referenced once for the whole batch.
+ *
+ * \param coh	[IN]	Container open handle
+ * \param oid	[IN]	Object ID
+ * \param epoch	[IN]	Epoch for the fetch.
+ * \param dio_nr [IN]	Number of dkey I/O descriptors in \a dios.
+ * \param dios	[IN/OUT]
+ *			Array of dkey I/O descriptors, see vos_obj_fetch()
+ *			for the semantics of iods and sgls of each of them.
+ *
+ * \return		Zero on success, negative value if error
+ */
+int
+vos_obj_fetch_multi(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
+		    unsigned int dio_nr, vos_dkey_io_t *dios);
+
 
 /**
  * Update records for the specfied object.
@@ -309,6 +347,28 @@ vos_obj_update(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	       uuid_t cookie, uint32_t pm_ver, daos_key_t *dkey,
 	       unsigned int iod_nr, daos_iod_t *iods, daos_sg_list_t *sgls);
 
+/**
+ * Update records of multiple dkeys of the specified object. The object is
+ * only referenced once, and all updates are applied within a single PMDK
+ * transaction, so either all of them take effect or none of them does.
+ *
+ * \param coh	[IN]	Container open handle
+ * \param oid	[IN]	object ID
+ * \param epoch	[IN]	Epoch for the update.
+ * \param cookie [IN]	Cookie ID to tag all updates of the batch.
+ * \param pm_ver [IN]   Pool map version for this update.
+ * \param dio_nr [IN]	Number of dkey I/O descriptors in \a dios.
+ * \param dios	[IN/OUT]
+ *			Array of dkey I/O descriptors, see vos_obj_update()
+ *			for the semantics of iods and sgls of each of them.
+ *
+ * \return		Zero on success, negative value if error
+ */
+int
+vos_obj_update_multi(daos_handle_t coh, daos_unit_oid_t oid,
+		     daos_epoch_t epoch, uuid_t cookie, uint32_t pm_ver,
+		     unsigned int dio_nr, vos_dkey_io_t *dios);
+
 /**
  * Punch an object, or punch a dkey, or punch an array of akeys under a akey.
  *
@@ -438,6 +498,19 @@ vos_obj_zc_update_end(daos_handle_t ioh, uuid_t cookie, uint32_t pm_ver,
 int
 vos_obj_zc_sgl_at(daos_handle_t ioh, unsigned int idx, daos_sg_list_t **sgl_pp);
 
+/**
+ * Persist a range of the zero-copy buffers of an update. It can be called
+ * for each piece of the buffers once its data has arrived, so persistence
+ * can overlap with transfer of the remaining data.
+ *
+ * \param ioh	[IN]	The ZC I/O handle of an update.
+ * \param addr	[IN]	Start address of the range, it must be within a
+ *			buffer returned by \a vos_obj_zc_sgl_at.
+ * \param size	[IN]	Size of the range.
+ */
+void
+vos_obj_zc_persist(daos_handle_t ioh, void *addr, daos_size_t size);
+
 /**
  * VOS iterator APIs
  */
@@ -66,6 +66,21 @@ typedef struct {
 	char			omd_data[64];
 } vos_obj_md_t;
 
+/**
+ * I/O descriptors of a single dkey, used by the batched update/fetch APIs
+ * vos_obj_update_multi() and vos_obj_fetch_multi().
+ */
+typedef struct {
+	/** distribution key */
+	daos_key_t		 dio_dkey;
+	/** number of I/O descriptors in \a dio_iods */
+	unsigned int		 dio_iod_nr;
+	/** array of I/O descriptors under \a dio_dkey */
+	daos_iod_t		*dio_iods;
+	/** scatter/gather lists of \a dio_iods, one per descriptor */
+	daos_sg_list_t		*dio_sgls;
+} vos_dkey_io_t;
+
 /**
  * VOS iterator types
  */
@@ -115,6 +130,10 @@ typedef struct {
 	daos_hash_out_t		pa_recx_max;
 	/** Save OID for aggregation optimization */
 	daos_unit_oid_t		pa_oid;
+	/** Number of records checked, for progress reporting */
+	uint64_t		pa_nr_scanned;
+	/** Number of records aggregated (deleted) */
+	uint64_t		pa_nr_purged;
 } vos_purge_anchor_t;
 
 /**
@@ -73,6 +73,11 @@ typedef struct {
 	unsigned int	 cs_type;
 	unsigned short	 cs_len;
 	unsigned short	 cs_buf_len;
+	/**
+	 * \a cs_csum is an array of checksums, one for every \a cs_chunk_size
+	 * bytes of the data, or a single checksum if it's zero.
+	 */
+	unsigned int	 cs_chunk_size;
 	void		*cs_csum;
 } daos_csum_buf_t;
 
@@ -81,6 +86,7 @@ daos_csum_set(daos_csum_buf_t *csum, void *buf, uint16_t size)
 {
 	csum->cs_csum = buf;
 	csum->cs_len = csum->cs_buf_len = size;
+	csum->cs_chunk_size = 0;
 }
 
 /** Generic hash format */
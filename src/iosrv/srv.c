@@ -70,8 +70,258 @@ struct dss_xstream_data {
 
 static struct dss_xstream_data	xstream_data;
 
+/**
+ * Work unit of the ES pools, it records the time it was pushed into the
+ * pool, so the scheduler can account the queueing delay of every ULT.
+ */
+struct dss_pool_unit {
+	d_list_t		 pu_link;
+	ABT_unit_type		 pu_type;
+	union {
+		ABT_thread	 pu_thread;
+		ABT_task	 pu_task;
+	};
+	/** time it was pushed, a yielded ULT is stamped again */
+	double			 pu_push_time;
+	bool			 pu_in_pool;
+};
+
+/** FIFO of the ES pools, the shared pool is pushed by other xstreams */
+struct dss_pool_data {
+	pthread_spinlock_t	 pd_lock;
+	d_list_t		 pd_units;
+	size_t			 pd_size;
+};
+
+static ABT_unit_type
+dss_pool_unit_get_type(ABT_unit unit)
+{
+	return ((struct dss_pool_unit *)unit)->pu_type;
+}
+
+static ABT_thread
+dss_pool_unit_get_thread(ABT_unit unit)
+{
+	struct dss_pool_unit *pu = (struct dss_pool_unit *)unit;
+
+	return pu->pu_type == ABT_UNIT_TYPE_THREAD ? pu->pu_thread :
+						     ABT_THREAD_NULL;
+}
+
+static ABT_task
+dss_pool_unit_get_task(ABT_unit unit)
+{
+	struct dss_pool_unit *pu = (struct dss_pool_unit *)unit;
+
+	return pu->pu_type == ABT_UNIT_TYPE_TASK ? pu->pu_task :
+						   ABT_TASK_NULL;
+}
+
+static ABT_bool
+dss_pool_unit_is_in_pool(ABT_unit unit)
+{
+	return ((struct dss_pool_unit *)unit)->pu_in_pool ? ABT_TRUE :
+							      ABT_FALSE;
+}
+
+static ABT_unit
+dss_pool_unit_create_from_thread(ABT_thread thread)
+{
+	struct dss_pool_unit *pu;
+
+	D_ALLOC_PTR(pu);
+	if (pu == NULL)
+		return ABT_UNIT_NULL;
+
+	D_INIT_LIST_HEAD(&pu->pu_link);
+	pu->pu_type = ABT_UNIT_TYPE_THREAD;
+	pu->pu_thread = thread;
+	return (ABT_unit)pu;
+}
+
+static ABT_unit
+dss_pool_unit_create_from_task(ABT_task task)
+{
+	struct dss_pool_unit *pu;
+
+	D_ALLOC_PTR(pu);
+	if (pu == NULL)
+		return ABT_UNIT_NULL;
+
+	D_INIT_LIST_HEAD(&pu->pu_link);
+	pu->pu_type = ABT_UNIT_TYPE_TASK;
+	pu->pu_task = task;
+	return (ABT_unit)pu;
+}
+
+static void
+dss_pool_unit_free(ABT_unit *unit)
+{
+	struct dss_pool_unit *pu = (struct dss_pool_unit *)*unit;
+
+	D_ASSERT(!pu->pu_in_pool);
+	D_FREE_PTR(pu);
+	*unit = ABT_UNIT_NULL;
+}
+
+static int
+dss_pool_init(ABT_pool pool, ABT_pool_config config)
+{
+	struct dss_pool_data	*pd;
+	int			 rc;
+
+	D_ALLOC_PTR(pd);
+	if (pd == NULL)
+		return ABT_ERR_MEM;
+
+	rc = pthread_spin_init(&pd->pd_lock, PTHREAD_PROCESS_PRIVATE);
+	if (rc != 0) {
+		D_FREE_PTR(pd);
+		return ABT_ERR_POOL;
+	}
+	D_INIT_LIST_HEAD(&pd->pd_units);
+
+	return ABT_pool_set_data(pool, pd);
+}
+
+static size_t
+dss_pool_get_size(ABT_pool pool)
+{
+	struct dss_pool_data *pd;
+
+	ABT_pool_get_data(pool, (void **)&pd);
+	return pd->pd_size;
+}
+
+/* The wait of a ULT starts from here, it's stamped at enqueue */
+static void
+dss_pool_push(ABT_pool pool, ABT_unit unit)
+{
+	struct dss_pool_unit	*pu = (struct dss_pool_unit *)unit;
+	struct dss_pool_data	*pd;
+
+	ABT_pool_get_data(pool, (void **)&pd);
+	pu->pu_push_time = ABT_get_wtime();
+
+	pthread_spin_lock(&pd->pd_lock);
+	d_list_add_tail(&pu->pu_link, &pd->pd_units);
+	pu->pu_in_pool = true;
+	pd->pd_size++;
+	pthread_spin_unlock(&pd->pd_lock);
+}
+
+static ABT_unit
+dss_pool_pop(ABT_pool pool)
+{
+	struct dss_pool_unit	*pu = NULL;
+	struct dss_pool_data	*pd;
+
+	ABT_pool_get_data(pool, (void **)&pd);
+
+	pthread_spin_lock(&pd->pd_lock);
+	if (!d_list_empty(&pd->pd_units)) {
+		pu = d_list_entry(pd->pd_units.next, struct dss_pool_unit,
+				  pu_link);
+		d_list_del_init(&pu->pu_link);
+		pu->pu_in_pool = false;
+		pd->pd_size--;
+	}
+	pthread_spin_unlock(&pd->pd_lock);
+
+	return pu == NULL ? ABT_UNIT_NULL : (ABT_unit)pu;
+}
+
+static int
+dss_pool_remove(ABT_pool pool, ABT_unit unit)
+{
+	struct dss_pool_unit	*pu = (struct dss_pool_unit *)unit;
+	struct dss_pool_data	*pd;
+	int			 rc = ABT_SUCCESS;
+
+	ABT_pool_get_data(pool, (void **)&pd);
+
+	pthread_spin_lock(&pd->pd_lock);
+	if (pu->pu_in_pool) {
+		d_list_del_init(&pu->pu_link);
+		pu->pu_in_pool = false;
+		pd->pd_size--;
+	} else {
+		rc = ABT_ERR_POOL;
+	}
+	pthread_spin_unlock(&pd->pd_lock);
+
+	return rc;
+}
+
+static int
+dss_pool_free(ABT_pool pool)
+{
+	struct dss_pool_data *pd;
+
+	ABT_pool_get_data(pool, (void **)&pd);
+	D_ASSERT(d_list_empty(&pd->pd_units));
+	pthread_spin_destroy(&pd->pd_lock);
+	D_FREE_PTR(pd);
+
+	return ABT_SUCCESS;
+}
+
+/** Create a FIFO ES pool which stamps the enqueue time of its units */
+static int
+dss_pool_create(ABT_pool_access access, ABT_pool *pool)
+{
+	ABT_pool_def	pool_def = {
+		.access			= access,
+		.u_get_type		= dss_pool_unit_get_type,
+		.u_get_thread		= dss_pool_unit_get_thread,
+		.u_get_task		= dss_pool_unit_get_task,
+		.u_is_in_pool		= dss_pool_unit_is_in_pool,
+		.u_create_from_thread	= dss_pool_unit_create_from_thread,
+		.u_create_from_task	= dss_pool_unit_create_from_task,
+		.u_free			= dss_pool_unit_free,
+		.p_init			= dss_pool_init,
+		.p_get_size		= dss_pool_get_size,
+		.p_push			= dss_pool_push,
+		.p_pop			= dss_pool_pop,
+		.p_remove		= dss_pool_remove,
+		.p_free			= dss_pool_free,
+	};
+
+	return dss_abterr2der(ABT_pool_create(&pool_def, ABT_POOL_CONFIG_NULL,
+					      pool));
+}
+
+/** Per-class scheduling statistics of an xstream */
+struct dss_sched_stats {
+	/** number of ULT runs */
+	uint64_t	ss_runs;
+	/** number of runnable ULTs */
+	uint64_t	ss_qdepth;
+	/** max number of runnable ULTs */
+	uint64_t	ss_qdepth_max;
+	/** total time (usec) ULTs waited in the pool before being run */
+	uint64_t	ss_wait_us;
+	/** max time (usec) a ULT waited in the pool before being run */
+	uint64_t	ss_wait_max_us;
+	/** total time (usec) spent on running ULTs */
+	uint64_t	ss_run_us;
+};
+
+/**
+ * ULTs are scheduled by smooth weighted round-robin across the ES pools,
+ * each pool is a scheduling class. Only classes with runnable ULTs take
+ * part in a round, so the scheduler is work-conserving and an idle class
+ * can't bank credits.
+ */
+struct sched_class {
+	/** current credit of the class */
+	int64_t			sc_credit;
+	struct dss_sched_stats	sc_stats;
+};
+
 struct sched_data {
-    uint32_t event_freq;
+	uint32_t		event_freq;
+	struct sched_class	sd_classes[DSS_POOL_CNT];
 };
 
 static int
@@ -94,66 +344,89 @@ dss_sched_init(ABT_sched sched, ABT_sched_config config)
 	return ret;
 }
 
-static ABT_unit
-normal_unit_pop(ABT_pool *pools, ABT_pool *pool)
+/**
+ * Weights of scheduling classes, rebuild takes dss_rebuild_res_percentage,
+ * and the rest is shared by I/O and other requests. Every class weighs at
+ * least 1, so none of them can be starved by a large rebuild percentage.
+ */
+static void
+dss_sched_weights(unsigned int *weights)
 {
-	ABT_unit unit;
+	unsigned int	rebuild = min(dss_rebuild_res_percentage, 100U);
+	unsigned int	share;
 
-	/* Let's pop I/O request ULT first */
-	ABT_pool_pop(pools[DSS_POOL_PRIV], &unit);
-	if (unit != ABT_UNIT_NULL) {
-		*pool = pools[DSS_POOL_PRIV];
-		return unit;
-	}
-
-	/* Other request and ollective ULT or created ULT */
-	ABT_pool_pop(pools[DSS_POOL_SHARE], &unit);
-	if (unit != ABT_UNIT_NULL) {
-		*pool = pools[DSS_POOL_SHARE];
-		return unit;
-	}
-
-	return ABT_UNIT_NULL;
+	share = (100 - rebuild) * DSS_SCHED_SHARE_PERCENTAGE / 100;
+	weights[DSS_POOL_REBUILD] = max(rebuild, 1U);
+	weights[DSS_POOL_SHARE]	  = max(share, 1U);
+	weights[DSS_POOL_PRIV]	  = max(100 - rebuild - share, 1U);
 }
 
+/**
+ * Choose ULT from the pools by the weights of their classes, the class
+ * is returned by \a cls.
+ */
 static ABT_unit
-rebuild_unit_pop(ABT_pool *pools, ABT_pool *pool)
+dss_sched_unit_pop(struct sched_data *data, ABT_pool *pools, ABT_pool *pool,
+		   int *cls)
 {
-	ABT_unit unit;
+	struct sched_class	*sc;
+	struct dss_pool_unit	*pu;
+	unsigned int		 weights[DSS_POOL_CNT];
+	ABT_unit		 unit;
+	size_t			 size;
+	int64_t			 total = 0;
+	int64_t			 best_credit = 0;
+	double			 now;
+	uint64_t		 wait;
+	int			 best = -1;
+	int			 i;
+
+	dss_sched_weights(weights);
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		sc = &data->sd_classes[i];
 
-	ABT_pool_pop(pools[DSS_POOL_REBUILD], &unit);
-	if (unit != ABT_UNIT_NULL) {
-		*pool = pools[DSS_POOL_REBUILD];
-		return unit;
-	}
+		if (ABT_pool_get_size(pools[i], &size) != ABT_SUCCESS)
+			size = 0;
 
-	return ABT_UNIT_NULL;
-}
+		sc->sc_stats.ss_qdepth = size;
+		if (size == 0) {
+			sc->sc_credit = 0;
+			continue;
+		}
 
-/**
- * Choose ULT from the pool. Note: the rebuild ULT will be
- * be choosen by dss_rebuild_res_percentage.
- *
- * XXX we may change the sequence later once we have more cases.
- */
-static ABT_unit
-dss_sched_unit_pop(ABT_pool *pools, ABT_pool *pool)
-{
-	size_t	 rebuild_cnt;
-	int	 rc;
+		if (size > sc->sc_stats.ss_qdepth_max)
+			sc->sc_stats.ss_qdepth_max = size;
 
-	rc = ABT_pool_get_total_size(pools[DSS_POOL_REBUILD],
-				     &rebuild_cnt);
-	if (rc != ABT_SUCCESS)
+		sc->sc_credit += weights[i];
+		total += weights[i];
+		if (best < 0 || sc->sc_credit > best_credit) {
+			best_credit = sc->sc_credit;
+			best = i;
+		}
+	}
+
+	if (best < 0)
 		return ABT_UNIT_NULL;
 
-	if (rebuild_cnt == 0 ||
-	    rand() % 100 > dss_rebuild_res_percentage)
-		return normal_unit_pop(pools, pool);
-	else
-		return rebuild_unit_pop(pools, pool);
+	sc = &data->sd_classes[best];
+	sc->sc_credit -= total;
 
-	return ABT_UNIT_NULL;
+	ABT_pool_pop(pools[best], &unit);
+	if (unit == ABT_UNIT_NULL)
+		return ABT_UNIT_NULL;
+
+	/* ES pools are created by dss_pool_create() */
+	pu = (struct dss_pool_unit *)unit;
+	now = ABT_get_wtime();
+	wait = now > pu->pu_push_time ? (now - pu->pu_push_time) * 1000000 : 0;
+	sc->sc_stats.ss_wait_us += wait;
+	if (wait > sc->sc_stats.ss_wait_max_us)
+		sc->sc_stats.ss_wait_max_us = wait;
+	sc->sc_stats.ss_runs++;
+
+	*pool = pools[best];
+	*cls = best;
+	return unit;
 }
 
 static void
@@ -164,6 +437,8 @@ dss_sched_run(ABT_sched sched)
 	ABT_pool		pools[DSS_POOL_CNT];
 	ABT_pool		pool = ABT_POOL_NULL;
 	ABT_unit		unit;
+	double			start;
+	int			cls;
 	int			ret;
 
 	ABT_sched_get_data(sched, (void **)&p_data);
@@ -176,9 +451,13 @@ dss_sched_run(ABT_sched sched)
 
 	while (1) {
 		/* Execute one work unit from the scheduler's pool */
-		unit = dss_sched_unit_pop(pools, &pool);
-		if (unit != ABT_UNIT_NULL && pool != ABT_UNIT_NULL)
+		unit = dss_sched_unit_pop(p_data, pools, &pool, &cls);
+		if (unit != ABT_UNIT_NULL && pool != ABT_UNIT_NULL) {
+			start = ABT_get_wtime();
 			ABT_xstream_run_unit(unit, pool);
+			p_data->sd_classes[cls].sc_stats.ss_run_us +=
+				(ABT_get_wtime() - start) * 1000000;
+		}
 
 		if (++work_count >= p_data->event_freq) {
 			ABT_xstream_check_events(sched);
@@ -449,9 +728,37 @@ err_free:
 	return NULL;
 }
 
+/** Log the scheduling statistics of a stopped xstream */
+static void
+dss_sched_stats_dump(struct dss_xstream *dx)
+{
+	struct sched_data	*data;
+	struct dss_sched_stats	*stats;
+	int			 i;
+
+	if (ABT_sched_get_data(dx->dx_sched, (void **)&data) != ABT_SUCCESS)
+		return;
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		stats = &data->sd_classes[i].sc_stats;
+		D_DEBUG(DB_TRACE, "xstream %d class %d: runs "DF_U64", qdepth "
+			"max "DF_U64", wait "DF_U64"/"DF_U64" us (total/max), "
+			"run "DF_U64" us\n", dx->dx_idx, i, stats->ss_runs,
+			stats->ss_qdepth_max, stats->ss_wait_us,
+			stats->ss_wait_max_us, stats->ss_run_us);
+	}
+}
+
 static inline void
 dss_xstream_free(struct dss_xstream *dx)
 {
+	int	i;
+
+	/* ES pools aren't automatic, they are freed after the scheduler */
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (dx->dx_pools[i] != ABT_POOL_NULL)
+			ABT_pool_free(&dx->dx_pools[i]);
+	}
 	hwloc_bitmap_free(dx->dx_cpuset);
 	D_FREE_PTR(dx);
 }
@@ -484,10 +791,9 @@ dss_start_one_xstream(hwloc_cpuset_t cpus, int idx)
 		access = i == DSS_POOL_SHARE ?
 			 ABT_POOL_ACCESS_MPSC : ABT_POOL_ACCESS_PRIV;
 
-		rc = ABT_pool_create_basic(ABT_POOL_FIFO, access, ABT_TRUE,
-					   &dx->dx_pools[i]);
-		if (rc != ABT_SUCCESS)
-			D_GOTO(out_pool, rc = dss_abterr2der(rc));
+		rc = dss_pool_create(access, &dx->dx_pools[i]);
+		if (rc != 0)
+			D_GOTO(out_pool, rc);
 	}
 
 	rc = dss_sched_create(dx->dx_pools, DSS_POOL_CNT, &dx->dx_sched);
@@ -535,10 +841,6 @@ out_xstream:
 out_sched:
 	ABT_sched_free(&dx->dx_sched);
 out_pool:
-	for (i = 0; i < DSS_POOL_CNT; i++) {
-		if (dx->dx_pools[i] != ABT_POOL_NULL)
-			ABT_pool_free(&dx->dx_pools[i]);
-	}
 	dss_xstream_free(dx);
 	return rc;
 }
@@ -570,6 +872,7 @@ dss_xstreams_fini(bool force)
 	/** housekeeping ... */
 	d_list_for_each_entry_safe(dx, tmp, &xstream_data.xd_list, dx_list) {
 		d_list_del_init(&dx->dx_list);
+		dss_sched_stats_dump(dx);
 		ABT_sched_free(&dx->dx_sched);
 		dss_xstream_free(dx);
 	}
@@ -1092,11 +1395,42 @@ dss_collective_internal(int (*func)(void *), void *arg, bool thread)
 	return rc;
 }
 
-/** TODO: use daos checksum library to offload checksum calculation */
+/** Calculate checksum of the data by daos checksum library */
 static int
 compute_checksum_ult(void *args)
 {
-	return 0;
+	struct dss_acc_csum_args	*ca = args;
+	daos_csum_buf_t			 cbuf;
+	int				 rc;
+
+	if (ca == NULL || ca->dca_csum == NULL || ca->dca_sgl == NULL ||
+	    ca->dca_csums == NULL || ca->dca_csum_nr == 0)
+		return -DER_INVAL;
+
+	if (ca->dca_chunk_size != 0) {
+		rc = daos_csum_compute_chunks(ca->dca_csum, ca->dca_sgl,
+					      ca->dca_chunk_size,
+					      ca->dca_csums, ca->dca_csum_nr);
+		return rc < 0 ? rc : 0;
+	}
+
+	rc = daos_csum_reset(ca->dca_csum);
+	if (rc != 0)
+		return rc;
+
+	rc = daos_csum_compute(ca->dca_csum, ca->dca_sgl);
+	if (rc != 0)
+		return rc;
+
+	daos_csum_set(&cbuf, ca->dca_csums[0].cs_csum,
+		      daos_csum_get_size(ca->dca_csum));
+	if (ca->dca_csums[0].cs_buf_len < cbuf.cs_buf_len)
+		return -DER_INVAL;
+
+	rc = daos_csum_get(ca->dca_csum, &cbuf);
+	if (rc == 0)
+		ca->dca_csums[0].cs_len = cbuf.cs_len;
+	return rc;
 }
 
 /** TODO: use OFI calls to calculate checksum on FPGA */
@@ -0,0 +1,367 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Coalescing of small updates on client.
+ *
+ * Small updates of the same container and epoch to the same target are
+ * queued in a batch instead of being sent right away. The batch is sent as
+ * one DAOS_OBJ_RPC_UPDATE_MULTI once it is full, or when it has waited for
+ * cli_coalesce_delay microseconds, then the shard task of each update is
+ * completed with its own status. A synchronous update is never delayed, it
+ * is sent at once with the updates queued before it.
+ */
+#define D_LOGFAC	DD_FAC(object)
+
+#include <daos/object.h>
+#include <daos/pool.h>
+#include <daos/rpc.h>
+#include "obj_rpc.h"
+#include "obj_internal.h"
+
+/** a queued shard update */
+struct obj_coalesce_ent {
+	d_list_t		 ce_link;
+	tse_task_t		*ce_task;
+	struct dc_obj_shard	*ce_shard;
+	struct dc_pool		*ce_pool;
+	daos_key_t		*ce_dkey;
+	daos_iod_t		*ce_iods;
+	daos_sg_list_t		*ce_sgls;
+	unsigned int		 ce_nr;
+	unsigned int		*ce_map_ver;
+};
+
+/** updates to be sent by the same RPC */
+struct obj_coalesce_batch {
+	/** link chain on coalesce_batches */
+	d_list_t		 cb_link;
+	/** queued updates, in the order of submission */
+	d_list_t		 cb_ents;
+	crt_context_t		 cb_ctx;
+	crt_endpoint_t		 cb_ep;
+	uuid_t			 cb_co_hdl;
+	uuid_t			 cb_co_uuid;
+	daos_epoch_t		 cb_epoch;
+	uint32_t		 cb_map_ver;
+	unsigned int		 cb_nr;
+	daos_size_t		 cb_size;
+	/** time in microseconds to send the batch */
+	uint64_t		 cb_expire;
+	/** updates packed in the RPC */
+	struct obj_update_ent	*cb_updates;
+};
+
+unsigned int		cli_coalesce_delay;
+
+static D_LIST_HEAD(coalesce_batches);
+static pthread_mutex_t	coalesce_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+coalesce_batch_complete(struct obj_coalesce_batch *batch, int rc,
+			int32_t *rets, uint32_t map_ver)
+{
+	struct obj_coalesce_ent	*ent;
+	struct obj_coalesce_ent	*tmp;
+	int			 i = 0;
+
+	d_list_for_each_entry_safe(ent, tmp, &batch->cb_ents, ce_link) {
+		int	ret = rc;
+
+		if (ret == 0) {
+			ret = rets[i];
+			*ent->ce_map_ver = map_ver;
+		}
+		i++;
+
+		d_list_del(&ent->ce_link);
+		obj_shard_decref(ent->ce_shard);
+		dc_pool_put(ent->ce_pool);
+		tse_task_complete(ent->ce_task, ret);
+		D_FREE_PTR(ent);
+	}
+
+	if (batch->cb_updates != NULL)
+		D_FREE(batch->cb_updates);
+	D_FREE_PTR(batch);
+}
+
+static void
+coalesce_update_cb(const struct crt_cb_info *cb_info)
+{
+	struct obj_coalesce_batch	*batch = cb_info->cci_arg;
+	struct obj_update_multi_out	*oumo;
+	uint32_t			 map_ver = 0;
+	int32_t				*rets = NULL;
+	int				 rc = cb_info->cci_rc;
+
+	if (rc != 0) {
+		D_ERROR("RPC %d failed: %d\n", DAOS_OBJ_RPC_UPDATE_MULTI, rc);
+		D_GOTO(out, rc);
+	}
+
+	rc = obj_reply_get_status(cb_info->cci_rpc);
+	if (rc != 0) {
+		D_ERROR("rpc %p RPC %d failed: %d\n", cb_info->cci_rpc,
+			DAOS_OBJ_RPC_UPDATE_MULTI, rc);
+		D_GOTO(out, rc);
+	}
+
+	map_ver = obj_reply_map_version_get(cb_info->cci_rpc);
+	oumo = crt_reply_get(cb_info->cci_rpc);
+	if (oumo->oum_rets.ca_count != batch->cb_nr) {
+		D_ERROR("out:%u != in:%u\n",
+			(unsigned)oumo->oum_rets.ca_count, batch->cb_nr);
+		D_GOTO(out, rc = -DER_PROTO);
+	}
+	rets = oumo->oum_rets.ca_arrays;
+out:
+	coalesce_batch_complete(batch, rc, rets, map_ver);
+}
+
+/** send a batch which has been removed from coalesce_batches */
+static void
+coalesce_batch_send(struct obj_coalesce_batch *batch)
+{
+	struct obj_update_multi_in	*oumi;
+	struct obj_coalesce_ent		*ent;
+	crt_rpc_t			*req;
+	int				 i = 0;
+	int				 rc;
+
+	D_DEBUG(DB_IO, "send %u updates ("DF_U64" bytes) to rank %d tag %d\n",
+		batch->cb_nr, batch->cb_size, batch->cb_ep.ep_rank,
+		batch->cb_ep.ep_tag);
+
+	D_ALLOC(batch->cb_updates, batch->cb_nr * sizeof(*batch->cb_updates));
+	if (batch->cb_updates == NULL)
+		D_GOTO(failed, rc = -DER_NOMEM);
+
+	d_list_for_each_entry(ent, &batch->cb_ents, ce_link) {
+		struct obj_update_ent *update = &batch->cb_updates[i++];
+
+		update->oue_oid  = ent->ce_shard->do_id;
+		update->oue_dkey = *ent->ce_dkey;
+		update->oue_nr	 = ent->ce_nr;
+		update->oue_iods = ent->ce_iods;
+		update->oue_sgls = ent->ce_sgls;
+	}
+
+	rc = obj_req_create(batch->cb_ctx, &batch->cb_ep,
+			    DAOS_OBJ_RPC_UPDATE_MULTI, &req);
+	if (rc != 0)
+		D_GOTO(failed, rc);
+
+	oumi = crt_req_get(req);
+	D_ASSERT(oumi != NULL);
+
+	uuid_copy(oumi->oum_co_hdl, batch->cb_co_hdl);
+	uuid_copy(oumi->oum_co_uuid, batch->cb_co_uuid);
+	oumi->oum_epoch = batch->cb_epoch;
+	oumi->oum_map_ver = batch->cb_map_ver;
+	oumi->oum_ents.ca_count = batch->cb_nr;
+	oumi->oum_ents.ca_arrays = batch->cb_updates;
+
+	/* the batch is completed by the callback even if sending failed */
+	crt_req_send(req, coalesce_update_cb, batch);
+	return;
+failed:
+	coalesce_batch_complete(batch, rc, NULL, 0);
+}
+
+static struct obj_coalesce_batch *
+coalesce_batch_find(crt_context_t ctx, crt_endpoint_t *tgt_ep, uuid_t co_hdl,
+		    daos_epoch_t epoch, uint32_t map_ver)
+{
+	struct obj_coalesce_batch *batch;
+
+	d_list_for_each_entry(batch, &coalesce_batches, cb_link) {
+		if (batch->cb_ctx == ctx &&
+		    batch->cb_ep.ep_grp == tgt_ep->ep_grp &&
+		    batch->cb_ep.ep_rank == tgt_ep->ep_rank &&
+		    batch->cb_ep.ep_tag == tgt_ep->ep_tag &&
+		    batch->cb_epoch == epoch &&
+		    batch->cb_map_ver == map_ver &&
+		    uuid_compare(batch->cb_co_hdl, co_hdl) == 0)
+			return batch;
+	}
+	return NULL;
+}
+
+/**
+ * Queue a small update of \a shard in the batch of its target, the update
+ * is not coalesced if it's too large to be sent inline. References of
+ * \a shard and \a pool are taken over if the update has been queued, and
+ * \a task is completed after the batch has been replied. The batch is sent
+ * right away if \a sync is true, because the caller is waiting for it.
+ *
+ * \return	true if the update has been queued, otherwise the caller
+ *		should send the update by itself.
+ */
+bool
+obj_coalesce_update(struct dc_obj_shard *shard, struct dc_pool *pool,
+		    crt_endpoint_t *tgt_ep, uuid_t co_hdl, uuid_t co_uuid,
+		    daos_epoch_t epoch, daos_key_t *dkey, unsigned int nr,
+		    daos_iod_t *iods, daos_sg_list_t *sgls,
+		    unsigned int *map_ver, bool sync, tse_task_t *task)
+{
+	struct obj_coalesce_batch	*batch;
+	struct obj_coalesce_ent		*ent;
+	crt_context_t			 ctx = daos_task2ctx(task);
+	daos_size_t			 size;
+	uint64_t			 delay = cli_coalesce_delay;
+
+	if (delay == 0 && DAOS_FAIL_CHECK(DAOS_OBJ_COALESCE))
+		delay = daos_fail_value_get();
+
+	if (delay == 0 || sgls == NULL ||
+	    daos_obj_id2class(shard->do_id.id_pub) == DAOS_OC_ECHO_RW)
+		return false;
+
+	size = daos_iods_len(iods, nr);
+	if (size == -1 || size >= cli_inline_size) {
+		/* flush the small updates queued before this one, so updates
+		 * to the target are still sent in order.
+		 */
+		D_MUTEX_LOCK(&coalesce_lock);
+		batch = coalesce_batch_find(ctx, tgt_ep, co_hdl, epoch,
+					    *map_ver);
+		if (batch != NULL)
+			d_list_del(&batch->cb_link);
+		D_MUTEX_UNLOCK(&coalesce_lock);
+
+		if (batch != NULL)
+			coalesce_batch_send(batch);
+		return false;
+	}
+
+	D_ALLOC_PTR(ent);
+	if (ent == NULL)
+		return false;
+
+	ent->ce_task	= task;
+	ent->ce_shard	= shard;
+	ent->ce_pool	= pool;
+	ent->ce_dkey	= dkey;
+	ent->ce_iods	= iods;
+	ent->ce_sgls	= sgls;
+	ent->ce_nr	= nr;
+	ent->ce_map_ver	= map_ver;
+
+	D_MUTEX_LOCK(&coalesce_lock);
+	batch = coalesce_batch_find(ctx, tgt_ep, co_hdl, epoch, *map_ver);
+	if (batch == NULL) {
+		D_ALLOC_PTR(batch);
+		if (batch == NULL) {
+			D_MUTEX_UNLOCK(&coalesce_lock);
+			D_FREE_PTR(ent);
+			return false;
+		}
+
+		D_INIT_LIST_HEAD(&batch->cb_ents);
+		batch->cb_ctx	  = ctx;
+		batch->cb_ep	  = *tgt_ep;
+		batch->cb_epoch	  = epoch;
+		batch->cb_map_ver = *map_ver;
+		batch->cb_expire  = d_timeus_secdiff(0) + delay;
+		uuid_copy(batch->cb_co_hdl, co_hdl);
+		uuid_copy(batch->cb_co_uuid, co_uuid);
+		d_list_add_tail(&batch->cb_link, &coalesce_batches);
+	}
+
+	d_list_add_tail(&ent->ce_link, &batch->cb_ents);
+	batch->cb_nr++;
+	batch->cb_size += size;
+	if (!sync && batch->cb_nr < OBJ_COALESCE_NR &&
+	    batch->cb_size < OBJ_COALESCE_SIZE)
+		batch = NULL; /* keep waiting */
+	else
+		d_list_del(&batch->cb_link);
+	D_MUTEX_UNLOCK(&coalesce_lock);
+
+	if (batch != NULL)
+		coalesce_batch_send(batch);
+	return true;
+}
+
+/**
+ * Move the batches of \a ctx to \a list, or of all contexts if \a ctx is
+ * NULL. Only the expired ones are moved if \a now isn't 0.
+ */
+static void
+coalesce_batches_take(crt_context_t ctx, uint64_t now, d_list_t *list)
+{
+	struct obj_coalesce_batch	*batch;
+	struct obj_coalesce_batch	*tmp;
+
+	D_MUTEX_LOCK(&coalesce_lock);
+	d_list_for_each_entry_safe(batch, tmp, &coalesce_batches, cb_link) {
+		if (ctx != NULL && batch->cb_ctx != ctx)
+			continue;
+		if (now == 0 || batch->cb_expire <= now)
+			d_list_move_tail(&batch->cb_link, list);
+	}
+	D_MUTEX_UNLOCK(&coalesce_lock);
+}
+
+void
+dc_obj_progress(crt_context_t ctx)
+{
+	struct obj_coalesce_batch	*batch;
+	struct obj_coalesce_batch	*tmp;
+	d_list_t			 expired;
+
+	/* NB: racy check without lock, a batch queued by another thread
+	 * will be sent by the next progress.
+	 */
+	if (d_list_empty(&coalesce_batches))
+		return;
+
+	/* batches are only sent on the context they were queued for, which
+	 * is the one progressed by the caller.
+	 */
+	D_INIT_LIST_HEAD(&expired);
+	coalesce_batches_take(ctx, d_timeus_secdiff(0), &expired);
+	d_list_for_each_entry_safe(batch, tmp, &expired, cb_link) {
+		d_list_del(&batch->cb_link);
+		coalesce_batch_send(batch);
+	}
+}
+
+/**
+ * Abort the queued updates on finalization, network context has gone so
+ * they can't be sent.
+ */
+void
+obj_coalesce_fini(void)
+{
+	struct obj_coalesce_batch	*batch;
+	struct obj_coalesce_batch	*tmp;
+	d_list_t			 list;
+
+	D_INIT_LIST_HEAD(&list);
+	coalesce_batches_take(NULL, 0, &list);
+	d_list_for_each_entry_safe(batch, tmp, &list, cb_link) {
+		d_list_del(&batch->cb_link);
+		coalesce_batch_complete(batch, -DER_CANCELED, NULL, 0);
+	}
+}
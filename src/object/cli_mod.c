@@ -27,12 +27,43 @@
 
 #include <pthread.h>
 #include <daos/common.h>
+#include <daos/checksum.h>
 #include <daos/rpc.h>
 #include <daos_types.h>
 #include "obj_rpc.h"
 #include "obj_internal.h"
 
 bool	cli_bypass_rpc;
+unsigned int	cli_csum_type;
+unsigned int	cli_csum_chunk;
+unsigned int	cli_inline_size = OBJ_BULK_LIMIT;
+struct obj_bulk_cache	*cli_bulk_cache;
+
+static void
+obj_csum_init(void)
+{
+	unsigned int	 type;
+	char		*env;
+
+	env = getenv(OBJ_CSUM_ENV);
+	if (env == NULL)
+		return;
+
+	type = daos_csum_name2type(env);
+	if (type >= DAOS_CS_MAX) {
+		D_ERROR("Invalid checksum %s, checksum is disabled\n", env);
+		return;
+	}
+	cli_csum_type = type;
+
+	cli_csum_chunk = OBJ_CSUM_CHUNK_DEF;
+	env = getenv(OBJ_CSUM_CHUNK_ENV);
+	if (env != NULL && atoi(env) > 0)
+		cli_csum_chunk = atoi(env);
+
+	D_DEBUG(DB_IO, "Checksum %s, chunk size %u\n",
+		daos_csum_type2name(cli_csum_type), cli_csum_chunk);
+}
 
 /**
  * Initialize object interface
@@ -48,8 +79,35 @@ dc_obj_init(void)
 		D_DEBUG(DB_IO, "All client I/O RPCs will be dropped\n");
 		cli_bypass_rpc = true;
 	}
+	obj_csum_init();
+
+	env = getenv(OBJ_INLINE_ENV);
+	if (env != NULL && atoi(env) >= 0) {
+		cli_inline_size = min(atoi(env), OBJ_INLINE_MAX);
+		D_DEBUG(DB_IO, "Max inline I/O size %u\n", cli_inline_size);
+	}
+
+	env = getenv(OBJ_COALESCE_ENV);
+	if (env != NULL && atoi(env) > 0) {
+		cli_coalesce_delay = atoi(env);
+		D_DEBUG(DB_IO, "Small updates are coalesced for %u us\n",
+			cli_coalesce_delay);
+	}
+
+	env = getenv(OBJ_BULK_CACHE_ENV);
+	if (env != NULL && atoi(env) > 0) {
+		rc = obj_bulk_cache_create(OBJ_BULK_CACHE_BITS, true, NULL,
+					   &cli_bulk_cache);
+		if (rc != 0)
+			return rc;
+		D_DEBUG(DB_IO, "Bulk handles of I/O buffers are cached\n");
+	}
 
 	rc = daos_rpc_register(daos_obj_rpcs, NULL, DAOS_OBJ_MODULE);
+	if (rc != 0 && cli_bulk_cache != NULL) {
+		obj_bulk_cache_destroy(cli_bulk_cache);
+		cli_bulk_cache = NULL;
+	}
 	return rc;
 }
 
@@ -59,5 +117,10 @@ dc_obj_init(void)
 void
 dc_obj_fini(void)
 {
+	obj_coalesce_fini();
 	daos_rpc_unregister(daos_obj_rpcs);
+	if (cli_bulk_cache != NULL) {
+		obj_bulk_cache_destroy(cli_bulk_cache);
+		cli_bulk_cache = NULL;
+	}
 }
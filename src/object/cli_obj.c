@@ -27,6 +27,7 @@
  */
 #define D_LOGFAC	DD_FAC(object)
 
+#include <daos/checksum.h>
 #include <daos/object.h>
 #include <daos/container.h>
 #include <daos/pool.h>
@@ -746,6 +747,8 @@ struct obj_auxi_args {
 	int		 result;
 	d_list_t	 shard_task_head;
 	tse_task_t	*obj_task;
+	/** chunk checksums allocated for iods of update */
+	daos_csum_buf_t	**csums;
 };
 
 /* shard update/punch auxiliary args, must be the first field of
@@ -843,6 +846,67 @@ obj_list_dkey_cb(tse_task_t *task, struct obj_list_arg *arg, unsigned int opc)
 	}
 }
 
+/**
+ * Compute chunk checksums for array iods of update which don't carry their
+ * own checksums.
+ */
+static int
+obj_update_csum_init(struct obj_auxi_args *obj_auxi, daos_obj_update_t *args)
+{
+	daos_csum_t	csum;
+	daos_iod_t	*iod;
+	int		i;
+	int		rc;
+
+	if (cli_csum_chunk == 0 || args->sgls == NULL)
+		return 0;
+
+	D_ALLOC(obj_auxi->csums, args->nr * sizeof(*obj_auxi->csums));
+	if (obj_auxi->csums == NULL)
+		return -DER_NOMEM;
+
+	rc = daos_csum_init_type(cli_csum_type, &csum);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < args->nr; i++) {
+		iod = &args->iods[i];
+		if (iod->iod_type != DAOS_IOD_ARRAY || iod->iod_csums != NULL ||
+		    iod->iod_size == 0)
+			continue;
+
+		rc = daos_csum_compute_iod(&csum, iod, &args->sgls[i],
+					   cli_csum_chunk);
+		if (rc != 0) {
+			D_ERROR("Failed to compute checksums: %d\n", rc);
+			break;
+		}
+		obj_auxi->csums[i] = iod->iod_csums;
+	}
+
+	daos_csum_free(&csum);
+	return rc;
+}
+
+/** Release the checksums allocated by \a obj_update_csum_init */
+static void
+obj_update_csum_fini(struct obj_auxi_args *obj_auxi, daos_obj_update_t *args)
+{
+	int	i;
+
+	if (obj_auxi->csums == NULL)
+		return;
+
+	for (i = 0; i < args->nr; i++) {
+		if (obj_auxi->csums[i] != NULL) {
+			D_ASSERT(args->iods[i].iod_csums == obj_auxi->csums[i]);
+			daos_csum_iod_free(&args->iods[i]);
+		}
+	}
+	D_FREE(obj_auxi->csums);
+	obj_auxi->csums = NULL;
+}
+
 static int
 obj_comp_cb(tse_task_t *task, void *data)
 {
@@ -924,6 +988,9 @@ obj_comp_cb(tse_task_t *task, void *data)
 		D_ASSERT(d_list_empty(head));
 	}
 
+	if (!io_retry && obj_auxi->opc == DAOS_OBJ_RPC_UPDATE)
+		obj_update_csum_fini(obj_auxi, dc_task_get_args(task));
+
 	obj_decref(obj);
 	return 0;
 }
@@ -1094,6 +1161,7 @@ shard_update_task(tse_task_t *task)
 	struct dc_object		*obj;
 	struct dc_obj_shard		*obj_shard;
 	uint32_t			 shard_tmp;
+	bool				 sync;
 	int				 rc;
 
 	args = tse_task_buf_embedded(task, sizeof(*args));
@@ -1131,11 +1199,13 @@ shard_update_task(tse_task_t *task)
 		return rc;
 	}
 
+	/* the caller is waiting, the update shouldn't be delayed */
+	sync = dc_task_is_sync(args->auxi.obj_auxi->obj_task);
 	tse_task_stack_push_data(task, &args->dkey_hash,
 				 sizeof(args->dkey_hash));
 	rc = dc_obj_shard_update(obj_shard, args->epoch, args->dkey, args->nr,
 				 args->iods, args->sgls, &args->auxi.map_ver,
-				 task);
+				 sync, task);
 
 	obj_shard_close(obj_shard);
 	return rc;
@@ -1257,6 +1327,8 @@ dc_obj_update(tse_task_t *task)
 
 	obj_auxi = tse_task_stack_push(task, sizeof(*obj_auxi));
 	obj_auxi->opc = DAOS_OBJ_RPC_UPDATE;
+	if (!obj_auxi->io_retry)
+		obj_auxi->csums = NULL;
 	shard_task_list_init(obj_auxi);
 	rc = tse_task_register_comp_cb(task, obj_comp_cb, &obj,
 				       sizeof(obj));
@@ -1281,10 +1353,18 @@ dc_obj_update(tse_task_t *task)
 	D_DEBUG(DB_IO, "update "DF_OID" start %u cnt %u\n",
 		DP_OID(obj->cob_md.omd_id), shard, shards_cnt);
 
-	head = &obj_auxi->shard_task_head;
 	/* for retried obj IO, reuse the previous shard tasks and resched it */
-	if (obj_auxi->io_retry)
+	if (obj_auxi->io_retry) {
+		head = &obj_auxi->shard_task_head;
 		goto task_sched;
+	}
+
+	/* checksums are released by obj_comp_cb() */
+	rc = obj_update_csum_init(obj_auxi, args);
+	if (rc != 0)
+		goto out_task;
+
+	head = &obj_auxi->shard_task_head;
 	for (i = 0; i < shards_cnt; i++, shard++) {
 		tse_task_t			*shard_task;
 		struct shard_update_args	*shard_arg;
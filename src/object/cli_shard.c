@@ -112,10 +112,21 @@ dc_obj_shard_close(struct dc_obj_shard *shard)
 	obj_shard_decref(shard);
 }
 
+/**
+ * The bulk array of update/fetch is followed by the cache entries of these
+ * bulk handles, see obj_shard_rw_bulk_prep().
+ */
+static inline struct obj_bulk_ent **
+obj_shard_bulk_ents(crt_bulk_t *bulks, unsigned int nr)
+{
+	return (struct obj_bulk_ent **)&bulks[nr];
+}
+
 static void
 obj_shard_rw_bulk_fini(crt_rpc_t *rpc)
 {
 	struct obj_rw_in	*orw;
+	struct obj_bulk_ent	**ents;
 	crt_bulk_t		*bulks;
 	unsigned int		nr;
 	int			i;
@@ -126,8 +137,11 @@ obj_shard_rw_bulk_fini(crt_rpc_t *rpc)
 		return;
 
 	nr = orw->orw_bulks.ca_count;
-	for (i = 0; i < nr; i++)
-		crt_bulk_free(bulks[i]);
+	ents = obj_shard_bulk_ents(bulks, nr);
+	for (i = 0; i < nr; i++) {
+		if (bulks[i] != NULL)
+			obj_bulk_put(cli_bulk_cache, bulks[i], ents[i]);
+	}
 
 	D_FREE(bulks);
 	orw->orw_bulks.ca_arrays = NULL;
@@ -211,7 +225,15 @@ dc_rw_cb(tse_task_t *task, void *arg)
 		for (i = 0; i < orw->orw_nr; i++)
 			iods[i].iod_size = sizes[i];
 
-		if (orwo->orw_sgls.ca_count > 0) {
+		if (orwo->orw_sgls.ca_count > 0 &&
+		    orw->orw_bulks.ca_count > 0) {
+			/* server returned data of bulk fetch inline */
+			rc = obj_sgls_copy_flat(rw_args->rwaa_sgls,
+						 rw_args->rwaa_nr,
+						 orwo->orw_sgls.ca_arrays,
+						 orwo->orw_sgls.ca_count,
+						 &orwo->orw_nrs);
+		} else if (orwo->orw_sgls.ca_count > 0) {
 			/* inline transfer */
 			rc = daos_sgls_copy_data_out(rw_args->rwaa_sgls,
 						     rw_args->rwaa_nr,
@@ -264,6 +286,7 @@ obj_shard_rw_bulk_prep(crt_rpc_t *rpc, unsigned int nr, daos_sg_list_t *sgls,
 		       tse_task_t *task)
 {
 	struct obj_rw_in	*orw;
+	struct obj_bulk_ent	**ents;
 	crt_bulk_t		*bulks;
 	crt_bulk_perm_t		 bulk_perm;
 	int			 i;
@@ -271,22 +294,26 @@ obj_shard_rw_bulk_prep(crt_rpc_t *rpc, unsigned int nr, daos_sg_list_t *sgls,
 
 	bulk_perm = (opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_UPDATE) ?
 		    CRT_BULK_RO : CRT_BULK_RW;
-	D_ALLOC(bulks, nr * sizeof(*bulks));
+	D_ALLOC(bulks, nr * (sizeof(*bulks) + sizeof(*ents)));
 	if (bulks == NULL)
 		D_GOTO(out, rc = -DER_NOMEM);
 
+	ents = obj_shard_bulk_ents(bulks, nr);
 	/* create bulk transfer for daos_sg_list */
 	for (i = 0; i < nr; i++) {
 		if (sgls != NULL && sgls[i].sg_iovs != NULL &&
 		    sgls[i].sg_iovs[0].iov_buf != NULL) {
-			rc = crt_bulk_create(daos_task2ctx(task),
-					     daos2crt_sg(&sgls[i]),
-					     bulk_perm, &bulks[i]);
+			rc = obj_bulk_get(cli_bulk_cache, daos_task2ctx(task),
+					  &sgls[i], bulk_perm, NULL,
+					  &bulks[i], &ents[i]);
 			if (rc < 0) {
 				int j;
 
-				for (j = 0; j < i; j++)
-					crt_bulk_free(bulks[j]);
+				for (j = 0; j < i; j++) {
+					if (bulks[j] != NULL)
+						obj_bulk_put(cli_bulk_cache,
+							     bulks[j], ents[j]);
+				}
 
 				D_GOTO(out, rc);
 			}
@@ -320,7 +347,7 @@ static int
 obj_shard_rw(struct dc_obj_shard *shard, enum obj_rpc_opc opc,
 	     daos_epoch_t epoch, daos_key_t *dkey, unsigned int nr,
 	     daos_iod_t *iods, daos_sg_list_t *sgls, unsigned int *map_ver,
-	     tse_task_t *task)
+	     bool sync, tse_task_t *task)
 {
 	struct dc_pool	       *pool;
 	crt_rpc_t	       *req;
@@ -350,6 +377,14 @@ obj_shard_rw(struct dc_obj_shard *shard, enum obj_rpc_opc opc,
 	D_DEBUG(DB_TRACE, "opc %d "DF_UOID" %.*s rank %d tag %d\n",
 		opc, DP_UOID(shard->do_id), (int)dkey->iov_len,
 		(char *)dkey->iov_buf, tgt_ep.ep_rank, tgt_ep.ep_tag);
+
+	/* small update could be sent with others to the same target */
+	if (opc == DAOS_OBJ_RPC_UPDATE && !cli_bypass_rpc &&
+	    obj_coalesce_update(shard, pool, &tgt_ep, cont_hdl_uuid,
+				cont_uuid, epoch, dkey, nr, iods, sgls,
+				map_ver, sync, task))
+		return 0;
+
 	rc = obj_req_create(daos_task2ctx(task), &tgt_ep, opc, &req);
 	if (rc != 0)
 		D_GOTO(out_pool, rc);
@@ -381,7 +416,9 @@ obj_shard_rw(struct dc_obj_shard *shard, enum obj_rpc_opc opc,
 	if (DAOS_FAIL_CHECK(DAOS_SHARD_OBJ_FAIL))
 		D_GOTO(out_req, rc = -DER_INVAL);
 
-	if (total_len >= OBJ_BULK_LIMIT) {
+	/* accept small fetched data inline even if bulk is provided */
+	orw->orw_inline_max = opc == DAOS_OBJ_RPC_FETCH ? cli_inline_size : 0;
+	if (total_len >= cli_inline_size) {
 		/* Transfer data by bulk */
 		rc = obj_shard_rw_bulk_prep(req, nr, sgls, task);
 		if (rc != 0)
@@ -435,7 +472,7 @@ obj_shard_rw(struct dc_obj_shard *shard, enum obj_rpc_opc opc,
 
 out_args:
 	crt_req_decref(req);
-	if (total_len >= OBJ_BULK_LIMIT)
+	if (total_len >= cli_inline_size)
 		obj_shard_rw_bulk_fini(req);
 out_req:
 	crt_req_decref(req);
@@ -542,11 +579,11 @@ out:
 int
 dc_obj_shard_update(struct dc_obj_shard *shard, daos_epoch_t epoch,
 		    daos_key_t *dkey, unsigned int nr, daos_iod_t *iods,
-		    daos_sg_list_t *sgls, unsigned int *map_ver,
+		    daos_sg_list_t *sgls, unsigned int *map_ver, bool sync,
 		    tse_task_t *task)
 {
 	return obj_shard_rw(shard, DAOS_OBJ_RPC_UPDATE, epoch, dkey,
-			    nr, iods, sgls, map_ver, task);
+			    nr, iods, sgls, map_ver, sync, task);
 }
 
 int
@@ -556,7 +593,7 @@ dc_obj_shard_fetch(struct dc_obj_shard *shard, daos_epoch_t epoch,
 		   unsigned int *map_ver, tse_task_t *task)
 {
 	return obj_shard_rw(shard, DAOS_OBJ_RPC_FETCH, epoch, dkey,
-			    nr, iods, sgls, map_ver, task);
+			    nr, iods, sgls, map_ver, false, task);
 }
 
 struct obj_enum_args {
@@ -0,0 +1,308 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Cache of registered bulk handles.
+ *
+ * Creating a bulk handle registers the memory to the network, which is the
+ * dominant cost of medium size transfers. Handles of contiguous buffers are
+ * cached by (context, address, length, permission, domain), so repeated I/O
+ * against the same buffer can reuse the registration.
+ *
+ * It also unpacks the data of bulk fetch returned inline by server.
+ */
+#define D_LOGFAC	DD_FAC(object)
+
+#include <daos/lru.h>
+#include <daos/rpc.h>
+#include "obj_internal.h"
+
+struct obj_bulk_key {
+	crt_context_t		 bk_ctx;
+	void			*bk_addr;
+	daos_size_t		 bk_len;
+	/** owner of the buffer, e.g. pool of the zero-copy buffer */
+	void			*bk_domain;
+	crt_bulk_perm_t		 bk_perm;
+};
+
+struct obj_bulk_ent {
+	struct daos_llink	 be_link;
+	struct obj_bulk_key	 be_key;
+	crt_bulk_t		 be_hdl;
+	struct obj_bulk_cache	*be_cache;
+};
+
+struct obj_bulk_cache {
+	struct daos_lru_cache	*bc_lru;
+	struct obj_bulk_domain_ops *bc_ops;
+	/** serialize accesses if the cache is shared by threads */
+	pthread_mutex_t		 bc_lock;
+	bool			 bc_locked;
+};
+
+static inline struct obj_bulk_ent *
+bulk_ent_obj(struct daos_llink *llink)
+{
+	return container_of(llink, struct obj_bulk_ent, be_link);
+}
+
+static int
+bulk_alloc_ref(void *key, unsigned int ksize, void *args,
+	       struct daos_llink **llink)
+{
+	struct obj_bulk_cache	*cache = args;
+	struct obj_bulk_key	*bkey = key;
+	struct obj_bulk_ent	*ent;
+	daos_sg_list_t		 sgl;
+	daos_iov_t		 iov;
+	int			 rc;
+
+	D_ALLOC_PTR(ent);
+	if (ent == NULL)
+		return -DER_NOMEM;
+
+	daos_iov_set(&iov, bkey->bk_addr, bkey->bk_len);
+	sgl.sg_nr = 1;
+	sgl.sg_nr_out = 1;
+	sgl.sg_iovs = &iov;
+
+	rc = crt_bulk_create(bkey->bk_ctx, daos2crt_sg(&sgl), bkey->bk_perm,
+			     &ent->be_hdl);
+	if (rc != 0) {
+		D_FREE_PTR(ent);
+		return rc;
+	}
+
+	if (bkey->bk_domain != NULL && cache->bc_ops != NULL)
+		cache->bc_ops->bdo_hold(bkey->bk_domain);
+
+	memcpy(&ent->be_key, bkey, sizeof(*bkey));
+	ent->be_cache = cache;
+	*llink = &ent->be_link;
+	return 0;
+}
+
+static void
+bulk_free_ref(struct daos_llink *llink)
+{
+	struct obj_bulk_ent	*ent = bulk_ent_obj(llink);
+	struct obj_bulk_cache	*cache = ent->be_cache;
+
+	crt_bulk_free(ent->be_hdl);
+	if (ent->be_key.bk_domain != NULL && cache->bc_ops != NULL)
+		cache->bc_ops->bdo_rele(ent->be_key.bk_domain);
+	D_FREE_PTR(ent);
+}
+
+static bool
+bulk_cmp_keys(const void *key, unsigned int ksize, struct daos_llink *llink)
+{
+	struct obj_bulk_ent *ent = bulk_ent_obj(llink);
+
+	return memcmp(key, &ent->be_key, sizeof(ent->be_key)) == 0;
+}
+
+static struct daos_llink_ops bulk_cache_ops = {
+	.lop_alloc_ref	= bulk_alloc_ref,
+	.lop_free_ref	= bulk_free_ref,
+	.lop_cmp_keys	= bulk_cmp_keys,
+};
+
+int
+obj_bulk_cache_create(int bits, bool locked, struct obj_bulk_domain_ops *ops,
+		      struct obj_bulk_cache **cache_p)
+{
+	struct obj_bulk_cache	*cache;
+	int			 rc;
+
+	D_ALLOC_PTR(cache);
+	if (cache == NULL)
+		return -DER_NOMEM;
+
+	rc = daos_lru_cache_create(bits, D_HASH_FT_NOLOCK, &bulk_cache_ops,
+				   &cache->bc_lru);
+	if (rc != 0)
+		D_GOTO(failed, rc);
+
+	if (locked) {
+		rc = D_MUTEX_INIT(&cache->bc_lock, NULL);
+		if (rc != 0) {
+			daos_lru_cache_destroy(cache->bc_lru);
+			D_GOTO(failed, rc);
+		}
+	}
+	cache->bc_locked = locked;
+	cache->bc_ops = ops;
+	*cache_p = cache;
+	return 0;
+failed:
+	D_FREE_PTR(cache);
+	return rc;
+}
+
+void
+obj_bulk_cache_destroy(struct obj_bulk_cache *cache)
+{
+	daos_lru_cache_destroy(cache->bc_lru);
+	if (cache->bc_locked)
+		D_MUTEX_DESTROY(&cache->bc_lock);
+	D_FREE_PTR(cache);
+}
+
+static bool
+bulk_domain_match(struct daos_llink *llink, void *args)
+{
+	struct obj_bulk_ent *ent = bulk_ent_obj(llink);
+
+	return ent->be_key.bk_domain == args;
+}
+
+/**
+ * Drop all cached handles of \a domain, it should be called by the owner
+ * of the domain before the domain goes away. Handles still in use are
+ * freed by the last \a obj_bulk_put.
+ */
+void
+obj_bulk_cache_evict(struct obj_bulk_cache *cache, void *domain)
+{
+	D_ASSERT(domain != NULL);
+	if (cache->bc_locked)
+		D_MUTEX_LOCK(&cache->bc_lock);
+
+	daos_lru_cache_evict(cache->bc_lru, bulk_domain_match, domain);
+
+	if (cache->bc_locked)
+		D_MUTEX_UNLOCK(&cache->bc_lock);
+}
+
+/**
+ * Get a bulk handle for \a sgl, the handle is taken from \a cache if the
+ * sgl is a single contiguous buffer, otherwise a new handle is created.
+ * The handle returned in \a hdl_p should be released by \a obj_bulk_put
+ * with the entry returned in \a ent_p, which is NULL for uncached handle.
+ */
+int
+obj_bulk_get(struct obj_bulk_cache *cache, crt_context_t ctx,
+	     daos_sg_list_t *sgl, crt_bulk_perm_t perm, void *domain,
+	     crt_bulk_t *hdl_p, struct obj_bulk_ent **ent_p)
+{
+	struct obj_bulk_key	 key;
+	struct daos_llink	*llink;
+	int			 rc;
+
+	*ent_p = NULL;
+	if (cache == NULL || sgl->sg_nr != 1)
+		return crt_bulk_create(ctx, daos2crt_sg(sgl), perm, hdl_p);
+
+	/* zero the padding, the key is compared by memcmp */
+	memset(&key, 0, sizeof(key));
+	key.bk_ctx	= ctx;
+	key.bk_addr	= sgl->sg_iovs[0].iov_buf;
+	key.bk_len	= sgl->sg_iovs[0].iov_len;
+	key.bk_domain	= domain;
+	key.bk_perm	= perm;
+
+	if (cache->bc_locked)
+		D_MUTEX_LOCK(&cache->bc_lock);
+
+	rc = daos_lru_ref_hold(cache->bc_lru, &key, sizeof(key), cache,
+			       &llink);
+
+	if (cache->bc_locked)
+		D_MUTEX_UNLOCK(&cache->bc_lock);
+
+	if (rc != 0) {
+		D_DEBUG(DB_IO, "Cannot cache bulk handle: %d\n", rc);
+		return crt_bulk_create(ctx, daos2crt_sg(sgl), perm, hdl_p);
+	}
+
+	*ent_p = bulk_ent_obj(llink);
+	*hdl_p = (*ent_p)->be_hdl;
+	return 0;
+}
+
+void
+obj_bulk_put(struct obj_bulk_cache *cache, crt_bulk_t hdl,
+	     struct obj_bulk_ent *ent)
+{
+	if (ent == NULL) {
+		crt_bulk_free(hdl);
+		return;
+	}
+
+	D_ASSERT(cache != NULL && ent->be_hdl == hdl);
+	if (cache->bc_locked)
+		D_MUTEX_LOCK(&cache->bc_lock);
+
+	daos_lru_ref_release(cache->bc_lru, &ent->be_link);
+
+	if (cache->bc_locked)
+		D_MUTEX_UNLOCK(&cache->bc_lock);
+}
+
+/**
+ * Copy data of a bulk fetch returned inline by server, each of \a src has
+ * a single iov which mirrors the bulk of the corresponding sgl of \a dst.
+ */
+int
+obj_sgls_copy_flat(daos_sg_list_t *dst, unsigned int dst_nr,
+		   daos_sg_list_t *src, unsigned int src_nr,
+		   struct crt_array *nrs)
+{
+	uint32_t	*sg_nrs = nrs->ca_arrays;
+	int		 i;
+	int		 j;
+
+	if (dst == NULL || src_nr != dst_nr || nrs->ca_count != dst_nr) {
+		D_ERROR("Invalid inline reply %u/%u/%u\n", src_nr, dst_nr,
+			(unsigned int)nrs->ca_count);
+		return -DER_PROTO;
+	}
+
+	for (i = 0; i < src_nr; i++) {
+		char		*buf;
+		daos_size_t	 len;
+
+		dst[i].sg_nr_out = sg_nrs[i];
+		if (src[i].sg_nr == 0)
+			continue;
+
+		buf = src[i].sg_iovs[0].iov_buf;
+		len = src[i].sg_iovs[0].iov_len;
+		for (j = 0; j < dst[i].sg_nr && len > 0; j++) {
+			daos_iov_t	*iov = &dst[i].sg_iovs[j];
+			daos_size_t	 nob = min(iov->iov_buf_len, len);
+
+			memcpy(iov->iov_buf, buf, nob);
+			iov->iov_len = nob;
+			buf += nob;
+			len -= nob;
+		}
+
+		if (len != 0) {
+			D_ERROR("%d: "DF_U64" bytes overflowed\n", i, len);
+			return -DER_PROTO;
+		}
+	}
+	return 0;
+}
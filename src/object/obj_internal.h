@@ -35,6 +35,7 @@
 #include <daos/placement.h>
 #include <daos/btree.h>
 #include <daos/btree_class.h>
+#include <daos/scratch.h>
 #include <daos_types.h>
 
 /**
@@ -55,6 +56,43 @@ extern bool	cli_bypass_rpc;
  */
 extern bool	srv_bypass_bulk;
 
+/**
+ * Max size of data transferred inline by update/fetch RPC, it can be set
+ * on both client and server. Client sends update inline if it's smaller
+ * than this size, server returns fetched data inline if it's not larger
+ * than the size of both sides, even if client has provided bulk handles.
+ */
+#define OBJ_INLINE_ENV		"DAOS_IO_INLINE_SIZE"
+
+extern unsigned int	cli_inline_size;
+extern unsigned int	srv_inline_size;
+
+/** checksum algorithm for array extents, checksum is disabled if unset */
+#define OBJ_CSUM_ENV		"DAOS_CSUM"
+/** chunk size of checksums in bytes */
+#define OBJ_CSUM_CHUNK_ENV	"DAOS_CSUM_CHUNK_SIZE"
+#define OBJ_CSUM_CHUNK_DEF	(32 << 10)
+
+/**
+ * Checksum type and chunk size for array extents, client computes chunk
+ * checksums on update if \a cli_csum_chunk isn't zero.
+ */
+extern unsigned int	cli_csum_type;
+extern unsigned int	cli_csum_chunk;
+
+/**
+ * Max delay in microseconds of coalescing small updates on client, small
+ * updates of the same container and epoch to a target are sent by one RPC
+ * after the delay, or once there are OBJ_COALESCE_NR updates or
+ * OBJ_COALESCE_SIZE bytes of data. Coalescing is disabled if it's zero,
+ * tests can still enable it by DAOS_OBJ_COALESCE with the delay as value.
+ */
+#define OBJ_COALESCE_ENV	"DAOS_IO_COALESCE"
+#define OBJ_COALESCE_NR		64
+#define OBJ_COALESCE_SIZE	OBJ_INLINE_MAX
+
+extern unsigned int	cli_coalesce_delay;
+
 /** client object shard */
 struct dc_obj_shard {
 	/** rank of the target this object belongs to */
@@ -175,9 +213,78 @@ enum_anchor_set_tag(daos_hash_out_t *anchor, uint32_t tag)
 	       ENUM_ANCHOR_TAG_LENGTH);
 }
 
+/**
+ * Server transfers buffers of bulk update in segments of this size, every
+ * segment is persisted once it has arrived.
+ */
+#define OBJ_BULK_SEG_SIZE	(1ULL << 20)
+
+/** log2 of the number of bulk handles cached by each xstream */
+#define OBJ_BULK_CACHE_BITS	8
+/**
+ * Cache registered bulk handles of I/O buffers on client. It should only
+ * be enabled if the application reuses I/O buffers and never unmaps them,
+ * because registration of a freed buffer could be reused for a new buffer
+ * at the same address.
+ */
+#define OBJ_BULK_CACHE_ENV	"DAOS_BULK_CACHE"
+
+/** client bulk handle cache, NULL if it's disabled */
+extern struct obj_bulk_cache	*cli_bulk_cache;
+
+/**
+ * Owner of the cached buffers, a cached handle holds a reference on its
+ * domain, the owner should evict handles of the domain by
+ * \a obj_bulk_cache_evict before the domain goes away.
+ */
+struct obj_bulk_domain_ops {
+	void	(*bdo_hold)(void *domain);
+	void	(*bdo_rele)(void *domain);
+};
+
+struct obj_bulk_cache;
+struct obj_bulk_ent;
+
+int obj_bulk_cache_create(int bits, bool locked,
+			  struct obj_bulk_domain_ops *ops,
+			  struct obj_bulk_cache **cache_p);
+void obj_bulk_cache_destroy(struct obj_bulk_cache *cache);
+void obj_bulk_cache_evict(struct obj_bulk_cache *cache, void *domain);
+int obj_bulk_get(struct obj_bulk_cache *cache, crt_context_t ctx,
+		 daos_sg_list_t *sgl, crt_bulk_perm_t perm, void *domain,
+		 crt_bulk_t *hdl_p, struct obj_bulk_ent **ent_p);
+void obj_bulk_put(struct obj_bulk_cache *cache, crt_bulk_t hdl,
+		  struct obj_bulk_ent *ent);
+int obj_sgls_copy_flat(daos_sg_list_t *dst, unsigned int dst_nr,
+		       daos_sg_list_t *src, unsigned int src_nr,
+		       struct crt_array *nrs);
+
+/**
+ * Number of size buckets of the I/O histogram, bucket 0 is for I/O smaller
+ * than 1K, bucket N is for [2^(N+9), 2^(N+10)), and the last one is for
+ * I/O of 1M or larger.
+ */
+#define OBJ_IO_HIST_BUCKETS	12
+
+struct obj_io_hist {
+	/** number of I/Os in each size bucket */
+	uint64_t		oh_sizes[OBJ_IO_HIST_BUCKETS];
+	/** number of I/Os whose data was transferred inline */
+	uint64_t		oh_inline;
+	/** number of I/Os whose data was transferred by bulk */
+	uint64_t		oh_bulk;
+};
+
 extern struct dss_module_key obj_module_key;
 struct obj_tls {
-	d_sg_list_t	ot_echo_sgl;
+	d_sg_list_t		ot_echo_sgl;
+	/** scratch arena for the reply arrays of fetch */
+	struct daos_scratch	ot_scratch;
+	/** registered bulk handles of zero-copy buffers */
+	struct obj_bulk_cache	*ot_bulk_cache;
+	/** size histograms of update and fetch */
+	struct obj_io_hist	ot_update_hist;
+	struct obj_io_hist	ot_fetch_hist;
 };
 
 int dc_obj_shard_open(struct dc_object *obj, uint32_t tgt, daos_unit_oid_t id,
@@ -187,7 +294,7 @@ void dc_obj_shard_close(struct dc_obj_shard *shard);
 int dc_obj_shard_update(struct dc_obj_shard *shard, daos_epoch_t epoch,
 			daos_key_t *dkey, unsigned int nr,
 			daos_iod_t *iods, daos_sg_list_t *sgls,
-			unsigned int *map_ver, tse_task_t *task);
+			unsigned int *map_ver, bool sync, tse_task_t *task);
 int dc_obj_shard_fetch(struct dc_obj_shard *shard, daos_epoch_t epoch,
 		       daos_key_t *dkey, unsigned int nr,
 		       daos_iod_t *iods, daos_sg_list_t *sgls,
@@ -222,8 +329,45 @@ void obj_shard_addref(struct dc_obj_shard *shard);
 void obj_addref(struct dc_object *obj);
 void obj_decref(struct dc_object *obj);
 
+/* cli_coalesce.c */
+struct dc_pool;
+bool obj_coalesce_update(struct dc_obj_shard *shard, struct dc_pool *pool,
+			 crt_endpoint_t *tgt_ep, uuid_t co_hdl, uuid_t co_uuid,
+			 daos_epoch_t epoch, daos_key_t *dkey, unsigned int nr,
+			 daos_iod_t *iods, daos_sg_list_t *sgls,
+			 unsigned int *map_ver, bool sync, tse_task_t *task);
+void obj_coalesce_fini(void);
+
+/* srv_bulk.c */
+struct ds_bulk_async_args {
+	int		bulks_inflight;
+	ABT_eventual	eventual;
+	int		result;
+	/** local bulk handles, released after all transfers are done */
+	d_list_t	locals;
+};
+
+/**
+ * Transfer \a length bytes between \a remote_bulk at \a remote_off and the
+ * local buffers \a sgl registered as \a local_bulk. If \a persist_ioh is
+ * valid, the transfer is split into segments of OBJ_BULK_SEG_SIZE and each
+ * segment is persisted on completion. Issued transfers are accounted in
+ * \a arg, the eventual of \a arg is set when the last one completes. It
+ * stops issuing segments on the first error and returns it.
+ */
+int ds_bulk_seg_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
+			 crt_bulk_t remote_bulk, daos_off_t remote_off,
+			 crt_bulk_t local_bulk, daos_sg_list_t *sgl,
+			 daos_size_t length, daos_handle_t persist_ioh,
+			 struct daos_scratch *scr,
+			 struct ds_bulk_async_args *arg);
+int ds_obj_fetch_inline(crt_rpc_t *rpc, daos_handle_t ioh,
+			struct daos_scratch *scr, daos_size_t *size,
+			bool *inlined);
+
 /* srv_obj.c */
 void ds_obj_rw_handler(crt_rpc_t *rpc);
+void ds_obj_update_multi_handler(crt_rpc_t *rpc);
 void ds_obj_enum_handler(crt_rpc_t *rpc);
 void ds_obj_punch_handler(crt_rpc_t *rpc);
 
@@ -37,6 +37,8 @@ static struct crt_msg_field *obj_rw_in_fields[] = {
 	&CMF_UINT64,	/* epoch */
 	&CMF_UINT32,	/* map_version */
 	&CMF_UINT32,	/* count of iod and sg */
+	&CMF_UINT32,	/* max size of inline fetch reply */
+	&CMF_UINT32,	/* padding */
 	&CMF_IOVEC,	/* dkey */
 	&DMF_IOD_ARRAY, /* I/O descriptor array */
 	&DMF_SGL_ARRAY, /* scatter/gather array */
@@ -52,6 +54,83 @@ static struct crt_msg_field *obj_rw_out_fields[] = {
 	&DMF_SGL_ARRAY, /* return buffer */
 };
 
+static int
+obj_proc_update_ent(crt_proc_t proc, struct obj_update_ent *ent)
+{
+	crt_proc_op_t	proc_op;
+	int		i;
+	int		rc;
+
+	rc = crt_proc_get_op(proc, &proc_op);
+	if (rc != 0)
+		return -DER_HG;
+
+	rc = daos_proc_unit_oid(proc, &ent->oue_oid);
+	if (rc != 0)
+		return rc;
+
+	rc = daos_proc_iovec(proc, &ent->oue_dkey);
+	if (rc != 0)
+		return rc;
+
+	rc = crt_proc_uint32_t(proc, &ent->oue_nr);
+	if (rc != 0)
+		return -DER_HG;
+
+	if (proc_op == CRT_PROC_DECODE && ent->oue_nr > 0) {
+		D_ALLOC(ent->oue_iods, ent->oue_nr * sizeof(*ent->oue_iods));
+		if (ent->oue_iods == NULL)
+			return -DER_NOMEM;
+
+		D_ALLOC(ent->oue_sgls, ent->oue_nr * sizeof(*ent->oue_sgls));
+		if (ent->oue_sgls == NULL) {
+			D_FREE(ent->oue_iods);
+			return -DER_NOMEM;
+		}
+	}
+
+	for (i = 0; i < ent->oue_nr; i++) {
+		rc = daos_proc_iod(proc, &ent->oue_iods[i]);
+		if (rc != 0)
+			D_GOTO(failed, rc);
+
+		rc = daos_proc_sg_list(proc, &ent->oue_sgls[i]);
+		if (rc != 0)
+			D_GOTO(failed, rc);
+	}
+
+	if (proc_op == CRT_PROC_FREE && ent->oue_nr > 0) {
+		D_FREE(ent->oue_iods);
+		D_FREE(ent->oue_sgls);
+	}
+	return 0;
+failed:
+	if (proc_op == CRT_PROC_DECODE) {
+		D_FREE(ent->oue_iods);
+		D_FREE(ent->oue_sgls);
+	}
+	return rc;
+}
+
+static struct crt_msg_field DMF_UPDATE_ENT_ARRAY =
+	DEFINE_CRT_MSG("obj_update_ent[]", CMF_ARRAY_FLAG,
+		       sizeof(struct obj_update_ent), obj_proc_update_ent);
+
+static struct crt_msg_field *obj_update_multi_in_fields[] = {
+	&CMF_UUID,	/* container handle uuid */
+	&CMF_UUID,	/* container uuid */
+	&CMF_UINT64,	/* epoch */
+	&CMF_UINT32,	/* map_version */
+	&CMF_UINT32,	/* padding */
+	&DMF_UPDATE_ENT_ARRAY, /* updates */
+};
+
+static struct crt_msg_field *obj_update_multi_out_fields[] = {
+	&CMF_INT,	/* status */
+	&CMF_UINT32,	/* map version */
+	&DMF_UINT32_ARRAY, /* status of each update */
+};
+
 static struct crt_msg_field *obj_key_enum_in_fields[] = {
 	&DMF_OID,	/* object ID */
 	&CMF_UUID,	/* container handle uuid */
@@ -112,6 +191,11 @@ static struct crt_req_format DQF_OBJ_FETCH =
 			   obj_rw_in_fields,
 			   obj_rw_out_fields);
 
+static struct crt_req_format DQF_OBJ_UPDATE_MULTI =
+	DEFINE_CRT_REQ_FMT("DAOS_OBJ_UPDATE_MULTI",
+			   obj_update_multi_in_fields,
+			   obj_update_multi_out_fields);
+
 static struct crt_req_format DQF_ENUMERATE =
 	DEFINE_CRT_REQ_FMT("DAOS_ENUM",
 			   obj_key_enum_in_fields,
@@ -136,57 +220,63 @@ struct daos_rpc daos_obj_rpcs[] = {
 	{
 		.dr_name	= "DAOS_OBJ_UPDATE",
 		.dr_opc		= DAOS_OBJ_RPC_UPDATE,
-		.dr_ver		= 1,
+		.dr_ver		= DAOS_OBJ_VERSION,
 		.dr_flags	= 0,
 		.dr_req_fmt	= &DQF_OBJ_UPDATE,
 	}, {
 		.dr_name	= "DAOS_OBJ_FETCH",
 		.dr_opc		= DAOS_OBJ_RPC_FETCH,
-		.dr_ver		= 1,
+		.dr_ver		= DAOS_OBJ_VERSION,
 		.dr_flags	= 0,
 		.dr_req_fmt	= &DQF_OBJ_FETCH,
 	}, {
 		.dr_name	= "DAOS_DKEY_ENUM",
 		.dr_opc		= DAOS_OBJ_DKEY_RPC_ENUMERATE,
-		.dr_ver		= 1,
+		.dr_ver		= DAOS_OBJ_VERSION,
 		.dr_flags	= 0,
 		.dr_req_fmt	= &DQF_ENUMERATE,
 	}, {
 		.dr_name        = "DAOS_AKEY_ENUM",
 		.dr_opc         = DAOS_OBJ_AKEY_RPC_ENUMERATE,
-		.dr_ver         = 1,
+		.dr_ver         = DAOS_OBJ_VERSION,
 		.dr_flags       = 0,
 		.dr_req_fmt     = &DQF_ENUMERATE,
 	}, {
 		.dr_name        = "DAOS_REC_ENUM",
 		.dr_opc         = DAOS_OBJ_RECX_RPC_ENUMERATE,
-		.dr_ver         = 1,
+		.dr_ver         = DAOS_OBJ_VERSION,
 		.dr_flags       = 0,
 		.dr_req_fmt     = &DQF_ENUMERATE,
 	}, {
 		.dr_name        = "DAOS_OBJ_ENUM",
 		.dr_opc         = DAOS_OBJ_RPC_ENUMERATE,
-		.dr_ver         = 1,
+		.dr_ver         = DAOS_OBJ_VERSION,
 		.dr_flags       = 0,
 		.dr_req_fmt     = &DQF_ENUMERATE,
 	}, {
 		.dr_name	= "DAOS_OBJ_PUNCH",
 		.dr_opc		= DAOS_OBJ_RPC_PUNCH,
-		.dr_ver		= 1,
+		.dr_ver		= DAOS_OBJ_VERSION,
 		.dr_flags	= 0,
 		.dr_req_fmt	= &DQF_OBJ_PUNCH,
 	}, {
 		.dr_name	= "DAOS_OBJ_PUNCH_DKEYS",
 		.dr_opc		= DAOS_OBJ_RPC_PUNCH_DKEYS,
-		.dr_ver		= 1,
+		.dr_ver		= DAOS_OBJ_VERSION,
 		.dr_flags	= 0,
 		.dr_req_fmt	= &DQF_OBJ_PUNCH_DKEYS,
 	}, {
 		.dr_name	= "DAOS_OBJ_PUNCH_AKEYS",
 		.dr_opc		= DAOS_OBJ_RPC_PUNCH_AKEYS,
-		.dr_ver		= 1,
+		.dr_ver		= DAOS_OBJ_VERSION,
 		.dr_flags	= 0,
 		.dr_req_fmt	= &DQF_OBJ_PUNCH_AKEYS,
+	}, {
+		.dr_name	= "DAOS_OBJ_UPDATE_MULTI",
+		.dr_opc		= DAOS_OBJ_RPC_UPDATE_MULTI,
+		.dr_ver		= DAOS_OBJ_VERSION,
+		.dr_flags	= 0,
+		.dr_req_fmt	= &DQF_OBJ_UPDATE_MULTI,
 	}, {
 		.dr_opc		= 0
 	}
@@ -201,7 +291,7 @@ obj_req_create(crt_context_t crt_ctx, crt_endpoint_t *tgt_ep,
 	if (DAOS_FAIL_CHECK(DAOS_OBJ_REQ_CREATE_TIMEOUT))
 		return -DER_TIMEDOUT;
 
-	opcode = DAOS_RPC_OPCODE(opc, DAOS_OBJ_MODULE, 1);
+	opcode = DAOS_RPC_OPCODE(opc, DAOS_OBJ_MODULE, DAOS_OBJ_VERSION);
 
 	return crt_req_create(crt_ctx, tgt_ep, opcode, req);
 }
@@ -227,6 +317,9 @@ obj_reply_set_status(crt_rpc_t *rpc, int status)
 	case DAOS_OBJ_RPC_PUNCH_AKEYS:
 		((struct obj_punch_out *)reply)->opo_ret = status;
 		break;
+	case DAOS_OBJ_RPC_UPDATE_MULTI:
+		((struct obj_update_multi_out *)reply)->oum_ret = status;
+		break;
 	default:
 		D_ASSERT(0);
 	}
@@ -250,6 +343,8 @@ obj_reply_get_status(crt_rpc_t *rpc)
 	case DAOS_OBJ_RPC_PUNCH_DKEYS:
 	case DAOS_OBJ_RPC_PUNCH_AKEYS:
 		return ((struct obj_punch_out *)reply)->opo_ret;
+	case DAOS_OBJ_RPC_UPDATE_MULTI:
+		return ((struct obj_update_multi_out *)reply)->oum_ret;
 	default:
 		D_ASSERT(0);
 	}
@@ -278,6 +373,10 @@ obj_reply_map_version_set(crt_rpc_t *rpc, uint32_t map_version)
 	case DAOS_OBJ_RPC_PUNCH_AKEYS:
 		((struct obj_punch_out *)reply)->opo_map_version = map_version;
 		break;
+	case DAOS_OBJ_RPC_UPDATE_MULTI:
+		((struct obj_update_multi_out *)reply)->oum_map_version =
+								map_version;
+		break;
 	default:
 		D_ASSERT(0);
 	}
@@ -301,6 +400,8 @@ obj_reply_map_version_get(crt_rpc_t *rpc)
 	case DAOS_OBJ_RPC_PUNCH_DKEYS:
 	case DAOS_OBJ_RPC_PUNCH_AKEYS:
 		return ((struct obj_punch_out *)reply)->opo_map_version;
+	case DAOS_OBJ_RPC_UPDATE_MULTI:
+		return ((struct obj_update_multi_out *)reply)->oum_map_version;
 	default:
 		D_ASSERT(0);
 	}
@@ -38,6 +38,14 @@
 #include <daos/rpc.h>
 
 #define OBJ_BULK_LIMIT	(4 * 1024) /* 4KB bytes */
+/* Max size of data can be carried inline by update/fetch RPC */
+#define OBJ_INLINE_MAX	(64 * 1024)
+
+/*
+ * Version of the object RPCs, bump it whenever the format of any object
+ * RPC changes.
+ */
+#define DAOS_OBJ_VERSION	3
 
 /*
  * RPC operation codes
@@ -55,6 +63,7 @@ enum obj_rpc_opc {
 	DAOS_OBJ_RPC_PUNCH		= 7,
 	DAOS_OBJ_RPC_PUNCH_DKEYS	= 8,
 	DAOS_OBJ_RPC_PUNCH_AKEYS	= 9,
+	DAOS_OBJ_RPC_UPDATE_MULTI	= 10,
 };
 
 struct obj_rw_in {
@@ -64,6 +73,9 @@ struct obj_rw_in {
 	uint64_t		orw_epoch;
 	uint32_t		orw_map_ver;
 	uint32_t		orw_nr;
+	/* max size of fetched data the client accepts inline in reply */
+	uint32_t		orw_inline_max;
+	uint32_t		orw_padding;
 	daos_key_t		orw_dkey;
 	struct crt_array	orw_iods;
 	struct crt_array	orw_sgls;
@@ -80,6 +92,33 @@ struct obj_rw_out {
 	struct crt_array	orw_sgls;
 };
 
+/* one of the coalesced small updates, its data is always inline */
+struct obj_update_ent {
+	daos_unit_oid_t		oue_oid;
+	daos_key_t		oue_dkey;
+	/* count of iod and sg */
+	uint32_t		oue_nr;
+	daos_iod_t		*oue_iods;
+	daos_sg_list_t		*oue_sgls;
+};
+
+/* updates of the same container and epoch sent to a target in one RPC */
+struct obj_update_multi_in {
+	uuid_t			oum_co_hdl;
+	uuid_t			oum_co_uuid;
+	uint64_t		oum_epoch;
+	uint32_t		oum_map_ver;
+	uint32_t		oum_padding;
+	struct crt_array	oum_ents;
+};
+
+struct obj_update_multi_out {
+	int32_t			oum_ret;
+	uint32_t		oum_map_version;
+	/* status of each update */
+	struct crt_array	oum_rets;
+};
+
 /* object Enumerate in/out */
 struct obj_key_enum_in {
 	daos_unit_oid_t		oei_oid;
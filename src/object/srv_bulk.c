@@ -0,0 +1,251 @@
+/**
+ * (C) Copyright 2019 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Bulk transfer of a run of local buffers in segments, the buffers of
+ * zero-copy update are persisted segment by segment as they arrive. Small
+ * bulk fetch is returned inline in the reply instead.
+ */
+#define D_LOGFAC	DD_FAC(object)
+
+#include <daos/rpc.h>
+#include <daos_srv/vos.h>
+#include "obj_rpc.h"
+#include "obj_internal.h"
+
+/** argument of each bulk transfer */
+struct ds_bulk_cb_args {
+	struct ds_bulk_async_args	*bca_async;
+	/** scratch arena the argument is allocated from */
+	struct daos_scratch		*bca_scratch;
+	/** ZC I/O handle, the segment is persisted on completion if valid */
+	daos_handle_t			 bca_ioh;
+	/** local buffers of the run */
+	daos_iov_t			*bca_iovs;
+	unsigned int			 bca_iov_nr;
+	/** offset and length of this segment within the run */
+	daos_off_t			 bca_off;
+	daos_size_t			 bca_len;
+};
+
+/**
+ * Persist the zero-copy buffers of a completed segment, while the following
+ * segments are still on the wire.
+ */
+static void
+bulk_seg_persist(struct ds_bulk_cb_args *cb_args)
+{
+	daos_off_t	off = cb_args->bca_off;
+	daos_size_t	len = cb_args->bca_len;
+	int		i;
+
+	for (i = 0; i < cb_args->bca_iov_nr && len > 0; i++) {
+		daos_iov_t	*iov = &cb_args->bca_iovs[i];
+		daos_size_t	 nob;
+
+		if (off >= iov->iov_len) {
+			off -= iov->iov_len;
+			continue;
+		}
+
+		nob = min(iov->iov_len - off, len);
+		vos_obj_zc_persist(cb_args->bca_ioh,
+				   (char *)iov->iov_buf + off, nob);
+		len -= nob;
+		off = 0;
+	}
+}
+
+static int
+bulk_complete_cb(const struct crt_bulk_cb_info *cb_info)
+{
+	struct ds_bulk_cb_args		*cb_args;
+	struct ds_bulk_async_args	*arg;
+	struct crt_bulk_desc		*bulk_desc;
+	crt_rpc_t			*rpc;
+	int				rc = 0;
+
+	rc = cb_info->bci_rc;
+	if (rc != 0)
+		D_ERROR("bulk transfer failed: rc = %d\n", rc);
+
+	bulk_desc = cb_info->bci_bulk_desc;
+	rpc = bulk_desc->bd_rpc;
+	cb_args = cb_info->bci_arg;
+	arg = cb_args->bca_async;
+
+	if (rc == 0 && !daos_handle_is_inval(cb_args->bca_ioh))
+		bulk_seg_persist(cb_args);
+
+	/**
+	 * Note: only one thread will access arg.result, so
+	 * it should be safe here.
+	 **/
+	if (arg->result == 0)
+		arg->result = rc;
+
+	D_ASSERT(arg->bulks_inflight > 0);
+	arg->bulks_inflight--;
+	if (arg->bulks_inflight == 0)
+		ABT_eventual_set(arg->eventual, &rc, sizeof(rc));
+
+	daos_scratch_free(cb_args->bca_scratch, cb_args);
+	crt_req_decref(rpc);
+	return rc;
+}
+
+int
+ds_bulk_seg_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
+		     crt_bulk_t remote_bulk, daos_off_t remote_off,
+		     crt_bulk_t local_bulk, daos_sg_list_t *sgl,
+		     daos_size_t length, daos_handle_t persist_ioh,
+		     struct daos_scratch *scr, struct ds_bulk_async_args *arg)
+{
+	crt_bulk_opid_t	bulk_opid;
+	daos_size_t	seg_size;
+	daos_off_t	seg_off;
+	int		rc;
+
+	seg_size = daos_handle_is_inval(persist_ioh) ?
+		   length : OBJ_BULK_SEG_SIZE;
+	for (seg_off = 0; seg_off < length; seg_off += seg_size) {
+		struct ds_bulk_cb_args	*cb_args;
+		struct crt_bulk_desc	 bulk_desc;
+
+		cb_args = daos_scratch_alloc(scr, sizeof(*cb_args));
+		if (cb_args == NULL)
+			return -DER_NOMEM;
+
+		cb_args->bca_async   = arg;
+		cb_args->bca_scratch = scr;
+		cb_args->bca_ioh     = persist_ioh;
+		cb_args->bca_iovs    = sgl->sg_iovs;
+		cb_args->bca_iov_nr  = sgl->sg_nr;
+		cb_args->bca_off     = seg_off;
+		cb_args->bca_len     = min(seg_size, length - seg_off);
+
+		crt_req_addref(rpc);
+
+		bulk_desc.bd_rpc	= rpc;
+		bulk_desc.bd_bulk_op	= bulk_op;
+		bulk_desc.bd_remote_hdl	= remote_bulk;
+		bulk_desc.bd_local_hdl	= local_bulk;
+		bulk_desc.bd_len	= cb_args->bca_len;
+		bulk_desc.bd_remote_off	= remote_off + seg_off;
+		bulk_desc.bd_local_off	= seg_off;
+
+		arg->bulks_inflight++;
+		rc = crt_bulk_transfer(&bulk_desc, bulk_complete_cb, cb_args,
+				       &bulk_opid);
+		if (rc < 0) {
+			D_ERROR("crt_bulk_transfer failed, rc: %d.\n", rc);
+			arg->bulks_inflight--;
+			daos_scratch_free(scr, cb_args);
+			crt_req_decref(rpc);
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Return the fetched data in the reply instead of bulk transfer, if it is
+ * not larger than the inline size of both client and server. Data of each
+ * sgl is packed into a single iov which mirrors the remote bulk, holes are
+ * zeroed. \a size returns the total size of the fetched data, the reply is
+ * allocated from \a scr.
+ */
+int
+ds_obj_fetch_inline(crt_rpc_t *rpc, daos_handle_t ioh,
+		    struct daos_scratch *scr, daos_size_t *size, bool *inlined)
+{
+	struct obj_rw_in	*orw = crt_req_get(rpc);
+	struct obj_rw_out	*orwo = crt_reply_get(rpc);
+	crt_bulk_t		*bulks = orw->orw_bulks.ca_arrays;
+	daos_sg_list_t		*sgls;
+	daos_iov_t		*iovs;
+	daos_size_t		 limit;
+	char			*buf;
+	int			 i;
+	int			 j;
+	int			 rc;
+
+	*size = 0;
+	*inlined = false;
+	for (i = 0; i < orw->orw_nr; i++) {
+		daos_sg_list_t *sgl;
+
+		if (bulks[i] == NULL)
+			continue;
+
+		rc = vos_obj_zc_sgl_at(ioh, i, &sgl);
+		if (rc != 0)
+			return rc;
+
+		for (j = 0; j < sgl->sg_nr_out; j++)
+			*size += sgl->sg_iovs[j].iov_len;
+	}
+
+	limit = min(orw->orw_inline_max, srv_inline_size);
+	if (*size == 0 || *size > limit || srv_bypass_bulk)
+		return 0;
+
+	sgls = daos_scratch_alloc(scr, orw->orw_nr * (sizeof(*sgls) +
+				  sizeof(*iovs)) + *size);
+	if (sgls == NULL)
+		return -DER_NOMEM;
+
+	iovs = (daos_iov_t *)&sgls[orw->orw_nr];
+	buf = (char *)&iovs[orw->orw_nr];
+	for (i = 0; i < orw->orw_nr; i++) {
+		daos_sg_list_t	*sgl;
+		daos_size_t	 len = 0;
+
+		sgls[i].sg_iovs = &iovs[i];
+		if (bulks[i] == NULL)
+			continue;
+
+		rc = vos_obj_zc_sgl_at(ioh, i, &sgl);
+		D_ASSERT(rc == 0);
+		for (j = 0; j < sgl->sg_nr_out; j++) {
+			daos_iov_t *iov = &sgl->sg_iovs[j];
+
+			/* NB: scratch memory has been zeroed for holes */
+			if (iov->iov_buf != NULL)
+				memcpy(buf + len, iov->iov_buf, iov->iov_len);
+			len += iov->iov_len;
+		}
+
+		if (len == 0)
+			continue;
+
+		daos_iov_set(&iovs[i], buf, len);
+		sgls[i].sg_nr = sgls[i].sg_nr_out = 1;
+		buf += len;
+	}
+
+	orwo->orw_sgls.ca_arrays = sgls;
+	orwo->orw_sgls.ca_count = orw->orw_nr;
+	*inlined = true;
+	return 0;
+}
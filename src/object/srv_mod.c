@@ -26,11 +26,45 @@
 #define D_LOGFAC	DD_FAC(object)
 
 #include <daos_srv/daos_server.h>
+#include <daos_srv/pool.h>
 #include <daos/rpc.h>
 #include "obj_rpc.h"
 #include "obj_internal.h"
 
 bool srv_bypass_bulk;
+unsigned int srv_inline_size = OBJ_INLINE_MAX;
+
+/**
+ * Zero-copy buffers of VOS are mapped by the pool, a cached bulk handle
+ * holds the pool child to keep the registered memory mapped, and it is
+ * evicted when the pool child is being closed.
+ */
+static void
+obj_bulk_pool_hold(void *domain)
+{
+	ds_pool_child_get(domain);
+}
+
+static void
+obj_bulk_pool_rele(void *domain)
+{
+	ds_pool_child_put(domain);
+}
+
+static struct obj_bulk_domain_ops obj_bulk_pool_ops = {
+	.bdo_hold	= obj_bulk_pool_hold,
+	.bdo_rele	= obj_bulk_pool_rele,
+};
+
+static void
+obj_bulk_pool_close(struct ds_pool_child *child)
+{
+	struct obj_tls *tls;
+
+	tls = dss_module_key_get(dss_tls_get(), &obj_module_key);
+	if (tls != NULL && tls->ot_bulk_cache != NULL)
+		obj_bulk_cache_evict(tls->ot_bulk_cache, child);
+}
 
 static int
 obj_mod_init(void)
@@ -43,14 +77,21 @@ obj_mod_init(void)
 		srv_bypass_bulk = true;
 	}
 
+	env = getenv(OBJ_INLINE_ENV);
+	if (env != NULL && atoi(env) >= 0)
+		srv_inline_size = min(atoi(env), OBJ_INLINE_MAX);
+	D_DEBUG(DB_IO, "Max inline fetch size %u\n", srv_inline_size);
+
 	dss_abt_pool_choose_cb_register(DAOS_OBJ_MODULE,
 					ds_obj_abt_pool_choose_cb);
+	ds_pool_child_close_cb_register(DAOS_OBJ_MODULE, obj_bulk_pool_close);
 	return 0;
 }
 
 static int
 obj_mod_fini(void)
 {
+	ds_pool_child_close_cb_register(DAOS_OBJ_MODULE, NULL);
 	return 0;
 }
 
@@ -92,6 +133,10 @@ static struct daos_rpc_handler obj_handlers[] = {
 		.dr_opc		= DAOS_OBJ_RPC_PUNCH_AKEYS,
 		.dr_hdlr	= ds_obj_punch_handler,
 	},
+	{
+		.dr_opc		= DAOS_OBJ_RPC_UPDATE_MULTI,
+		.dr_hdlr	= ds_obj_update_multi_handler,
+	},
 	{
 		.dr_opc		= 0
 	}
@@ -102,11 +147,44 @@ obj_tls_init(const struct dss_thread_local_storage *dtls,
 	     struct dss_module_key *key)
 {
 	struct obj_tls *tls;
+	int		rc;
 
 	D_ALLOC_PTR(tls);
+	if (tls == NULL)
+		return NULL;
+
+	daos_scratch_init(&tls->ot_scratch, DAOS_SCRATCH_CHUNK_SIZE,
+			  DAOS_SCRATCH_IDLE_MAX);
+
+	/* bulk transfer can go without the cache */
+	rc = obj_bulk_cache_create(OBJ_BULK_CACHE_BITS, false,
+				   &obj_bulk_pool_ops, &tls->ot_bulk_cache);
+	if (rc != 0) {
+		D_ERROR("Failed to create bulk cache: %d\n", rc);
+		tls->ot_bulk_cache = NULL;
+	}
 	return tls;
 }
 
+static void
+obj_io_hist_dump(const char *name, struct obj_io_hist *hist)
+{
+	int	i;
+
+	D_DEBUG(DB_IO, "%s: inline "DF_U64", bulk "DF_U64"\n", name,
+		hist->oh_inline, hist->oh_bulk);
+	for (i = 0; i < OBJ_IO_HIST_BUCKETS; i++) {
+		if (hist->oh_sizes[i] == 0)
+			continue;
+		if (i == OBJ_IO_HIST_BUCKETS - 1)
+			D_DEBUG(DB_IO, "%s: >=%uK "DF_U64"\n", name,
+				1U << (i - 1), hist->oh_sizes[i]);
+		else
+			D_DEBUG(DB_IO, "%s: <%uK "DF_U64"\n", name,
+				1U << i, hist->oh_sizes[i]);
+	}
+}
+
 static void
 obj_tls_fini(const struct dss_thread_local_storage *dtls,
 	     struct dss_module_key *key, void *data)
@@ -116,6 +194,13 @@ obj_tls_fini(const struct dss_thread_local_storage *dtls,
 	if (tls->ot_echo_sgl.sg_iovs != NULL)
 		daos_sgl_fini(&tls->ot_echo_sgl, true);
 
+	if (tls->ot_bulk_cache != NULL)
+		obj_bulk_cache_destroy(tls->ot_bulk_cache);
+
+	obj_io_hist_dump("update", &tls->ot_update_hist);
+	obj_io_hist_dump("fetch", &tls->ot_fetch_hist);
+
+	daos_scratch_fini(&tls->ot_scratch);
 	D_FREE_PTR(tls);
 }
 
@@ -46,6 +46,41 @@ obj_tls_get()
 	return dss_module_key_get(dss_tls_get(), &obj_module_key);
 }
 
+/**
+ * Release the reply arrays of fetch allocated from the scratch arena, it
+ * should be called after sending the reply.
+ */
+static void
+ds_obj_rw_reply_fini(crt_rpc_t *rpc)
+{
+	struct obj_rw_in	*orwi = crt_req_get(rpc);
+	struct obj_rw_out	*orwo = crt_reply_get(rpc);
+	struct daos_scratch	*scr = &obj_tls_get()->ot_scratch;
+
+	if (opc_get(rpc->cr_opc) != DAOS_OBJ_RPC_FETCH)
+		return;
+
+	if (orwo->orw_sizes.ca_arrays != NULL) {
+		daos_scratch_free(scr, orwo->orw_sizes.ca_arrays);
+		orwo->orw_sizes.ca_arrays = NULL;
+		orwo->orw_sizes.ca_count = 0;
+	}
+
+	if (orwo->orw_nrs.ca_arrays != NULL) {
+		daos_scratch_free(scr, orwo->orw_nrs.ca_arrays);
+		orwo->orw_nrs.ca_arrays = NULL;
+		orwo->orw_nrs.ca_count = 0;
+	}
+
+	/* inline reply of bulk fetch, see ds_obj_fetch_inline() */
+	if (orwi->orw_bulks.ca_count != 0 &&
+	    orwo->orw_sgls.ca_arrays != NULL) {
+		daos_scratch_free(scr, orwo->orw_sgls.ca_arrays);
+		orwo->orw_sgls.ca_arrays = NULL;
+		orwo->orw_sgls.ca_count = 0;
+	}
+}
+
 /**
  * After bulk finish, let's send reply, then release the resource.
  */
@@ -103,59 +138,46 @@ ds_obj_rw_complete(crt_rpc_t *rpc, struct ds_cont_hdl *cont_hdl,
 	if (rc != 0)
 		D_ERROR("send reply failed: %d\n", rc);
 
-	if (opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_FETCH) {
-		if (orwo->orw_sizes.ca_arrays != NULL) {
-			D_FREE(orwo->orw_sizes.ca_arrays);
-			orwo->orw_sizes.ca_count = 0;
-		}
-
-		if (orwo->orw_nrs.ca_arrays != NULL) {
-			D_FREE(orwo->orw_nrs.ca_arrays);
-			orwo->orw_nrs.ca_count = 0;
-		}
-	}
+	ds_obj_rw_reply_fini(rpc);
 }
 
-struct ds_bulk_async_args {
-	int		bulks_inflight;
-	ABT_eventual	eventual;
-	int		result;
-};
+static daos_size_t
+obj_sgls_data_len(daos_sg_list_t *sgls, int nr)
+{
+	daos_size_t	len = 0;
+	int		i;
 
-static int
-bulk_complete_cb(const struct crt_bulk_cb_info *cb_info)
+	for (i = 0; sgls != NULL && i < nr; i++)
+		len += daos_sgl_data_len(&sgls[i]);
+	return len;
+}
+
+static void
+obj_io_hist_add(struct obj_io_hist *hist, daos_size_t size, bool inlined)
 {
-	struct ds_bulk_async_args	*arg;
-	struct crt_bulk_desc		*bulk_desc;
-	crt_rpc_t			*rpc;
-	crt_bulk_t			local_bulk_hdl;
-	int				rc = 0;
+	int	bucket = 0;
 
-	rc = cb_info->bci_rc;
-	if (rc != 0)
-		D_ERROR("bulk transfer failed: rc = %d\n", rc);
-
-	bulk_desc = cb_info->bci_bulk_desc;
-	local_bulk_hdl = bulk_desc->bd_local_hdl;
-	rpc = bulk_desc->bd_rpc;
-	arg = (struct ds_bulk_async_args *)cb_info->bci_arg;
-	/**
-	 * Note: only one thread will access arg.result, so
-	 * it should be safe here.
-	 **/
-	if (arg->result == 0)
-		arg->result = rc;
-
-	D_ASSERT(arg->bulks_inflight > 0);
-	arg->bulks_inflight--;
-	if (arg->bulks_inflight == 0)
-		ABT_eventual_set(arg->eventual, &rc, sizeof(rc));
-
-	crt_bulk_free(local_bulk_hdl);
-	crt_req_decref(rpc);
-	return rc;
+	if (size >= 1024) {
+		/* floor(log2(size)) - 9 */
+		bucket = 63 - __builtin_clzll(size) - 9;
+		if (bucket >= OBJ_IO_HIST_BUCKETS)
+			bucket = OBJ_IO_HIST_BUCKETS - 1;
+	}
+	hist->oh_sizes[bucket]++;
+	if (inlined)
+		hist->oh_inline++;
+	else
+		hist->oh_bulk++;
 }
 
+/** local bulk handle of a contiguous run of buffers */
+struct ds_bulk_local {
+	d_list_t		 bl_link;
+	crt_bulk_t		 bl_hdl;
+	/** cache entry of the handle, NULL if it's not cached */
+	struct obj_bulk_ent	*bl_ent;
+};
+
 /**
  * Simulate bulk transfer by memcpy, all data are actually dropped.
  */
@@ -197,19 +219,39 @@ bulk_bypass(daos_sg_list_t *sgl, crt_bulk_op_t bulk_op)
 	return 0;
 }
 
+/**
+ * Transfer data between the remote bulks and local buffers. Registered
+ * handles of contiguous buffers owned by the pool \a pool_child are cached
+ * by the xstream, the local handles are always created on the fly if it
+ * is NULL.
+ *
+ * Buffers of zero-copy update are transferred in segments of
+ * OBJ_BULK_SEG_SIZE, each segment is persisted as soon as it arrives, so
+ * persistence of a segment overlaps with transfer of the next ones.
+ */
 static int
 ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 		 crt_bulk_t *remote_bulks, daos_handle_t ioh,
-		 daos_sg_list_t **sgls, int sgl_nr)
+		 daos_sg_list_t **sgls, int sgl_nr,
+		 struct ds_pool_child *pool_child)
 {
-	crt_bulk_opid_t		bulk_opid;
+	struct obj_tls		*tls = obj_tls_get();
+	struct obj_bulk_cache	*cache;
+	struct ds_bulk_local	*local;
+	struct ds_bulk_local	*tmp;
 	crt_bulk_perm_t		bulk_perm;
 	struct ds_bulk_async_args arg = { 0 };
+	daos_handle_t		persist_ioh = DAOS_HDL_INVAL;
 	int			i;
 	int			rc;
 	int			*status;
 
 	bulk_perm = bulk_op == CRT_BULK_PUT ? CRT_BULK_RO : CRT_BULK_RW;
+	cache = pool_child != NULL ? tls->ot_bulk_cache : NULL;
+	if (bulk_op == CRT_BULK_GET && sgls == NULL)
+		persist_ioh = ioh;
+
+	D_INIT_LIST_HEAD(&arg.locals);
 	rc = ABT_eventual_create(sizeof(*status), &arg.eventual);
 	if (rc != 0)
 		return dss_abterr2der(rc);
@@ -217,8 +259,6 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 	D_DEBUG(DB_IO, "sgl nr is %d\n", sgl_nr);
 	for (i = 0; i < sgl_nr; i++) {
 		daos_sg_list_t		*sgl;
-		struct crt_bulk_desc	 bulk_desc;
-		crt_bulk_t		 local_bulk_hdl;
 		int			 ret = 0;
 		daos_size_t		 offset = 0;
 		unsigned int		 idx = 0;
@@ -288,40 +328,36 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 			sgl_sent.sg_nr = idx - start;
 			sgl_sent.sg_nr_out = idx - start;
 
-			ret = crt_bulk_create(rpc->cr_ctx,
-					      daos2crt_sg(&sgl_sent),
-					      bulk_perm, &local_bulk_hdl);
-			if (ret != 0) {
-				D_ERROR("crt_bulk_create %d failed;rc: %d\n",
-					 i, ret);
+			local = daos_scratch_alloc(&tls->ot_scratch,
+						   sizeof(*local));
+			if (local == NULL) {
 				if (rc == 0)
-					rc = ret;
+					rc = -DER_NOMEM;
 				offset += length;
 				continue;
 			}
 
-			crt_req_addref(rpc);
-
-			bulk_desc.bd_rpc	= rpc;
-			bulk_desc.bd_bulk_op	= bulk_op;
-			bulk_desc.bd_remote_hdl	= remote_bulks[i];
-			bulk_desc.bd_local_hdl	= local_bulk_hdl;
-			bulk_desc.bd_len	= length;
-			bulk_desc.bd_remote_off	= offset;
-			bulk_desc.bd_local_off	= 0;
-
-			arg.bulks_inflight++;
-			ret = crt_bulk_transfer(&bulk_desc, bulk_complete_cb,
-						&arg, &bulk_opid);
-			if (ret < 0) {
-				D_ERROR("crt_bulk_transfer failed, rc: %d.\n",
-					ret);
-				arg.bulks_inflight--;
-				crt_bulk_free(local_bulk_hdl);
-				crt_req_decref(rpc);
+			ret = obj_bulk_get(cache, rpc->cr_ctx, &sgl_sent,
+					   bulk_perm, pool_child,
+					   &local->bl_hdl, &local->bl_ent);
+			if (ret != 0) {
+				D_ERROR("crt_bulk_create %d failed;rc: %d\n",
+					 i, ret);
+				daos_scratch_free(&tls->ot_scratch, local);
 				if (rc == 0)
 					rc = ret;
+				offset += length;
+				continue;
 			}
+			d_list_add_tail(&local->bl_link, &arg.locals);
+
+			ret = ds_bulk_seg_transfer(rpc, bulk_op,
+						   remote_bulks[i], offset,
+						   local->bl_hdl, &sgl_sent,
+						   length, persist_ioh,
+						   &tls->ot_scratch, &arg);
+			if (ret != 0 && rc == 0)
+				rc = ret;
 			offset += length;
 		}
 	}
@@ -338,6 +374,11 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 	if (rc == 0)
 		rc = arg.result;
 out_eventual:
+	d_list_for_each_entry_safe(local, tmp, &arg.locals, bl_link) {
+		d_list_del(&local->bl_link);
+		obj_bulk_put(cache, local->bl_hdl, local->bl_ent);
+		daos_scratch_free(&tls->ot_scratch, local);
+	}
 	ABT_eventual_free(&arg.eventual);
 	return rc;
 }
@@ -389,7 +430,8 @@ ds_obj_update_sizes_in_reply(crt_rpc_t *rpc)
 	size_count = orw->orw_iods.ca_count;
 
 	orwo->orw_sizes.ca_count = size_count;
-	D_ALLOC(sizes, size_count * sizeof(*sizes));
+	sizes = daos_scratch_alloc(&obj_tls_get()->ot_scratch,
+				   size_count * sizeof(*sizes));
 	if (sizes == NULL)
 		return -DER_NOMEM;
 
@@ -423,13 +465,12 @@ ds_obj_update_nrs_in_reply(crt_rpc_t *rpc, daos_handle_t ioh,
 
 	/* return num_out for sgl */
 	orwo->orw_nrs.ca_count = nrs_count;
-	D_ALLOC(orwo->orw_nrs.ca_arrays,
-		nrs_count * sizeof(uint32_t));
-
-	if (orwo->orw_nrs.ca_arrays == NULL)
+	nrs = daos_scratch_alloc(&obj_tls_get()->ot_scratch,
+				 nrs_count * sizeof(*nrs));
+	if (nrs == NULL)
 		D_GOTO(out, rc = -DER_NOMEM);
 
-	nrs = orwo->orw_nrs.ca_arrays;
+	orwo->orw_nrs.ca_arrays = nrs;
 	for (i = 0; i < nrs_count; i++) {
 		daos_sg_list_t	*sgl;
 
@@ -624,7 +665,7 @@ ds_obj_rw_echo_handler(crt_rpc_t *rpc)
 	}
 
 	rc = ds_bulk_transfer(rpc, bulk_op, orw->orw_bulks.ca_arrays,
-			      DAOS_HDL_INVAL, &p_sgl, orw->orw_nr);
+			      DAOS_HDL_INVAL, &p_sgl, orw->orw_nr, NULL);
 
 out:
 	orwo->orw_ret = rc;
@@ -632,6 +673,8 @@ out:
 	rc = crt_reply_send(rpc);
 	if (rc != 0)
 		D_ERROR("send reply failed: %d\n", rc);
+
+	ds_obj_rw_reply_fini(rpc);
 }
 
 void
@@ -643,6 +686,8 @@ ds_obj_rw_handler(crt_rpc_t *rpc)
 	daos_handle_t		ioh = DAOS_HDL_INVAL;
 	crt_bulk_op_t		bulk_op;
 	uint32_t		map_version = 0;
+	daos_size_t		size;
+	bool			inlined;
 	int			rc;
 
 	orw = crt_req_get(rpc);
@@ -675,13 +720,30 @@ ds_obj_rw_handler(crt_rpc_t *rpc)
 		DP_UOID(orw->orw_oid), dss_get_module_info()->dmi_tid);
 	/* Inline update/fetch */
 	if (orw->orw_bulks.ca_arrays == NULL && orw->orw_bulks.ca_count == 0) {
+		struct obj_tls		*tls = obj_tls_get();
+		struct obj_rw_out	*orwo = crt_reply_get(rpc);
+
 		rc = ds_obj_rw_inline(rpc, cont, cont_hdl->sch_uuid,
 				      map_version);
+		/* size of the data sent, not of the fetch buffers */
+		if (opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_UPDATE) {
+			size = obj_sgls_data_len(orw->orw_sgls.ca_arrays,
+						 orw->orw_sgls.ca_count);
+			obj_io_hist_add(&tls->ot_update_hist, size, true);
+		} else {
+			size = obj_sgls_data_len(orwo->orw_sgls.ca_arrays,
+						 orwo->orw_sgls.ca_count);
+			obj_io_hist_add(&tls->ot_fetch_hist, size, true);
+		}
 		D_GOTO(out, rc);
 	}
 
 	/* bulk update/fetch */
 	if (opc_get(rpc->cr_opc) == DAOS_OBJ_RPC_UPDATE) {
+		obj_io_hist_add(&obj_tls_get()->ot_update_hist,
+				daos_iods_len(orw->orw_iods.ca_arrays,
+					      orw->orw_nr), false);
+
 		rc = vos_obj_zc_update_begin(cont->sc_hdl,
 					     orw->orw_oid, orw->orw_epoch,
 					     &orw->orw_dkey, orw->orw_nr,
@@ -714,17 +776,26 @@ ds_obj_rw_handler(crt_rpc_t *rpc)
 		if (rc != 0)
 			D_GOTO(out, rc);
 
-		/* no in_line transfer */
 		orwo->orw_sgls.ca_count = 0;
 		orwo->orw_sgls.ca_arrays = NULL;
 
 		rc = ds_obj_update_nrs_in_reply(rpc, ioh, NULL);
 		if (rc != 0)
 			D_GOTO(out, rc);
+
+		/* small data can go with the reply, no bulk round trip */
+		rc = ds_obj_fetch_inline(rpc, ioh, &obj_tls_get()->ot_scratch,
+					 &size, &inlined);
+		if (rc != 0)
+			D_GOTO(out, rc);
+
+		obj_io_hist_add(&obj_tls_get()->ot_fetch_hist, size, inlined);
+		if (inlined)
+			D_GOTO(out, rc);
 	}
 
 	rc = ds_bulk_transfer(rpc, bulk_op, orw->orw_bulks.ca_arrays,
-			      ioh, NULL, orw->orw_nr);
+			      ioh, NULL, orw->orw_nr, cont_hdl->sch_pool);
 out:
 	ds_obj_rw_complete(rpc, cont_hdl, ioh, rc, map_version);
 	if (cont_hdl) {
@@ -734,6 +805,156 @@ out:
 	}
 }
 
+static inline bool
+obj_update_ent_same_obj(struct obj_update_ent *a, struct obj_update_ent *b)
+{
+	return a->oue_oid.id_pub.lo == b->oue_oid.id_pub.lo &&
+	       a->oue_oid.id_pub.hi == b->oue_oid.id_pub.hi &&
+	       a->oue_oid.id_shard == b->oue_oid.id_shard;
+}
+
+/**
+ * Apply \a nr coalesced updates of the same object by one VOS transaction.
+ * If the transaction fails, updates are applied one by one so that only
+ * the failed ones are reported to client.
+ */
+static void
+ds_obj_update_group(struct ds_cont_hdl *cont_hdl, struct ds_cont *cont,
+		    daos_epoch_t epoch, uint32_t map_version,
+		    struct obj_update_ent *ents, unsigned int nr,
+		    vos_dkey_io_t *dios, int32_t *rets)
+{
+	int	i;
+	int	rc;
+
+	if (nr > 1) {
+		for (i = 0; i < nr; i++) {
+			dios[i].dio_dkey	= ents[i].oue_dkey;
+			dios[i].dio_iod_nr	= ents[i].oue_nr;
+			dios[i].dio_iods	= ents[i].oue_iods;
+			dios[i].dio_sgls	= ents[i].oue_sgls;
+		}
+
+		rc = vos_obj_update_multi(cont->sc_hdl, ents[0].oue_oid,
+					  epoch, cont_hdl->sch_uuid,
+					  map_version, nr, dios);
+		if (rc == 0) {
+			memset(rets, 0, nr * sizeof(*rets));
+			return;
+		}
+		D_DEBUG(DB_IO, DF_UOID" %u coalesced updates failed: %d, "
+			"apply them one by one\n", DP_UOID(ents[0].oue_oid),
+			nr, rc);
+	}
+
+	for (i = 0; i < nr; i++) {
+		struct obj_update_ent *ent = &ents[i];
+
+		rets[i] = vos_obj_update(cont->sc_hdl, ent->oue_oid, epoch,
+					 cont_hdl->sch_uuid, map_version,
+					 &ent->oue_dkey, ent->oue_nr,
+					 ent->oue_iods, ent->oue_sgls);
+		if (rets[i] != 0)
+			D_ERROR(DF_UOID" coalesced update failed: %d\n",
+				DP_UOID(ent->oue_oid), rets[i]);
+	}
+}
+
+/**
+ * Apply the small updates coalesced by client. Consecutive updates of the
+ * same object are applied by one VOS transaction, a failed transaction
+ * falls back to per-update transactions so that a failed update doesn't
+ * abort the others, and the status of each update is returned to client.
+ */
+void
+ds_obj_update_multi_handler(crt_rpc_t *rpc)
+{
+	struct obj_update_multi_in	*oumi;
+	struct obj_update_multi_out	*oumo;
+	struct obj_update_ent		*ents;
+	struct ds_cont_hdl		*cont_hdl = NULL;
+	struct ds_cont			*cont = NULL;
+	vos_dkey_io_t			*dios = NULL;
+	int32_t				*rets = NULL;
+	uint32_t			 map_version = 0;
+	int				 nr;
+	int				 i;
+	int				 j;
+	int				 rc;
+
+	oumi = crt_req_get(rpc);
+	D_ASSERT(oumi != NULL);
+	oumo = crt_reply_get(rpc);
+	D_ASSERT(oumo != NULL);
+
+	rc = ds_check_container(oumi->oum_co_hdl, oumi->oum_co_uuid,
+				&cont_hdl, &cont);
+	if (rc)
+		D_GOTO(out, rc);
+
+	if (!(cont_hdl->sch_capas & DAOS_COO_RW)) {
+		D_ERROR("cont "DF_UUID" sch_capas "DF_U64", "
+			"NO_PERM to update.\n",
+			DP_UUID(oumi->oum_co_uuid), cont_hdl->sch_capas);
+		D_GOTO(out, rc = -DER_NO_PERM);
+	}
+
+	D_ASSERT(cont_hdl->sch_pool != NULL);
+	map_version = cont_hdl->sch_pool->spc_map_version;
+	if (oumi->oum_map_ver < map_version) {
+		D_DEBUG(DB_IO, "stale version req %d map_version %d\n",
+			oumi->oum_map_ver, map_version);
+	}
+
+	nr = oumi->oum_ents.ca_count;
+	D_ALLOC(rets, nr * sizeof(*rets));
+	if (rets == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	D_ALLOC(dios, nr * sizeof(*dios));
+	if (dios == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	D_DEBUG(DB_TRACE, "%d updates tag %d\n", nr,
+		dss_get_module_info()->dmi_tid);
+
+	ents = oumi->oum_ents.ca_arrays;
+	for (i = 0; i < nr; i = j) {
+		for (j = i + 1; j < nr; j++) {
+			if (!obj_update_ent_same_obj(&ents[i], &ents[j]))
+				break;
+		}
+
+		ds_obj_update_group(cont_hdl, cont, oumi->oum_epoch,
+				    map_version, &ents[i], j - i, dios,
+				    &rets[i]);
+	}
+
+	for (i = 0; i < nr; i++)
+		obj_io_hist_add(&obj_tls_get()->ot_update_hist,
+				daos_sgls_buf_len(ents[i].oue_sgls,
+						  ents[i].oue_nr), true);
+
+	oumo->oum_rets.ca_count = oumi->oum_ents.ca_count;
+	oumo->oum_rets.ca_arrays = rets;
+out:
+	obj_reply_set_status(rpc, rc);
+	obj_reply_map_version_set(rpc, map_version);
+	rc = crt_reply_send(rpc);
+	if (rc != 0)
+		D_ERROR("send reply failed: %d\n", rc);
+
+	if (dios != NULL)
+		D_FREE(dios);
+	if (rets != NULL)
+		D_FREE(rets);
+	if (cont_hdl) {
+		if (!cont_hdl->sch_cont)
+			ds_cont_put(cont); /* -1 for rebuild container */
+		ds_cont_hdl_put(cont_hdl);
+	}
+}
+
 static void
 ds_eu_complete(crt_rpc_t *rpc, int status, struct ds_iter_arg *arg)
 {
@@ -1215,7 +1436,7 @@ obj_enum_reply_bulk(crt_rpc_t *rpc)
 		return 0;
 
 	rc = ds_bulk_transfer(rpc, CRT_BULK_PUT, bulks, DAOS_HDL_INVAL,
-			      sgls, idx);
+			      sgls, idx, NULL);
 
 	if (oei->oei_kds_bulk) {
 		D_FREE(oeo->oeo_kds.ca_arrays);
@@ -0,0 +1,312 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+#define D_LOGFAC	DD_FAC(tests)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <daos/common.h>
+#include <daos/rpc.h>
+#include "../obj_internal.h"
+
+/*
+ * Unit tests of the bulk handle cache. Registration is emulated by
+ * crt_bulk_create() which counts the handles being created and freed.
+ */
+
+#define UT_BUF_SIZE	4096
+
+struct ut_domain {
+	int	ud_ref;
+};
+
+static int			 ut_bulk_created;
+static int			 ut_bulk_live;
+static char			 ut_buf[4][UT_BUF_SIZE];
+static struct ut_domain		 ut_domains[2];
+static struct obj_bulk_cache	*ut_cache;
+static crt_context_t		 ut_ctx = (crt_context_t)0x1;
+
+int
+crt_bulk_create(crt_context_t crt_ctx, d_sg_list_t *sgl,
+		crt_bulk_perm_t bulk_perm, crt_bulk_t *bulk_hdl)
+{
+	int *hdl;
+
+	D_ALLOC_PTR(hdl);
+	if (hdl == NULL)
+		return -DER_NOMEM;
+
+	ut_bulk_created++;
+	ut_bulk_live++;
+	*bulk_hdl = hdl;
+	return 0;
+}
+
+int
+crt_bulk_free(crt_bulk_t bulk_hdl)
+{
+	assert_true(ut_bulk_live > 0);
+	ut_bulk_live--;
+	D_FREE_PTR((int *)bulk_hdl);
+	return 0;
+}
+
+static void
+ut_domain_hold(void *domain)
+{
+	((struct ut_domain *)domain)->ud_ref++;
+}
+
+static void
+ut_domain_rele(void *domain)
+{
+	struct ut_domain *dom = domain;
+
+	assert_true(dom->ud_ref > 0);
+	dom->ud_ref--;
+}
+
+static struct obj_bulk_domain_ops ut_domain_ops = {
+	.bdo_hold	= ut_domain_hold,
+	.bdo_rele	= ut_domain_rele,
+};
+
+static void
+ut_sgl_init(daos_sg_list_t *sgl, daos_iov_t *iovs, int nr, int buf,
+	    daos_size_t len)
+{
+	int	i;
+
+	for (i = 0; i < nr; i++)
+		daos_iov_set(&iovs[i], ut_buf[buf + i], len);
+	sgl->sg_nr = nr;
+	sgl->sg_nr_out = nr;
+	sgl->sg_iovs = iovs;
+}
+
+/* get a handle of \a len bytes of ut_buf[buf] */
+static struct obj_bulk_ent *
+ut_get(int buf, daos_size_t len, crt_bulk_perm_t perm, void *domain,
+       crt_bulk_t *hdl)
+{
+	struct obj_bulk_ent	*ent;
+	daos_sg_list_t		 sgl;
+	daos_iov_t		 iov;
+	int			 rc;
+
+	ut_sgl_init(&sgl, &iov, 1, buf, len);
+	rc = obj_bulk_get(ut_cache, ut_ctx, &sgl, perm, domain, hdl, &ent);
+	assert_int_equal(rc, 0);
+	assert_non_null(ent);
+	return ent;
+}
+
+static int
+ut_setup(void **state)
+{
+	ut_bulk_created = 0;
+	ut_bulk_live = 0;
+	memset(ut_domains, 0, sizeof(ut_domains));
+	return obj_bulk_cache_create(4, false, &ut_domain_ops, &ut_cache);
+}
+
+static int
+ut_teardown(void **state)
+{
+	obj_bulk_cache_destroy(ut_cache);
+	ut_cache = NULL;
+
+	/* all registrations and domain references are dropped */
+	assert_int_equal(ut_bulk_live, 0);
+	assert_int_equal(ut_domains[0].ud_ref, 0);
+	assert_int_equal(ut_domains[1].ud_ref, 0);
+	return 0;
+}
+
+/* The same buffer reuses the registration, busy or idle */
+static void
+ut_bulk_hit(void **state)
+{
+	struct obj_bulk_ent	*ent1;
+	struct obj_bulk_ent	*ent2;
+	crt_bulk_t		 hdl1;
+	crt_bulk_t		 hdl2;
+
+	ent1 = ut_get(0, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[0], &hdl1);
+	ent2 = ut_get(0, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[0], &hdl2);
+	assert_ptr_equal(ent1, ent2);
+	assert_ptr_equal(hdl1, hdl2);
+	assert_int_equal(ut_bulk_created, 1);
+	/* one domain reference for the cached handle */
+	assert_int_equal(ut_domains[0].ud_ref, 1);
+
+	obj_bulk_put(ut_cache, hdl1, ent1);
+	obj_bulk_put(ut_cache, hdl2, ent2);
+	assert_int_equal(ut_bulk_live, 1);
+
+	/* hit the idle entry */
+	ent1 = ut_get(0, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[0], &hdl1);
+	assert_ptr_equal(hdl1, hdl2);
+	assert_int_equal(ut_bulk_created, 1);
+	obj_bulk_put(ut_cache, hdl1, ent1);
+}
+
+/* Any difference of address, length, permission or domain is a miss */
+static void
+ut_bulk_miss(void **state)
+{
+	struct obj_bulk_ent	*ents[5];
+	crt_bulk_t		 hdls[5];
+	int			 i;
+	int			 j;
+
+	ents[0] = ut_get(0, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[0],
+			 &hdls[0]);
+	ents[1] = ut_get(1, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[0],
+			 &hdls[1]);
+	ents[2] = ut_get(0, UT_BUF_SIZE / 2, CRT_BULK_RW, &ut_domains[0],
+			 &hdls[2]);
+	ents[3] = ut_get(0, UT_BUF_SIZE, CRT_BULK_RO, &ut_domains[0],
+			 &hdls[3]);
+	ents[4] = ut_get(0, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[1],
+			 &hdls[4]);
+
+	assert_int_equal(ut_bulk_created, 5);
+	for (i = 0; i < 5; i++) {
+		for (j = i + 1; j < 5; j++)
+			assert_ptr_not_equal(hdls[i], hdls[j]);
+	}
+	assert_int_equal(ut_domains[0].ud_ref, 4);
+	assert_int_equal(ut_domains[1].ud_ref, 1);
+
+	for (i = 0; i < 5; i++)
+		obj_bulk_put(ut_cache, hdls[i], ents[i]);
+	assert_int_equal(ut_bulk_live, 5);
+}
+
+/*
+ * Evicting a domain drops its idle handles at once and its busy handles
+ * on the last put, handles of other domains are kept.
+ */
+static void
+ut_bulk_evict_domain(void **state)
+{
+	struct obj_bulk_ent	*busy;
+	struct obj_bulk_ent	*ent;
+	crt_bulk_t		 busy_hdl;
+	crt_bulk_t		 hdl;
+	crt_bulk_t		 other_hdl;
+
+	ent = ut_get(0, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[0], &hdl);
+	obj_bulk_put(ut_cache, hdl, ent);
+	busy = ut_get(1, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[0], &busy_hdl);
+	ent = ut_get(2, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[1], &other_hdl);
+	obj_bulk_put(ut_cache, other_hdl, ent);
+	assert_int_equal(ut_bulk_live, 3);
+	assert_int_equal(ut_domains[0].ud_ref, 2);
+
+	obj_bulk_cache_evict(ut_cache, &ut_domains[0]);
+	/* the idle handle is gone, the busy one is still usable */
+	assert_int_equal(ut_bulk_live, 2);
+	assert_int_equal(ut_domains[0].ud_ref, 1);
+
+	obj_bulk_put(ut_cache, busy_hdl, busy);
+	assert_int_equal(ut_bulk_live, 1);
+	assert_int_equal(ut_domains[0].ud_ref, 0);
+
+	/* the other domain still hits */
+	ent = ut_get(2, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[1], &hdl);
+	assert_ptr_equal(hdl, other_hdl);
+	assert_int_equal(ut_bulk_created, 3);
+	obj_bulk_put(ut_cache, hdl, ent);
+
+	/* the evicted buffer has to be registered again */
+	ent = ut_get(0, UT_BUF_SIZE, CRT_BULK_RW, &ut_domains[0], &hdl);
+	assert_int_equal(ut_bulk_created, 4);
+	assert_int_equal(ut_domains[0].ud_ref, 1);
+	obj_bulk_put(ut_cache, hdl, ent);
+}
+
+/* Multi-iov buffers are never cached nor hold their domain */
+static void
+ut_bulk_multi_iov(void **state)
+{
+	struct obj_bulk_ent	*ent;
+	daos_sg_list_t		 sgl;
+	daos_iov_t		 iovs[2];
+	crt_bulk_t		 hdl;
+	int			 i;
+	int			 rc;
+
+	ut_sgl_init(&sgl, iovs, 2, 0, UT_BUF_SIZE);
+	for (i = 0; i < 2; i++) {
+		rc = obj_bulk_get(ut_cache, ut_ctx, &sgl, CRT_BULK_RW,
+				  &ut_domains[0], &hdl, &ent);
+		assert_int_equal(rc, 0);
+		assert_null(ent);
+		assert_int_equal(ut_bulk_created, i + 1);
+		assert_int_equal(ut_bulk_live, 1);
+		assert_int_equal(ut_domains[0].ud_ref, 0);
+
+		obj_bulk_put(ut_cache, hdl, ent);
+		assert_int_equal(ut_bulk_live, 0);
+	}
+
+	/* so is any buffer without a cache */
+	ut_sgl_init(&sgl, iovs, 1, 0, UT_BUF_SIZE);
+	rc = obj_bulk_get(NULL, ut_ctx, &sgl, CRT_BULK_RW, &ut_domains[0],
+			  &hdl, &ent);
+	assert_int_equal(rc, 0);
+	assert_null(ent);
+	obj_bulk_put(NULL, hdl, ent);
+	assert_int_equal(ut_bulk_created, 3);
+	assert_int_equal(ut_bulk_live, 0);
+}
+
+static const struct CMUnitTest bulk_uts[] = {
+	cmocka_unit_test_setup_teardown(ut_bulk_hit, ut_setup, ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_bulk_miss, ut_setup, ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_bulk_evict_domain, ut_setup,
+					ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_bulk_multi_iov, ut_setup,
+					ut_teardown),
+};
+
+int
+main(int argc, char **argv)
+{
+	int rc;
+
+	rc = daos_debug_init(NULL);
+	if (rc != 0)
+		return rc;
+
+	rc = cmocka_run_group_tests_name("Object bulk cache unit tests",
+					 bulk_uts, NULL, NULL);
+	daos_debug_fini();
+	return rc;
+}
@@ -0,0 +1,627 @@
+/**
+ * (C) Copyright 2019 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+#define D_LOGFAC	DD_FAC(tests)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <daos/common.h>
+#include <daos/rpc.h>
+#include <daos_srv/vos.h>
+#include "../obj_rpc.h"
+#include "../obj_internal.h"
+
+/*
+ * Unit tests of the segmented bulk transfer. crt_bulk_transfer() records
+ * the issued segments, they are completed by the test in any order, and
+ * vos_obj_zc_persist() records the persisted ranges.
+ *
+ * Inline reply of bulk fetch is packed from the sgls returned by
+ * vos_obj_zc_sgl_at(), and unpacked by the client helper.
+ */
+
+#define UT_SEG_MAX	8
+#define UT_BUF_SIZE	(4 * OBJ_BULK_SEG_SIZE)
+
+struct ut_seg {
+	struct crt_bulk_desc	 us_desc;
+	crt_bulk_cb_t		 us_cb;
+	void			*us_arg;
+};
+
+struct ut_range {
+	char		*ur_addr;
+	daos_size_t	 ur_len;
+};
+
+static char			 ut_buf[UT_BUF_SIZE];
+static struct ut_seg		 ut_segs[UT_SEG_MAX];
+static int			 ut_seg_nr;
+static struct ut_range		 ut_persisted[UT_SEG_MAX * 2];
+static int			 ut_persisted_nr;
+/* fail the transfer of this segment synchronously, -1 for none */
+static int			 ut_fail_seg;
+static int			 ut_rpc_ref;
+static int			 ut_eventual_set;
+static int			 ut_eventual_rc;
+static struct daos_scratch	 ut_scratch;
+static crt_rpc_t		 ut_rpc;
+static daos_handle_t		 ut_ioh = { .cookie = 1 };
+static crt_bulk_t		 ut_remote = (crt_bulk_t)0x1;
+static crt_bulk_t		 ut_local = (crt_bulk_t)0x2;
+static daos_sg_list_t		*ut_zc_sgls;
+static unsigned int		 ut_zc_nr;
+static daos_iov_t		 ut_zc_iovs[4];
+static daos_sg_list_t		 ut_zc_sgl_arr[3];
+static crt_bulk_t		 ut_fetch_bulks[3];
+static struct obj_rw_in		 ut_orw;
+static struct obj_rw_out	 ut_orwo;
+
+/* defined by srv_mod.c */
+unsigned int			 srv_inline_size = OBJ_INLINE_MAX;
+bool				 srv_bypass_bulk;
+
+/* the handle cache of obj_bulk.c is not used by these tests */
+int
+crt_bulk_create(crt_context_t crt_ctx, d_sg_list_t *sgl,
+		crt_bulk_perm_t bulk_perm, crt_bulk_t *bulk_hdl)
+{
+	fail();
+	return -DER_INVAL;
+}
+
+int
+crt_bulk_free(crt_bulk_t bulk_hdl)
+{
+	fail();
+	return -DER_INVAL;
+}
+
+int
+crt_bulk_transfer(struct crt_bulk_desc *bulk_desc, crt_bulk_cb_t complete_cb,
+		  void *arg, crt_bulk_opid_t *opid)
+{
+	if (ut_seg_nr == ut_fail_seg)
+		return -DER_HG;
+
+	assert_true(ut_seg_nr < UT_SEG_MAX);
+	ut_segs[ut_seg_nr].us_desc = *bulk_desc;
+	ut_segs[ut_seg_nr].us_cb = complete_cb;
+	ut_segs[ut_seg_nr].us_arg = arg;
+	ut_seg_nr++;
+	return 0;
+}
+
+int
+crt_req_addref(crt_rpc_t *req)
+{
+	assert_ptr_equal(req, &ut_rpc);
+	ut_rpc_ref++;
+	return 0;
+}
+
+int
+crt_req_decref(crt_rpc_t *req)
+{
+	assert_ptr_equal(req, &ut_rpc);
+	assert_true(ut_rpc_ref > 0);
+	ut_rpc_ref--;
+	return 0;
+}
+
+void
+vos_obj_zc_persist(daos_handle_t ioh, void *addr, daos_size_t size)
+{
+	assert_int_equal(ioh.cookie, ut_ioh.cookie);
+	assert_true(ut_persisted_nr < UT_SEG_MAX * 2);
+	ut_persisted[ut_persisted_nr].ur_addr = addr;
+	ut_persisted[ut_persisted_nr].ur_len = size;
+	ut_persisted_nr++;
+}
+
+int
+vos_obj_zc_sgl_at(daos_handle_t ioh, unsigned int idx, daos_sg_list_t **sgl_pp)
+{
+	assert_int_equal(ioh.cookie, ut_ioh.cookie);
+	if (idx >= ut_zc_nr)
+		return -DER_INVAL;
+
+	*sgl_pp = &ut_zc_sgls[idx];
+	return 0;
+}
+
+int
+ABT_eventual_set(ABT_eventual eventual, void *value, int nbytes)
+{
+	assert_int_equal(nbytes, sizeof(int));
+	ut_eventual_set++;
+	ut_eventual_rc = *(int *)value;
+	return 0;
+}
+
+static void
+ut_seg_complete(int seg, int rc)
+{
+	struct crt_bulk_cb_info	info = { 0 };
+
+	info.bci_bulk_desc = &ut_segs[seg].us_desc;
+	info.bci_arg = ut_segs[seg].us_arg;
+	info.bci_rc = rc;
+	ut_segs[seg].us_cb(&info);
+}
+
+/* three iovs of 1.5M, 1M and 1M, 3.5M is split into four segments */
+static void
+ut_sgl_init(daos_sg_list_t *sgl, daos_iov_t *iovs)
+{
+	daos_iov_set(&iovs[0], ut_buf, OBJ_BULK_SEG_SIZE * 3 / 2);
+	daos_iov_set(&iovs[1], ut_buf + OBJ_BULK_SEG_SIZE * 2,
+		     OBJ_BULK_SEG_SIZE);
+	daos_iov_set(&iovs[2], ut_buf + OBJ_BULK_SEG_SIZE * 3,
+		     OBJ_BULK_SEG_SIZE);
+	sgl->sg_nr = 3;
+	sgl->sg_nr_out = 3;
+	sgl->sg_iovs = iovs;
+}
+
+static int
+ut_setup(void **state)
+{
+	ut_seg_nr = 0;
+	ut_persisted_nr = 0;
+	ut_fail_seg = -1;
+	ut_rpc_ref = 0;
+	ut_eventual_set = 0;
+	ut_eventual_rc = 0;
+	ut_zc_sgls = NULL;
+	ut_zc_nr = 0;
+	srv_inline_size = OBJ_INLINE_MAX;
+	srv_bypass_bulk = false;
+	daos_scratch_init(&ut_scratch, 4096, 1);
+	return 0;
+}
+
+static int
+ut_teardown(void **state)
+{
+	/* every segment dropped its RPC reference */
+	assert_int_equal(ut_rpc_ref, 0);
+	daos_scratch_fini(&ut_scratch);
+	return 0;
+}
+
+/* Every segment of a ZC update is persisted as soon as it completes */
+static void
+ut_update_segs(void **state)
+{
+	struct ds_bulk_async_args	arg = { 0 };
+	daos_sg_list_t			sgl;
+	daos_iov_t			iovs[3];
+	daos_size_t			len = OBJ_BULK_SEG_SIZE * 7 / 2;
+	daos_off_t			remote_off = 4096;
+	int				i;
+	int				rc;
+
+	ut_sgl_init(&sgl, iovs);
+	rc = ds_bulk_seg_transfer(&ut_rpc, CRT_BULK_GET, ut_remote,
+				  remote_off, ut_local, &sgl, len, ut_ioh,
+				  &ut_scratch, &arg);
+	assert_int_equal(rc, 0);
+	assert_int_equal(ut_seg_nr, 4);
+	assert_int_equal(arg.bulks_inflight, 4);
+	assert_int_equal(ut_rpc_ref, 4);
+
+	for (i = 0; i < 4; i++) {
+		struct crt_bulk_desc *desc = &ut_segs[i].us_desc;
+
+		assert_ptr_equal(desc->bd_rpc, &ut_rpc);
+		assert_int_equal(desc->bd_bulk_op, CRT_BULK_GET);
+		assert_ptr_equal(desc->bd_remote_hdl, ut_remote);
+		assert_ptr_equal(desc->bd_local_hdl, ut_local);
+		assert_int_equal(desc->bd_local_off, i * OBJ_BULK_SEG_SIZE);
+		assert_int_equal(desc->bd_remote_off,
+				 remote_off + i * OBJ_BULK_SEG_SIZE);
+		assert_int_equal(desc->bd_len, i < 3 ? OBJ_BULK_SEG_SIZE :
+				 OBJ_BULK_SEG_SIZE / 2);
+	}
+
+	/* the second segment spans the first two iovs */
+	ut_seg_complete(1, 0);
+	assert_int_equal(ut_persisted_nr, 2);
+	assert_ptr_equal(ut_persisted[0].ur_addr, ut_buf + OBJ_BULK_SEG_SIZE);
+	assert_int_equal(ut_persisted[0].ur_len, OBJ_BULK_SEG_SIZE / 2);
+	assert_ptr_equal(ut_persisted[1].ur_addr,
+			 ut_buf + OBJ_BULK_SEG_SIZE * 2);
+	assert_int_equal(ut_persisted[1].ur_len, OBJ_BULK_SEG_SIZE / 2);
+	assert_int_equal(arg.bulks_inflight, 3);
+	assert_int_equal(ut_eventual_set, 0);
+
+	ut_seg_complete(0, 0);
+	assert_int_equal(ut_persisted_nr, 3);
+	assert_ptr_equal(ut_persisted[2].ur_addr, ut_buf);
+	assert_int_equal(ut_persisted[2].ur_len, OBJ_BULK_SEG_SIZE);
+
+	ut_seg_complete(3, 0);
+	assert_int_equal(ut_persisted_nr, 4);
+	assert_ptr_equal(ut_persisted[3].ur_addr,
+			 ut_buf + OBJ_BULK_SEG_SIZE * 7 / 2);
+	assert_int_equal(ut_persisted[3].ur_len, OBJ_BULK_SEG_SIZE / 2);
+
+	/* so does the third one, over the last two iovs */
+	ut_seg_complete(2, 0);
+	assert_int_equal(ut_persisted_nr, 6);
+	assert_ptr_equal(ut_persisted[4].ur_addr,
+			 ut_buf + OBJ_BULK_SEG_SIZE * 5 / 2);
+	assert_int_equal(ut_persisted[4].ur_len, OBJ_BULK_SEG_SIZE / 2);
+	assert_ptr_equal(ut_persisted[5].ur_addr,
+			 ut_buf + OBJ_BULK_SEG_SIZE * 3);
+	assert_int_equal(ut_persisted[5].ur_len, OBJ_BULK_SEG_SIZE / 2);
+
+	assert_int_equal(arg.bulks_inflight, 0);
+	assert_int_equal(arg.result, 0);
+	assert_int_equal(ut_eventual_set, 1);
+	assert_int_equal(ut_eventual_rc, 0);
+}
+
+/*
+ * A failed segment is not persisted and its error is reported, the other
+ * segments still complete and the waiter is woken up once.
+ */
+static void
+ut_update_seg_fail(void **state)
+{
+	struct ds_bulk_async_args	arg = { 0 };
+	daos_sg_list_t			sgl;
+	daos_iov_t			iovs[3];
+	daos_size_t			len = OBJ_BULK_SEG_SIZE * 7 / 2;
+	int				rc;
+
+	ut_sgl_init(&sgl, iovs);
+	rc = ds_bulk_seg_transfer(&ut_rpc, CRT_BULK_GET, ut_remote, 0,
+				  ut_local, &sgl, len, ut_ioh, &ut_scratch,
+				  &arg);
+	assert_int_equal(rc, 0);
+	assert_int_equal(ut_seg_nr, 4);
+
+	ut_seg_complete(0, 0);
+	ut_seg_complete(1, -DER_TIMEDOUT);
+	ut_seg_complete(2, 0);
+	assert_int_equal(arg.result, -DER_TIMEDOUT);
+	assert_int_equal(ut_eventual_set, 0);
+	ut_seg_complete(3, 0);
+
+	/* segments 0, 2 and 3, nothing of the failed one */
+	assert_int_equal(ut_persisted_nr, 4);
+	assert_ptr_equal(ut_persisted[0].ur_addr, ut_buf);
+	assert_ptr_equal(ut_persisted[1].ur_addr,
+			 ut_buf + OBJ_BULK_SEG_SIZE * 5 / 2);
+	assert_ptr_equal(ut_persisted[2].ur_addr,
+			 ut_buf + OBJ_BULK_SEG_SIZE * 3);
+	assert_ptr_equal(ut_persisted[3].ur_addr,
+			 ut_buf + OBJ_BULK_SEG_SIZE * 7 / 2);
+
+	assert_int_equal(arg.bulks_inflight, 0);
+	/* a later success does not clear the error */
+	assert_int_equal(arg.result, -DER_TIMEDOUT);
+	assert_int_equal(ut_eventual_set, 1);
+}
+
+/* Segments are not issued after a synchronous failure */
+static void
+ut_update_issue_fail(void **state)
+{
+	struct ds_bulk_async_args	arg = { 0 };
+	daos_sg_list_t			sgl;
+	daos_iov_t			iovs[3];
+	daos_size_t			len = OBJ_BULK_SEG_SIZE * 7 / 2;
+	int				rc;
+
+	ut_fail_seg = 2;
+	ut_sgl_init(&sgl, iovs);
+	rc = ds_bulk_seg_transfer(&ut_rpc, CRT_BULK_GET, ut_remote, 0,
+				  ut_local, &sgl, len, ut_ioh, &ut_scratch,
+				  &arg);
+	assert_int_equal(rc, -DER_HG);
+	assert_int_equal(ut_seg_nr, 2);
+	assert_int_equal(arg.bulks_inflight, 2);
+	assert_int_equal(ut_rpc_ref, 2);
+
+	ut_seg_complete(0, 0);
+	ut_seg_complete(1, 0);
+	assert_int_equal(ut_persisted_nr, 3);
+	assert_int_equal(arg.bulks_inflight, 0);
+	assert_int_equal(ut_eventual_set, 1);
+}
+
+/* Without a ZC handle the run is transferred at once, nothing persisted */
+static void
+ut_fetch_single(void **state)
+{
+	struct ds_bulk_async_args	arg = { 0 };
+	daos_sg_list_t			sgl;
+	daos_iov_t			iovs[3];
+	daos_size_t			len = OBJ_BULK_SEG_SIZE * 7 / 2;
+	int				rc;
+
+	ut_sgl_init(&sgl, iovs);
+	rc = ds_bulk_seg_transfer(&ut_rpc, CRT_BULK_PUT, ut_remote, 512,
+				  ut_local, &sgl, len, DAOS_HDL_INVAL,
+				  &ut_scratch, &arg);
+	assert_int_equal(rc, 0);
+	assert_int_equal(ut_seg_nr, 1);
+	assert_int_equal(ut_segs[0].us_desc.bd_len, len);
+	assert_int_equal(ut_segs[0].us_desc.bd_remote_off, 512);
+	assert_int_equal(ut_segs[0].us_desc.bd_local_off, 0);
+
+	ut_seg_complete(0, 0);
+	assert_int_equal(ut_persisted_nr, 0);
+	assert_int_equal(arg.bulks_inflight, 0);
+	assert_int_equal(ut_eventual_set, 1);
+}
+
+/*
+ * Inline fetch of three sgls, the first one has a hole between two extents,
+ * the last one is not fetched by bulk: 8 bytes, hole of 8 bytes, 4 bytes;
+ * 16 bytes; nothing.
+ */
+static void
+ut_fetch_init(void)
+{
+	static char	ext0[] = "abcdefgh";
+	static char	ext1[] = "ijkl";
+	static char	ext2[] = "0123456789abcdef";
+
+	daos_iov_set(&ut_zc_iovs[0], ext0, 8);
+	daos_iov_set(&ut_zc_iovs[1], NULL, 8);
+	daos_iov_set(&ut_zc_iovs[2], ext1, 4);
+	daos_iov_set(&ut_zc_iovs[3], ext2, 16);
+	ut_zc_sgl_arr[0].sg_iovs = &ut_zc_iovs[0];
+	ut_zc_sgl_arr[0].sg_nr = ut_zc_sgl_arr[0].sg_nr_out = 3;
+	ut_zc_sgl_arr[1].sg_iovs = &ut_zc_iovs[3];
+	ut_zc_sgl_arr[1].sg_nr = ut_zc_sgl_arr[1].sg_nr_out = 1;
+	ut_zc_sgl_arr[2].sg_nr = ut_zc_sgl_arr[2].sg_nr_out = 0;
+	ut_zc_sgls = ut_zc_sgl_arr;
+	ut_zc_nr = 3;
+
+	ut_fetch_bulks[0] = ut_remote;
+	ut_fetch_bulks[1] = ut_remote;
+	ut_fetch_bulks[2] = NULL;
+
+	memset(&ut_orw, 0, sizeof(ut_orw));
+	memset(&ut_orwo, 0, sizeof(ut_orwo));
+	ut_orw.orw_nr = 3;
+	ut_orw.orw_inline_max = OBJ_INLINE_MAX;
+	ut_orw.orw_bulks.ca_arrays = ut_fetch_bulks;
+	ut_orw.orw_bulks.ca_count = 3;
+	ut_rpc.cr_input = &ut_orw;
+	ut_rpc.cr_output = &ut_orwo;
+}
+
+static void
+ut_fetch_reply_fini(void)
+{
+	daos_scratch_free(&ut_scratch, ut_orwo.orw_sgls.ca_arrays);
+	ut_orwo.orw_sgls.ca_arrays = NULL;
+	ut_orwo.orw_sgls.ca_count = 0;
+}
+
+/* The hole is zeroed and the data is scattered over several client iovs */
+static void
+ut_fetch_inline_sparse(void **state)
+{
+	daos_sg_list_t	*reply;
+	daos_sg_list_t	 dst[3];
+	daos_iov_t	 dst_iovs[4];
+	char		 dst_buf[4][16];
+	uint32_t	 nrs[3] = { 3, 1, 0 };
+	struct crt_array nrs_arr = { .ca_arrays = nrs, .ca_count = 3 };
+	daos_size_t	 size;
+	bool		 inlined;
+	int		 rc;
+
+	ut_fetch_init();
+	rc = ds_obj_fetch_inline(&ut_rpc, ut_ioh, &ut_scratch, &size,
+				 &inlined);
+	assert_int_equal(rc, 0);
+	assert_true(inlined);
+	assert_int_equal(size, 36);
+	assert_int_equal(ut_orwo.orw_sgls.ca_count, 3);
+
+	reply = ut_orwo.orw_sgls.ca_arrays;
+	assert_int_equal(reply[0].sg_nr, 1);
+	assert_int_equal(reply[0].sg_iovs[0].iov_len, 20);
+	assert_memory_equal(reply[0].sg_iovs[0].iov_buf,
+			    "abcdefgh\0\0\0\0\0\0\0\0ijkl", 20);
+	assert_int_equal(reply[1].sg_nr, 1);
+	assert_int_equal(reply[1].sg_iovs[0].iov_len, 16);
+	assert_memory_equal(reply[1].sg_iovs[0].iov_buf,
+			    "0123456789abcdef", 16);
+	assert_int_equal(reply[2].sg_nr, 0);
+
+	/* client buffers of 7, 7 and 10 bytes, then 16 bytes, then 16 */
+	memset(dst_buf, 'x', sizeof(dst_buf));
+	daos_iov_set(&dst_iovs[0], dst_buf[0], 0);
+	dst_iovs[0].iov_buf_len = 7;
+	daos_iov_set(&dst_iovs[1], dst_buf[1], 0);
+	dst_iovs[1].iov_buf_len = 7;
+	daos_iov_set(&dst_iovs[2], dst_buf[2], 0);
+	dst_iovs[2].iov_buf_len = 10;
+	daos_iov_set(&dst_iovs[3], dst_buf[3], 0);
+	dst_iovs[3].iov_buf_len = 16;
+	dst[0].sg_iovs = &dst_iovs[0];
+	dst[0].sg_nr = 3;
+	dst[1].sg_iovs = &dst_iovs[3];
+	dst[1].sg_nr = 1;
+	dst[2].sg_iovs = NULL;
+	dst[2].sg_nr = 0;
+
+	rc = obj_sgls_copy_flat(dst, 3, reply, 3, &nrs_arr);
+	assert_int_equal(rc, 0);
+	assert_int_equal(dst[0].sg_nr_out, 3);
+	assert_int_equal(dst_iovs[0].iov_len, 7);
+	assert_int_equal(dst_iovs[1].iov_len, 7);
+	assert_int_equal(dst_iovs[2].iov_len, 6);
+	assert_memory_equal(dst_buf[0], "abcdefg", 7);
+	assert_memory_equal(dst_buf[1], "h\0\0\0\0\0\0", 7);
+	assert_memory_equal(dst_buf[2], "\0\0ijklxxxx", 10);
+	assert_int_equal(dst[1].sg_nr_out, 1);
+	assert_int_equal(dst_iovs[3].iov_len, 16);
+	assert_memory_equal(dst_buf[3], "0123456789abcdef", 16);
+	assert_int_equal(dst[2].sg_nr_out, 0);
+
+	ut_fetch_reply_fini();
+}
+
+/* Data is only inlined if it fits the limits of both client and server */
+static void
+ut_fetch_inline_limit(void **state)
+{
+	daos_size_t	size;
+	bool		inlined;
+	int		rc;
+
+	ut_fetch_init();
+
+	/* client accepts less than the server sends */
+	ut_orw.orw_inline_max = 35;
+	rc = ds_obj_fetch_inline(&ut_rpc, ut_ioh, &ut_scratch, &size,
+				 &inlined);
+	assert_int_equal(rc, 0);
+	assert_false(inlined);
+	assert_int_equal(size, 36);
+	assert_null(ut_orwo.orw_sgls.ca_arrays);
+
+	/* server sends less than the client accepts */
+	ut_orw.orw_inline_max = OBJ_INLINE_MAX;
+	srv_inline_size = 35;
+	rc = ds_obj_fetch_inline(&ut_rpc, ut_ioh, &ut_scratch, &size,
+				 &inlined);
+	assert_int_equal(rc, 0);
+	assert_false(inlined);
+	assert_null(ut_orwo.orw_sgls.ca_arrays);
+
+	/* a client not supporting inline fetch */
+	ut_orw.orw_inline_max = 0;
+	srv_inline_size = OBJ_INLINE_MAX;
+	rc = ds_obj_fetch_inline(&ut_rpc, ut_ioh, &ut_scratch, &size,
+				 &inlined);
+	assert_int_equal(rc, 0);
+	assert_false(inlined);
+
+	/* both limits are inclusive */
+	ut_orw.orw_inline_max = 36;
+	srv_inline_size = 36;
+	rc = ds_obj_fetch_inline(&ut_rpc, ut_ioh, &ut_scratch, &size,
+				 &inlined);
+	assert_int_equal(rc, 0);
+	assert_true(inlined);
+	ut_fetch_reply_fini();
+
+	/* nothing is inlined while bulk is bypassed for evaluation */
+	srv_bypass_bulk = true;
+	rc = ds_obj_fetch_inline(&ut_rpc, ut_ioh, &ut_scratch, &size,
+				 &inlined);
+	assert_int_equal(rc, 0);
+	assert_false(inlined);
+}
+
+/* A reply not matching the client sgls is rejected */
+static void
+ut_fetch_inline_mismatch(void **state)
+{
+	daos_sg_list_t	*reply;
+	daos_sg_list_t	 dst[3];
+	daos_iov_t	 dst_iovs[2];
+	char		 dst_buf[2][16];
+	uint32_t	 nrs[3] = { 3, 1, 0 };
+	struct crt_array nrs_arr = { .ca_arrays = nrs, .ca_count = 3 };
+	daos_size_t	 size;
+	bool		 inlined;
+	int		 rc;
+
+	ut_fetch_init();
+	rc = ds_obj_fetch_inline(&ut_rpc, ut_ioh, &ut_scratch, &size,
+				 &inlined);
+	assert_int_equal(rc, 0);
+	assert_true(inlined);
+	reply = ut_orwo.orw_sgls.ca_arrays;
+
+	/* the first sgl can only take 16 of the 20 bytes */
+	daos_iov_set(&dst_iovs[0], dst_buf[0], 0);
+	dst_iovs[0].iov_buf_len = 16;
+	daos_iov_set(&dst_iovs[1], dst_buf[1], 0);
+	dst_iovs[1].iov_buf_len = 16;
+	dst[0].sg_iovs = &dst_iovs[0];
+	dst[0].sg_nr = 1;
+	dst[1].sg_iovs = &dst_iovs[1];
+	dst[1].sg_nr = 1;
+	dst[2].sg_iovs = NULL;
+	dst[2].sg_nr = 0;
+	rc = obj_sgls_copy_flat(dst, 3, reply, 3, &nrs_arr);
+	assert_int_equal(rc, -DER_PROTO);
+
+	/* number of sgls or nrs differs */
+	rc = obj_sgls_copy_flat(dst, 2, reply, 3, &nrs_arr);
+	assert_int_equal(rc, -DER_PROTO);
+	nrs_arr.ca_count = 2;
+	rc = obj_sgls_copy_flat(dst, 3, reply, 3, &nrs_arr);
+	assert_int_equal(rc, -DER_PROTO);
+	rc = obj_sgls_copy_flat(NULL, 3, reply, 3, &nrs_arr);
+	assert_int_equal(rc, -DER_PROTO);
+
+	ut_fetch_reply_fini();
+}
+
+static const struct CMUnitTest srv_bulk_uts[] = {
+	cmocka_unit_test_setup_teardown(ut_update_segs, ut_setup, ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_update_seg_fail, ut_setup,
+					ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_update_issue_fail, ut_setup,
+					ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_fetch_single, ut_setup,
+					ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_fetch_inline_sparse, ut_setup,
+					ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_fetch_inline_limit, ut_setup,
+					ut_teardown),
+	cmocka_unit_test_setup_teardown(ut_fetch_inline_mismatch, ut_setup,
+					ut_teardown),
+};
+
+int
+main(int argc, char **argv)
+{
+	int rc;
+
+	rc = daos_debug_init(NULL);
+	if (rc != 0)
+		return rc;
+
+	rc = cmocka_run_group_tests_name("Object server bulk unit tests",
+					 srv_bulk_uts, NULL, NULL);
+	daos_debug_fini();
+	return rc;
+}
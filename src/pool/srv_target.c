@@ -66,6 +66,13 @@ ds_pool_child_lookup(const uuid_t uuid)
 	return NULL;
 }
 
+void
+ds_pool_child_get(struct ds_pool_child *child)
+{
+	D_ASSERTF(child->spc_ref > 0, "%d\n", child->spc_ref);
+	child->spc_ref++;
+}
+
 void
 ds_pool_child_put(struct ds_pool_child *child)
 {
@@ -80,6 +87,31 @@ ds_pool_child_put(struct ds_pool_child *child)
 	}
 }
 
+static ds_pool_child_close_cb_t pool_child_close_cbs[DAOS_MAX_MODULE];
+
+/**
+ * Register callback of module \a mod_id to be invoked before a pool child
+ * is closed, \a cb can be NULL to unregister the callback.
+ */
+void
+ds_pool_child_close_cb_register(unsigned int mod_id,
+				ds_pool_child_close_cb_t cb)
+{
+	D_ASSERT(mod_id < DAOS_MAX_MODULE);
+	pool_child_close_cbs[mod_id] = cb;
+}
+
+static void
+pool_child_close_notify(struct ds_pool_child *child)
+{
+	int	i;
+
+	for (i = 0; i < DAOS_MAX_MODULE; i++) {
+		if (pool_child_close_cbs[i] != NULL)
+			pool_child_close_cbs[i](child);
+	}
+}
+
 void
 ds_pool_child_purge(struct pool_tls *tls)
 {
@@ -169,6 +201,7 @@ ds_pool_child_close(uuid_t uuid)
 	if (child == NULL)
 		return 0;
 
+	pool_child_close_notify(child);
 	d_list_del_init(&child->spc_list);
 	ds_pool_child_put(child); /* -1 for the list */
 	ds_pool_child_put(child); /* -1 for lookup */
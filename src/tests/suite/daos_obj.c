@@ -1738,6 +1738,126 @@ update_overlapped_recxs(void **state)
 	print_message("all good\n");
 }
 
+#define IO_COALESCE_NR		16
+#define IO_COALESCE_LARGE	(64 * 1024)
+/* in microseconds, long enough to notice a delayed synchronous update */
+#define IO_COALESCE_DELAY	(2 * 1000 * 1000)
+
+/**
+ * Small updates are coalesced by client, mix them with large updates of two
+ * objects on the same rank, then check the status and data of each update.
+ * Coalescing is enabled by DAOS_OBJ_COALESCE unless DAOS_IO_COALESCE is
+ * set. A synchronous small update should not wait for the delay.
+ */
+static void
+io_coalesce(void **state)
+{
+	test_arg_t	*arg = *state;
+	daos_handle_t	 ohs[2];
+	daos_event_t	 evs[IO_COALESCE_NR];
+	daos_event_t	*evp[IO_COALESCE_NR];
+	char		 dkey_bufs[IO_COALESCE_NR][16];
+	daos_iov_t	 dkeys[IO_COALESCE_NR];
+	daos_iod_t	 iods[IO_COALESCE_NR];
+	daos_sg_list_t	 sgls[IO_COALESCE_NR];
+	daos_iov_t	 sg_iovs[IO_COALESCE_NR];
+	char		*bufs[IO_COALESCE_NR];
+	daos_size_t	 sizes[IO_COALESCE_NR];
+	daos_epoch_t	 epoch = 3;
+	uint64_t	 start;
+	char		*fetch_buf;
+	int		 done;
+	int		 i;
+	int		 rc;
+
+	daos_fail_loc_set(DAOS_OBJ_COALESCE | DAOS_FAIL_VALUE);
+	daos_fail_value_set(IO_COALESCE_DELAY);
+
+	for (i = 0; i < 2; i++) {
+		daos_obj_id_t	oid;
+
+		oid = dts_oid_gen(DAOS_OC_R1S_SPEC_RANK, 0, arg->myrank);
+		oid = dts_oid_set_rank(oid, 0);
+		rc = daos_obj_open(arg->coh, oid, 0, 0, &ohs[i], NULL);
+		assert_int_equal(rc, 0);
+	}
+
+	print_message("Submit %d small and large updates\n", IO_COALESCE_NR);
+	for (i = 0; i < IO_COALESCE_NR; i++) {
+		/* every fourth update is too large to be coalesced */
+		sizes[i] = (i % 4 == 3) ? IO_COALESCE_LARGE : 8 * (i + 1);
+		bufs[i] = malloc(sizes[i]);
+		assert_non_null(bufs[i]);
+		memset(bufs[i], 'a' + i, sizes[i]);
+
+		snprintf(dkey_bufs[i], sizeof(dkey_bufs[i]), "dkey_%d", i);
+		daos_iov_set(&dkeys[i], dkey_bufs[i], strlen(dkey_bufs[i]));
+
+		daos_iov_set(&sg_iovs[i], bufs[i], sizes[i]);
+		sgls[i].sg_nr		= 1;
+		sgls[i].sg_nr_out	= 0;
+		sgls[i].sg_iovs		= &sg_iovs[i];
+
+		memset(&iods[i], 0, sizeof(iods[i]));
+		daos_iov_set(&iods[i].iod_name, "akey", strlen("akey"));
+		daos_csum_set(&iods[i].iod_kcsum, NULL, 0);
+		iods[i].iod_nr		= 1;
+		iods[i].iod_size	= sizes[i];
+		iods[i].iod_type	= DAOS_IOD_SINGLE;
+
+		rc = daos_event_init(&evs[i], arg->eq, NULL);
+		assert_int_equal(rc, 0);
+
+		rc = daos_obj_update(ohs[i % 2], epoch, &dkeys[i], 1,
+				     &iods[i], &sgls[i], &evs[i]);
+		assert_int_equal(rc, 0);
+	}
+
+	for (done = 0; done < IO_COALESCE_NR; done += rc) {
+		rc = daos_eq_poll(arg->eq, 1, DAOS_EQ_WAIT,
+				  IO_COALESCE_NR, evp);
+		assert_true(rc > 0);
+	}
+	assert_int_equal(done, IO_COALESCE_NR);
+
+	for (i = 0; i < IO_COALESCE_NR; i++) {
+		assert_int_equal(evs[i].ev_error, 0);
+		rc = daos_event_fini(&evs[i]);
+		assert_int_equal(rc, 0);
+	}
+
+	print_message("Synchronous small update\n");
+	start = d_timeus_secdiff(0);
+	rc = daos_obj_update(ohs[0], epoch, &dkeys[0], 1, &iods[0], &sgls[0],
+			     NULL);
+	assert_int_equal(rc, 0);
+	assert_true(d_timeus_secdiff(0) - start < IO_COALESCE_DELAY);
+	daos_fail_loc_set(0);
+
+	print_message("Fetch and verify each update\n");
+	fetch_buf = malloc(IO_COALESCE_LARGE);
+	assert_non_null(fetch_buf);
+	for (i = 0; i < IO_COALESCE_NR; i++) {
+		memset(fetch_buf, 0, IO_COALESCE_LARGE);
+		daos_iov_set(&sg_iovs[i], fetch_buf, IO_COALESCE_LARGE);
+		iods[i].iod_size = DAOS_REC_ANY;
+
+		rc = daos_obj_fetch(ohs[i % 2], epoch, &dkeys[i], 1, &iods[i],
+				    &sgls[i], NULL, NULL);
+		assert_int_equal(rc, 0);
+		assert_int_equal(iods[i].iod_size, sizes[i]);
+		assert_memory_equal(fetch_buf, bufs[i], sizes[i]);
+		free(bufs[i]);
+	}
+	free(fetch_buf);
+
+	for (i = 0; i < 2; i++) {
+		rc = daos_obj_close(ohs[i], NULL);
+		assert_int_equal(rc, 0);
+	}
+	print_message("all good\n");
+}
+
 static const struct CMUnitTest io_tests[] = {
 	{ "IO1: simple update/fetch/verify",
 	  io_simple, async_disable, test_case_teardown},
@@ -1796,6 +1916,8 @@ static const struct CMUnitTest io_tests[] = {
 	  async_enable, test_case_teardown},
 	{ "IO29: update with overlapped recxs", update_overlapped_recxs,
 	  async_enable, test_case_teardown},
+	{ "IO30: coalesced small and large updates", io_coalesce,
+	  async_disable, test_case_teardown},
 };
 
 int
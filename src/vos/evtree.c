@@ -718,21 +718,36 @@ evt_tcx_clone(struct evt_context *tcx, struct evt_context **tcx_pp)
 static int
 evt_ptr_create(struct evt_context *tcx, uuid_t cookie, uint32_t pm_ver,
 	       umem_id_t mmid, uint32_t idx_nob, uint64_t idx_num,
-	       TMMID(struct evt_ptr) *ptr_mmid_p)
+	       daos_csum_buf_t *csum, TMMID(struct evt_ptr) *ptr_mmid_p)
 {
 	struct evt_ptr		*ptr;
 	TMMID(struct evt_ptr)	 ptr_mmid;
+	umem_id_t		 cs_mmid = UMMID_NULL;
 	int			 rc;
 
+	if (csum != NULL && csum->cs_len != 0 && csum->cs_chunk_size != 0) {
+		cs_mmid = umem_alloc(evt_umm(tcx), csum->cs_len);
+		if (UMMID_IS_NULL(cs_mmid))
+			return -DER_NOMEM;
+		memcpy(evt_mmid2ptr(tcx, cs_mmid), csum->cs_csum,
+		       csum->cs_len);
+	}
+
 	ptr_mmid = umem_znew_typed(evt_umm(tcx), struct evt_ptr);
 	if (TMMID_IS_NULL(ptr_mmid))
-		return -DER_NOMEM;
+		D_GOTO(failed_csum, rc = -DER_NOMEM);
 
 	ptr = evt_tmmid2ptr(tcx, ptr_mmid);
 	ptr->pt_inob = idx_nob;
 	ptr->pt_inum = idx_num;
 	uuid_copy(ptr->pt_cookie, cookie);
 	ptr->pt_ver = pm_ver;
+	if (!UMMID_IS_NULL(cs_mmid)) {
+		ptr->pt_csum_mmid  = cs_mmid;
+		ptr->pt_csum_chunk = csum->cs_chunk_size;
+		ptr->pt_csum_type  = csum->cs_type;
+		ptr->pt_csum_len   = csum->cs_len;
+	}
 
 	if (UMMID_IS_NULL(mmid) && idx_nob * idx_num > EVT_PTR_PAYLOAD) {
 		mmid = umem_alloc(evt_umm(tcx), idx_nob * idx_num);
@@ -745,11 +760,15 @@ evt_ptr_create(struct evt_context *tcx, uuid_t cookie, uint32_t pm_ver,
 	return 0;
  failed:
 	umem_free_typed(evt_umm(tcx), ptr_mmid);
+ failed_csum:
+	if (!UMMID_IS_NULL(cs_mmid))
+		umem_free(evt_umm(tcx), cs_mmid);
 	return rc;
 }
 
 /**
- * Free a data pointer. It also frees the data buffer if \a free_data is true.
+ * Free a data pointer. It also frees the data buffer and checksums if
+ * \a free_data is true.
  */
 static void
 evt_ptr_free(struct evt_context *tcx, TMMID(struct evt_ptr) ptr_mmid,
@@ -761,6 +780,8 @@ evt_ptr_free(struct evt_context *tcx, TMMID(struct evt_ptr) ptr_mmid,
 	if (free_data) {
 		if (!UMMID_IS_NULL(ptr->pt_mmid))
 			umem_free(evt_umm(tcx), ptr->pt_mmid);
+		if (!UMMID_IS_NULL(ptr->pt_csum_mmid))
+			umem_free(evt_umm(tcx), ptr->pt_csum_mmid);
 	}
 	umem_free_typed(evt_umm(tcx), ptr_mmid);
 }
@@ -1067,7 +1088,6 @@ evt_node_destroy(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 	evt_node_free(tcx, nd_mmid);
 }
 
-#if 0
 static inline int
 evt_node_tx_add(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
 {
@@ -1079,7 +1099,6 @@ evt_node_tx_add(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
 			       evt_node_size(tcx, nd->tn_flags));
 	return rc;
 }
-#endif
 
 /** Return the MBR of a node */
 static struct evt_rect *
@@ -1505,6 +1524,107 @@ evt_insert_or_split(struct evt_context *tcx, struct evt_entry *ent_new)
 	return rc;
 }
 
+/** Remove the entry at the offset \a at of a tree node */
+static void
+evt_node_entry_remove(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		      unsigned int at)
+{
+	struct evt_node	*nd = evt_tmmid2ptr(tcx, nd_mmid);
+	unsigned int	 nr;
+
+	D_ASSERT(at < nd->tn_nr);
+	nr = nd->tn_nr - at - 1;
+	if (nr != 0) {
+		memmove(evt_node_rect_at(tcx, nd_mmid, at),
+			evt_node_rect_at(tcx, nd_mmid, at + 1),
+			nr * sizeof(struct evt_rect));
+
+		if (evt_node_is_leaf(tcx, nd_mmid))
+			memmove(evt_node_pref_at(tcx, nd_mmid, at),
+				evt_node_pref_at(tcx, nd_mmid, at + 1),
+				nr * sizeof(struct evt_ptr_ref));
+		else
+			memmove(evt_node_child_at(tcx, nd_mmid, at),
+				evt_node_child_at(tcx, nd_mmid, at + 1),
+				nr * sizeof(TMMID(struct evt_node)));
+	}
+	nd->tn_nr--;
+}
+
+/**
+ * Delete the leaf rectangle pointed by the trace of \a tcx, and release its
+ * extent pointer. A node which becomes empty is freed and removed from its
+ * parent, MBRs of the remaining nodes on the path are recomputed.
+ *
+ * NB: nodes are never merged, and the tree depth is only reset when the
+ * last rectangle is deleted.
+ */
+static int
+evt_node_delete(struct evt_context *tcx)
+{
+	struct evt_trace	*trace;
+	struct evt_ptr_ref	*pref;
+	TMMID(struct evt_node)	 nd_mmid;
+	int			 level;
+	int			 rc;
+
+	D_ASSERT(tcx->tc_depth > 0);
+	for (level = tcx->tc_depth - 1; level >= 0; level--) {
+		trace = &tcx->tc_trace[level];
+		nd_mmid = trace->tr_node;
+
+		if (evt_node_is_leaf(tcx, nd_mmid)) {
+			pref = evt_node_pref_at(tcx, nd_mmid, trace->tr_at);
+			evt_ptr_decref(tcx, pref->pr_ptr_mmid);
+		}
+
+		if (evt_tmmid2ptr(tcx, nd_mmid)->tn_nr > 1)
+			break;
+
+		/* the last entry of this node */
+		D_DEBUG(DB_TRACE, "Free empty node "TMMID_PF" at level %d\n",
+			TMMID_P(nd_mmid), level);
+		evt_node_free(tcx, nd_mmid);
+	}
+
+	if (level < 0) { /* the tree is empty now */
+		if (evt_has_tx(tcx)) {
+			rc = evt_root_tx_add(tcx);
+			if (rc != 0)
+				return rc;
+		}
+		tcx->tc_root->tr_node = EVT_NODE_NULL;
+		tcx->tc_root->tr_depth = 0;
+		evt_tcx_set_dep(tcx, 0);
+		return 0;
+	}
+
+	trace = &tcx->tc_trace[level];
+	if (evt_has_tx(tcx)) {
+		rc = evt_node_tx_add(tcx, trace->tr_node);
+		if (rc != 0)
+			return rc;
+	}
+	evt_node_entry_remove(tcx, trace->tr_node, trace->tr_at);
+	evt_node_mbr_cal(tcx, trace->tr_node);
+
+	/* the MBR can shrink, update it in all ancestors */
+	for (level--; level >= 0; level--) {
+		struct evt_trace *child = trace;
+
+		trace = &tcx->tc_trace[level];
+		if (evt_has_tx(tcx)) {
+			rc = evt_node_tx_add(tcx, trace->tr_node);
+			if (rc != 0)
+				return rc;
+		}
+		*evt_node_rect_at(tcx, trace->tr_node, trace->tr_at) =
+			*evt_node_mbr_get(tcx, child->tr_node);
+		evt_node_mbr_cal(tcx, trace->tr_node);
+	}
+	return 0;
+}
+
 /** Insert a single entry to evtree */
 static int
 evt_insert_entry(struct evt_context *tcx, struct evt_entry *ent)
@@ -1574,6 +1694,8 @@ evt_ptr_copy(struct evt_context *tcx, TMMID(struct evt_ptr) dst_mmid,
 	/* Free the pmem that dst_ptr references */
 	if (!UMMID_IS_NULL(dst_ptr->pt_mmid))
 		umem_free(evt_umm(tcx), dst_ptr->pt_mmid);
+	if (!UMMID_IS_NULL(dst_ptr->pt_csum_mmid))
+		umem_free(evt_umm(tcx), dst_ptr->pt_csum_mmid);
 
 	memcpy(dst_ptr, src_ptr, sizeof(*dst_ptr));
 	dst_ptr->pt_ref = ref;
@@ -1647,9 +1769,11 @@ out:
  */
 int
 evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
-	   struct evt_rect *rect, uint32_t inob, umem_id_t mmid)
+	   struct evt_rect *rect, uint32_t inob, umem_id_t mmid,
+	   daos_csum_buf_t *csum)
 {
 	struct evt_context	*tcx;
+	struct evt_ptr		*ptr;
 	TMMID(struct evt_ptr)	 ptr_mmid;
 	int			 rc;
 
@@ -1658,7 +1782,7 @@ evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
 		return -DER_NO_HDL;
 
 	rc = evt_ptr_create(tcx, cookie, pm_ver, mmid, inob,
-			    evt_rect_width(rect), &ptr_mmid);
+			    evt_rect_width(rect), csum, &ptr_mmid);
 	if (rc != 0)
 		return rc;
 
@@ -1668,6 +1792,10 @@ evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
 
 	return 0;
  failed:
+	/* The data buffer belongs to the caller, but the checksum doesn't */
+	ptr = evt_tmmid2ptr(tcx, ptr_mmid);
+	if (!UMMID_IS_NULL(ptr->pt_csum_mmid))
+		umem_free(evt_umm(tcx), ptr->pt_csum_mmid);
 	evt_ptr_free(tcx, ptr_mmid, false);
 	return rc;
 }
@@ -1680,7 +1808,8 @@ evt_insert(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
  */
 int
 evt_insert_sgl(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
-	       struct evt_rect *rect, uint32_t inob, daos_sg_list_t *sgl)
+	       struct evt_rect *rect, uint32_t inob, daos_sg_list_t *sgl,
+	       daos_csum_buf_t *csum)
 {
 	struct evt_context	*tcx;
 	TMMID(struct evt_ptr)	 ptr_mmid;
@@ -1692,7 +1821,7 @@ evt_insert_sgl(daos_handle_t toh, uuid_t cookie, uint32_t pm_ver,
 		return -DER_NO_HDL;
 
 	rc = evt_ptr_create(tcx, cookie, pm_ver, UMMID_NULL, inob,
-			    evt_rect_width(rect), &ptr_mmid);
+			    evt_rect_width(rect), csum, &ptr_mmid);
 	if (rc != 0)
 		return rc;
 
@@ -1767,7 +1896,17 @@ evt_fill_entry(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 	uuid_copy(entry->en_cookie, ptr->pt_cookie);
 	entry->en_ver = ptr->pt_ver;
 
-	addr = evt_ptr_payload(tcx, pref->pr_ptr_mmid, &entry->en_inob, NULL);
+	daos_csum_set(&entry->en_csum, NULL, 0);
+	if (!UMMID_IS_NULL(ptr->pt_csum_mmid)) {
+		daos_csum_set(&entry->en_csum,
+			      evt_mmid2ptr(tcx, ptr->pt_csum_mmid),
+			      ptr->pt_csum_len);
+		entry->en_csum.cs_type = ptr->pt_csum_type;
+		entry->en_csum.cs_chunk_size = ptr->pt_csum_chunk;
+	}
+
+	addr = evt_ptr_payload(tcx, pref->pr_ptr_mmid, &entry->en_inob,
+			       &entry->en_ptr_inum);
 	if (addr == NULL) { /* punched */
 		entry->en_addr   = NULL;
 		entry->en_offset = 0;
@@ -1985,6 +2124,592 @@ evt_find(daos_handle_t toh, struct evt_rect *rect,
 	return rc;
 }
 
+/**
+ * Callback of evt_walk, it is called for each leaf rectangle which overlaps
+ * with the searched rectangle.
+ */
+typedef void (*evt_walk_cb_t)(struct evt_context *tcx,
+			      TMMID(struct evt_node) nd_mmid, unsigned int at,
+			      struct evt_rect *rect, void *arg);
+
+/**
+ * Optional callback of evt_walk, it is called for the MBR of each child node
+ * which overlaps with the searched rectangle, the child is skipped if it
+ * returns true.
+ */
+typedef bool (*evt_prune_cb_t)(struct evt_context *tcx,
+			       struct evt_rect *mbr, void *arg);
+
+/**
+ * Depth-first walk of all leaf rectangles overlapping with \a rect in offset
+ * range, and visible at epoch \a rect::rc_epc_lo. The search path is stored
+ * in the trace of \a tcx, so no memory is allocated.
+ */
+static void
+evt_walk(struct evt_context *tcx, struct evt_rect *rect, evt_walk_cb_t cb,
+	 evt_prune_cb_t prune, void *arg)
+{
+	TMMID(struct evt_node)	 nd_mmid;
+	struct evt_trace	*trace;
+	struct evt_node		*node;
+	struct evt_rect		*rtmp;
+	int			 range_overlap;
+	int			 time_overlap;
+	int			 level;
+	int			 at;
+	int			 i;
+	bool			 leaf;
+
+	if (tcx->tc_root->tr_depth == 0)
+		return; /* empty tree */
+
+	evt_tcx_reset_trace(tcx);
+
+	level = at = 0;
+	nd_mmid = tcx->tc_root->tr_node;
+	while (1) {
+		node = evt_tmmid2ptr(tcx, nd_mmid);
+		leaf = evt_node_is_leaf(tcx, nd_mmid);
+
+		for (i = at; i < node->tn_nr; i++) {
+			rtmp = evt_node_rect_at(tcx, nd_mmid, i);
+			evt_rect_overlap(rtmp, rect, &range_overlap,
+					 &time_overlap);
+			if (range_overlap == RT_OVERLAP_NO ||
+			    time_overlap == RT_OVERLAP_UNDER)
+				continue;
+
+			if (leaf) {
+				cb(tcx, nd_mmid, i, rtmp, arg);
+				continue;
+			}
+
+			if (prune == NULL || !prune(tcx, rtmp, arg))
+				break; /* enter the child node */
+		}
+
+		if (i < node->tn_nr) {
+			evt_tcx_set_trace(tcx, level, nd_mmid, i);
+			nd_mmid = *evt_node_child_at(tcx, nd_mmid, i);
+			at = 0;
+			level++;
+
+		} else {
+			if (level == 0) /* done with the root */
+				return;
+
+			level--;
+			trace = evt_tcx_trace(tcx, level);
+			nd_mmid = trace->tr_node;
+			at = trace->tr_at + 1;
+			D_ASSERT(at <= tcx->tc_order);
+		}
+	}
+}
+
+/** order of rectangles: start offset then epoch */
+static int
+evt_rect_off_cmp(struct evt_rect *rt1, struct evt_rect *rt2)
+{
+	if (rt1->rc_off_lo != rt2->rc_off_lo)
+		return rt1->rc_off_lo < rt2->rc_off_lo ? -1 : 1;
+
+	if (rt1->rc_epc_lo != rt2->rc_epc_lo)
+		return rt1->rc_epc_lo < rt2->rc_epc_lo ? -1 : 1;
+
+	return 0;
+}
+
+/** number of candidates of evt_find_visible which don't need allocation */
+#define EVT_VISIBLE_INLINE	16
+
+/** an extent overlapping with the range of evt_find_visible */
+struct evt_vis_cand {
+	struct evt_rect		vc_rect;
+	TMMID(struct evt_node)	vc_nd_mmid;
+	unsigned int		vc_at;
+};
+
+/** state of evt_find_visible */
+struct evt_visible {
+	/** candidates, sorted by evt_rect_off_cmp() after the walk */
+	struct evt_vis_cand	*vs_cands;
+	/** max-heap (by epoch) of candidates covering the current offset */
+	unsigned int		*vs_heap;
+	/** number of candidates */
+	unsigned int		 vs_nr;
+	/** capacity of \a vs_cands and \a vs_heap */
+	unsigned int		 vs_max;
+	/** number of candidates in \a vs_heap */
+	unsigned int		 vs_heap_nr;
+	/** error of collecting candidates */
+	int			 vs_rc;
+	struct evt_vis_cand	 vs_cands_buf[EVT_VISIBLE_INLINE];
+	unsigned int		 vs_heap_buf[EVT_VISIBLE_INLINE];
+};
+
+static void
+evt_visible_init(struct evt_visible *vs)
+{
+	vs->vs_cands	= vs->vs_cands_buf;
+	vs->vs_heap	= vs->vs_heap_buf;
+	vs->vs_nr	= vs->vs_heap_nr = 0;
+	vs->vs_max	= EVT_VISIBLE_INLINE;
+	vs->vs_rc	= 0;
+}
+
+static void
+evt_visible_fini(struct evt_visible *vs)
+{
+	if (vs->vs_cands != vs->vs_cands_buf) {
+		D_FREE(vs->vs_cands);
+		D_FREE(vs->vs_heap);
+	}
+}
+
+/** double the capacity of candidates, the heap is still empty */
+static int
+evt_visible_grow(struct evt_visible *vs)
+{
+	struct evt_vis_cand	*cands;
+	unsigned int		*heap;
+	unsigned int		 max = vs->vs_max * 2;
+
+	D_ALLOC(cands, max * sizeof(*cands));
+	if (cands == NULL)
+		return -DER_NOMEM;
+
+	D_ALLOC(heap, max * sizeof(*heap));
+	if (heap == NULL) {
+		D_FREE(cands);
+		return -DER_NOMEM;
+	}
+
+	memcpy(cands, vs->vs_cands, vs->vs_nr * sizeof(*cands));
+	evt_visible_fini(vs);
+	vs->vs_cands	= cands;
+	vs->vs_heap	= heap;
+	vs->vs_max	= max;
+	return 0;
+}
+
+/** add an extent to the candidates, the error is stored in \a vs_rc */
+static void
+evt_visible_add(struct evt_visible *vs, TMMID(struct evt_node) nd_mmid,
+		unsigned int at, struct evt_rect *rect)
+{
+	struct evt_vis_cand *cand;
+
+	if (vs->vs_rc != 0)
+		return;
+
+	if (vs->vs_nr == vs->vs_max) {
+		vs->vs_rc = evt_visible_grow(vs);
+		if (vs->vs_rc != 0)
+			return;
+	}
+
+	cand = &vs->vs_cands[vs->vs_nr++];
+	cand->vc_rect	 = *rect;
+	cand->vc_nd_mmid = nd_mmid;
+	cand->vc_at	 = at;
+}
+
+/** collect all extents visible at the epoch of the search */
+static void
+evt_visible_cand_cb(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		    unsigned int at, struct evt_rect *rect, void *arg)
+{
+	evt_visible_add(arg, nd_mmid, at, rect);
+}
+
+static void
+evt_visible_swap(void *array, int a, int b)
+{
+	struct evt_visible	*vs = array;
+	struct evt_vis_cand	 tmp;
+
+	tmp = vs->vs_cands[a];
+	vs->vs_cands[a] = vs->vs_cands[b];
+	vs->vs_cands[b] = tmp;
+}
+
+static int
+evt_visible_cmp(void *array, int a, int b)
+{
+	struct evt_visible *vs = array;
+
+	return evt_rect_off_cmp(&vs->vs_cands[a].vc_rect,
+				&vs->vs_cands[b].vc_rect);
+}
+
+static daos_sort_ops_t evt_visible_sort_ops = {
+	.so_swap	= evt_visible_swap,
+	.so_cmp		= evt_visible_cmp,
+};
+
+/** candidate \a a of the heap is newer than \a b */
+static inline bool
+evt_visible_newer(struct evt_visible *vs, unsigned int a, unsigned int b)
+{
+	return vs->vs_cands[vs->vs_heap[a]].vc_rect.rc_epc_lo >
+	       vs->vs_cands[vs->vs_heap[b]].vc_rect.rc_epc_lo;
+}
+
+static inline void
+evt_visible_heap_swap(struct evt_visible *vs, unsigned int a, unsigned int b)
+{
+	unsigned int tmp = vs->vs_heap[a];
+
+	vs->vs_heap[a] = vs->vs_heap[b];
+	vs->vs_heap[b] = tmp;
+}
+
+static void
+evt_visible_push(struct evt_visible *vs, unsigned int idx)
+{
+	unsigned int i = vs->vs_heap_nr++;
+
+	D_ASSERT(vs->vs_heap_nr <= vs->vs_max);
+	vs->vs_heap[i] = idx;
+	for (; i > 0 && evt_visible_newer(vs, i, (i - 1) / 2); i = (i - 1) / 2)
+		evt_visible_heap_swap(vs, i, (i - 1) / 2);
+}
+
+static void
+evt_visible_pop(struct evt_visible *vs)
+{
+	unsigned int i = 0;
+	unsigned int c;
+
+	D_ASSERT(vs->vs_heap_nr > 0);
+	vs->vs_heap[0] = vs->vs_heap[--vs->vs_heap_nr];
+	while ((c = 2 * i + 1) < vs->vs_heap_nr) {
+		if (c + 1 < vs->vs_heap_nr && evt_visible_newer(vs, c + 1, c))
+			c++;
+		if (!evt_visible_newer(vs, c, i))
+			break;
+		evt_visible_heap_swap(vs, i, c);
+		i = c;
+	}
+}
+
+/** the newest candidate in the heap, or NULL if the heap is empty */
+static inline struct evt_vis_cand *
+evt_visible_top(struct evt_visible *vs)
+{
+	return vs->vs_heap_nr == 0 ? NULL : &vs->vs_cands[vs->vs_heap[0]];
+}
+
+/**
+ * Stream visible extents intercepting with the input rectangle \a rect in
+ * offset order.
+ *
+ * Please check API comment in evtree.h for the details.
+ */
+int
+evt_find_visible(daos_handle_t toh, struct evt_rect *rect,
+		 evt_visible_cb_t cb, void *arg)
+{
+	struct evt_context	*tcx;
+	struct evt_visible	 vs;
+	struct evt_vis_cand	*top;
+	struct evt_vis_cand	*cand;
+	struct evt_entry	 ent;
+	struct evt_rect		 srch;
+	daos_off_t		 off;
+	daos_off_t		 end;
+	unsigned int		 i;
+	unsigned int		 j;
+	int			 rc = 0;
+
+	tcx = evt_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	D_DEBUG(DB_TRACE, "Streaming visible extents of "DF_RECT"\n",
+		DP_RECT(rect));
+
+	evt_visible_init(&vs);
+	evt_walk(tcx, rect, evt_visible_cand_cb, NULL, &vs);
+	if (vs.vs_rc != 0)
+		D_GOTO(out, rc = vs.vs_rc);
+
+	daos_array_sort(&vs, vs.vs_nr, false, &evt_visible_sort_ops);
+
+	/* Sweep the candidates in offset order, the top of the heap is the
+	 * newest extent covering the current offset.
+	 */
+	srch.rc_epc_lo = rect->rc_epc_lo;
+	off = rect->rc_off_lo;
+	for (i = 0;;) {
+		for (; i < vs.vs_nr && vs.vs_cands[i].vc_rect.rc_off_lo <= off;
+		     i++)
+			evt_visible_push(&vs, i);
+
+		while ((top = evt_visible_top(&vs)) != NULL &&
+		       top->vc_rect.rc_off_hi < off)
+			evt_visible_pop(&vs);
+
+		if (top == NULL) { /* hole */
+			if (i == vs.vs_nr)
+				break;
+			off = vs.vs_cands[i].vc_rect.rc_off_lo;
+			continue;
+		}
+
+		/* the top extent is cut off by the first newer extent which
+		 * starts after the current offset.
+		 */
+		end = min(rect->rc_off_hi, top->vc_rect.rc_off_hi);
+		for (j = i; j < vs.vs_nr; j++) {
+			cand = &vs.vs_cands[j];
+			if (cand->vc_rect.rc_off_lo > end)
+				break;
+
+			if (cand->vc_rect.rc_epc_lo > top->vc_rect.rc_epc_lo) {
+				end = cand->vc_rect.rc_off_lo - 1;
+				break;
+			}
+		}
+
+		srch.rc_off_lo = off;
+		srch.rc_off_hi = end;
+		evt_fill_entry(tcx, top->vc_nd_mmid, top->vc_at, &srch, &ent);
+		D_INIT_LIST_HEAD(&ent.en_link);
+
+		rc = cb(&ent, arg);
+		if (rc != 0) {
+			rc = rc == 1 ? 0 : rc;
+			break;
+		}
+
+		if (end == rect->rc_off_hi)
+			break;
+
+		off = end + 1;
+	}
+out:
+	evt_visible_fini(&vs);
+	return rc;
+}
+
+/** newer extents overlapping with the extent being checked */
+struct evt_cover {
+	struct evt_visible	cv_vs;
+	/** epoch of the extent being checked */
+	daos_epoch_t		cv_epoch;
+};
+
+static void
+evt_cover_cb(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+	     unsigned int at, struct evt_rect *rect, void *arg)
+{
+	struct evt_cover *cv = arg;
+
+	if (rect->rc_epc_lo > cv->cv_epoch)
+		evt_visible_add(&cv->cv_vs, nd_mmid, at, rect);
+}
+
+/**
+ * Check if \a rect is fully covered by newer extents which are visible at
+ * \a epoch, which means that \a rect is invisible at any epoch after it.
+ * The newer extents are collected by one walk, then checked in offset order.
+ *
+ * \return	1 if \a rect is covered, 0 if not, negative value on error.
+ */
+static int
+evt_rect_is_covered(struct evt_context *tcx, struct evt_rect *rect,
+		    daos_epoch_t epoch)
+{
+	struct evt_cover	 cv;
+	struct evt_rect		 srch;
+	struct evt_rect		*rtmp;
+	daos_off_t		 next;
+	unsigned int		 i;
+	int			 rc = 0;
+
+	evt_visible_init(&cv.cv_vs);
+	cv.cv_epoch = rect->rc_epc_lo;
+	srch.rc_epc_lo = epoch;
+	srch.rc_off_lo = rect->rc_off_lo;
+	srch.rc_off_hi = rect->rc_off_hi;
+	evt_walk(tcx, &srch, evt_cover_cb, NULL, &cv);
+	if (cv.cv_vs.vs_rc != 0)
+		D_GOTO(out, rc = cv.cv_vs.vs_rc);
+
+	daos_array_sort(&cv.cv_vs, cv.cv_vs.vs_nr, false,
+			&evt_visible_sort_ops);
+
+	/* @next is the first offset which isn't covered yet */
+	next = rect->rc_off_lo;
+	for (i = 0; i < cv.cv_vs.vs_nr; i++) {
+		rtmp = &cv.cv_vs.vs_cands[i].vc_rect;
+		if (rtmp->rc_off_lo > next)
+			break; /* hole */
+
+		if (rtmp->rc_off_hi >= rect->rc_off_hi)
+			D_GOTO(out, rc = 1);
+
+		next = max(next, rtmp->rc_off_hi + 1);
+	}
+out:
+	evt_visible_fini(&cv.cv_vs);
+	return rc;
+}
+
+/** max number of rectangles checked by each round of evt_compact */
+#define EVT_COMPACT_BATCH	32
+
+/** candidates of a compaction round, sorted by start offset and epoch */
+struct evt_compact_batch {
+	/** rectangle after which the candidates are collected */
+	struct evt_rect		 cb_last;
+	/** \a cb_last is valid */
+	bool			 cb_started;
+	/** number of candidates */
+	unsigned int		 cb_nr;
+	/** max number of candidates of this round */
+	unsigned int		 cb_max;
+	/** number of rectangles visited by the walk of this round */
+	unsigned int		 cb_visited;
+	/** epoch of the compaction */
+	daos_epoch_t		 cb_epoch;
+	struct evt_rect		 cb_rects[EVT_COMPACT_BATCH];
+};
+
+static void
+evt_compact_batch_cb(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
+		     unsigned int at, struct evt_rect *rect, void *arg)
+{
+	struct evt_compact_batch *cb = arg;
+	int			  i;
+
+	cb->cb_visited++;
+	/* the newest extent of @cb_epoch can't be covered */
+	if (rect->rc_epc_lo >= cb->cb_epoch)
+		return;
+
+	if (cb->cb_started && evt_rect_off_cmp(rect, &cb->cb_last) <= 0)
+		return; /* checked by previous rounds */
+
+	if (cb->cb_nr == cb->cb_max &&
+	    evt_rect_off_cmp(rect, &cb->cb_rects[cb->cb_nr - 1]) >= 0)
+		return; /* not in the first @cb_max candidates */
+
+	/* insertion sort, the last candidate is dropped if batch is full */
+	i = cb->cb_nr < cb->cb_max ? cb->cb_nr++ : cb->cb_nr - 1;
+	for (; i > 0 && evt_rect_off_cmp(rect, &cb->cb_rects[i - 1]) < 0; i--)
+		cb->cb_rects[i] = cb->cb_rects[i - 1];
+
+	cb->cb_rects[i] = *rect;
+}
+
+/**
+ * Once the batch is full, a child node can be skipped if all its rectangles
+ * start after the last candidate, because none of them can be a candidate.
+ */
+static bool
+evt_compact_prune_cb(struct evt_context *tcx, struct evt_rect *mbr, void *arg)
+{
+	struct evt_compact_batch *cb = arg;
+
+	return cb->cb_nr == cb->cb_max &&
+	       mbr->rc_off_lo > cb->cb_rects[cb->cb_nr - 1].rc_off_lo;
+}
+
+/**
+ * Free extents which are fully covered by newer extents at \a epoch.
+ *
+ * Please check API comment in evtree.h for the details.
+ */
+int
+evt_compact(daos_handle_t toh, daos_epoch_t epoch, unsigned int *credits,
+	    daos_hash_out_t *anchor)
+{
+	struct evt_context		*tcx;
+	struct evt_compact_batch	 cb;
+	struct evt_rect			*rect;
+	struct evt_rect			 srch;
+	unsigned int			 i;
+	int				 freed = 0;
+	int				 rc = 0;
+
+	tcx = evt_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (daos_hash_is_eof(anchor))
+		return 0;
+
+	memset(&cb, 0, sizeof(cb));
+	cb.cb_epoch = epoch;
+	if (!daos_hash_is_zero(anchor)) {
+		memcpy(&cb.cb_last, &anchor->body[0], sizeof(cb.cb_last));
+		cb.cb_started = true;
+	}
+
+	while (*credits > 0) {
+		cb.cb_nr = 0;
+		cb.cb_visited = 0;
+		cb.cb_max = min(*credits, EVT_COMPACT_BATCH);
+		srch.rc_off_lo = cb.cb_started ? cb.cb_last.rc_off_lo : 0;
+		srch.rc_off_hi = ~0ULL;
+		srch.rc_epc_lo = epoch;
+		evt_walk(tcx, &srch, evt_compact_batch_cb,
+			 evt_compact_prune_cb, &cb);
+
+		/* charge the walk as well, but always check the first
+		 * candidate so each call can make progress.
+		 */
+		*credits -= min(*credits, cb.cb_visited);
+		for (i = 0; i < cb.cb_nr; i++) {
+			if (*credits == 0 && i > 0)
+				break;
+
+			rect = &cb.cb_rects[i];
+			if (*credits > 0)
+				(*credits)--;
+
+			cb.cb_last = *rect;
+			cb.cb_started = true;
+			rc = evt_rect_is_covered(tcx, rect, epoch);
+			if (rc < 0)
+				D_GOTO(out, rc);
+			if (rc == 0)
+				continue;
+
+			D_DEBUG(DB_TRACE, "Free covered rect "DF_RECT"\n",
+				DP_RECT(rect));
+
+			evt_ent_list_init(&tcx->tc_ent_list);
+			rc = evt_find_ent_list(tcx, EVT_FIND_SAME, rect,
+					       &tcx->tc_ent_list);
+			if (rc == 0 && !evt_ent_list_empty(&tcx->tc_ent_list))
+				rc = evt_node_delete(tcx);
+			evt_ent_list_fini(&tcx->tc_ent_list);
+			if (rc != 0)
+				D_GOTO(out, rc);
+			freed++;
+		}
+
+		if (cb.cb_nr < cb.cb_max && i == cb.cb_nr) {
+			/* all rectangles have been checked */
+			daos_hash_set_eof(anchor);
+			D_GOTO(out, rc = 0);
+		}
+	}
+
+	if (cb.cb_started) {
+		memset(anchor, 0, sizeof(*anchor));
+		memcpy(&anchor->body[0], &cb.cb_last, sizeof(cb.cb_last));
+	}
+out:
+	D_DEBUG(DB_TRACE, "Compacted %d extents at epoch "DF_U64"\n",
+		freed, epoch);
+	return rc;
+}
+
 /** move the probing trace forward or backward */
 bool
 evt_move_trace(struct evt_context *tcx, bool forward)
@@ -230,7 +230,8 @@ ts_add_rect(char *args)
 	sgl.sg_nr = 1;
 	sgl.sg_iovs = &iov;
 
-	rc = evt_insert_sgl(ts_toh, ts_uuid, 0, &rect, val ? 1 : 0, &sgl);
+	rc = evt_insert_sgl(ts_toh, ts_uuid, 0, &rect, val ? 1 : 0, &sgl,
+			    NULL);
 	if (rc == 0)
 		total_added++;
 	if (should_pass) {
@@ -247,6 +248,35 @@ ts_add_rect(char *args)
 	return rc;
 }
 
+/** compare streamed visible extents with the sorted list of evt_find */
+static int
+ts_visible_cb(struct evt_entry *ent, void *arg)
+{
+	struct evt_entry_list	*enlist = arg;
+	struct evt_entry	*exp;
+
+	if (evt_ent_list_empty(enlist)) {
+		D_PRINT("Unexpected visible rect "DF_RECT"\n",
+			DP_RECT(&ent->en_sel_rect));
+		return -DER_INVAL;
+	}
+
+	exp = d_list_entry(enlist->el_list.next, struct evt_entry, en_link);
+	if (exp->en_sel_rect.rc_off_lo != ent->en_sel_rect.rc_off_lo ||
+	    exp->en_sel_rect.rc_off_hi != ent->en_sel_rect.rc_off_hi ||
+	    exp->en_sel_rect.rc_epc_lo != ent->en_sel_rect.rc_epc_lo ||
+	    exp->en_addr != ent->en_addr) {
+		D_PRINT("Visible rect "DF_RECT" mismatch, expected "DF_RECT
+			"\n", DP_RECT(&ent->en_sel_rect),
+			DP_RECT(&exp->en_sel_rect));
+		return -DER_INVAL;
+	}
+
+	/* NB: entries are still owned by the pools of @enlist */
+	d_list_del_init(&exp->en_link);
+	return 0;
+}
+
 static int
 ts_find_rect(char *args)
 {
@@ -279,6 +309,18 @@ ts_find_rect(char *args)
 			ent->en_addr ? (char *)ent->en_addr : "<NULL>");
 	}
 
+	/* the streamed fragments should consume the whole list */
+	rc = evt_find_visible(ts_toh, &rect, ts_visible_cb, &enlist);
+	if (rc == 0 && !evt_ent_list_empty(&enlist)) {
+		ent = d_list_entry(enlist.el_list.next, struct evt_entry,
+				   en_link);
+		D_PRINT("Missing visible rect "DF_RECT"\n",
+			DP_RECT(&ent->en_sel_rect));
+		rc = -DER_INVAL;
+	}
+	if (rc != 0)
+		D_FATAL("Streaming visible rects failed %d\n", rc);
+
 	evt_ent_list_fini(&enlist);
 	return rc;
 }
@@ -338,6 +380,102 @@ ts_list_rect(void)
 	return 0;
 }
 
+/** count extents which are older than \a epoch */
+static int
+ts_count_rect(daos_epoch_t epoch)
+{
+	struct evt_entry ent;
+	daos_handle_t	 ih;
+	int		 nr = 0;
+	int		 rc;
+
+	rc = evt_iter_prepare(ts_toh, 0, &ih);
+	if (rc != 0)
+		D_FATAL("Failed to prepare iterator: %d\n", rc);
+
+	rc = evt_iter_probe(ih, EVT_ITER_FIRST, NULL, NULL);
+	while (rc == 0) {
+		rc = evt_iter_fetch(ih, &ent, NULL);
+		if (rc != 0)
+			break;
+
+		if (ent.en_rect.rc_epc_lo < epoch)
+			nr++;
+		rc = evt_iter_next(ih);
+	}
+	if (rc != -DER_NONEXIST)
+		D_FATAL("Failed to count rects: %d\n", rc);
+
+	evt_iter_finish(ih);
+	return nr;
+}
+
+/** small to exercise the anchor */
+#define TS_COMPACT_CREDITS	8
+
+static int
+ts_compact(char *args)
+{
+	struct evt_entry_list	enlist;
+	struct evt_rect		rect;
+	d_list_t		covered;
+	daos_hash_out_t		anchor;
+	daos_epoch_t		epoch;
+	int			nr;
+	int			steps;
+	int			rc;
+
+	epoch = strtoull(args, NULL, 0);
+	if (epoch == 0) {
+		D_PRINT("Invalid epoch %s\n", args);
+		return -1;
+	}
+
+	/* visible extents at @epoch should not be changed by compaction */
+	rect.rc_off_lo = 0;
+	rect.rc_off_hi = ~0ULL;
+	rect.rc_epc_lo = epoch;
+
+	evt_ent_list_init(&enlist);
+	rc = evt_find(ts_toh, &rect, &enlist, &covered);
+	if (rc != 0)
+		D_FATAL("Find rect failed %d\n", rc);
+
+	nr = ts_count_rect(epoch);
+	memset(&anchor, 0, sizeof(anchor));
+	for (steps = 0; !daos_hash_is_eof(&anchor); steps++) {
+		unsigned int	credits = TS_COMPACT_CREDITS;
+
+		rc = evt_compact(ts_toh, epoch, &credits, &anchor);
+		if (rc != 0)
+			D_FATAL("Compact at "DF_U64" failed %d\n", epoch, rc);
+
+		if (!daos_hash_is_eof(&anchor) && credits != 0)
+			D_FATAL("Compaction stopped with %u credits left\n",
+				credits);
+		if (steps > nr)
+			D_FATAL("Compaction made no progress\n");
+	}
+	D_PRINT("Compacted %d extents at "DF_U64" in %d steps\n",
+		nr, epoch, steps);
+
+	/* each extent is scanned at least once before being checked, and
+	 * a call does at most one check beyond its credits.
+	 */
+	if (steps < 2 * nr / (TS_COMPACT_CREDITS + 1))
+		D_FATAL("Compaction of %d extents is not bounded by credits, "
+			"%d steps\n", nr, steps);
+
+	rc = evt_find_visible(ts_toh, &rect, ts_visible_cb, &enlist);
+	if (rc == 0 && !evt_ent_list_empty(&enlist))
+		rc = -DER_INVAL;
+	if (rc != 0)
+		D_FATAL("Visible rects changed after compaction %d\n", rc);
+
+	evt_ent_list_fini(&enlist);
+	return rc;
+}
+
 #define TS_VAL_CYCLE	4
 
 static int
@@ -419,7 +557,7 @@ ts_many_add(char *args)
 		sgl.sg_nr = 1;
 		sgl.sg_iovs = &iov;
 
-		rc = evt_insert_sgl(ts_toh, ts_uuid, 0, &rect, 1, &sgl);
+		rc = evt_insert_sgl(ts_toh, ts_uuid, 0, &rect, 1, &sgl, NULL);
 		if (rc != 0) {
 			D_FATAL("Add rect %d failed %d\n", i, rc);
 			break;
@@ -451,6 +589,7 @@ static struct option ts_ops[] = {
 	{ "find",	required_argument,	NULL,	'f'	},
 	{ "delete",	required_argument,	NULL,	'd'	},
 	{ "list",	no_argument,		NULL,	'l'	},
+	{ "compact",	required_argument,	NULL,	'p'	},
 	{ "debug",	required_argument,	NULL,	'b'	},
 	{ NULL,		0,			NULL,	0	},
 };
@@ -485,6 +624,9 @@ ts_cmd_run(char opc, char *args)
 	case 'l':
 		rc = ts_list_rect();
 		break;
+	case 'p':
+		rc = ts_compact(args);
+		break;
 	case 'b':
 		rc = ts_tree_debug(args);
 		break;
@@ -519,7 +661,7 @@ main(int argc, char **argv)
 	}
 
 	optind = 0;
-	while ((rc = getopt_long(argc, argv, "C:a:m:f:d:b:Docl",
+	while ((rc = getopt_long(argc, argv, "C:a:m:f:d:b:p:Docl",
 				 ts_ops, NULL)) != -1) {
 		rc = ts_cmd_run(rc, optarg);
 		if (rc != 0)
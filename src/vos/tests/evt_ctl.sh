@@ -67,6 +67,31 @@ EOF
 `
 }
 
+# value of $1 records, all filled with the same letter chosen by $2
+function fill_val {
+    c=$(printf "\\$(printf '%03o' $[ 97 + $2 % 26 ])")
+    printf "%$1s" | tr ' ' $c
+}
+
+# Many overlapping extents, each one is newer than the extents it overlaps:
+# nested extents which shrink toward the middle, and a staircase of extents
+# which start after the previous one, so a find has to cut many fragments.
+function overlap_set {
+    j=0
+    while [ $j -lt 48 ]; do
+        lo=$[ 200 + $j ]
+        hi=$[ 300 - $j ]
+        cmd+=" -a $lo-$hi@$[ 70000 + $j ]:$(fill_val $[ $hi - $lo + 1 ] $j)"
+        lo=$[ 290 + $j * 2 ]
+        hi=$[ $lo + 30 ]
+        cmd+=" -a $lo-$hi@$[ 70100 + $j ]:$(fill_val 31 $[ $j + 13 ])"
+        j=$[ $j + 1 ]
+    done
+
+    cmd+=" -f 200-400@70200 -f 190-410@70024 -f 250-350@70120"
+    cmd+=" -f 240-260@70047 -f 300-330@70099"
+}
+
 i=0
 while [ $i -lt 20 ]; do
     base=$[ i * 9 ]
@@ -75,8 +100,10 @@ while [ $i -lt 20 ]; do
     i=$[ $i + 1 ]
 done
 
+overlap_set
+
 echo $cmd
 
-$cmd -b "-1" -a "20-25@60000:finish" -D
+$cmd -p 100 -f 0-100@200 -b "-1" -a "20-25@60000:finish" -D
 
 echo Test returned $?
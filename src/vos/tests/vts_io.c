@@ -1569,6 +1569,269 @@ failed:
 	assert_int_equal(rc, 0);
 }
 
+#define IO_MULTI_DKEY_NR	8
+
+struct io_multi_dkey_bufs {
+	vos_dkey_io_t		dios[IO_MULTI_DKEY_NR];
+	daos_iod_t		iods[IO_MULTI_DKEY_NR];
+	daos_sg_list_t		sgls[IO_MULTI_DKEY_NR];
+	daos_iov_t		val_iovs[IO_MULTI_DKEY_NR];
+	char			dkey_bufs[IO_MULTI_DKEY_NR][UPDATE_DKEY_SIZE];
+	char			akey_buf[UPDATE_AKEY_SIZE];
+	char			update_bufs[IO_MULTI_DKEY_NR][UPDATE_BUF_SIZE];
+	char			fetch_bufs[IO_MULTI_DKEY_NR][UPDATE_BUF_SIZE];
+};
+
+/** Prepare a single value update under the same akey for each dkey */
+static void
+io_multi_dkey_prep(struct io_test_args *arg, struct io_multi_dkey_bufs *mb)
+{
+	daos_key_t	akey;
+	int		i;
+
+	memset(mb, 0, sizeof(*mb));
+	dts_key_gen(&mb->akey_buf[0], arg->akey_size, arg->akey);
+	set_iov(&akey, &mb->akey_buf[0], arg->ofeat & DAOS_OF_AKEY_UINT64);
+
+	for (i = 0; i < IO_MULTI_DKEY_NR; i++) {
+		dts_key_gen(&mb->dkey_bufs[i][0], arg->dkey_size, arg->dkey);
+		set_iov(&mb->dios[i].dio_dkey, &mb->dkey_bufs[i][0],
+			arg->ofeat & DAOS_OF_DKEY_UINT64);
+
+		/* dts_buf_render() reseeds by time, tag each value by dkey */
+		dts_buf_render(mb->update_bufs[i], UPDATE_BUF_SIZE);
+		mb->update_bufs[i][0] = '0' + i;
+		daos_iov_set(&mb->val_iovs[i], &mb->update_bufs[i][0],
+			     UPDATE_BUF_SIZE);
+		mb->sgls[i].sg_nr	= 1;
+		mb->sgls[i].sg_iovs	= &mb->val_iovs[i];
+
+		mb->iods[i].iod_name = akey;
+		mb->iods[i].iod_type = DAOS_IOD_SINGLE;
+		mb->iods[i].iod_size = UPDATE_BUF_SIZE;
+		mb->iods[i].iod_nr   = 1;
+
+		mb->dios[i].dio_iod_nr = 1;
+		mb->dios[i].dio_iods   = &mb->iods[i];
+		mb->dios[i].dio_sgls   = &mb->sgls[i];
+	}
+}
+
+/** Switch the prepared updates to fetch all values into fetch_bufs */
+static int
+io_multi_dkey_fetch(struct io_test_args *arg, struct io_multi_dkey_bufs *mb,
+		    daos_epoch_t epoch)
+{
+	int	i;
+
+	memset(mb->fetch_bufs, 0, sizeof(mb->fetch_bufs));
+	for (i = 0; i < IO_MULTI_DKEY_NR; i++) {
+		daos_iov_set(&mb->val_iovs[i], &mb->fetch_bufs[i][0],
+			     UPDATE_BUF_SIZE);
+		mb->iods[i].iod_size = DAOS_REC_ANY;
+	}
+
+	return vos_obj_fetch_multi(arg->ctx.tc_co_hdl, arg->oid, epoch,
+				   IO_MULTI_DKEY_NR, mb->dios);
+}
+
+static void
+io_multi_dkey_update_fetch(void **state)
+{
+	struct io_test_args		*arg = *state;
+	struct io_multi_dkey_bufs	*mb;
+	daos_epoch_t			 epoch = gen_rand_epoch();
+	struct d_uuid			 cookie;
+	int				 i;
+	int				 rc;
+
+	D_ALLOC_PTR(mb);
+	assert_non_null(mb);
+	io_multi_dkey_prep(arg, mb);
+
+	cookie = gen_rand_cookie();
+	rc = vos_obj_update_multi(arg->ctx.tc_co_hdl, arg->oid, epoch,
+				  cookie.uuid, 0, IO_MULTI_DKEY_NR, mb->dios);
+	assert_int_equal(rc, 0);
+
+	rc = io_multi_dkey_fetch(arg, mb, epoch);
+	assert_int_equal(rc, 0);
+
+	for (i = 0; i < IO_MULTI_DKEY_NR; i++) {
+		assert_int_equal(mb->iods[i].iod_size, UPDATE_BUF_SIZE);
+		assert_memory_equal(mb->update_bufs[i], mb->fetch_bufs[i],
+				    UPDATE_BUF_SIZE);
+	}
+	D_FREE_PTR(mb);
+}
+
+/**
+ * The last dkey of a batched update has a value shorter than its iod, the
+ * whole batch should fail and none of the dkeys should be visible.
+ */
+static void
+io_multi_dkey_update_abort(void **state)
+{
+	struct io_test_args		*arg = *state;
+	struct io_multi_dkey_bufs	*mb;
+	daos_epoch_t			 epoch = gen_rand_epoch();
+	struct d_uuid			 cookie;
+	int				 i;
+	int				 rc;
+
+	D_ALLOC_PTR(mb);
+	assert_non_null(mb);
+	io_multi_dkey_prep(arg, mb);
+	mb->val_iovs[IO_MULTI_DKEY_NR - 1].iov_len = UPDATE_BUF_SIZE / 2;
+
+	cookie = gen_rand_cookie();
+	rc = vos_obj_update_multi(arg->ctx.tc_co_hdl, arg->oid, epoch,
+				  cookie.uuid, 0, IO_MULTI_DKEY_NR, mb->dios);
+	assert_int_not_equal(rc, 0);
+
+	rc = io_multi_dkey_fetch(arg, mb, epoch);
+	assert_int_equal(rc, 0);
+
+	for (i = 0; i < IO_MULTI_DKEY_NR; i++)
+		assert_int_equal(mb->iods[i].iod_size, 0);
+	D_FREE_PTR(mb);
+}
+
+#define IO_INLINE_NR		32
+#define IO_INLINE_VAL_MAX	(VOS_SINGV_INLINE_MAX * 2)
+
+/**
+ * Small single values are stored inline in records of the single value tree.
+ * Update values of mixed sizes in reverse epoch order so btree has to move
+ * records, then verify all of them by both copy and zero-copy fetch.
+ */
+static void
+io_inline_value_update_fetch(void **state)
+{
+	struct io_test_args	*arg = *state;
+	daos_iod_t		 iod;
+	daos_sg_list_t		 sgl;
+	daos_iov_t		 val_iov;
+	daos_key_t		 dkey;
+	daos_key_t		 akey;
+	char			 dkey_buf[UPDATE_DKEY_SIZE];
+	char			 akey_buf[UPDATE_AKEY_SIZE];
+	char			 update_bufs[IO_INLINE_NR][IO_INLINE_VAL_MAX];
+	char			 fetch_buf[IO_INLINE_VAL_MAX];
+	daos_size_t		 sizes[IO_INLINE_NR];
+	daos_epoch_t		 epoch = gen_rand_epoch();
+	struct d_uuid		 cookie;
+	int			 zc;
+	int			 i;
+	int			 rc;
+
+	memset(&iod, 0, sizeof(iod));
+	memset(&sgl, 0, sizeof(sgl));
+
+	dts_key_gen(&dkey_buf[0], arg->dkey_size, arg->dkey);
+	set_iov(&dkey, &dkey_buf[0], arg->ofeat & DAOS_OF_DKEY_UINT64);
+	dts_key_gen(&akey_buf[0], arg->akey_size, arg->akey);
+	set_iov(&akey, &akey_buf[0], arg->ofeat & DAOS_OF_AKEY_UINT64);
+
+	iod.iod_name = akey;
+	iod.iod_type = DAOS_IOD_SINGLE;
+	iod.iod_nr   = 1;
+	sgl.sg_nr    = 1;
+	sgl.sg_iovs  = &val_iov;
+
+	arg->ta_flags = 0; /* zero-copy update is never inline */
+	cookie = gen_rand_cookie();
+	for (i = IO_INLINE_NR - 1; i >= 0; i--) {
+		sizes[i] = (i * 7) % IO_INLINE_VAL_MAX + 1;
+		dts_buf_render(update_bufs[i], sizes[i]);
+		daos_iov_set(&val_iov, &update_bufs[i][0], sizes[i]);
+		iod.iod_size = sizes[i];
+
+		rc = io_test_obj_update(arg, epoch + i, &dkey, &iod, &sgl,
+					&cookie, true);
+		assert_int_equal(rc, 0);
+	}
+
+	for (zc = 0; zc < 2; zc++) {
+		arg->ta_flags = zc ? TF_ZERO_COPY : 0;
+		for (i = 0; i < IO_INLINE_NR; i++) {
+			memset(fetch_buf, 0, sizeof(fetch_buf));
+			daos_iov_set(&val_iov, &fetch_buf[0],
+				     IO_INLINE_VAL_MAX);
+			iod.iod_size = DAOS_REC_ANY;
+
+			rc = io_test_obj_fetch(arg, epoch + i, &dkey, &iod,
+					       &sgl, true);
+			assert_int_equal(rc, 0);
+			assert_int_equal(iod.iod_size, sizes[i]);
+			assert_memory_equal(update_bufs[i], fetch_buf,
+					    sizes[i]);
+		}
+	}
+}
+
+/**
+ * Create a fresh object, dkey and single value akey by the regular update
+ * path, for values both below and above the inline threshold.
+ */
+static void
+io_inline_value_new_akey(void **state)
+{
+	struct io_test_args	*arg = *state;
+	daos_iod_t		 iod;
+	daos_sg_list_t		 sgl;
+	daos_iov_t		 val_iov;
+	daos_key_t		 dkey;
+	daos_key_t		 akey;
+	char			 dkey_buf[UPDATE_DKEY_SIZE];
+	char			 akey_buf[UPDATE_AKEY_SIZE];
+	char			 update_buf[IO_INLINE_VAL_MAX];
+	char			 fetch_buf[IO_INLINE_VAL_MAX];
+	daos_size_t		 sizes[] = {1, VOS_SINGV_INLINE_MAX,
+					    VOS_SINGV_INLINE_MAX + 1,
+					    IO_INLINE_VAL_MAX};
+	daos_epoch_t		 epoch = gen_rand_epoch();
+	struct d_uuid		 cookie;
+	int			 i;
+	int			 rc;
+
+	memset(&iod, 0, sizeof(iod));
+	memset(&sgl, 0, sizeof(sgl));
+	iod.iod_type = DAOS_IOD_SINGLE;
+	iod.iod_nr   = 1;
+	sgl.sg_nr    = 1;
+	sgl.sg_iovs  = &val_iov;
+
+	arg->ta_flags = 0;
+	cookie = gen_rand_cookie();
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		arg->oid = gen_oid(arg->ofeat);
+		dts_key_gen(&dkey_buf[0], arg->dkey_size, arg->dkey);
+		set_iov(&dkey, &dkey_buf[0], arg->ofeat & DAOS_OF_DKEY_UINT64);
+		dts_key_gen(&akey_buf[0], arg->akey_size, arg->akey);
+		set_iov(&akey, &akey_buf[0], arg->ofeat & DAOS_OF_AKEY_UINT64);
+		iod.iod_name = akey;
+
+		dts_buf_render(update_buf, sizes[i]);
+		daos_iov_set(&val_iov, &update_buf[0], sizes[i]);
+		iod.iod_size = sizes[i];
+
+		rc = vos_obj_update(arg->ctx.tc_co_hdl, arg->oid, epoch,
+				    cookie.uuid, 0, &dkey, 1, &iod, &sgl);
+		assert_int_equal(rc, 0);
+
+		memset(fetch_buf, 0, sizeof(fetch_buf));
+		daos_iov_set(&val_iov, &fetch_buf[0], IO_INLINE_VAL_MAX);
+		iod.iod_size = DAOS_REC_ANY;
+
+		rc = vos_obj_fetch(arg->ctx.tc_co_hdl, arg->oid, epoch,
+				   &dkey, 1, &iod, &sgl);
+		assert_int_equal(rc, 0);
+		assert_int_equal(iod.iod_size, sizes[i]);
+		assert_memory_equal(update_buf, fetch_buf, sizes[i]);
+	}
+}
+
 static void
 io_simple_punch(void **state)
 {
@@ -1704,6 +1967,14 @@ static const struct CMUnitTest io_tests[] = {
 		io_simple_punch, NULL, NULL},
 	{ "VOS205: Simple near-epoch retrieval test",
 		io_simple_near_epoch, NULL, NULL},
+	{ "VOS206: Batched multi-dkey update/fetch/verify test",
+		io_multi_dkey_update_fetch, NULL, NULL},
+	{ "VOS206.1: Batched multi-dkey update all-or-none test",
+		io_multi_dkey_update_abort, NULL, NULL},
+	{ "VOS207: Inline single value update/fetch/verify test",
+		io_inline_value_update_fetch, NULL, NULL},
+	{ "VOS208: Single value update/fetch on a new akey test",
+		io_inline_value_new_akey, NULL, NULL},
 	{ "VOS220: 100K update/fetch/verify test",
 		io_multiple_dkey, NULL, NULL},
 	{ "VOS222: overwrite test",
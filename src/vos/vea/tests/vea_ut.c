@@ -52,6 +52,19 @@ struct vea_ut_args {
 
 static struct vea_ut_args	ut_args;
 
+/* Unmap calls & unmapped bytes recorded by ut_unmap_cb() */
+static uint64_t			ut_unmap_calls;
+static uint64_t			ut_unmap_bytes;
+
+static int
+ut_unmap_cb(uint64_t off, uint64_t cnt, void *data)
+{
+	assert_true(off != 0 && cnt != 0);
+	ut_unmap_calls++;
+	ut_unmap_bytes += cnt;
+	return 0;
+}
+
 static void
 print_usage(void)
 {
@@ -96,13 +109,11 @@ ut_load(void **state)
 	struct vea_unmap_context unmap_ctxt;
 	int rc;
 
-	unmap_ctxt.vnc_unmap = NULL;
+	unmap_ctxt.vnc_unmap = ut_unmap_cb;
 	unmap_ctxt.vnc_data = NULL;
 	rc = vea_load(&args->vua_umm, args->vua_md, &unmap_ctxt,
 		      &args->vua_vsi);
 	assert_int_equal(rc, 0);
-
-	/* TODO: Test VOS unmap callback */
 }
 
 static void
@@ -296,6 +307,111 @@ ut_tx_publish(void **state)
 	}
 }
 
+static void
+ut_magazine(void **state)
+{
+	struct vea_ut_args *args = *state;
+	struct vea_hint_context *h_ctxt;
+	struct vea_resrvd_ext *ext, *copy;
+	d_list_t *r_list;
+	uint64_t blk_off = VEA_HINT_OFF_INVAL;
+	uint32_t blk_cnt = 8;
+	int rc, i;
+
+	/*
+	 * The hint of I/O stream 0 was cancelled, its reservations will be
+	 * served by the magazine, they should be contiguous and published
+	 * as a single extent.
+	 */
+	r_list = &args->vua_resrvd_list[0];
+	h_ctxt = args->vua_hint_ctxt[0];
+	for (i = 0; i < 4; i++) {
+		rc = vea_reserve(args->vua_vsi, blk_cnt, h_ctxt, r_list);
+		assert_int_equal(rc, 0);
+
+		ext = d_list_entry(r_list->prev, struct vea_resrvd_ext,
+				   vre_link);
+		assert_int_equal(ext->vre_blk_cnt, blk_cnt);
+		if (i == 0)
+			blk_off = ext->vre_blk_off;
+		else
+			assert_int_equal(ext->vre_blk_off,
+					 blk_off + i * blk_cnt);
+
+		rc = vea_verify_alloc(args->vua_vsi, true, ext->vre_blk_off,
+				      blk_cnt);
+		assert_int_equal(rc, 0);
+	}
+
+	D_ALLOC_PTR(copy);
+	assert_ptr_not_equal(copy, NULL);
+
+	D_INIT_LIST_HEAD(&copy->vre_link);
+	copy->vre_blk_off = blk_off;
+	copy->vre_blk_cnt = blk_cnt * 4;
+	d_list_add(&copy->vre_link, &args->vua_alloc_list);
+
+	print_message("publish reservation from magazine\n");
+	rc = umem_tx_begin(&args->vua_umm);
+	assert_int_equal(rc, 0);
+	rc = vea_tx_publish(args->vua_vsi, h_ctxt, r_list);
+	assert_int_equal(rc, 0);
+	rc = umem_tx_commit(&args->vua_umm);
+	assert_int_equal(rc, 0);
+
+	rc = vea_verify_alloc(args->vua_vsi, false, blk_off, blk_cnt * 4);
+	assert_int_equal(rc, 0);
+
+	/* the rest of the carved extents are still cached */
+	rc = vea_verify_alloc(args->vua_vsi, true, blk_off + blk_cnt * 4,
+			      blk_cnt);
+	assert_int_equal(rc, 0);
+
+	print_message("flush magazines\n");
+	rc = vea_flush(args->vua_vsi);
+	assert_int_equal(rc, 0);
+	rc = vea_verify_alloc(args->vua_vsi, true, blk_off + blk_cnt * 4,
+			      blk_cnt);
+	assert_int_equal(rc, 1);
+}
+
+static void
+ut_query(void **state)
+{
+	struct vea_ut_args *args = *state;
+	struct vea_stat stat;
+	uint64_t frags, hist_cnt = 0;
+	int rc, i;
+
+	rc = vea_query(args->vua_vsi, &stat);
+	assert_int_equal(rc, 0);
+
+	print_message("free:"DF_U64" frags:"DF_U64" largest:"DF_U64
+		      " frag_ratio:%u%% hint_ratio:%u%%\n",
+		      stat.vs_free_blks, stat.vs_frags, stat.vs_largest_blks,
+		      stat.vs_frag_ratio, stat.vs_hint_ratio);
+
+	assert_true(stat.vs_frags > 0);
+	assert_true(stat.vs_largest_blks <= stat.vs_free_blks);
+	assert_true(stat.vs_frag_ratio <= 100);
+	assert_true(stat.vs_hint_hits > 0);
+	assert_true(stat.vs_hint_hits <= stat.vs_hint_tries);
+	for (i = 0; i < VEA_STAT_HIST_NR; i++)
+		hist_cnt += stat.vs_hist[i];
+	assert_int_equal(hist_cnt, stat.vs_frags);
+	frags = stat.vs_frags;
+
+	print_message("defragment free space\n");
+	rc = vea_defrag(args->vua_vsi);
+	assert_int_equal(rc, 0);
+
+	rc = vea_query(args->vua_vsi, &stat);
+	assert_int_equal(rc, 0);
+	assert_int_equal(stat.vs_mag_blks, 0);
+	assert_int_equal(stat.vs_agg_blks, 0);
+	assert_true(stat.vs_frags <= frags);
+}
+
 static void
 ut_free(void **state)
 {
@@ -328,6 +444,15 @@ ut_free(void **state)
 	print_message("persistent free extents:\n");
 	vea_dump(args->vua_vsi, false);
 
+	/* defragment doesn't reclaim the free extents before they expire */
+	rc = vea_defrag(args->vua_vsi);
+	assert_int_equal(rc, 0);
+	d_list_for_each_entry(ext, r_list, vre_link) {
+		rc = vea_verify_alloc(args->vua_vsi, true, ext->vre_blk_off,
+				      ext->vre_blk_cnt);
+		assert_int_equal(rc, 0);
+	}
+
 	/* wait for free extents expire */
 	print_message("wait for %d seconds ...\n", VEA_MIGRATE_INTVL);
 	sleep(VEA_MIGRATE_INTVL);
@@ -340,6 +465,10 @@ ut_free(void **state)
 	rc = vea_cancel(args->vua_vsi, h_ctxt, r_list);
 	assert_int_equal(rc, 0);
 
+	/* the reserve could refill a magazine */
+	rc = vea_flush(args->vua_vsi);
+	assert_int_equal(rc, 0);
+
 	r_list = &args->vua_alloc_list;
 	d_list_for_each_entry(ext, r_list, vre_link) {
 		blk_off = ext->vre_blk_off;
@@ -350,6 +479,184 @@ ut_free(void **state)
 	}
 }
 
+static void
+ut_unmap(void **state)
+{
+	struct vea_ut_args *args = *state;
+	struct vea_stat stat;
+	uint64_t queued, unmapped, blk_sz;
+	int rc;
+
+	blk_sz = args->vua_md->vsd_blk_sz;
+	rc = vea_query(args->vua_vsi, &stat);
+	assert_int_equal(rc, 0);
+
+	/* the freed extents are queued for unmap on migration */
+	queued = stat.vs_unmap_blks;
+	print_message("queued unmap blks:"DF_U64"\n", queued);
+	assert_true(queued > 0);
+	assert_true(ut_unmap_calls == 0);
+
+	rc = vea_unmap_poll(args->vua_vsi, 1, &unmapped);
+	assert_int_equal(rc, 0);
+	assert_int_equal(ut_unmap_bytes, unmapped * blk_sz);
+	assert_true(unmapped <= queued);
+
+	/* defragment drives the unmap, small extents are held back */
+	rc = vea_defrag(args->vua_vsi);
+	assert_int_equal(rc, 0);
+	rc = vea_query(args->vua_vsi, &stat);
+	assert_int_equal(rc, 0);
+	assert_true(stat.vs_unmap_blks <= queued - unmapped);
+	assert_int_equal(ut_unmap_bytes + stat.vs_unmap_blks * blk_sz,
+			 queued * blk_sz);
+
+	rc = vea_unmap_flush(args->vua_vsi);
+	assert_int_equal(rc, 0);
+	assert_int_equal(ut_unmap_bytes, queued * blk_sz);
+	print_message("unmapped "DF_U64" bytes in "DF_U64" calls\n",
+		      ut_unmap_bytes, ut_unmap_calls);
+
+	rc = vea_query(args->vua_vsi, &stat);
+	assert_int_equal(rc, 0);
+	assert_int_equal(stat.vs_unmap_blks, 0);
+}
+
+#define UT_VEC_ALLOC_MAX	16
+
+static int
+ut_reserve_publish(struct vea_ut_args *args, uint32_t blk_cnt,
+		   struct vea_resrvd_ext *copy)
+{
+	struct vea_hint_context *h_ctxt = args->vua_hint_ctxt[2];
+	d_list_t *r_list = &args->vua_resrvd_list[2];
+	struct vea_resrvd_ext *ext;
+	int rc;
+
+	rc = vea_reserve(args->vua_vsi, blk_cnt, h_ctxt, r_list);
+	if (rc)
+		return rc;
+
+	ext = d_list_entry(r_list->next, struct vea_resrvd_ext, vre_link);
+	*copy = *ext;
+	D_INIT_LIST_HEAD(&copy->vre_link);
+	/* The vector is freed on publish */
+	copy->vre_vector = NULL;
+
+	rc = umem_tx_begin(&args->vua_umm);
+	assert_int_equal(rc, 0);
+	rc = vea_tx_publish(args->vua_vsi, h_ctxt, r_list);
+	assert_int_equal(rc, 0);
+	rc = umem_tx_commit(&args->vua_umm);
+	assert_int_equal(rc, 0);
+
+	return 0;
+}
+
+static void
+ut_vector(void **state)
+{
+	struct vea_ut_args *args = *state;
+	struct vea_resrvd_ext allocs[UT_VEC_ALLOC_MAX], copy;
+	struct vea_ext_vector vec;
+	struct vea_stat stat;
+	uint32_t blk_cnt = 4096;
+	int nr, i, rc;
+
+	/* make all the freed extents visible for allocation */
+	rc = vea_defrag(args->vua_vsi);
+	assert_int_equal(rc, 0);
+
+	print_message("fill up the device with %u blocks extents\n", blk_cnt);
+	for (nr = 0; nr < UT_VEC_ALLOC_MAX; nr++) {
+		rc = ut_reserve_publish(args, blk_cnt, &allocs[nr]);
+		if (rc == -DER_NOMEM)
+			break;
+		assert_int_equal(rc, 0);
+	}
+	assert_true(nr > 2 && nr < UT_VEC_ALLOC_MAX);
+
+	/* punch holes by freeing every other extent */
+	for (i = 0; i < nr; i += 2) {
+		rc = vea_free(args->vua_vsi, allocs[i].vre_blk_off,
+			      allocs[i].vre_blk_cnt);
+		assert_int_equal(rc, 0);
+	}
+
+	/* wait for the holes expire */
+	print_message("wait for %d seconds ...\n", VEA_MIGRATE_INTVL);
+	sleep(VEA_MIGRATE_INTVL);
+	rc = vea_defrag(args->vua_vsi);
+	assert_int_equal(rc, 0);
+	rc = vea_query(args->vua_vsi, &stat);
+	assert_int_equal(rc, 0);
+
+	/* no single free extent is large enough */
+	blk_cnt = stat.vs_largest_blks + 1;
+	print_message("reserve vector of %u blocks, free:"DF_U64"\n",
+		      blk_cnt, stat.vs_free_blks);
+	assert_true(blk_cnt <= stat.vs_free_blks);
+
+	rc = vea_reserve(args->vua_vsi, blk_cnt, args->vua_hint_ctxt[2],
+			 &args->vua_resrvd_list[2]);
+	assert_int_equal(rc, 0);
+
+	copy = *d_list_entry(args->vua_resrvd_list[2].next,
+			     struct vea_resrvd_ext, vre_link);
+	assert_non_null(copy.vre_vector);
+	vec = *copy.vre_vector;
+	assert_true(vec.vev_size > 1);
+	assert_int_equal(copy.vre_blk_off, vec.vev_blk_off[0]);
+
+	for (i = 0; i < vec.vev_size; i++) {
+		rc = vea_verify_alloc(args->vua_vsi, true, vec.vev_blk_off[i],
+				      vec.vev_blk_cnt[i]);
+		assert_int_equal(rc, 0);
+	}
+
+	rc = umem_tx_begin(&args->vua_umm);
+	assert_int_equal(rc, 0);
+	rc = vea_tx_publish(args->vua_vsi, args->vua_hint_ctxt[2],
+			    &args->vua_resrvd_list[2]);
+	assert_int_equal(rc, 0);
+	rc = umem_tx_commit(&args->vua_umm);
+	assert_int_equal(rc, 0);
+
+	memset(&vec, 0, sizeof(vec));
+	rc = vea_get_ext_vector(args->vua_vsi, copy.vre_blk_off, blk_cnt,
+				&vec);
+	assert_int_equal(rc, 0);
+	assert_true(vec.vev_size > 1);
+
+	for (i = 0; i < vec.vev_size; i++) {
+		rc = vea_verify_alloc(args->vua_vsi, false, vec.vev_blk_off[i],
+				      vec.vev_blk_cnt[i]);
+		assert_int_equal(rc, 0);
+	}
+
+	print_message("free the extent vector\n");
+	rc = vea_free(args->vua_vsi, copy.vre_blk_off, blk_cnt);
+	assert_int_equal(rc, 0);
+
+	for (i = 0; i < vec.vev_size; i++) {
+		rc = vea_verify_alloc(args->vua_vsi, false, vec.vev_blk_off[i],
+				      vec.vev_blk_cnt[i]);
+		assert_int_equal(rc, 1);
+	}
+
+	/* the vector is gone, it's treated as a contiguous extent now */
+	rc = vea_get_ext_vector(args->vua_vsi, copy.vre_blk_off, blk_cnt,
+				&vec);
+	assert_int_equal(rc, 0);
+	assert_int_equal(vec.vev_size, 1);
+
+	for (i = 1; i < nr; i += 2) {
+		rc = vea_free(args->vua_vsi, allocs[i].vre_blk_off,
+			      allocs[i].vre_blk_cnt);
+		assert_int_equal(rc, 0);
+	}
+}
+
 static void
 ut_hint_unload(void **state)
 {
@@ -367,9 +674,19 @@ static void
 ut_unload(void **state)
 {
 	struct vea_ut_args *args = *state;
+	struct vea_stat stat;
+	uint64_t unmapped;
+	int rc;
+
+	rc = vea_query(args->vua_vsi, &stat);
+	assert_int_equal(rc, 0);
+	unmapped = ut_unmap_bytes;
 
+	/* the extents queued for unmap are unmapped on unload */
 	vea_unload(args->vua_vsi);
 	args->vua_vsi = NULL;
+	assert_int_equal(ut_unmap_bytes - unmapped,
+			 stat.vs_unmap_blks * args->vua_md->vsd_blk_sz);
 }
 
 static const struct CMUnitTest vea_uts[] = {
@@ -379,7 +696,11 @@ static const struct CMUnitTest vea_uts[] = {
 	{ "vea_reserve", ut_reserve, NULL, NULL},
 	{ "vea_cancel", ut_cancel, NULL, NULL},
 	{ "vea_tx_publish", ut_tx_publish, NULL, NULL},
+	{ "vea_magazine", ut_magazine, NULL, NULL},
+	{ "vea_query", ut_query, NULL, NULL},
 	{ "vea_free", ut_free, NULL, NULL},
+	{ "vea_unmap", ut_unmap, NULL, NULL},
+	{ "vea_vector", ut_vector, NULL, NULL},
 	{ "vea_hint_unload", ut_hint_unload, NULL, NULL},
 	{ "vea_unload", ut_unload, NULL, NULL},
 };
@@ -42,8 +42,14 @@ free_class_remove(struct vea_free_class *vfc, struct vea_entry *entry)
 int
 compound_vec_alloc(struct vea_space_info *vsi, struct vea_ext_vector *vec)
 {
-	/* TODO Add in in-memory extent vector tree */
-	return 0;
+	daos_iov_t key, val;
+
+	/* Extent vector is indexed by the offset of its first extent */
+	daos_iov_set(&key, &vec->vev_blk_off[0], sizeof(vec->vev_blk_off[0]));
+	daos_iov_set(&val, vec, sizeof(*vec));
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_vec_btr));
+	return dbtree_update(vsi->vsi_vec_btr, &key, &val);
 }
 
 static int
@@ -337,12 +343,224 @@ reserve_small(struct vea_space_info *vsi, uint32_t blk_cnt,
 	return rc;
 }
 
+/* Magazine index for @blk_cnt, -1 if it isn't served by magazines */
+static int
+blkcnt_to_mag(uint32_t blk_cnt)
+{
+	int idx;
+
+	if (blk_cnt == 0 || (blk_cnt & (blk_cnt - 1)) != 0)
+		return -1;
+
+	idx = __builtin_ctz(blk_cnt);
+	return idx < VEA_MAG_CLASS_CNT ? idx : -1;
+}
+
+/*
+ * Refill an empty magazine by carving a bulk extent reserved from the large
+ * or small free extents into VEA_MAG_DEPTH equal sized extents.
+ */
+static int
+magazine_refill(struct vea_space_info *vsi, struct vea_magazine *mag,
+		uint32_t blk_cnt)
+{
+	struct vea_resrvd_ext bulk;
+	uint32_t bulk_cnt = blk_cnt * VEA_MAG_DEPTH;
+	int i, rc;
+
+	D_ASSERT(mag->vm_cnt == 0);
+	memset(&bulk, 0, sizeof(bulk));
+
+	rc = reserve_large(vsi, bulk_cnt, &bulk);
+	if (rc == 0 && bulk.vre_blk_cnt == 0)
+		rc = reserve_small(vsi, bulk_cnt, &bulk);
+
+	/* No contiguous bulk extent, leave it to the regular reserve */
+	if (rc == -DER_NOMEM)
+		return 0;
+	else if (rc)
+		return rc;
+
+	/* Carved extents are popped in ascending offset order */
+	for (i = 0; i < VEA_MAG_DEPTH; i++)
+		mag->vm_offs[i] = bulk.vre_blk_off +
+				  (uint64_t)(VEA_MAG_DEPTH - 1 - i) * blk_cnt;
+	mag->vm_cnt = VEA_MAG_DEPTH;
+
+	D_DEBUG(DB_IO, "refilled magazine ["DF_U64", %u] * %d\n",
+		bulk.vre_blk_off, blk_cnt, VEA_MAG_DEPTH);
+	return 0;
+}
+
+int
+reserve_magazine(struct vea_space_info *vsi, uint32_t blk_cnt,
+		 struct vea_resrvd_ext *resrvd)
+{
+	struct vea_magazine *mag;
+	int idx, rc;
+
+	idx = blkcnt_to_mag(blk_cnt);
+	if (idx < 0)
+		return 0;
+
+	/* Bulk extent is always carved from a single free extent */
+	if (blk_cnt * VEA_MAG_DEPTH > vsi->vsi_class.vfc_large_thresh)
+		return 0;
+
+	mag = &vsi->vsi_mags[idx];
+	if (mag->vm_cnt == 0) {
+		rc = magazine_refill(vsi, mag, blk_cnt);
+		if (rc || mag->vm_cnt == 0)
+			return rc;
+	}
+
+	mag->vm_cnt--;
+	resrvd->vre_blk_off = mag->vm_offs[mag->vm_cnt];
+	resrvd->vre_blk_cnt = blk_cnt;
+
+	D_DEBUG(DB_IO, "["DF_U64", %u]\n", resrvd->vre_blk_off,
+		resrvd->vre_blk_cnt);
+
+	return 0;
+}
+
+/*
+ * Return all the extents cached in magazines to the compound index, returns
+ * the number of returned extents on success.
+ */
+int
+magazines_flush(struct vea_space_info *vsi)
+{
+	struct vea_free_extent vfe;
+	struct vea_magazine *mag;
+	int i, nr = 0, rc;
+
+	memset(&vfe, 0, sizeof(vfe));
+	for (i = 0; i < VEA_MAG_CLASS_CNT; i++) {
+		mag = &vsi->vsi_mags[i];
+		vfe.vfe_blk_cnt = 1U << i;
+
+		while (mag->vm_cnt > 0) {
+			vfe.vfe_blk_off = mag->vm_offs[mag->vm_cnt - 1];
+			rc = compound_free(vsi, &vfe, VEA_FL_GEN_AGE);
+			if (rc)
+				return rc;
+
+			mag->vm_cnt--;
+			nr++;
+		}
+	}
+
+	return nr;
+}
+
+/* Allocate the free extent starts from @vfe->vfe_blk_off */
+static int
+compound_alloc_off(struct vea_space_info *vsi, struct vea_free_extent *vfe)
+{
+	struct vea_entry *entry;
+	daos_iov_t key, val;
+	int rc;
+
+	daos_iov_set(&key, &vfe->vfe_blk_off, sizeof(vfe->vfe_blk_off));
+	daos_iov_set(&val, NULL, 0);
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_free_btr));
+	rc = dbtree_fetch(vsi->vsi_free_btr, BTR_PROBE_EQ, &key, NULL, &val);
+	if (rc)
+		return rc;
+
+	entry = (struct vea_entry *)val.iov_buf;
+	D_ASSERT(entry->ve_ext.vfe_blk_cnt >= vfe->vfe_blk_cnt);
+
+	return compound_alloc(vsi, vfe, entry);
+}
+
+/*
+ * Reserve an extent vector by gathering free extents from the size classed
+ * LRUs, larger extents have priority to keep the vector short. It's called
+ * when no single free extent is large enough, so the vfc_heap must be empty.
+ */
 int
 reserve_vector(struct vea_space_info *vsi, uint32_t blk_cnt,
 	       struct vea_resrvd_ext *resrvd)
 {
-	/* TODO reserve extent vector for non-contiguous allocation */
-	return -DER_NOMEM;
+	struct vea_free_class *vfc = &vsi->vsi_class;
+	struct vea_ext_vector *vec;
+	struct vea_free_extent vfe;
+	struct vea_entry *entry;
+	uint32_t tot_blks = 0, cnt;
+	uint64_t off;
+	int i, j, rc;
+
+	D_ALLOC_PTR(vec);
+	if (vec == NULL)
+		return -DER_NOMEM;
+
+	for (i = 0; i < vfc->vfc_lru_cnt && tot_blks < blk_cnt; i++) {
+		d_list_for_each_entry(entry, &vfc->vfc_lrus[i], ve_link) {
+			if (tot_blks == blk_cnt ||
+			    vec->vev_size == VEA_EXT_VECTOR_MAX)
+				break;
+
+			cnt = min(entry->ve_ext.vfe_blk_cnt,
+				  blk_cnt - tot_blks);
+			vec->vev_blk_off[vec->vev_size] =
+				entry->ve_ext.vfe_blk_off;
+			vec->vev_blk_cnt[vec->vev_size] = cnt;
+			vec->vev_size++;
+			tot_blks += cnt;
+		}
+	}
+
+	if (tot_blks < blk_cnt) {
+		D_DEBUG(DB_IO, "no extent vector for %u blks, %u/%u\n",
+			blk_cnt, tot_blks, vec->vev_size);
+		D_GOTO(error, rc = -DER_NOMEM);
+	}
+
+	/* Sort the vector by offset */
+	for (i = 1; i < vec->vev_size; i++) {
+		off = vec->vev_blk_off[i];
+		cnt = vec->vev_blk_cnt[i];
+		for (j = i; j > 0 && vec->vev_blk_off[j - 1] > off; j--) {
+			vec->vev_blk_off[j] = vec->vev_blk_off[j - 1];
+			vec->vev_blk_cnt[j] = vec->vev_blk_cnt[j - 1];
+		}
+		vec->vev_blk_off[j] = off;
+		vec->vev_blk_cnt[j] = cnt;
+	}
+
+	/*
+	 * Entry pointers can't be cached across compound_alloc(), since the
+	 * btree records could be moved by the tree update.
+	 */
+	for (i = 0; i < vec->vev_size; i++) {
+		vfe.vfe_blk_off = vec->vev_blk_off[i];
+		vfe.vfe_blk_cnt = vec->vev_blk_cnt[i];
+
+		rc = compound_alloc_off(vsi, &vfe);
+		if (rc)
+			goto rollback;
+	}
+
+	resrvd->vre_blk_off = vec->vev_blk_off[0];
+	resrvd->vre_blk_cnt = blk_cnt;
+	resrvd->vre_vector = vec;
+
+	D_DEBUG(DB_IO, "["DF_U64", %u] vector size: %u\n",
+		resrvd->vre_blk_off, resrvd->vre_blk_cnt, vec->vev_size);
+
+	return 0;
+rollback:
+	while (--i >= 0) {
+		vfe.vfe_blk_off = vec->vev_blk_off[i];
+		vfe.vfe_blk_cnt = vec->vev_blk_cnt[i];
+		compound_free(vsi, &vfe, VEA_FL_GEN_AGE);
+	}
+error:
+	D_FREE_PTR(vec);
+	return rc;
 }
 
 int
@@ -423,3 +641,40 @@ persistent_alloc(struct vea_space_info *vsi, struct vea_free_extent *vfe)
 
 	return 0;
 }
+
+/*
+ * Make an extent vector persistent, the allocated extents are removed from
+ * the persistent free extent tree, and the vector is recorded in both the
+ * persistent and the in-memory extent vector trees.
+ */
+int
+persistent_vec_alloc(struct vea_space_info *vsi, struct vea_ext_vector *vec)
+{
+	struct vea_free_extent vfe;
+	daos_iov_t key, val;
+	int i, rc;
+
+	D_ASSERT(pmemobj_tx_stage() == TX_STAGE_WORK);
+	rc = verify_vec_entry(NULL, vec);
+	if (rc)
+		return rc;
+
+	for (i = 0; i < vec->vev_size; i++) {
+		vfe.vfe_blk_off = vec->vev_blk_off[i];
+		vfe.vfe_blk_cnt = vec->vev_blk_cnt[i];
+
+		rc = persistent_alloc(vsi, &vfe);
+		if (rc)
+			return rc;
+	}
+
+	daos_iov_set(&key, &vec->vev_blk_off[0], sizeof(vec->vev_blk_off[0]));
+	daos_iov_set(&val, vec, sizeof(*vec));
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_md_vec_btr));
+	rc = dbtree_update(vsi->vsi_md_vec_btr, &key, &val);
+	if (rc)
+		return rc;
+
+	return compound_vec_alloc(vsi, vec);
+}
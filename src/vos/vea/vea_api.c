@@ -174,6 +174,13 @@ out:
 void
 vea_unload(struct vea_space_info *vsi)
 {
+	int rc;
+
+	/* Unmap the queued extents, they'd never be unmapped otherwise */
+	rc = unmap_issue(vsi, 0, true, NULL);
+	if (rc)
+		D_ERROR("failed to flush unmap queue rc:%d\n", rc);
+
 	unload_space_info(vsi);
 
 	/* Destroy the in-memory free extent tree */
@@ -194,6 +201,12 @@ vea_unload(struct vea_space_info *vsi)
 		vsi->vsi_agg_btr = DAOS_HDL_INVAL;
 	}
 
+	/* Destroy the in-memory unmap tree */
+	if (!daos_handle_is_inval(vsi->vsi_unmap_btr)) {
+		dbtree_destroy(vsi->vsi_unmap_btr);
+		vsi->vsi_unmap_btr = DAOS_HDL_INVAL;
+	}
+
 	destroy_free_class(&vsi->vsi_class);
 	D_FREE_PTR(vsi);
 }
@@ -230,6 +243,8 @@ vea_load(struct umem_instance *umem, struct vea_space_df *md,
 	vsi->vsi_tot_resrvd = 0;
 	vsi->vsi_agg_time = 0;
 	vsi->vsi_unmap_ctxt = *unmap_ctxt;
+	vsi->vsi_unmap_btr = DAOS_HDL_INVAL;
+	vsi->vsi_unmap_blks = 0;
 
 	rc = create_free_class(&vsi->vsi_class, md);
 	if (rc)
@@ -255,6 +270,12 @@ vea_load(struct umem_instance *umem, struct vea_space_df *md,
 	if (rc != 0)
 		goto error;
 
+	/* Create in-memory unmap tree */
+	rc = dbtree_create(DBTREE_CLASS_IV, 0, VEA_TREE_ODR, &uma,
+			   NULL, &vsi->vsi_unmap_btr);
+	if (rc != 0)
+		goto error;
+
 	/* Load free space tracking info from SCM */
 	rc = load_space_info(vsi);
 	if (rc)
@@ -267,6 +288,26 @@ error:
 	return rc;
 }
 
+/* Return all the extents of a canceled extent vector to compound index */
+static int
+cancel_vec(struct vea_space_info *vsi, struct vea_ext_vector *vec,
+	   unsigned int flags)
+{
+	struct vea_free_extent vfe;
+	int i, rc;
+
+	for (i = 0; i < vec->vev_size; i++) {
+		vfe.vfe_blk_off = vec->vev_blk_off[i];
+		vfe.vfe_blk_cnt = vec->vev_blk_cnt[i];
+
+		rc = compound_free(vsi, &vfe, flags);
+		if (rc)
+			return rc;
+	}
+
+	return 0;
+}
+
 /*
  * Reserve an extent on block device.
  *
@@ -277,20 +318,27 @@ error:
  * Reserve attempting order:
  *
  * 1. Reserve from the free extent with 'hinted' start offset. (vsi_free_tree)
- * 2. Reserve from the largest free extent if it isn't non-active (extent age
+ * 2. Pop a pre-carved extent from the magazine of the size class, refill the
+ *    magazine in bulk from 3rd or 4th step when it's empty. (vsi_mags)
+ * 3. Reserve from the largest free extent if it isn't non-active (extent age
  *    isn't VEA_EXT_AGE_MAX), otherwise, divide it in half-and-half and resreve
  *    from the latter half. (vfc_heap)
- * 3. Search & reserve from a bunch of extent size classed LRUs in first fit
- *    policy, larger & older free extent has priority. (vfc_lrus)
- * 4. Repeat the search in 3rd step to reserve an extent vector. (vsi_vec_tree)
- * 5. Fail reserve with ENOMEM if all above attempts fail.
+ * 4. Search & reserve from a bunch of extent size classed LRUs in first fit
+ *    policy, larger & older free extent has priority. (vfc_lrus) On failure,
+ *    reclaim the extents in magazines and the expired recently freed
+ *    extents, then retry from 3rd step.
+ * 5. Repeat the search in 4th step to reserve an extent vector. (vsi_vec_tree)
+ * 6. Fail reserve with ENOMEM if all above attempts fail.
  */
 int
 vea_reserve(struct vea_space_info *vsi, uint32_t blk_cnt,
 	    struct vea_hint_context *hint, d_list_t *resrvd_list)
 {
 	struct vea_resrvd_ext *resrvd;
-	int rc = 0;
+	struct vea_ext_vector *vec;
+	struct vea_stat *stat = &vsi->vsi_stat;
+	bool reclaimed = false;
+	int i, rc = 0;
 
 	if (blk_cnt > vsi->vsi_class.vfc_large_thresh) {
 		D_ERROR("required blk_cnt: %u > %u, blk_sz: %u\n",
@@ -300,7 +348,7 @@ vea_reserve(struct vea_space_info *vsi, uint32_t blk_cnt,
 	}
 
 	/* Trigger free extents migration */
-	migrate_free_exts(vsi);
+	migrate_free_exts(vsi, 0);
 
 	D_ALLOC_PTR(resrvd);
 	if (resrvd == NULL)
@@ -313,41 +361,102 @@ vea_reserve(struct vea_space_info *vsi, uint32_t blk_cnt,
 	hint_get(hint, &resrvd->vre_hint_off);
 
 	/* Reserve from hint offset */
+	if (resrvd->vre_hint_off != VEA_HINT_OFF_INVAL)
+		stat->vs_hint_tries++;
 	rc = reserve_hint(vsi, blk_cnt, resrvd);
 	if (rc != 0)
 		goto error;
-	else if (resrvd->vre_blk_cnt != 0)
+	else if (resrvd->vre_blk_cnt != 0) {
+		stat->vs_hint_hits++;
 		goto done;
+	}
 
+	/* Reserve from the magazine */
+	rc = reserve_magazine(vsi, blk_cnt, resrvd);
+	if (rc != 0)
+		goto error;
+	else if (resrvd->vre_blk_cnt != 0) {
+		stat->vs_resrv_mag++;
+		goto done;
+	}
+retry:
 	/* Reserve from the large extents */
 	rc = reserve_large(vsi, blk_cnt, resrvd);
 	if (rc != 0)
 		goto error;
-	else if (resrvd->vre_blk_cnt != 0)
+	else if (resrvd->vre_blk_cnt != 0) {
+		stat->vs_resrv_large++;
 		goto done;
+	}
 
 	/* Reserve from the small extents */
 	rc = reserve_small(vsi, blk_cnt, resrvd);
-	if (rc != 0)
-		goto error;
-	else if (resrvd->vre_blk_cnt != 0)
+	if (rc == -DER_NOMEM && !reclaimed) {
+		/*
+		 * Cached or expired free extents could satisfy it, extents
+		 * freed within VEA_MIGRATE_INTVL aren't reused.
+		 */
+		reclaimed = true;
+		rc = reclaim_free_exts(vsi, false);
+		if (rc > 0)
+			goto retry;
+		rc = rc ? : -DER_NOMEM;
+	}
+	if (rc == 0) {
+		D_ASSERT(resrvd->vre_blk_cnt != 0);
+		stat->vs_resrv_small++;
 		goto done;
+	} else if (rc != -DER_NOMEM) {
+		goto error;
+	}
 
 	/* Reserve extent vector as the last resort */
 	rc = reserve_vector(vsi, blk_cnt, resrvd);
 	if (rc != 0)
 		goto error;
+	stat->vs_resrv_vec++;
 done:
 	D_ASSERT(resrvd->vre_blk_off != VEA_HINT_OFF_INVAL);
 	D_ASSERT(resrvd->vre_blk_cnt == blk_cnt);
+	/* Don't unmap the reserved extent(s) queued for unmap */
+	vec = resrvd->vre_vector;
+	if (vec != NULL) {
+		for (i = 0; i < vec->vev_size && rc == 0; i++)
+			rc = unmap_cancel(vsi, vec->vev_blk_off[i],
+					  vec->vev_blk_cnt[i]);
+	} else {
+		rc = unmap_cancel(vsi, resrvd->vre_blk_off, blk_cnt);
+	}
+	if (rc != 0) {
+		struct vea_free_extent vfe;
+
+		D_ERROR("failed to cancel unmap rc:%d\n", rc);
+		/* Return the reserved extent(s) to compound index */
+		if (vec != NULL) {
+			cancel_vec(vsi, vec, VEA_FL_GEN_AGE);
+		} else {
+			vfe.vfe_blk_off = resrvd->vre_blk_off;
+			vfe.vfe_blk_cnt = resrvd->vre_blk_cnt;
+			compound_free(vsi, &vfe, VEA_FL_GEN_AGE);
+		}
+		goto error;
+	}
+
 	/* Update hint offset */
-	hint_update(hint, resrvd->vre_blk_off + blk_cnt,
-		    &resrvd->vre_hint_seq);
+	if (vec != NULL)
+		hint_update(hint, vec->vev_blk_off[vec->vev_size - 1] +
+			    vec->vev_blk_cnt[vec->vev_size - 1],
+			    &resrvd->vre_hint_seq);
+	else
+		hint_update(hint, resrvd->vre_blk_off + blk_cnt,
+			    &resrvd->vre_hint_seq);
 
 	d_list_add_tail(&resrvd->vre_link, resrvd_list);
 
 	return 0;
 error:
+	if (resrvd->vre_vector != NULL)
+		D_FREE_PTR(resrvd->vre_vector);
 	D_FREE_PTR(resrvd);
 	return rc;
 }
@@ -385,6 +494,16 @@ process_resrvd_list(struct vea_space_info *vsi, struct vea_hint_context *hint,
 		seq_max = resrvd->vre_hint_seq;
 		off_p = resrvd->vre_hint_off;
 
+		/* Extent vector is never merged with other reservations */
+		if (resrvd->vre_vector != NULL) {
+			rc = publish ?
+			     persistent_vec_alloc(vsi, resrvd->vre_vector) :
+			     cancel_vec(vsi, resrvd->vre_vector, flags);
+			if (rc)
+				goto error;
+			continue;
+		}
+
 		if (vfe.vfe_blk_cnt == 0) {
 			vfe.vfe_blk_off = resrvd->vre_blk_off;
 			vfe.vfe_blk_cnt = resrvd->vre_blk_cnt;
@@ -414,6 +533,8 @@ process_resrvd_list(struct vea_space_info *vsi, struct vea_hint_context *hint,
 error:
 	d_list_for_each_entry_safe(resrvd, tmp, resrvd_list, vre_link) {
 		d_list_del_init(&resrvd->vre_link);
+		if (resrvd->vre_vector != NULL)
+			D_FREE_PTR(resrvd->vre_vector);
 		D_FREE_PTR(resrvd);
 	}
 
@@ -462,35 +583,140 @@ int
 vea_free(struct vea_space_info *vsi, uint64_t blk_off, uint32_t blk_cnt)
 {
 	struct umem_instance *umem = vsi->vsi_umem;
+	struct vea_ext_vector vec;
 	struct vea_free_extent vfe;
-	int rc;
+	bool is_vec = true;
+	int i, rc;
+
+	/* Free all the extents of the vector if it's an extent vector */
+	rc = lookup_vec(vsi, blk_off, blk_cnt, &vec);
+	if (rc == -DER_NONEXIST) {
+		is_vec = false;
+		vec.vev_blk_off[0] = blk_off;
+		vec.vev_blk_cnt[0] = blk_cnt;
+		vec.vev_size = 1;
+	} else if (rc) {
+		return rc;
+	}
 
-	vfe.vfe_blk_off = blk_off;
-	vfe.vfe_blk_cnt = blk_cnt;
+	for (i = 0; i < vec.vev_size; i++) {
+		vfe.vfe_blk_off = vec.vev_blk_off[i];
+		vfe.vfe_blk_cnt = vec.vev_blk_cnt[i];
 
-	rc = verify_free_entry(NULL, &vfe);
-	if (rc)
-		return rc;
+		rc = verify_free_entry(NULL, &vfe);
+		if (rc)
+			return rc;
+	}
 
 	/* Start transaction */
 	rc = umem_tx_begin(umem);
 	if (rc != 0)
 		return rc;
 
-	/* Add the free extent in persistent free extent tree */
-	rc = persistent_free(vsi, &vfe);
+	/* Add the free extent(s) in persistent free extent tree */
+	for (i = 0; i < vec.vev_size && rc == 0; i++) {
+		vfe.vfe_blk_off = vec.vev_blk_off[i];
+		vfe.vfe_blk_cnt = vec.vev_blk_cnt[i];
+
+		rc = persistent_free(vsi, &vfe);
+	}
+
+	if (rc == 0 && is_vec)
+		rc = persistent_vec_free(vsi, &vec);
 
 	/* Commit/Abort transaction on success/error */
 	rc = rc ? umem_tx_abort(umem, rc) : umem_tx_commit(umem);
-	if (rc == 0)
+	if (rc == 0 && is_vec)
+		rc = compound_vec_free(vsi, &vec);
+
+	for (i = 0; i < vec.vev_size && rc == 0; i++) {
+		vfe.vfe_blk_off = vec.vev_blk_off[i];
+		vfe.vfe_blk_cnt = vec.vev_blk_cnt[i];
+
 		rc = aggregated_free(vsi, &vfe);
+	}
 
 	/* Migrate the expired aggregated free extents to compound index */
-	migrate_free_exts(vsi);
+	migrate_free_exts(vsi, 0);
 
 	return rc;
 }
 
+/* Return the pre-carved extents cached in magazines to the free index. */
+int
+vea_flush(struct vea_space_info *vsi)
+{
+	int rc;
+
+	rc = magazines_flush(vsi);
+	return rc < 0 ? rc : 0;
+}
+
+/*
+ * Unmap the queued free extents, at most @max_blks blocks are unmapped in a
+ * call to bound the unmap traffic. It's supposed to be called by a background
+ * poller of the caller.
+ */
+int
+vea_unmap_poll(struct vea_space_info *vsi, uint64_t max_blks,
+	       uint64_t *unmapped_blks)
+{
+	D_ASSERT(max_blks > 0);
+	return unmap_issue(vsi, max_blks, false, unmapped_blks);
+}
+
+/* Unmap all the queued free extents. */
+int
+vea_unmap_flush(struct vea_space_info *vsi)
+{
+	return unmap_issue(vsi, 0, true, NULL);
+}
+
+/* Query free space and fragmentation statistics. */
+int
+vea_query(struct vea_space_info *vsi, struct vea_stat *stat)
+{
+	int rc;
+
+	D_ASSERT(stat != NULL);
+	*stat = vsi->vsi_stat;
+	stat->vs_unmap_blks = vsi->vsi_unmap_blks;
+
+	rc = stat_free_exts(vsi, stat);
+	if (rc)
+		return rc;
+
+	if (stat->vs_free_blks != 0)
+		stat->vs_frag_ratio = (stat->vs_free_blks -
+				       stat->vs_largest_blks) * 100 /
+				      stat->vs_free_blks;
+	if (stat->vs_hint_tries != 0)
+		stat->vs_hint_ratio = stat->vs_hint_hits * 100 /
+				      stat->vs_hint_tries;
+	return 0;
+}
+
+/*
+ * Coalesce free extents to rebuild large contiguous free runs. It's supposed
+ * to be called by a background ULT of the caller. The extents freed within
+ * VEA_MIGRATE_INTVL are left aside, they could still be read by in-flight
+ * I/O against the old data.
+ *
+ * The queued unmaps are issued here as well, so the unmap traffic is driven
+ * by the same background ULT and bounded by VEA_DEFRAG_UNMAP_BLKS per call.
+ */
+int
+vea_defrag(struct vea_space_info *vsi)
+{
+	int rc;
+
+	rc = reclaim_free_exts(vsi, false);
+	if (rc < 0)
+		return rc;
+
+	return unmap_issue(vsi, VEA_DEFRAG_UNMAP_BLKS, false, NULL);
+}
+
 /* Set an arbitrary age to a free extent with specified start offset. */
 int
 vea_set_ext_age(struct vea_space_info *vsi, uint64_t blk_off, uint64_t age)
@@ -498,12 +724,27 @@ vea_set_ext_age(struct vea_space_info *vsi, uint64_t blk_off, uint64_t age)
 	return 0;
 }
 
-/* Convert an extent into an allocated extent vector. */
+/*
+ * Convert an extent into an allocated extent vector, a contiguous extent is
+ * converted into a vector with single extent.
+ */
 int
 vea_get_ext_vector(struct vea_space_info *vsi, uint64_t blk_off,
 		   uint32_t blk_cnt, struct vea_ext_vector *ext_vector)
 {
-	return 0;
+	int rc;
+
+	D_ASSERT(ext_vector != NULL);
+	rc = lookup_vec(vsi, blk_off, blk_cnt, ext_vector);
+	if (rc == -DER_NONEXIST) {
+		memset(ext_vector, 0, sizeof(*ext_vector));
+		ext_vector->vev_blk_off[0] = blk_off;
+		ext_vector->vev_blk_cnt[0] = blk_cnt;
+		ext_vector->vev_size = 1;
+		rc = 0;
+	}
+
+	return rc;
 }
 
 /* Load persistent hint data and initialize in-memory hint context */
@@ -29,6 +29,7 @@ enum vea_free_type {
 	VEA_TYPE_COMPOUND,
 	VEA_TYPE_AGGREGATE,
 	VEA_TYPE_PERSIST,
+	VEA_TYPE_UNMAP,
 };
 
 /*
@@ -54,6 +55,8 @@ merge_free_ext(struct vea_space_info *vsi, struct vea_free_extent *ext_in,
 		btr_hdl = vsi->vsi_md_free_btr;
 	else if (type  == VEA_TYPE_AGGREGATE)
 		btr_hdl = vsi->vsi_agg_btr;
+	else if (type == VEA_TYPE_UNMAP)
+		btr_hdl = vsi->vsi_unmap_btr;
 	else
 		return -DER_INVAL;
 
@@ -74,7 +77,7 @@ repeat:
 	else if (rc)
 		return rc;	/* Error */
 
-	if (type == VEA_TYPE_PERSIST) {
+	if (type == VEA_TYPE_PERSIST || type == VEA_TYPE_UNMAP) {
 		entry = NULL;
 		ext = (struct vea_free_extent *)val.iov_buf;
 	} else {
@@ -253,6 +256,34 @@ persistent_free(struct vea_space_info *vsi, struct vea_free_extent *vfe)
 	return rc;
 }
 
+/*
+ * Remove an extent vector from the persistent extent vector tree, it's called
+ * in the same transaction which frees the vector extents.
+ */
+int
+persistent_vec_free(struct vea_space_info *vsi, struct vea_ext_vector *vec)
+{
+	daos_iov_t key;
+
+	D_ASSERT(pmemobj_tx_stage() == TX_STAGE_WORK);
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_md_vec_btr));
+	daos_iov_set(&key, &vec->vev_blk_off[0], sizeof(vec->vev_blk_off[0]));
+
+	return dbtree_delete(vsi->vsi_md_vec_btr, &key, NULL);
+}
+
+/* Remove an extent vector from the in-memory extent vector tree */
+int
+compound_vec_free(struct vea_space_info *vsi, struct vea_ext_vector *vec)
+{
+	daos_iov_t key;
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_vec_btr));
+	daos_iov_set(&key, &vec->vev_blk_off[0], sizeof(vec->vev_blk_off[0]));
+
+	return dbtree_delete(vsi->vsi_vec_btr, &key, NULL);
+}
+
 /* Free extent to the aggregate free tree */
 int
 aggregated_free(struct vea_space_info *vsi, struct vea_free_extent *vfe)
@@ -302,24 +333,177 @@ aggregated_free(struct vea_space_info *vsi, struct vea_free_extent *vfe)
 	return 0;
 }
 
-void
-migrate_free_exts(struct vea_space_info *vsi)
+/* Queue a free extent for unmap, it's coalesced with adjacent queued ones */
+int
+unmap_queue(struct vea_space_info *vsi, struct vea_free_extent *vfe)
+{
+	struct vea_free_extent dummy;
+	daos_iov_t key, val;
+	int rc;
+
+	if (vsi->vsi_unmap_ctxt.vnc_unmap == NULL)
+		return 0;
+
+	dummy = *vfe;
+	rc = merge_free_ext(vsi, vfe, &dummy, VEA_TYPE_UNMAP, 0);
+	if (rc)
+		return rc;
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_unmap_btr));
+	daos_iov_set(&key, &dummy.vfe_blk_off, sizeof(dummy.vfe_blk_off));
+	daos_iov_set(&val, &dummy, sizeof(dummy));
+
+	rc = dbtree_update(vsi->vsi_unmap_btr, &key, &val);
+	if (rc)
+		return rc;
+
+	vsi->vsi_unmap_blks += vfe->vfe_blk_cnt;
+	return 0;
+}
+
+/*
+ * Remove the reserved extent from unmap queue, otherwise, the data written
+ * to the reserved extent could be discarded by a delayed unmap.
+ */
+int
+unmap_cancel(struct vea_space_info *vsi, uint64_t blk_off, uint32_t blk_cnt)
+{
+	struct vea_free_extent found, frag;
+	daos_iov_t key_in, key_out, val;
+	uint64_t off, found_end, end = blk_off + blk_cnt;
+	int rc;
+
+	if (vsi->vsi_unmap_blks == 0)
+		return 0;
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_unmap_btr));
+	/* Cut all the queued extents overlapping with [blk_off, end) */
+	while (1) {
+		off = end - 1;
+		daos_iov_set(&key_in, &off, sizeof(off));
+		daos_iov_set(&key_out, &off, sizeof(off));
+		daos_iov_set(&val, &found, sizeof(found));
+
+		rc = dbtree_fetch(vsi->vsi_unmap_btr, BTR_PROBE_LE, &key_in,
+				  &key_out, &val);
+		if (rc == -DER_NONEXIST)
+			return 0;
+		else if (rc)
+			return rc;
+
+		found_end = found.vfe_blk_off + found.vfe_blk_cnt;
+		if (found_end <= blk_off)
+			return 0;
+
+		rc = dbtree_delete(vsi->vsi_unmap_btr, &key_out, NULL);
+		if (rc)
+			return rc;
+		vsi->vsi_unmap_blks -= found.vfe_blk_cnt;
+
+		/* Add back the rear part, the fore part is cut in next loop */
+		if (found_end > end) {
+			frag.vfe_blk_off = end;
+			frag.vfe_blk_cnt = found_end - end;
+			rc = unmap_queue(vsi, &frag);
+			if (rc)
+				return rc;
+		}
+
+		if (found.vfe_blk_off < blk_off) {
+			frag.vfe_blk_off = found.vfe_blk_off;
+			frag.vfe_blk_cnt = blk_off - found.vfe_blk_off;
+			return unmap_queue(vsi, &frag);
+		}
+	}
+}
+
+/*
+ * Unmap the queued extents in offset order until @max_blks (0 for no limit)
+ * blocks are unmapped, small extents are left in queue to be coalesced with
+ * later freed extents unless @flush is true.
+ */
+int
+unmap_issue(struct vea_space_info *vsi, uint64_t max_blks, bool flush,
+	    uint64_t *unmapped_blks)
+{
+	struct vea_unmap_context *ctxt = &vsi->vsi_unmap_ctxt;
+	struct vea_free_extent found;
+	daos_iov_t key_in, key_out, val;
+	uint32_t blk_sz = vsi->vsi_md->vsd_blk_sz;
+	uint64_t off = 0, unmapped = 0;
+	int rc = 0, opc = BTR_PROBE_GE;
+
+	if (vsi->vsi_unmap_blks == 0)
+		goto out;
+
+	D_ASSERT(ctxt->vnc_unmap != NULL);
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_unmap_btr));
+	while (max_blks == 0 || unmapped < max_blks) {
+		daos_iov_set(&key_in, &off, sizeof(off));
+		daos_iov_set(&key_out, &off, sizeof(off));
+		daos_iov_set(&val, &found, sizeof(found));
+
+		rc = dbtree_fetch(vsi->vsi_unmap_btr, opc, &key_in, &key_out,
+				  &val);
+		if (rc == -DER_NONEXIST) {
+			rc = 0;
+			break;
+		} else if (rc) {
+			break;
+		}
+
+		opc = BTR_PROBE_GT;
+		if (!flush && found.vfe_blk_cnt < VEA_UNMAP_MIN_BLKS)
+			continue;
+
+		rc = dbtree_delete(vsi->vsi_unmap_btr, &key_out, NULL);
+		if (rc)
+			break;
+		vsi->vsi_unmap_blks -= found.vfe_blk_cnt;
+
+		rc = ctxt->vnc_unmap(found.vfe_blk_off * blk_sz,
+				     (uint64_t)found.vfe_blk_cnt * blk_sz,
+				     ctxt->vnc_data);
+		if (rc) {
+			D_ERROR("failed to unmap ["DF_U64", %u] rc:%d\n",
+				found.vfe_blk_off, found.vfe_blk_cnt, rc);
+			break;
+		}
+		unmapped += found.vfe_blk_cnt;
+	}
+
+	D_DEBUG(DB_IO, "unmapped "DF_U64" blks, "DF_U64" blks queued\n",
+		unmapped, vsi->vsi_unmap_blks);
+out:
+	if (unmapped_blks != NULL)
+		*unmapped_blks = unmapped;
+	return rc;
+}
+
+/*
+ * Migrate the expired aggregated free extents to compound index, see
+ * vea_migrate_flags for @flags.
+ *
+ * Returns the number of migrated extents.
+ */
+int
+migrate_free_exts(struct vea_space_info *vsi, unsigned int flags)
 {
 	struct vea_free_extent vfe;
 	struct vea_entry *entry, *tmp;
 	uint64_t cur_time;
-	uint32_t blk_sz = vsi->vsi_md->vsd_blk_sz;
-	unsigned int flags = VEA_FL_GEN_AGE;
+	int migrated = 0;
 	int rc = 0;
 	char *op = "";
 
 	rc = get_current_age(&cur_time);
 	if (rc)
-		return;
+		return 0;
 
 	D_ASSERT(cur_time >= vsi->vsi_agg_time);
-	if (cur_time < (vsi->vsi_agg_time + VEA_MIGRATE_INTVL))
-		return;
+	if (!(flags & VEA_MIG_NOW) &&
+	    cur_time < (vsi->vsi_agg_time + VEA_MIGRATE_INTVL))
+		return 0;
 
 	vsi->vsi_agg_time = cur_time;
 
@@ -328,7 +512,8 @@ migrate_free_exts(struct vea_space_info *vsi)
 		daos_iov_t key;
 
 		/* The oldest extent isn't expired */
-		if (cur_time < (vfe.vfe_age + VEA_MIGRATE_INTVL))
+		if (!(flags & VEA_MIG_ALL) &&
+		    cur_time < (vfe.vfe_age + VEA_MIGRATE_INTVL))
 			break;
 
 		/* Remove entry from aggregate LRU list */
@@ -345,30 +530,53 @@ migrate_free_exts(struct vea_space_info *vsi)
 			break;
 		}
 
-		rc = compound_free(vsi, &vfe, flags);
+		rc = compound_free(vsi, &vfe, VEA_FL_GEN_AGE);
 		if (rc) {
 			op = "add";
 			break;
 		}
 
 		/*
-		 * Unmap isn't a expensive non-queue command anymore, do unmap
-		 * as soon as the extent is freed.
+		 * Queue the extent for unmap, the queued extents are coalesced
+		 * and unmapped in large batches by vea_unmap_poll().
 		 */
-		if (vsi->vsi_unmap_ctxt.vnc_unmap != NULL) {
-			uint64_t off = vfe.vfe_blk_off * blk_sz;
-			uint64_t cnt = vfe.vfe_blk_cnt * blk_sz;
-
-			rc = vsi->vsi_unmap_ctxt.vnc_unmap(off, cnt,
-					vsi->vsi_unmap_ctxt.vnc_data);
-			if (rc) {
-				op = "unmap";
-				break;
-			}
+		rc = unmap_queue(vsi, &vfe);
+		if (rc) {
+			op = "unmap";
+			break;
 		}
+		migrated++;
 	}
 
 	D_DEBUG(rc ? DLOG_ERR : DB_IO,
 		"failed to migrate ["DF_U64", %u] op:%s rc:%d\n",
 		vfe.vfe_blk_off, vfe.vfe_blk_cnt, op, rc);
+	return migrated;
+}
+
+/*
+ * Make free extents visible for allocation, including the extents cached in
+ * magazines and the expired recently freed extents which haven't been
+ * migrated yet. The recently freed extents which aren't expired are reclaimed
+ * as well if @all is true.
+ *
+ * Returns 1 if any extent was reclaimed, 0 if there is nothing to reclaim,
+ * negative value on error.
+ */
+int
+reclaim_free_exts(struct vea_space_info *vsi, bool all)
+{
+	bool reclaimed;
+	int rc;
+
+	rc = magazines_flush(vsi);
+	if (rc < 0)
+		return rc;
+	reclaimed = rc > 0;
+
+	if (migrate_free_exts(vsi, all ? VEA_MIG_NOW | VEA_MIG_ALL :
+					 VEA_MIG_NOW) > 0)
+		reclaimed = true;
+
+	return reclaimed ? 1 : 0;
 }
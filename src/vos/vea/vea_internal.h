@@ -54,6 +54,28 @@ struct vea_entry {
 #define VEA_LARGE_EXT_MB	64	/* Large extent threashold in MB */
 #define VEA_HINT_OFF_INVAL	0	/* Inavlid hint offset */
 #define VEA_MIGRATE_INTVL	10	/* Seconds */
+/*
+ * Queued unmap extents smaller than this are held back to be coalesced with
+ * later freed extents, unless the unmap queue is flushed.
+ */
+#define VEA_UNMAP_MIN_BLKS	256
+/* Max blocks unmapped by each vea_defrag() call */
+#define VEA_DEFRAG_UNMAP_BLKS	(1ULL << 15)
+
+/*
+ * Small reservations with power of two block count (up to 32 blocks) are
+ * served from per size class magazines of pre-carved extents, a magazine
+ * is refilled by carving a bulk extent from the compound index.
+ */
+#define VEA_MAG_CLASS_CNT	6	/* 1, 2, 4, 8, 16, 32 blocks */
+#define VEA_MAG_DEPTH		32	/* Max extents cached in a magazine */
+
+struct vea_magazine {
+	/* Start offsets of cached extents, popped from the tail */
+	uint64_t		vm_offs[VEA_MAG_DEPTH];
+	/* Number of cached extents */
+	uint32_t		vm_cnt;
+};
 
 struct free_ext_cursor {
 	struct vea_entry	*fec_cur;
@@ -119,6 +141,14 @@ struct vea_space_info {
 	uint64_t		 vsi_agg_time;
 	/* Unmap context to performe unmap against freed extent */
 	struct vea_unmap_context	vsi_unmap_ctxt;
+	/* Free extents queued for unmap, sorted by offset */
+	daos_handle_t		 vsi_unmap_btr;
+	/* Blocks queued for unmap */
+	uint64_t		 vsi_unmap_blks;
+	/* Magazines of pre-carved extents for small reservations */
+	struct vea_magazine	 vsi_mags[VEA_MAG_CLASS_CNT];
+	/* Reserve counters, the other fields are filled by vea_query() */
+	struct vea_stat		 vsi_stat;
 };
 
 static inline bool ext_is_idle(struct vea_free_extent *vfe)
@@ -144,6 +174,13 @@ enum vea_free_flags {
 	VEA_FL_GEN_AGE		= (1 << 1),
 };
 
+enum vea_migrate_flags {
+	/* Don't throttle the migration to once per VEA_MIGRATE_INTVL */
+	VEA_MIG_NOW		= (1 << 0),
+	/* Migrate the recently freed extents which aren't expired as well */
+	VEA_MIG_ALL		= (1 << 1),
+};
+
 /* vea_init.c */
 void destroy_free_class(struct vea_free_class *vfc);
 int create_free_class(struct vea_free_class *vfc, struct vea_space_df *md);
@@ -155,9 +192,12 @@ int verify_free_entry(uint64_t *off, struct vea_free_extent *vfe);
 int verify_vec_entry(uint64_t *off, struct vea_ext_vector *vec);
 int ext_adjacent(struct vea_free_extent *cur, struct vea_free_extent *next);
 int verify_resrvd_ext(struct vea_resrvd_ext *resrvd);
+int lookup_vec(struct vea_space_info *vsi, uint64_t blk_off, uint32_t blk_cnt,
+	       struct vea_ext_vector *vec);
 int vea_dump(struct vea_space_info *vsi, bool transient);
 int vea_verify_alloc(struct vea_space_info *vsi, bool transient,
 		     uint64_t off, uint32_t cnt);
+int stat_free_exts(struct vea_space_info *vsi, struct vea_stat *stat);
 
 /* vea_alloc.c */
 void free_class_remove(struct vea_free_class *vfc, struct vea_entry *entry);
@@ -170,14 +210,28 @@ int reserve_small(struct vea_space_info *vsi, uint32_t blk_cnt,
 		  struct vea_resrvd_ext *resrvd);
 int reserve_vector(struct vea_space_info *vsi, uint32_t blk_cnt,
 		   struct vea_resrvd_ext *resrvd);
+int reserve_magazine(struct vea_space_info *vsi, uint32_t blk_cnt,
+		     struct vea_resrvd_ext *resrvd);
+int magazines_flush(struct vea_space_info *vsi);
 int persistent_alloc(struct vea_space_info *vsi, struct vea_free_extent *vfe);
+int persistent_vec_alloc(struct vea_space_info *vsi,
+			 struct vea_ext_vector *vec);
 
 /* vea_free.c */
 int compound_free(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 		  unsigned int flags);
 int persistent_free(struct vea_space_info *vsi, struct vea_free_extent *vfe);
+int persistent_vec_free(struct vea_space_info *vsi,
+			struct vea_ext_vector *vec);
+int compound_vec_free(struct vea_space_info *vsi, struct vea_ext_vector *vec);
 int aggregated_free(struct vea_space_info *vsi, struct vea_free_extent *vfe);
-void migrate_free_exts(struct vea_space_info *vsi);
+int migrate_free_exts(struct vea_space_info *vsi, unsigned int flags);
+int unmap_queue(struct vea_space_info *vsi, struct vea_free_extent *vfe);
+int unmap_cancel(struct vea_space_info *vsi, uint64_t blk_off,
+		 uint32_t blk_cnt);
+int unmap_issue(struct vea_space_info *vsi, uint64_t max_blks, bool flush,
+		uint64_t *unmapped_blks);
+int reclaim_free_exts(struct vea_space_info *vsi, bool all);
 
 /* vea_hint.c */
 void hint_get(struct vea_hint_context *hint, uint64_t *off);
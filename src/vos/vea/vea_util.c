@@ -114,9 +114,50 @@ verify_resrvd_ext(struct vea_resrvd_ext *resrvd)
 		D_CRIT("invalid blk_cnt %u\n", resrvd->vre_blk_cnt);
 		return -DER_INVAL;
 	} else if (resrvd->vre_vector != NULL) {
-		/* Vector allocation isn't supported yet. */
-		D_CRIT("vector isn't NULL?\n");
-		return -DER_NOSYS;
+		return verify_vec_entry(&resrvd->vre_blk_off,
+					resrvd->vre_vector);
+	}
+
+	return 0;
+}
+
+/*
+ * Copy out the allocated extent vector starts from @blk_off, returns
+ * -DER_NONEXIST if @blk_off isn't the start of an extent vector.
+ */
+int
+lookup_vec(struct vea_space_info *vsi, uint64_t blk_off, uint32_t blk_cnt,
+	   struct vea_ext_vector *vec)
+{
+	daos_iov_t key, val;
+	uint32_t tot_blks = 0;
+	int i, rc;
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_vec_btr));
+	rc = dbtree_is_empty(vsi->vsi_vec_btr);
+	if (rc < 0)
+		return rc;
+	else if (rc > 0)
+		return -DER_NONEXIST;
+
+	daos_iov_set(&key, &blk_off, sizeof(blk_off));
+	daos_iov_set(&val, vec, sizeof(*vec));
+
+	rc = dbtree_fetch(vsi->vsi_vec_btr, BTR_PROBE_EQ, &key, NULL, &val);
+	if (rc)
+		return rc;
+
+	rc = verify_vec_entry(&blk_off, vec);
+	if (rc)
+		return rc;
+
+	for (i = 0; i < vec->vev_size; i++)
+		tot_blks += vec->vev_blk_cnt[i];
+
+	if (tot_blks != blk_cnt) {
+		D_ERROR("mismatched vector ["DF_U64", %u] != %u\n",
+			blk_off, tot_blks, blk_cnt);
+		return -DER_INVAL;
 	}
 
 	return 0;
@@ -180,6 +221,70 @@ vea_dump(struct vea_space_info *vsi, bool transient)
 	return rc = -DER_NONEXIST ? 0 : rc;
 }
 
+static int
+stat_free_entry(daos_handle_t ih, daos_iov_t *key, daos_iov_t *val, void *arg)
+{
+	struct vea_stat *stat = arg;
+	struct vea_entry *entry;
+	uint32_t blk_cnt;
+	int idx;
+
+	entry = (struct vea_entry *)val->iov_buf;
+	blk_cnt = entry->ve_ext.vfe_blk_cnt;
+	D_ASSERT(blk_cnt != 0);
+
+	stat->vs_free_blks += blk_cnt;
+	stat->vs_frags++;
+	if (blk_cnt > stat->vs_largest_blks)
+		stat->vs_largest_blks = blk_cnt;
+
+	idx = 31 - __builtin_clz(blk_cnt);
+	stat->vs_hist[min(idx, VEA_STAT_HIST_NR - 1)]++;
+
+	return 0;
+}
+
+static int
+stat_agg_entry(daos_handle_t ih, daos_iov_t *key, daos_iov_t *val, void *arg)
+{
+	struct vea_stat *stat = arg;
+	struct vea_entry *entry;
+
+	entry = (struct vea_entry *)val->iov_buf;
+	stat->vs_agg_blks += entry->ve_ext.vfe_blk_cnt;
+
+	return 0;
+}
+
+/* Walk the in-memory free extents to fill the space usage of @stat */
+int
+stat_free_exts(struct vea_space_info *vsi, struct vea_stat *stat)
+{
+	struct vea_magazine *mag;
+	int i, rc;
+
+	stat->vs_free_blks = stat->vs_agg_blks = stat->vs_mag_blks = 0;
+	stat->vs_frags = stat->vs_largest_blks = 0;
+	memset(stat->vs_hist, 0, sizeof(stat->vs_hist));
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_free_btr));
+	rc = dbtree_iterate(vsi->vsi_free_btr, false, stat_free_entry, stat);
+	if (rc)
+		return rc;
+
+	D_ASSERT(!daos_handle_is_inval(vsi->vsi_agg_btr));
+	rc = dbtree_iterate(vsi->vsi_agg_btr, false, stat_agg_entry, stat);
+	if (rc)
+		return rc;
+
+	for (i = 0; i < VEA_MAG_CLASS_CNT; i++) {
+		mag = &vsi->vsi_mags[i];
+		stat->vs_mag_blks += (uint64_t)mag->vm_cnt << i;
+	}
+
+	return 0;
+}
+
 /**
  * Check if two extents are overlapping.
  * returns	0 - Non-overlapping
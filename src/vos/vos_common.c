@@ -68,6 +68,10 @@ vos_csum_compute(daos_sg_list_t *sgl, daos_csum_buf_t *csum)
 	daos_csum_t *checksum =
 		&vos_tls_get()->vtl_imems_inst.vis_checksum;
 #endif
+	rc = daos_csum_reset(checksum);
+	if (rc != 0)
+		return rc;
+
 	rc = daos_csum_compute(checksum, sgl);
 	if (rc != 0) {
 		D_ERROR("Checksum compute error from VOS: %d\n", rc);
@@ -81,6 +85,102 @@ vos_csum_compute(daos_sg_list_t *sgl, daos_csum_buf_t *csum)
 	return rc;
 }
 
+/**
+ * Return the per-xstream checksum instance of \a type, it's initialized on
+ * first use and reused by all I/Os afterwards.
+ */
+static daos_csum_t *
+vos_csum_get(unsigned int type)
+{
+	daos_csum_t	*checksum;
+	int		 rc;
+
+	if (type >= DAOS_CS_MAX)
+		return NULL;
+#ifdef VOS_STANDALONE
+	checksum = &vsa_imems_inst->vis_csums[type];
+#else
+	checksum = &vos_tls_get()->vtl_imems_inst.vis_csums[type];
+#endif
+	if (checksum->dc_init)
+		return checksum;
+
+	rc = daos_csum_init_type(type, checksum);
+	if (rc != 0) {
+		D_ERROR("Failed to initialize checksum type %u: %d\n",
+			type, rc);
+		return NULL;
+	}
+	return checksum;
+}
+
+int
+vos_csum_chunks_valid(daos_csum_buf_t *csum, daos_size_t len)
+{
+	daos_csum_t	*checksum;
+
+	checksum = vos_csum_get(csum->cs_type);
+	if (checksum == NULL)
+		return -DER_INVAL;
+
+	if (csum->cs_csum == NULL ||
+	    csum->cs_len != daos_csum_chunk_cnt(len, csum->cs_chunk_size) *
+			    daos_csum_get_size(checksum)) {
+		D_ERROR("Invalid chunk checksums, len=%u, chunk=%u, "
+			"data="DF_U64"\n", csum->cs_len, csum->cs_chunk_size,
+			len);
+		return -DER_INVAL;
+	}
+	return 0;
+}
+
+int
+vos_csum_verify_ext(struct evt_entry *ent, daos_size_t nr)
+{
+	daos_csum_buf_t	*cbuf = &ent->en_csum;
+	daos_csum_t	*checksum;
+	daos_size_t	 chunk = cbuf->cs_chunk_size;
+	daos_size_t	 ext_len;
+	daos_size_t	 size;
+	daos_size_t	 off;
+	daos_size_t	 end;
+	char		*base;
+	int		 rc = 0;
+
+	D_ASSERT(ent->en_addr != NULL && cbuf->cs_csum != NULL);
+	checksum = vos_csum_get(cbuf->cs_type);
+	if (checksum == NULL)
+		return -DER_INVAL;
+
+	/* checksums are for chunks of the whole extent */
+	base = ent->en_addr - ent->en_offset * ent->en_inob;
+	ext_len = ent->en_ptr_inum * ent->en_inob;
+	size = daos_csum_get_size(checksum);
+	if (cbuf->cs_len != daos_csum_chunk_cnt(ext_len, chunk) * size) {
+		D_ERROR("Corrupted checksums of extent "DF_RECT"\n",
+			DP_RECT(&ent->en_rect));
+		return -DER_IO;
+	}
+
+	/* only verify the chunks being read, partial chunks at the edges
+	 * are verified as a whole.
+	 */
+	off = ent->en_offset * ent->en_inob;
+	end = off + nr * ent->en_inob;
+	for (off -= off % chunk; off < end; off += chunk) {
+		rc = daos_csum_verify(checksum, base + off,
+				      min(chunk, ext_len - off),
+				      cbuf->cs_csum + (off / chunk) * size);
+		if (rc != 0) {
+			D_ERROR("Checksum mismatch of extent "DF_RECT
+				", chunk "DF_U64": %d\n",
+				DP_RECT(&ent->en_rect), off / chunk, rc);
+			break;
+		}
+	}
+	return rc;
+}
+
 /**
  * VOS in-memory structure creation.
  * Handle-hash:
@@ -100,6 +200,13 @@ vos_csum_compute(daos_sg_list_t *sgl, daos_csum_buf_t *csum)
 static inline void
 vos_imem_strts_destroy(struct vos_imem_strts *imem_inst)
 {
+	int	i;
+
+	for (i = 0; i < DAOS_CS_MAX; i++) {
+		if (imem_inst->vis_csums[i].dc_init)
+			daos_csum_free(&imem_inst->vis_csums[i]);
+	}
+
 	if (imem_inst->vis_ocache)
 		vos_obj_cache_destroy(imem_inst->vis_ocache);
 
@@ -108,6 +215,8 @@ vos_imem_strts_destroy(struct vos_imem_strts *imem_inst)
 
 	if (imem_inst->vis_cont_hhash)
 		d_uhash_destroy(imem_inst->vis_cont_hhash);
+
+	daos_scratch_fini(&imem_inst->vis_scratch);
 }
 
 static inline int
@@ -117,6 +226,9 @@ vos_imem_strts_create(struct vos_imem_strts *imem_inst)
 	int		rc;
 
 	imem_inst->vis_enable_checksum = 0;
+	daos_scratch_init(&imem_inst->vis_scratch, DAOS_SCRATCH_CHUNK_SIZE,
+			  DAOS_SCRATCH_IDLE_MAX);
+
 	rc = vos_obj_cache_create(LRU_CACHE_BITS,
 				  &imem_inst->vis_ocache);
 	if (rc) {
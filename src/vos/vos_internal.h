@@ -36,6 +36,7 @@
 #include <daos/common.h>
 #include <daos/checksum.h>
 #include <daos/lru.h>
+#include <daos/scratch.h>
 #include <daos_srv/daos_server.h>
 #include <vos_layout.h>
 #include <vos_obj.h>
@@ -108,7 +109,13 @@ struct vos_imem_strts {
 	struct d_hash_table	*vis_cont_hhash;
 	int			vis_enable_checksum;
 	daos_csum_t		vis_checksum;
-
+	/**
+	 * per-type instances for verifying chunk checksums of extents,
+	 * initialized on first use
+	 */
+	daos_csum_t		vis_csums[DAOS_CS_MAX];
+	/** scratch arena for zero-copy I/O contexts and buffers */
+	struct daos_scratch	vis_scratch;
 };
 
 
@@ -119,8 +126,22 @@ enum {
 	VOS_KEY_CMP_UINT64	= (1ULL << 63),
 	VOS_KEY_CMP_LEXICAL	= (1ULL << 62),
 	VOS_KEY_CMP_ANY		= (VOS_KEY_CMP_UINT64 | VOS_KEY_CMP_LEXICAL),
+	/**
+	 * Hashed key is generated by a single 128-bit murmur3 hash, trees
+	 * created without this bit use murmur64 + string32 hash.
+	 */
+	VOS_KEY_HASH_M128	= (1ULL << 61),
+	/**
+	 * Single values (and checksums) up to VOS_SINGV_INLINE_MAX bytes are
+	 * stored in the record of single value tree, instead of a separately
+	 * allocated vos_irec_df.
+	 */
+	VOS_SINGV_INLINE	= (1ULL << 60),
 };
 
+/** max size of inline single value, checksum included */
+#define VOS_SINGV_INLINE_MAX	64
+
 #define VOS_KEY_CMP_UINT64_SET	(VOS_KEY_CMP_UINT64  | BTR_FEAT_DIRECT_KEY)
 #define VOS_KEY_CMP_LEXICAL_SET	(VOS_KEY_CMP_LEXICAL | BTR_FEAT_DIRECT_KEY)
 #define VOS_OFEAT_SHIFT		48
@@ -188,6 +209,16 @@ vos_cont_hhash_get(void)
 #endif
 }
 
+static inline struct daos_scratch *
+vos_scratch_get(void)
+{
+#ifdef VOS_STANDALONE
+	return &vsa_imems_inst->vis_scratch;
+#else
+	return &vos_tls_get()->vtl_imems_inst.vis_scratch;
+#endif
+}
+
 extern pthread_mutex_t vos_pmemobj_lock;
 
 static inline PMEMobjpool *
@@ -272,6 +303,17 @@ int vos_csum_enabled(void);
  * compute checksum for a sgl using CRC64
  */
 int vos_csum_compute(daos_sg_list_t *sgl, daos_csum_buf_t *csum);
+
+/**
+ * Check if the chunk checksums \a csum match \a len bytes of extent data
+ */
+int vos_csum_chunks_valid(daos_csum_buf_t *csum, daos_size_t len);
+
+/**
+ * Verify chunks covering the \a nr indices selected by the evtree entry
+ * \a ent against the checksums stored with the extent.
+ */
+int vos_csum_verify_ext(struct evt_entry *ent, daos_size_t nr);
 /**
  * Register btree class for container table, it is called within vos_init()
  *
@@ -420,6 +462,9 @@ enum vos_tree_class {
 int vos_obj_tree_init(struct vos_object *obj);
 int vos_obj_tree_fini(struct vos_object *obj);
 int vos_obj_tree_register(void);
+int vos_obj_recx_compact(struct vos_object *obj, vos_iter_entry_t *dent,
+			 vos_iter_entry_t *aent, daos_epoch_t epoch,
+			 unsigned int *credits, daos_hash_out_t *anchor);
 
 /**
  * Data structure which carries the keys, epoch ranges to the multi-nested
@@ -462,6 +507,8 @@ struct vos_rec_bundle {
 	uint32_t		 rb_ver;
 	/** tree class */
 	enum vos_tree_class	 rb_tclass;
+	/** fetch: the returned value is stored inline in the tree record */
+	bool			 rb_inline;
 };
 
 #define VOS_SIZE_ROUND		8
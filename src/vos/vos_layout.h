@@ -95,9 +95,23 @@ struct vos_cookie_rec_df {
 	daos_epoch_t		cr_max_epoch;
 };
 
+/** magic number of VOS pool */
+#define POOL_DF_MAGIC				0x5ca1ab1e
+
+/**
+ * Durable format version of VOS pool, it should be bumped on any
+ * incompatible change of the persistent structures.
+ *
+ * 2: chunk checksums of evtree extents are stored out of line
+ *    (evt_ptr::pt_csum_mmid, pt_csum_type, pt_csum_chunk, pt_csum_len)
+ */
+#define POOL_DF_VERSION				2
+
 struct vos_pool_df {
 	/* Structs stored in LE or BE representation */
 	uint32_t				pd_magic;
+	/* Durable format version, see POOL_DF_VERSION */
+	uint32_t				pd_version;
 	/* Unique PoolID for each VOS pool assigned on creation */
 	uuid_t					pd_id;
 	/* Flags for compatibility features */
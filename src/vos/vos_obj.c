@@ -63,6 +63,8 @@ struct vos_zc_context {
 	struct iod_buf		*zc_iobufs;
 	/** reference on the object */
 	struct vos_object	*zc_obj;
+	/** per-xstream arena of this context and all its buffers */
+	struct daos_scratch	*zc_scratch;
 	/** actv fields used for zc buffer reservation */
 	unsigned int		 zc_actv_cnt;
 	unsigned int		 zc_actv_at;
@@ -85,8 +87,35 @@ struct iod_buf {
 	unsigned int		 db_mmid_nr;
 	/** pre-allocated pmem buffers (for zc update only) */
 	umem_id_t		*db_mmids;
+	/**
+	 * DRAM copy of the inline single value (for zc fetch only), the
+	 * value cannot be referenced in place because btree moves records.
+	 */
+	char			*db_inline;
+	/**
+	 * scratch arena of sg_iovs of db_sgl, db_mmids and db_inline, it's
+	 * NULL for non-zc.
+	 */
+	struct daos_scratch	*db_scratch;
 };
 
+/** allocate \a nr iovs for the zc sgl of \a iobuf from its scratch arena */
+static int
+iobuf_sgl_init(struct iod_buf *iobuf, unsigned int nr)
+{
+	daos_sg_list_t *sgl = &iobuf->db_sgl;
+
+	D_ASSERT(sgl->sg_iovs == NULL);
+	sgl->sg_iovs = daos_scratch_alloc(iobuf->db_scratch,
+					  nr * sizeof(*sgl->sg_iovs));
+	if (sgl->sg_iovs == NULL)
+		return -DER_NOMEM;
+
+	sgl->sg_nr = nr;
+	sgl->sg_nr_out = 0;
+	return 0;
+}
+
 static bool
 iobuf_sgl_empty(struct iod_buf *iobuf)
 {
@@ -166,12 +195,13 @@ iobuf_zc_fetch(struct iod_buf *iobuf, daos_iov_t *iov)
 	nr  = sgl->sg_nr;
 
 	if (at == nr - 1) {
-		D_ALLOC(iovs, nr * 2 * sizeof(*iovs));
+		iovs = daos_scratch_alloc(iobuf->db_scratch,
+					  nr * 2 * sizeof(*iovs));
 		if (iovs == NULL)
 			return -DER_NOMEM;
 
 		memcpy(iovs, &sgl->sg_iovs[0], nr * sizeof(*iovs));
-		D_FREE(sgl->sg_iovs);
+		daos_scratch_free(iobuf->db_scratch, sgl->sg_iovs);
 
 		sgl->sg_iovs	= iovs;
 		sgl->sg_nr	= nr * 2;
@@ -470,6 +500,18 @@ akey_fetch_single(daos_handle_t toh, daos_epoch_range_t *epr,
 		D_GOTO(out, rc);
 	}
 
+	if (rc == 0 && rbund.rb_inline && iobuf->db_zc &&
+	    diov.iov_len != 0 && !iobuf_sgl_empty(iobuf)) {
+		D_ASSERT(iobuf->db_inline == NULL);
+		iobuf->db_inline = daos_scratch_alloc(iobuf->db_scratch,
+						      diov.iov_len);
+		if (iobuf->db_inline == NULL)
+			D_GOTO(out, rc = -DER_NOMEM);
+
+		memcpy(iobuf->db_inline, diov.iov_buf, diov.iov_len);
+		diov.iov_buf = iobuf->db_inline;
+	}
+
 	rc = iobuf_fetch(iobuf, &diov);
 	if (rc != 0)
 		D_GOTO(out, rc);
@@ -479,104 +521,123 @@ akey_fetch_single(daos_handle_t toh, daos_epoch_range_t *epr,
 	return rc;
 }
 
-/** Fetch a extent from an akey */
+/** state of akey_fetch_recx while visible extents are streamed */
+struct recx_fetch_args {
+	struct iod_buf		*rf_iobuf;
+	/** the next index to be fetched */
+	daos_off_t		 rf_index;
+	/** hole width */
+	daos_size_t		 rf_holes;
+	/** record size */
+	unsigned int		 rf_rsize;
+};
+
+/** copy out a visible extent returned by evt_find_visible */
+static int
+recx_fetch_visible_cb(struct evt_entry *ent, void *arg)
+{
+	struct recx_fetch_args	*rf = arg;
+	daos_off_t		 lo = ent->en_sel_rect.rc_off_lo;
+	daos_off_t		 hi = ent->en_sel_rect.rc_off_hi;
+	daos_iov_t		 iov;
+	daos_size_t		 nr;
+	int			 rc;
+
+	D_ASSERT(hi >= lo);
+	nr = hi - lo + 1;
+
+	if (lo != rf->rf_index) {
+		D_ASSERTF(lo > rf->rf_index, DF_U64"/"DF_U64", "DF_RECT"\n",
+			  lo, rf->rf_index, DP_RECT(&ent->en_sel_rect));
+		rf->rf_holes += lo - rf->rf_index;
+	}
+
+	if (ent->en_inob == 0) { /* hole extent */
+		rf->rf_index = lo + nr;
+		rf->rf_holes += nr;
+		return 0;
+	}
+
+	if (rf->rf_rsize == 0)
+		rf->rf_rsize = ent->en_inob;
+
+	if (rf->rf_rsize != ent->en_inob) {
+		D_ERROR("Record sizes of all indices must be "
+			"the same: %u/%u\n", rf->rf_rsize, ent->en_inob);
+		return -DER_IO_INVAL;
+	}
+
+	if (ent->en_csum.cs_csum != NULL) {
+		rc = vos_csum_verify_ext(ent, nr);
+		if (rc != 0)
+			return rc;
+	}
+
+	if (rf->rf_holes != 0) {
+		daos_iov_set(&iov, NULL, rf->rf_holes * rf->rf_rsize);
+		/* skip the hole in iobuf */
+		rc = iobuf_fetch(rf->rf_iobuf, &iov);
+		if (rc != 0)
+			return rc;
+		rf->rf_holes = 0;
+	}
+
+	daos_iov_set(&iov, ent->en_addr, nr * rf->rf_rsize);
+	rc = iobuf_fetch(rf->rf_iobuf, &iov);
+	if (rc != 0)
+		return rc;
+
+	rf->rf_index = lo + nr;
+	return 0;
+}
+
+/**
+ * Fetch a extent from an akey.
+ *
+ * Visible extents are streamed from the evtree in offset order, so memory
+ * consumption does not grow with the overwrite history of the extent.
+ */
 static int
 akey_fetch_recx(daos_handle_t toh, daos_epoch_range_t *epr, daos_recx_t *recx,
 		daos_size_t *rsize_p, struct iod_buf *iobuf)
 {
-	struct evt_entry	*ent;
-	/* At present, this is not exposed in interface but passing it toggles
-	 * sorting and clipping of rectangles
-	 */
-	d_list_t		 covered;
-	struct evt_entry_list	 ent_list;
+	struct recx_fetch_args	 rf;
 	struct evt_rect		 rect;
 	daos_iov_t		 iov;
-	daos_size_t		 holes; /* hole width */
-	daos_off_t		 index;
 	daos_off_t		 end;
-	unsigned int		 rsize;
 	int			 rc;
 
-	index = recx->rx_idx;
-	end   = recx->rx_idx + recx->rx_nr;
+	end = recx->rx_idx + recx->rx_nr;
 
-	rect.rc_off_lo = index;
+	rect.rc_off_lo = recx->rx_idx;
 	rect.rc_off_hi = end - 1;
 	rect.rc_epc_lo = epr->epr_lo;
 
-	evt_ent_list_init(&ent_list);
-	rc = evt_find(toh, &rect, &ent_list, &covered);
+	rf.rf_iobuf = iobuf;
+	rf.rf_index = recx->rx_idx;
+	rf.rf_holes = 0;
+	rf.rf_rsize = 0;
+
+	rc = evt_find_visible(toh, &rect, recx_fetch_visible_cb, &rf);
 	if (rc != 0)
 		D_GOTO(failed, rc);
 
-	rsize = 0;
-	holes = 0;
-	evt_ent_list_for_each(ent, &ent_list) {
-		daos_off_t	lo = ent->en_sel_rect.rc_off_lo;
-		daos_off_t	hi = ent->en_sel_rect.rc_off_hi;
-		daos_size_t	nr;
-
-		D_ASSERT(hi >= lo);
-		nr = hi - lo + 1;
-
-		if (lo != index) {
-			D_ASSERTF(lo > index,
-				  DF_U64"/"DF_U64", "DF_RECT", "DF_RECT"\n",
-				  lo, index, DP_RECT(&rect),
-				  DP_RECT(&ent->en_sel_rect));
-			holes += lo - index;
-		}
-
-		if (ent->en_inob == 0) { /* hole extent */
-			index = lo + nr;
-			holes += nr;
-			continue;
-		}
-
-		if (rsize == 0)
-			rsize = ent->en_inob;
-
-		if (rsize != ent->en_inob) {
-			D_ERROR("Record sizes of all indices must be "
-				"the same: %u/%u\n", rsize, ent->en_inob);
-			D_GOTO(failed, rc = -DER_IO_INVAL);
-		}
+	D_ASSERT(rf.rf_index <= end);
+	if (rf.rf_index < end)
+		rf.rf_holes += end - rf.rf_index;
 
-		if (holes != 0) {
-			daos_iov_set(&iov, NULL, holes * rsize);
-			/* skip the hole in iobuf */
-			rc = iobuf_fetch(iobuf, &iov);
-			if (rc != 0)
-				D_GOTO(failed, rc);
-			holes = 0;
-		}
-
-		daos_iov_set(&iov, ent->en_addr, nr * rsize);
-		rc = iobuf_fetch(iobuf, &iov);
-		if (rc != 0)
-			D_GOTO(failed, rc);
-
-		index = lo + nr;
-	}
-
-	D_ASSERT(index <= end);
-	if (index < end)
-		holes += end - index;
-
-	if (holes != 0) { /* trailing holes */
-		if (rsize == 0) { /* nothing but holes */
+	if (rf.rf_holes != 0) { /* trailing holes */
+		if (rf.rf_rsize == 0) { /* nothing but holes */
 			vos_empty_sgl(&iobuf->db_sgl);
 		} else {
-			daos_iov_set(&iov, NULL, holes * rsize);
+			daos_iov_set(&iov, NULL, rf.rf_holes * rf.rf_rsize);
 			rc = iobuf_fetch(iobuf, &iov);
 			if (rc != 0)
 				D_GOTO(failed, rc);
 		}
 	}
-	*rsize_p = rsize;
+	*rsize_p = rf.rf_rsize;
  failed:
-	evt_ent_list_fini(&ent_list);
 	return rc;
 }
 
@@ -646,6 +707,19 @@ akey_fetch(struct vos_object *obj, daos_epoch_t epoch, daos_handle_t ak_toh,
 	return rc;
 }
 
+/** Reset record sizes and sgls of @iods which have nothing to fetch */
+static void
+iods_empty_fetch(unsigned int iod_nr, daos_iod_t *iods, daos_sg_list_t *sgls)
+{
+	int	i;
+
+	for (i = 0; i < iod_nr; i++) {
+		iods[i].iod_size = 0;
+		if (sgls != NULL)
+			vos_empty_sgl(&sgls[i]);
+	}
+}
+
 /** Fetch a set of records under the same dkey */
 static int
 dkey_fetch(struct vos_object *obj, daos_epoch_t epoch, daos_key_t *dkey,
@@ -664,11 +738,7 @@ dkey_fetch(struct vos_object *obj, daos_epoch_t epoch, daos_key_t *dkey,
 	epr.epr_lo = epr.epr_hi = epoch;
 	rc = tree_prepare(obj, &epr, obj->obj_toh, VOS_BTR_DKEY, dkey, 0, &toh);
 	if (rc == -DER_NONEXIST) {
-		for (i = 0; i < iod_nr; i++) {
-			iods[i].iod_size = 0;
-			if (sgls != NULL)
-				vos_empty_sgl(&sgls[i]);
-		}
+		iods_empty_fetch(iod_nr, iods, sgls);
 		D_DEBUG(DB_IO, "nonexistent dkey\n");
 		return 0;
 
@@ -726,14 +796,8 @@ vos_obj_fetch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 		return rc;
 
 	if (vos_obj_is_empty(obj)) {
-		int	i;
-
 		D_DEBUG(DB_IO, "Empty object, nothing to fetch\n");
-		for (i = 0; i < iod_nr; i++) {
-			iods[i].iod_size = 0;
-			if (sgls != NULL)
-				vos_empty_sgl(&sgls[i]);
-		}
+		iods_empty_fetch(iod_nr, iods, sgls);
 		D_GOTO(out, rc = 0);
 	}
 
@@ -743,6 +807,47 @@ vos_obj_fetch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	return rc;
 }
 
+/**
+ * Fetch records of multiple dkeys from the specified object, the object
+ * is only held once for all dkeys.
+ */
+int
+vos_obj_fetch_multi(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
+		    unsigned int dio_nr, vos_dkey_io_t *dios)
+{
+	struct vos_object *obj;
+	int		   i;
+	int		   rc;
+
+	D_DEBUG(DB_TRACE, "Fetch "DF_UOID", dkey_nr %d, epoch "DF_U64"\n",
+		DP_UOID(oid), dio_nr, epoch);
+
+	rc = vos_obj_hold(vos_obj_cache_current(), coh, oid, epoch, true, &obj);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < dio_nr; i++) {
+		vos_dkey_io_t	*dio = &dios[i];
+
+		if (vos_obj_is_empty(obj)) {
+			iods_empty_fetch(dio->dio_iod_nr, dio->dio_iods,
+					 dio->dio_sgls);
+			continue;
+		}
+
+		rc = dkey_fetch(obj, epoch, &dio->dio_dkey, dio->dio_iod_nr,
+				dio->dio_iods, dio->dio_sgls, NULL);
+		if (rc != 0) {
+			D_DEBUG(DB_IO, "Failed to fetch dkey %d of "DF_UOID
+				": %d\n", i, DP_UOID(oid), rc);
+			break;
+		}
+	}
+
+	vos_obj_release(vos_obj_cache_current(), obj);
+	return rc;
+}
+
 static int
 akey_update_single(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 		   uint32_t pm_ver, daos_size_t rsize, struct iod_buf *iobuf)
@@ -754,6 +859,8 @@ akey_update_single(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 	daos_iov_t		riov;
 	daos_iov_t		iov; /* iov for the sink buffer */
 	umem_id_t		mmid;
+	char			inl_buf[VOS_SINGV_INLINE_MAX];
+	bool			inl = false;
 	int			rc;
 
 	tree_key_bundle2iov(&kbund, &kiov);
@@ -768,6 +875,16 @@ akey_update_single(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 		mmid = iobuf->db_mmids[0];
 	} else {
 		mmid = UMMID_NULL;
+		if (rsize != 0 && rsize <= VOS_SINGV_INLINE_MAX) {
+			/* gather the small value, so the tree can store it
+			 * inline while creating the record.
+			 */
+			daos_iov_set(&iov, inl_buf, rsize);
+			rc = iobuf_update(iobuf, &iov);
+			if (rc != 0)
+				D_GOTO(out, rc = -DER_IO_INVAL);
+			inl = true;
+		}
 	}
 
 	tree_rec_bundle2iov(&rbund, &riov);
@@ -784,6 +901,9 @@ akey_update_single(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 		D_GOTO(out, rc);
 	}
 
+	if (inl) /* value has been copied in by the tree */
+		D_GOTO(out, rc = 0);
+
 	rc = iobuf_update(iobuf, &iov);
 	if (rc != 0)
 		D_GOTO(out, rc = -DER_IO_INVAL);
@@ -799,7 +919,7 @@ out:
 static int
 akey_update_recx(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 		 uint32_t pm_ver, daos_recx_t *recx, daos_size_t rsize,
-		 struct iod_buf *iobuf)
+		 daos_csum_buf_t *csum, struct iod_buf *iobuf)
 {
 	struct evt_rect	rect;
 	daos_iov_t	iov;
@@ -809,10 +929,18 @@ akey_update_recx(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 	rect.rc_off_lo = recx->rx_idx;
 	rect.rc_off_hi = recx->rx_idx + recx->rx_nr - 1;
 
+	if (csum != NULL && csum->cs_chunk_size != 0 && rsize != 0) {
+		rc = vos_csum_chunks_valid(csum, recx->rx_nr * rsize);
+		if (rc != 0)
+			D_GOTO(out, rc);
+	} else {
+		csum = NULL;
+	}
+
 	daos_iov_set(&iov, NULL, rsize);
 	if (iobuf->db_zc) {
 		rc = evt_insert(toh, cookie, pm_ver, &rect, rsize,
-				iobuf->db_mmids[iobuf->db_at]);
+				iobuf->db_mmids[iobuf->db_at], csum);
 		if (rc != 0)
 			D_GOTO(out, rc);
 	} else {
@@ -826,7 +954,8 @@ akey_update_recx(daos_handle_t toh, daos_epoch_range_t *epr, uuid_t cookie,
 		 * copy actual data into those buffers after evt_insert_sgl().
 		 * See iobuf_update() for the details.
 		 */
-		rc = evt_insert_sgl(toh, cookie, pm_ver, &rect, rsize, &sgl);
+		rc = evt_insert_sgl(toh, cookie, pm_ver, &rect, rsize, &sgl,
+				    csum);
 		if (rc != 0)
 			D_GOTO(out, rc);
 
@@ -879,10 +1008,13 @@ akey_update(struct vos_object *obj, daos_epoch_t epoch, uuid_t cookie,
 
 	for (i = 0; i < iod->iod_nr; i++) {
 		daos_epoch_range_t *etmp;
+		daos_csum_buf_t	   *csum;
 
 		etmp = iod->iod_eprs ? &iod->iod_eprs[i] : &epr;
+		csum = iod->iod_csums ? &iod->iod_csums[i] : NULL;
 		rc = akey_update_recx(toh, etmp, cookie, pm_ver,
-				      &iod->iod_recxs[i], iod->iod_size, iobuf);
+				      &iod->iod_recxs[i], iod->iod_size, csum,
+				      iobuf);
 		if (rc != 0) {
 			D_ERROR(DF_UOID", akey_update_recx failed, rc %d.\n",
 				DP_UOID(obj->obj_id), rc);
@@ -901,7 +1033,6 @@ dkey_update(struct vos_object *obj, daos_epoch_t epoch, uuid_t cookie,
 {
 	daos_epoch_range_t	epr;
 	daos_handle_t		ak_toh;
-	daos_handle_t		ck_toh;
 	int			i;
 	int			rc;
 
@@ -938,16 +1069,22 @@ dkey_update(struct vos_object *obj, daos_epoch_t epoch, uuid_t cookie,
 			D_GOTO(out, rc);
 		}
 	}
+ out:
+	tree_release(ak_toh, false);
+	return rc;
+}
+
+/** Record @cookie of a successful update in the cookie tree */
+static int
+obj_cookie_update(struct vos_object *obj, uuid_t cookie, daos_epoch_t epoch)
+{
+	daos_handle_t	ck_toh;
+	int		rc;
 
-	/** If dkey update is successful update the cookie tree */
 	ck_toh = vos_obj2cookie_hdl(obj);
 	rc = vos_cookie_find_update(ck_toh, cookie, epoch, true, NULL);
-	if (rc) {
+	if (rc)
 		D_ERROR("Failed to record cookie: %d\n", rc);
-		D_GOTO(out, rc);
-	}
- out:
-	tree_release(ak_toh, false);
 	return rc;
 }
 
@@ -981,11 +1118,72 @@ vos_obj_update(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 		if (rc != 0)
 			D_ERROR(DF_UOID", dkey_update failed, rc %d.\n",
 				DP_UOID(oid), rc);
+		else
+			rc = obj_cookie_update(obj, cookie, epoch);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D_DEBUG(DB_IO, "Failed to update object: %d\n", rc);
+	} TX_END
+
+	vos_obj_release(vos_obj_cache_current(), obj);
+	return rc;
+}
+
+/**
+ * Update records of multiple dkeys of the specified object. The object is
+ * held once and all dkeys are updated in the same transaction, which is
+ * aborted if any of them fails.
+ */
+int
+vos_obj_update_multi(daos_handle_t coh, daos_unit_oid_t oid,
+		     daos_epoch_t epoch, uuid_t cookie, uint32_t pm_ver,
+		     unsigned int dio_nr, vos_dkey_io_t *dios)
+{
+	struct vos_object	*obj;
+	PMEMobjpool		*pop;
+	int			 i;
+	int			 rc;
+
+	D_DEBUG(DB_IO, "Update "DF_UOID", dkey_nr %d, cookie "DF_UUID" epoch "
+		DF_U64"\n", DP_UOID(oid), dio_nr, DP_UUID(cookie), epoch);
+
+	rc = vos_obj_hold(vos_obj_cache_current(), coh, oid, epoch, false,
+			  &obj);
+	if (rc != 0) {
+		D_ERROR("Update "DF_UOID", vos_obj_hold failed, rc %d.\n",
+			DP_UOID(oid), rc);
+		return rc;
+	}
+
+	pop = vos_obj2pop(obj);
+	TX_BEGIN(pop) {
+		for (i = 0; i < dio_nr; i++) {
+			vos_dkey_io_t	*dio = &dios[i];
+
+			rc = dkey_update(obj, epoch, cookie, pm_ver,
+					 &dio->dio_dkey, dio->dio_iod_nr,
+					 dio->dio_iods, dio->dio_sgls, NULL);
+			if (rc != 0) {
+				D_ERROR(DF_UOID", dkey_update %d failed, "
+					"rc %d.\n", DP_UOID(oid), i, rc);
+				pmemobj_tx_abort(rc);
+			}
+		}
+
+		rc = obj_cookie_update(obj, cookie, epoch);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
 	} TX_ONABORT {
 		rc = umem_tx_errno(rc);
 		D_DEBUG(DB_IO, "Failed to update object: %d\n", rc);
 	} TX_END
 
+	/* trees opened by the aborted dkeys could refer to rolled back
+	 * roots, evict the object so it's reopened by the next access.
+	 */
+	if (rc != 0)
+		vos_obj_evict(obj);
+
 	vos_obj_release(vos_obj_cache_current(), obj);
 	return rc;
 }
@@ -1113,6 +1311,48 @@ vos_obj_punch(daos_handle_t coh, daos_unit_oid_t oid, daos_epoch_t epoch,
 	return rc;
 }
 
+/**
+ * Free record extents of the akey \a aent under the dkey \a dent which are
+ * fully overwritten at \a epoch, see evt_compact() for \a credits and
+ * \a anchor.
+ */
+int
+vos_obj_recx_compact(struct vos_object *obj, vos_iter_entry_t *dent,
+		     vos_iter_entry_t *aent, daos_epoch_t epoch,
+		     unsigned int *credits, daos_hash_out_t *anchor)
+{
+	daos_handle_t	dk_toh;
+	daos_handle_t	ak_toh;
+	int		rc;
+
+	rc = tree_prepare(obj, &dent->ie_epr, obj->obj_toh, VOS_BTR_DKEY,
+			  &dent->ie_key, 0, &dk_toh);
+	if (rc != 0)
+		return rc == -DER_NONEXIST ? 0 : rc;
+
+	rc = tree_prepare(obj, &aent->ie_epr, dk_toh, VOS_BTR_AKEY,
+			  &aent->ie_key, SUBTR_EVT, &ak_toh);
+	if (rc != 0) {
+		if (rc == -DER_NONEXIST)
+			rc = 0;
+		D_GOTO(out, rc);
+	}
+
+	TX_BEGIN(vos_obj2pop(obj)) {
+		rc = evt_compact(ak_toh, epoch, credits, anchor);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D_DEBUG(DB_EPC, "Failed to compact extents: %d\n", rc);
+	} TX_END
+
+	tree_release(ak_toh, true);
+ out:
+	tree_release(dk_toh, false);
+	return rc;
+}
+
 /**
  * @} vos_obj_io_func
  */
@@ -1163,7 +1403,8 @@ vos_zcc_reserve_init(struct vos_zc_context *zcc)
 	if (total_acts > POBJ_MAX_ACTIONS)
 		return;
 
-	D_ALLOC(zcc->zc_actv, total_acts * sizeof(*zcc->zc_actv));
+	zcc->zc_actv = daos_scratch_alloc(zcc->zc_scratch,
+					  total_acts * sizeof(*zcc->zc_actv));
 	if (zcc->zc_actv == NULL)
 		return;
 
@@ -1176,12 +1417,16 @@ vos_zcc_reserve_fini(struct vos_zc_context *zcc)
 	if (zcc->zc_actv_cnt == 0)
 		return;
 	D_ASSERT(zcc->zc_actv != NULL);
-	D_FREE(zcc->zc_actv);
+	daos_scratch_free(zcc->zc_scratch, zcc->zc_actv);
+	zcc->zc_actv = NULL;
 }
 
 /**
  * Create a zero-copy I/O context. This context includes buffers pointers
  * to return to caller which can proceed the zero-copy I/O.
+ *
+ * The context, its I/O buffers and all their arrays are allocated from the
+ * per-xstream scratch arena, so a steady-state I/O does not touch the heap.
  */
 static int
 vos_zcc_create(daos_handle_t coh, daos_unit_oid_t oid, bool read_only,
@@ -1189,12 +1434,18 @@ vos_zcc_create(daos_handle_t coh, daos_unit_oid_t oid, bool read_only,
 	       struct vos_zc_context **zcc_pp)
 {
 	struct vos_zc_context *zcc;
+	struct daos_scratch   *scr = vos_scratch_get();
+	int		       i;
 	int		       rc;
 
-	D_ALLOC_PTR(zcc);
+	/* NB: the context and its iobufs share the same allocation */
+	zcc = daos_scratch_alloc(scr, sizeof(*zcc) +
+				 iod_nr * sizeof(*zcc->zc_iobufs));
 	if (zcc == NULL)
 		return -DER_NOMEM;
 
+	zcc->zc_scratch = scr;
+
 	rc = vos_obj_hold(vos_obj_cache_current(), coh, oid, epoch, read_only,
 			  &zcc->zc_obj);
 	if (rc != 0) {
@@ -1205,9 +1456,9 @@ vos_zcc_create(daos_handle_t coh, daos_unit_oid_t oid, bool read_only,
 
 	zcc->zc_iod_nr = iod_nr;
 	zcc->zc_iods = iods;
-	D_ALLOC(zcc->zc_iobufs, zcc->zc_iod_nr * sizeof(*zcc->zc_iobufs));
-	if (zcc->zc_iobufs == NULL)
-		D_GOTO(failed, rc = -DER_NOMEM);
+	zcc->zc_iobufs = (struct iod_buf *)&zcc[1];
+	for (i = 0; i < iod_nr; i++)
+		zcc->zc_iobufs[i].db_scratch = scr;
 
 	zcc->zc_epoch = epoch;
 	zcc->zc_is_update = !read_only;
@@ -1232,7 +1483,10 @@ vos_zcc_free_iobuf(struct vos_zc_context *zcc, bool has_tx, int err)
 	for (iobuf = &zcc->zc_iobufs[0];
 	     iobuf < &zcc->zc_iobufs[zcc->zc_iod_nr]; iobuf++) {
 
-		daos_sgl_fini(&iobuf->db_sgl, false);
+		daos_scratch_free(iobuf->db_scratch, iobuf->db_sgl.sg_iovs);
+		iobuf->db_sgl.sg_iovs = NULL;
+		daos_scratch_free(iobuf->db_scratch, iobuf->db_inline);
+		iobuf->db_inline = NULL;
 		if (iobuf->db_mmids == NULL)
 			continue;
 
@@ -1257,10 +1511,11 @@ vos_zcc_free_iobuf(struct vos_zc_context *zcc, bool has_tx, int err)
 			iobuf->db_mmids[i] = UMMID_NULL;
 		}
 
-		D_FREE(iobuf->db_mmids);
+		daos_scratch_free(iobuf->db_scratch, iobuf->db_mmids);
+		iobuf->db_mmids = NULL;
 	}
 
-	D_FREE(zcc->zc_iobufs);
+	zcc->zc_iobufs = NULL;
 	return true;
 }
 
@@ -1301,7 +1556,7 @@ vos_zcc_destroy(struct vos_zc_context *zcc, int err)
 		vos_obj_release(vos_obj_cache_current(), zcc->zc_obj);
 	vos_zcc_reserve_fini(zcc);
 
-	D_FREE_PTR(zcc);
+	daos_scratch_free(zcc->zc_scratch, zcc);
 }
 
 static int
@@ -1329,7 +1584,7 @@ dkey_zc_fetch_begin(struct vos_zc_context *zcc, daos_epoch_t epoch,
 			return -DER_IO_INVAL;
 		}
 
-		rc = daos_sgl_init(&iobuf->db_sgl, nr);
+		rc = iobuf_sgl_init(iobuf, nr);
 		if (rc != 0) {
 			D_DEBUG(DB_IO, "Failed to create sgl %d: %d\n", i, rc);
 			return rc;
@@ -1449,11 +1704,12 @@ akey_zc_update_begin(struct vos_zc_context *zcc, int iod_idx)
 	}
 
 	iobuf->db_mmid_nr = iod->iod_nr;
-	D_ALLOC(iobuf->db_mmids, iod->iod_nr * sizeof(*iobuf->db_mmids));
+	iobuf->db_mmids = daos_scratch_alloc(iobuf->db_scratch, iod->iod_nr *
+					     sizeof(*iobuf->db_mmids));
 	if (iobuf->db_mmids == NULL)
 		return -DER_NOMEM;
 
-	rc = daos_sgl_init(&iobuf->db_sgl, iod->iod_nr);
+	rc = iobuf_sgl_init(iobuf, iod->iod_nr);
 	if (rc != 0)
 		return -DER_NOMEM;
 
@@ -1608,6 +1864,9 @@ vos_obj_zc_update_end(daos_handle_t ioh, uuid_t cookie, uint32_t pm_ver,
 		D_DEBUG(DB_IO, "Submit ZC update\n");
 		err = dkey_update(zcc->zc_obj, zcc->zc_epoch, cookie,
 				  pm_ver, dkey, iod_nr, iods, NULL, zcc);
+		if (err == 0)
+			err = obj_cookie_update(zcc->zc_obj, cookie,
+						zcc->zc_epoch);
 	} TX_ONABORT {
 		err = umem_tx_errno(err);
 		D_DEBUG(DB_IO, "Failed to submit ZC update: %d\n", err);
@@ -1635,6 +1894,15 @@ vos_obj_zc_sgl_at(daos_handle_t ioh, unsigned int idx, daos_sg_list_t **sgl_pp)
 	return 0;
 }
 
+void
+vos_obj_zc_persist(daos_handle_t ioh, void *addr, daos_size_t size)
+{
+	struct vos_zc_context *zcc = vos_ioh2zcc(ioh);
+
+	D_ASSERT(zcc->zc_is_update && zcc->zc_obj != NULL);
+	umem_persist(vos_obj2umm(zcc->zc_obj), addr, size);
+}
+
 /**
  * @} vos_obj_zio_func
  */
@@ -204,6 +204,8 @@ vos_pool_create(const char *path, uuid_t uuid, daos_size_t size)
 		if (rc != 0)
 			pmemobj_tx_abort(EFAULT);
 
+		pool_df->pd_magic = POOL_DF_MAGIC;
+		pool_df->pd_version = POOL_DF_VERSION;
 		uuid_copy(pool_df->pd_id, uuid);
 		pool_df->pd_pool_info.pif_size  = size;
 		/* XXX we don't really maintain the available size */
@@ -345,6 +347,14 @@ vos_pool_open(const char *path, uuid_t uuid, daos_handle_t *poh)
 	}
 
 	pool_df = vos_pool_ptr2df(pool);
+	if (pool_df->pd_magic != POOL_DF_MAGIC ||
+	    pool_df->pd_version != POOL_DF_VERSION) {
+		D_ERROR("Incompatible pool format, magic=%x version=%u, "
+			"expected magic=%x version=%u\n", pool_df->pd_magic,
+			pool_df->pd_version, POOL_DF_MAGIC, POOL_DF_VERSION);
+		D_GOTO(failed, rc = -DER_PROTO);
+	}
+
 	if (uuid_compare(uuid, pool_df->pd_id)) {
 		D_ERROR("Mismatch uuid, user="DF_UUID", pool="DF_UUID"\n",
 			DP_UUID(uuid), DP_UUID(pool_df->pd_id));
@@ -594,6 +594,7 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 		if (!it_max && !it_reuse) {
 			found++;
 			credits--;
+			vp_anchor->pa_nr_scanned++;
 		}
 
 		if (pcx->pc_type == VOS_ITER_SINGLE) {
@@ -660,6 +661,7 @@ epoch_aggregate(struct purge_context *pcx, int *empty_ret,
 
 		/* Number of keys aggregated in this tree ctx */
 		aggregated++;
+		vp_anchor->pa_nr_purged++;
 	}
 
 	if (rc == 0 && empty_ret != NULL) {
@@ -907,3 +909,147 @@ vos_epoch_aggregate(daos_handle_t coh, daos_unit_oid_t oid,
 	purge_ctx_fini(&pcx, rc);
 	return rc;
 }
+
+/**
+ * Compact record extents of all akeys under the dkey \a dent, resume from
+ * the akey anchor of \a anchor if it is set. The akey anchor is left set if
+ * the pass runs out of credits.
+ */
+static int
+epoch_compact_dkey(struct vos_object *obj, vos_iter_param_t *param,
+		   vos_iter_entry_t *dent, daos_epoch_t epoch,
+		   unsigned int *credits, vos_purge_anchor_t *anchor)
+{
+	vos_iter_entry_t	aent;
+	daos_handle_t		ih;
+	int			rc;
+
+	param->ip_dkey = dent->ie_key;
+	rc = vos_iter_prepare(VOS_ITER_AKEY, param, &ih);
+	if (rc != 0)
+		return rc == -DER_NONEXIST ? 0 : rc;
+
+	if (AKEY_ANCHOR & anchor->pa_mask)
+		rc = vos_iter_probe(ih, &anchor->pa_akey);
+	else
+		rc = vos_iter_probe(ih, NULL);
+
+	while (rc == 0) {
+		rc = vos_iter_fetch(ih, &aent, &anchor->pa_akey);
+		if (rc != 0)
+			break;
+
+		anchor->pa_mask |= AKEY_ANCHOR;
+		rc = vos_obj_recx_compact(obj, dent, &aent, epoch, credits,
+					  &anchor->pa_recx);
+		if (rc != 0)
+			break;
+
+		if (!daos_hash_is_eof(&anchor->pa_recx))
+			break; /* out of credits, resume from this akey */
+
+		memset(&anchor->pa_recx, 0, sizeof(anchor->pa_recx));
+		rc = vos_iter_next(ih);
+	}
+
+	if (rc == -DER_NONEXIST) { /* all akeys have been compacted */
+		memset(&anchor->pa_akey, 0, sizeof(anchor->pa_akey));
+		anchor->pa_mask &= ~AKEY_ANCHOR;
+		rc = 0;
+	}
+	vos_iter_finish(ih);
+	return rc;
+}
+
+int
+vos_epoch_compact(daos_handle_t coh, daos_unit_oid_t oid,
+		  unsigned int *credits, vos_purge_anchor_t *anchor,
+		  bool *finished)
+{
+	struct vos_object	*obj;
+	vos_iter_param_t	 param;
+	vos_iter_entry_t	 dent;
+	vos_cont_info_t		 vc_info;
+	daos_handle_t		 ih;
+	int			 rc;
+
+	*finished = false;
+	if (memcmp(&anchor->pa_oid, &oid, sizeof(oid)) != 0) {
+		/** anchor was working on a different OID */
+		memset(anchor, 0, sizeof(*anchor));
+		anchor->pa_oid = oid;
+	} else if (DKEY_SCAN_COMPLETE & anchor->pa_mask) {
+		*finished = true;
+		return 0;
+	}
+
+	rc = vos_cont_query(coh, &vc_info);
+	if (rc != 0)
+		return rc;
+
+	/** nothing can be compacted before the first aggregation */
+	if (vc_info.pci_purged_epoch == 0) {
+		*finished = true;
+		return 0;
+	}
+
+	D_DEBUG(DB_EPC, "Epoch compact for:"DF_OID" at "DF_U64"\n",
+		DP_OID(oid.id_pub), vc_info.pci_purged_epoch);
+
+	rc = vos_obj_hold(vos_obj_cache_current(), coh, oid, DAOS_EPOCH_MAX,
+			  true, &obj);
+	if (rc != 0)
+		return rc;
+
+	if (vos_obj_is_empty(obj))
+		D_GOTO(done, rc = 0);
+
+	rc = vos_obj_tree_init(obj);
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	memset(&param, 0, sizeof(param));
+	param.ip_hdl		= coh;
+	param.ip_oid		= oid;
+	param.ip_epr.epr_lo	= 0;
+	param.ip_epr.epr_hi	= DAOS_EPOCH_MAX;
+
+	rc = vos_iter_prepare(VOS_ITER_DKEY, &param, &ih);
+	if (rc == -DER_NONEXIST)
+		D_GOTO(done, rc = 0);
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	if (DKEY_ANCHOR & anchor->pa_mask)
+		rc = vos_iter_probe(ih, &anchor->pa_dkey);
+	else
+		rc = vos_iter_probe(ih, NULL);
+
+	while (rc == 0) {
+		rc = vos_iter_fetch(ih, &dent, &anchor->pa_dkey);
+		if (rc != 0)
+			break;
+
+		anchor->pa_mask |= DKEY_ANCHOR;
+		rc = epoch_compact_dkey(obj, &param, &dent,
+					vc_info.pci_purged_epoch, credits,
+					anchor);
+		if (rc != 0 || (AKEY_ANCHOR & anchor->pa_mask))
+			break;
+
+		rc = vos_iter_next(ih);
+	}
+	vos_iter_finish(ih);
+
+	if (rc != -DER_NONEXIST)
+		D_GOTO(out, rc);
+ done:
+	memset(&anchor->pa_dkey, 0, sizeof(anchor->pa_dkey));
+	anchor->pa_mask &= ~DKEY_ANCHOR;
+	anchor->pa_mask |= DKEY_SCAN_COMPLETE;
+	*finished = true;
+	rc = 0;
+ out:
+	vos_obj_release(vos_obj_cache_current(), obj);
+	return rc;
+}
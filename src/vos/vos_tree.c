@@ -79,9 +79,12 @@ vos_iov2rec_bundle(daos_iov_t *val_iov)
  * hashed key for the key-btree, it is stored in btr_record::rec_hkey
  */
 struct kb_hkey {
-	/** murmur64 hash */
+	/** murmur64 hash, or the low half of murmur128 (VOS_KEY_HASH_M128) */
 	uint64_t		kb_hash1;
-	/** reserved: the second hash to avoid hash collison of murmur64 */
+	/**
+	 * the second hash to avoid hash collison of murmur64, or the high
+	 * half of murmur128 (VOS_KEY_HASH_M128)
+	 */
 	uint64_t		kb_hash2;
 	/** Low is the first update epoch, high is the punched epoch or
 	 *  DOAS_EPOCH_MAX if no punch
@@ -189,9 +192,19 @@ kb_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
 	struct vos_key_bundle	*kbund = vos_iov2key_bundle(key_iov);
 	daos_key_t		*key   = kbund->kb_key;
 
-	kkey->kb_hash1  = d_hash_murmur64(key->iov_buf, key->iov_len,
-					  VOS_BTR_MUR_SEED);
-	kkey->kb_hash2  = d_hash_string_u32(key->iov_buf, key->iov_len);
+	if (tins->ti_root->tr_feats & VOS_KEY_HASH_M128) {
+		uint64_t	hash[2];
+
+		daos_hash_murmur128(key->iov_buf, key->iov_len,
+				    VOS_BTR_MUR_SEED, hash);
+		kkey->kb_hash1 = hash[0];
+		kkey->kb_hash2 = hash[1];
+	} else {
+		kkey->kb_hash1 = d_hash_murmur64(key->iov_buf, key->iov_len,
+						 VOS_BTR_MUR_SEED);
+		kkey->kb_hash2 = d_hash_string_u32(key->iov_buf,
+						   key->iov_len);
+	}
 	kkey->kb_epr = *kbund->kb_epr;
 }
 
@@ -367,6 +380,10 @@ kb_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 			tree_feats |= VOS_KEY_CMP_UINT64_SET;
 		else if (obj_feats & DAOS_OF_AKEY_LEXICAL)
 			tree_feats |= VOS_KEY_CMP_LEXICAL_SET;
+		else
+			tree_feats |= VOS_KEY_HASH_M128;
+	} else if (ta->ta_class == VOS_BTR_SINGV) {
+		tree_feats |= VOS_SINGV_INLINE;
 	}
 
 	umem_attr_get(&tins->ti_umm, &uma);
@@ -541,6 +558,29 @@ struct svb_hkey {
 	uuid_t		sv_cookie;
 };
 
+/** size of the inline value buffer of a record (VOS_SINGV_INLINE) */
+#define SVB_INLINE_SIZE	(sizeof(struct vos_irec_df) + VOS_SINGV_INLINE_MAX)
+
+static inline bool
+svb_has_inline(struct btr_instance *tins)
+{
+	return tins->ti_root->tr_feats & VOS_SINGV_INLINE;
+}
+
+/**
+ * Return the vos_irec_df of a record, it is either allocated separately or
+ * stored in the inline value buffer right after the hashed key.
+ */
+static inline struct vos_irec_df *
+svb_rec2irec(struct btr_instance *tins, struct btr_record *rec)
+{
+	if (UMMID_IS_NULL(rec->rec_mmid) && svb_has_inline(tins))
+		return (struct vos_irec_df *)
+		       &rec->rec_hkey[sizeof(struct svb_hkey)];
+
+	return vos_rec2irec(tins, rec);
+}
+
 /**
  * Set size for the record and returns write buffer address of the record,
  * so caller can copy/rdma data into it.
@@ -549,7 +589,7 @@ static int
 svb_rec_copy_in(struct btr_instance *tins, struct btr_record *rec,
 		struct vos_key_bundle *kbund, struct vos_rec_bundle *rbund)
 {
-	struct vos_irec_df	*irec	= vos_rec2irec(tins, rec);
+	struct vos_irec_df	*irec	= svb_rec2irec(tins, rec);
 	daos_csum_buf_t		*csum	= rbund->rb_csum;
 	daos_iov_t		*iov	= rbund->rb_iov;
 	struct svb_hkey		*skey;
@@ -573,6 +613,12 @@ svb_rec_copy_in(struct btr_instance *tins, struct btr_record *rec,
 		return 0;
 	}
 
+	/* NB: value can be provided by caller, the inline value has to be
+	 * copied in here because the record will be moved by btree.
+	 */
+	if (iov->iov_buf != NULL)
+		memcpy(vos_irec2data(irec), iov->iov_buf, iov->iov_len);
+
 	csum->cs_csum = vos_irec2csum(irec);
 	iov->iov_buf = vos_irec2data(irec);
 	return 0;
@@ -586,7 +632,7 @@ svb_rec_copy_out(struct btr_instance *tins, struct btr_record *rec,
 		 struct vos_key_bundle *kbund, struct vos_rec_bundle *rbund)
 {
 	struct svb_hkey	   *skey = (struct svb_hkey *)&rec->rec_hkey[0];
-	struct vos_irec_df *irec  = vos_rec2irec(tins, rec);
+	struct vos_irec_df *irec  = svb_rec2irec(tins, rec);
 	daos_csum_buf_t	   *csum  = rbund->rb_csum;
 	daos_iov_t	   *iov   = rbund->rb_iov;
 
@@ -606,6 +652,7 @@ svb_rec_copy_out(struct btr_instance *tins, struct btr_record *rec,
 	}
 	rbund->rb_rsize	= irec->ir_size;
 	rbund->rb_ver	= irec->ir_ver;
+	rbund->rb_inline = UMMID_IS_NULL(rec->rec_mmid);
 	return 0;
 }
 
@@ -620,6 +667,13 @@ svb_hkey_size(struct btr_instance *tins)
 	return sizeof(struct svb_hkey);
 }
 
+/** size of the inline value buffer */
+static int
+svb_rec_inline_size(struct btr_instance *tins)
+{
+	return svb_has_inline(tins) ? SVB_INLINE_SIZE : 0;
+}
+
 /** generate hkey */
 static void
 svb_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
@@ -660,6 +714,12 @@ svb_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 	rbund = vos_iov2rec_bundle(val_iov);
 
 	if (UMMID_IS_NULL(rbund->rb_mmid)) {
+		if (svb_has_inline(tins) &&
+		    vos_irec_size(rbund) <= SVB_INLINE_SIZE) {
+			rec->rec_mmid = UMMID_NULL; /* stored inline */
+			D_GOTO(copy_in, rc = 0);
+		}
+
 		rec->rec_mmid = umem_alloc(&tins->ti_umm,
 					   vos_irec_size(rbund));
 		if (UMMID_IS_NULL(rec->rec_mmid))
@@ -668,7 +728,7 @@ svb_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 		rec->rec_mmid = rbund->rb_mmid;
 		rbund->rb_mmid = UMMID_NULL; /* taken over by btree */
 	}
-
+ copy_in:
 	rc = svb_rec_copy_in(tins, rec, kbund, rbund);
 	return rc;
 }
@@ -718,7 +778,7 @@ svb_rec_update(struct btr_instance *tins, struct btr_record *rec,
 	rbund = vos_iov2rec_bundle(val_iov);
 
 	if (!UMMID_IS_NULL(rbund->rb_mmid) ||
-	    !vos_irec_size_equal(vos_rec2irec(tins, rec), rbund)) {
+	    !vos_irec_size_equal(svb_rec2irec(tins, rec), rbund)) {
 		/* This function should return -DER_NO_PERM to dbtree if:
 		 * - it is a rdma, the original record should be replaced.
 		 * - the new record size cannot match the original one, so we
@@ -733,12 +793,18 @@ svb_rec_update(struct btr_instance *tins, struct btr_record *rec,
 	skey = (struct svb_hkey *)&rec->rec_hkey[0];
 	D_DEBUG(DB_IO, "Overwrite epoch "DF_U64"\n", skey->sv_epoch);
 
-	umem_tx_add(&tins->ti_umm, rec->rec_mmid, vos_irec_size(rbund));
+	if (UMMID_IS_NULL(rec->rec_mmid)) /* inline value and cookie */
+		umem_tx_add_ptr(&tins->ti_umm, &rec->rec_hkey[0],
+				sizeof(*skey) + vos_irec_size(rbund));
+	else
+		umem_tx_add(&tins->ti_umm, rec->rec_mmid,
+			    vos_irec_size(rbund));
 	return svb_rec_copy_in(tins, rec, kbund, rbund);
 }
 
 static btr_ops_t singv_btr_ops = {
 	.to_hkey_size		= svb_hkey_size,
+	.to_rec_inline_size	= svb_rec_inline_size,
 	.to_hkey_gen		= svb_hkey_gen,
 	.to_hkey_cmp		= svb_hkey_cmp,
 	.to_rec_alloc		= svb_rec_alloc,
@@ -768,7 +834,7 @@ static struct vos_btr_attr vos_btr_attrs[] = {
 	{
 		.ta_class	= VOS_BTR_SINGV,
 		.ta_order	= VOS_BTR_ORDER,
-		.ta_feats	= 0,
+		.ta_feats	= VOS_SINGV_INLINE,
 		.ta_name	= "singv",
 		.ta_ops		= &singv_btr_ops,
 	},
@@ -806,6 +872,8 @@ vos_obj_tree_init(struct vos_object *obj)
 			tree_feats |= VOS_KEY_CMP_UINT64_SET;
 		else if (obj_feats & DAOS_OF_DKEY_LEXICAL)
 			tree_feats |= VOS_KEY_CMP_LEXICAL_SET;
+		else
+			tree_feats |= VOS_KEY_HASH_M128;
 
 		rc = dbtree_create_inplace(ta->ta_class, tree_feats,
 					   ta->ta_order, vos_obj2uma(obj),
@@ -39,7 +39,12 @@ if [ -d "/mnt/daos" ]; then
     run_test src/common/tests/btree.sh perf direct -s 20000
     run_test src/common/tests/btree.sh perf ukey -s 20000
     run_test build/src/common/tests/sched
+    run_test build/src/common/tests/other --hash
     run_test build/src/client/tests/eq_tests
+    run_test build/src/eio/tests/eio_ra_ut
+    run_test build/src/object/tests/obj_bulk_ut
+    run_test build/src/object/tests/srv_bulk_ut
+    run_test build/src/container/tests/agg_pace_ut
     run_test src/vos/tests/evt_ctl.sh
 
     if [ $failed -eq 0 ]; then